@@ -314,6 +314,92 @@ def unpack_mma_output(filename):
 
     return args, objs
 
+def is_history_file(filename):
+    """
+    Check whether the file is a binary iteration history file
+    """
+    try:
+        with open(filename, 'rb') as fp:
+            return fp.read(8) == b'PAROPTHS'
+    except IOError:
+        return False
+
+def read_history(filename):
+    """
+    Map a binary iteration history file into memory.
+
+    The history files are written by the interior point, trust region
+    and MMA optimizers when the history_file, tr_history_file or
+    mma_history_file options are set. The rows are returned as a
+    read-only numpy record array that is memory-mapped from the file,
+    so no data is copied. Columns are accessed by name, for instance
+    data['fobj']. Values that were not set in an iteration are NaN.
+
+    The file can be read while the optimization is running, in which
+    case only the complete rows are returned.
+
+    Returns the name of the solver ('ip', 'tr' or 'mma') and the rows.
+    """
+
+    with open(filename, 'rb') as fp:
+        header = fp.read(64)
+        if len(header) < 64 or header[0:8] != b'PAROPTHS':
+            raise ValueError('%s is not a ParOpt history file'%(filename))
+
+        # Determine the byte order from the marker
+        endian = '<'
+        marker = np.frombuffer(header, dtype='<i4', count=1, offset=12)[0]
+        if marker != 0x01020304:
+            endian = '>'
+        version, marker, header_size, row_size, ncols = \
+            np.frombuffer(header, dtype=endian + 'i4', count=5, offset=8)
+        if version != 1:
+            raise ValueError('Unsupported history file version %d'%(version))
+        solver = header[32:64].split(b'\0', 1)[0].decode('utf-8')
+
+        # Read the column descriptions
+        names = []
+        formats = []
+        offsets = []
+        columns = fp.read(40*ncols)
+        for i in range(ncols):
+            col = columns[40*i:40*(i+1)]
+            names.append(col[0:32].split(b'\0', 1)[0].decode('utf-8'))
+            ctype, coffset = np.frombuffer(col, dtype=endian + 'i4',
+                                           count=2, offset=32)
+            if ctype == 1:
+                formats.append(endian + 'i8')
+            else:
+                formats.append(endian + 'f8')
+            offsets.append(coffset)
+
+        # Find the number of complete rows in the file
+        fp.seek(0, 2)
+        nrows = (fp.tell() - header_size)//row_size
+
+    dtype = np.dtype({'names': names, 'formats': formats,
+                      'offsets': offsets, 'itemsize': row_size})
+    if nrows == 0:
+        return solver, np.zeros(0, dtype=dtype)
+
+    return solver, np.memmap(filename, dtype=dtype, mode='r',
+                             offset=header_size, shape=(nrows,))
+
+def unpack_history(filename):
+    """
+    Unpack the columns from a binary iteration history file.
+
+    This returns the column names and a list of numpy arrays in the
+    same form as unpack_output, unpack_tr_output and unpack_mma_output.
+    The arrays are views of the memory-mapped file.
+    """
+
+    solver, data = read_history(filename)
+    args = list(data.dtype.names)
+    objs = [data[name] for name in args]
+
+    return args, objs
+
 # Read in a ParOpt checkpoint file and produce python variables
 def unpack_checkpoint(filename):
     """Convert the checkpoint file to usable python objects"""
@@ -797,8 +883,12 @@ cdef class Problem(ProblemBase):
         cdef int nwinequality = -1
         cdef int use_lower = 1
         cdef int use_upper = 1
+        cdef int obj_quadratic = 0
+        cdef int sparse_linear = 0
+        cdef int *dense_linear_ptr = NULL
         cdef np.ndarray _rowp
         cdef np.ndarray _cols
+        cdef np.ndarray _dense_linear
 
         # Sparse data - in a python format that will be converted into an array
         rowp = None
@@ -843,6 +933,24 @@ cdef class Problem(ProblemBase):
             else:
                 use_upper = 0
 
+        # Declare a quadratic objective and the linear constraints. The
+        # dense linear flags are given for each dense constraint.
+        if "obj_quadratic" in kwargs:
+            if kwargs["obj_quadratic"]:
+                obj_quadratic = 1
+        if "dense_con_linear" in kwargs:
+            dense_linear = kwargs["dense_con_linear"]
+            if len(dense_linear) != ncon:
+                raise ValueError("dense_con_linear is incorrect length")
+            _dense_linear = np.zeros(ncon, dtype=np.intc)
+            for i in range(ncon):
+                if dense_linear[i]:
+                    _dense_linear[i] = 1
+            dense_linear_ptr = <int*>_dense_linear.data
+        if "sparse_con_linear" in kwargs:
+            if kwargs["sparse_con_linear"]:
+                sparse_linear = 1
+
         # Set the type of sparse constraint
         if "nwblock" in kwargs:
             nwblock = kwargs["nwblock"]
@@ -857,6 +965,7 @@ cdef class Problem(ProblemBase):
             sparse.setProblemSizes(nvars, ncon, nwcon)
             sparse.setNumInequalities(ninequality, nwinequality)
             sparse.setVarBoundOptions(use_lower, use_upper)
+            sparse.setLinearity(obj_quadratic, dense_linear_ptr, sparse_linear)
 
             if len(rowp) != nwcon + 1:
                 raise ValueError("rowp is incorrect length")
@@ -888,6 +997,7 @@ cdef class Problem(ProblemBase):
             block.setProblemSizes(nvars, ncon, nwcon)
             block.setNumInequalities(ninequality, nwinequality)
             block.setVarBoundOptions(use_lower, use_upper)
+            block.setLinearity(obj_quadratic, dense_linear_ptr, sparse_linear)
 
             # Set the pointers
             block.setSelfPointer(<void*>self)
@@ -911,6 +1021,128 @@ cdef class Problem(ProblemBase):
             self.ptr.decref()
         return
 
+cdef int _evalobjconlocal(void *_self, int nvars, int ncon, int nlocal,
+                          ParOptVec *_x, ParOptScalar *fobj,
+                          ParOptScalar *cons, ParOptScalar *lcons):
+    fail = 0
+
+    try:
+        # Call the objective function
+        x = _init_PVec(_x)
+        fail, _fobj, _cons, _lcons = (<object>_self).evalObjConLocal(x)
+
+        # Copy over the objective value
+        fobj[0] = _fobj
+
+        # Copy the values from the numpy arrays
+        for i in range(ncon):
+            cons[i] = _cons[i]
+        for i in range(nlocal):
+            lcons[i] = _lcons[i]
+    except:
+        tb = traceback.format_exc()
+        print(tb)
+        exit(0)
+
+    return fail
+
+cdef int _evalobjconlocalgradient(void *_self, int nvars, int ncon,
+                                  int nlocal, ParOptVec *_x, ParOptVec *_g,
+                                  ParOptVec **A, int num_groups,
+                                  const int *_groups,
+                                  const ParOptScalar *_weights,
+                                  ParOptVec **_Ag):
+    fail = 0
+    try:
+        # The numpy arrays that will be used for x
+        x = _init_PVec(_x)
+        g = _init_PVec(_g)
+        Ac = []
+        for i in range(ncon):
+            Ac.append(_init_PVec(A[i]))
+        Ag = []
+        for i in range(num_groups):
+            Ag.append(_init_PVec(_Ag[i]))
+
+        # Copy the groups and weights of the local constraints
+        groups = np.array(inplace_array_1d(np.NPY_INT, nlocal,
+                                           <void*>_groups))
+        weights = np.array(inplace_array_1d(PAROPT_NPY_SCALAR, nlocal,
+                                            <void*>_weights))
+
+        # Call the objective function
+        fail = (<object>_self).evalObjConLocalGradient(x, g, Ac, groups,
+                                                       weights, Ag)
+    except:
+        tb = traceback.format_exc()
+        print(tb)
+        exit(0)
+
+    return fail
+
+cdef class AggregatedProblem(ProblemBase):
+    cdef CyParOptAggregatedProblem *agg
+    def __init__(self, MPI.Comm comm, int nvars=0, int ncon=0, int nlocal=0,
+                 ninequality=None, options=None):
+        """
+        Create a problem that aggregates a large set of local
+        constraints into a small number of dense constraints
+
+        Sub-classes implement getVarsAndBounds(x, lb, ub),
+        evalObjConLocal(x), which returns fail, fobj, con and lcon, and
+        evalObjConLocalGradient(x, g, A, groups, weights, Ag). The
+        gradient of the k-th aggregate is the sum of weights[j] times
+        the gradient of the j-th local constraint over all j with
+        groups[j] = k, and must be added to Ag[k].
+
+        Args:
+            comm: The MPI communicator
+            nvars: The local number of design variables
+            ncon: The number of user-defined dense constraints
+            nlocal: The number of local constraints on this processor
+            ninequality: The number of user-defined dense inequalities
+            options: The aggregation options
+        """
+        cdef MPI_Comm c_comm = comm.ob_mpi
+        cdef ParOptOptions *opts = new ParOptOptions(c_comm)
+        ParOptAggregatedProblemAddDefaultOptions(opts)
+        if options is not None:
+            addDictionaryToOptions(options, opts)
+
+        if ninequality is None:
+            ninequality = ncon
+
+        self.agg = new CyParOptAggregatedProblem(c_comm, opts)
+        self.agg.setAggregatedProblemSizes(nvars, ncon, nlocal, 0)
+        self.agg.setAggregatedNumInequalities(ninequality, 0)
+
+        # Set the pointers
+        self.agg.setSelfPointer(<void*>self)
+        self.agg.setGetVarsAndBounds(_getvarsandbounds)
+        self.agg.setEvalObjConLocal(_evalobjconlocal)
+        self.agg.setEvalObjConLocalGradient(_evalobjconlocalgradient)
+        self.agg.incref()
+        self.ptr = self.agg
+        return
+
+    def __dealloc__(self):
+        if self.agg:
+            self.agg.decref()
+        return
+
+    def getNumAggregationGroups(self):
+        return self.agg.getNumAggregationGroups()
+
+    def getAggregationParameter(self):
+        return self.agg.getAggregationParameter()
+
+    def updateAggregation(self):
+        """
+        Increase the aggregation parameter and re-compute the groups.
+        Returns True if the aggregated constraints changed.
+        """
+        return self.agg.updateAggregation() != 0
+
 cdef class PVec:
     def __cinit__(self):
         self.ptr = NULL
@@ -1225,9 +1457,52 @@ cdef class LSR1(CompactQuasiNewton):
         self.ptr.setInitDiagonalType(diag_type)
         self.ptr.incref()
 
+cdef class ProblemFactory:
+    cdef CyParOptProblemFactory *ptr
+    cdef list problems
+    def __cinit__(self):
+        """
+        Create the problem instances used to evaluate several design
+        points concurrently on groups of processors
+
+        Sub-classes must implement createProblem(comm), which returns a
+        new problem instance on the communicator of the group.
+        """
+        self.problems = []
+        self.ptr = new CyParOptProblemFactory()
+        self.ptr.setSelfPointer(<void*>self)
+        self.ptr.setCreateProblem(_createproblem)
+        self.ptr.incref()
+
+    def __dealloc__(self):
+        if self.ptr:
+            self.ptr.decref()
+
+    def createProblem(self, comm):
+        raise NotImplementedError()
+
+cdef ParOptProblem* _createproblem(void *_self, MPI_Comm _comm):
+    cdef ProblemBase prob = None
+    cdef MPI.Comm comm = MPI.Comm()
+    try:
+        comm.ob_mpi = _comm
+        prob = (<object>_self).createProblem(comm)
+
+        # Keep a reference to the problem for the life of the factory
+        (<ProblemFactory>_self).problems.append(prob)
+    except:
+        tb = traceback.format_exc()
+        print(tb)
+        exit(0)
+
+    if prob is None:
+        return NULL
+    return prob.ptr
+
 # Python class for corresponding instance ParOpt
 cdef class InteriorPoint:
     cdef ParOptInteriorPoint *ptr
+    cdef ProblemFactory ls_factory
     def __cinit__(self, ProblemBase _prob, options):
         cdef ParOptOptions *opts = new ParOptOptions(_prob.ptr.getMPIComm())
         ParOptInteriorPointAddDefaultOptions(opts)
@@ -1338,6 +1613,9 @@ cdef class InteriorPoint:
         self.ptr.setPenaltyGamma(g)
         free(g)
 
+    def getBarrierParameter(self):
+        return self.ptr.getBarrierParameter()
+
     def getComplementarity(self):
         return self.ptr.getComplementarity()
 
@@ -1353,6 +1631,30 @@ cdef class InteriorPoint:
     def resetDesignAndBounds(self):
         self.ptr.resetDesignAndBounds()
 
+    def warmStartDesignAndBounds(self, PVec x, z=None, PVec zw=None,
+                                 PVec zl=None, PVec zu=None):
+        """
+        Start the next optimization from the design point x and the
+        multipliers from a previous optimization
+        """
+        cdef ParOptScalar *_z = NULL
+        cdef ParOptVec *_zw = NULL
+        cdef ParOptVec *_zl = NULL
+        cdef ParOptVec *_zu = NULL
+        cdef np.ndarray z_array
+
+        # Copy the multipliers to a contiguous array
+        if z is not None:
+            z_array = np.array(z, dtype=dtype)
+            _z = <ParOptScalar*>z_array.data
+        if zw is not None:
+            _zw = zw.ptr
+        if zl is not None:
+            _zl = zl.ptr
+        if zu is not None:
+            _zu = zu.ptr
+        self.ptr.warmStartDesignAndBounds(x.ptr, _z, _zw, _zl, _zu)
+
     # Write out the design variables to binary format (fast MPI/IO)
     def writeSolutionFile(self, fname):
         cdef char *filename = convert_to_chars(fname)
@@ -1364,6 +1666,18 @@ cdef class InteriorPoint:
         if filename is not None:
             return self.ptr.readSolutionFile(filename)
 
+    def setLineSearchProblemFactory(self, ProblemFactory factory):
+        """
+        Set the factory used to evaluate the line search trial points
+        concurrently. The number of groups is set by the
+        num_line_search_groups option.
+        """
+        self.ls_factory = factory
+        if factory is not None:
+            self.ptr.setLineSearchProblemFactory(factory.ptr)
+        else:
+            self.ptr.setLineSearchProblemFactory(NULL)
+
 cdef class MMA(ProblemBase):
     cdef ParOptMMA *mma
     def __cinit__(self, ProblemBase _prob, options):
@@ -1375,11 +1689,54 @@ cdef class MMA(ProblemBase):
         self.ptr = self.mma
         return
 
+    def optimize(self, InteriorPoint optimizer):
+        self.mma.optimize(optimizer.ptr)
+
     def getOptimizedPoint(self):
         cdef ParOptVec *x
         self.mma.getOptimizedPoint(&x)
         return _init_PVec(x)
 
+    def evalObjCon(self, PVec x):
+        """
+        Evaluate the objective and constraints of the current subproblem
+
+        Returns fail, fobj and the constraint values
+        """
+        cdef int ncon = 0
+        cdef ParOptScalar fobj = 0.0
+        cdef np.ndarray con
+        self.mma.getProblemSizes(NULL, &ncon, NULL)
+        con = np.zeros(ncon, dtype=dtype)
+        fail = self.mma.evalObjCon(x.ptr, &fobj, <ParOptScalar*>con.data)
+        return fail, fobj, con
+
+    def evalObjConGradient(self, PVec x, PVec g, list A):
+        """
+        Evaluate the objective and constraint gradients of the current
+        subproblem in g and the vectors in A
+        """
+        cdef int ncon = 0
+        cdef ParOptVec **Ac = NULL
+        self.mma.getProblemSizes(NULL, &ncon, NULL)
+        if len(A) != ncon:
+            raise ValueError('Expected %d constraint gradient vectors'%(ncon))
+        Ac = <ParOptVec**>malloc(ncon*sizeof(ParOptVec*))
+        for i in range(ncon):
+            Ac[i] = (<PVec>A[i]).ptr
+        fail = self.mma.evalObjConGradient(x.ptr, g.ptr, Ac)
+        free(Ac)
+        return fail
+
+    def evalHessianDiag(self, PVec x, z, PVec hdiag):
+        """
+        Evaluate the diagonal of the Hessian of the Lagrangian of the
+        current subproblem in hdiag
+        """
+        cdef np.ndarray z_array = np.array(z, dtype=dtype)
+        return self.mma.evalHessianDiag(x.ptr, <ParOptScalar*>z_array.data,
+                                        NULL, hdiag.ptr)
+
     def getAsymptotes(self):
         cdef ParOptVec *L = NULL
         cdef ParOptVec *U = NULL
@@ -1392,6 +1749,214 @@ cdef class MMA(ProblemBase):
         self.mma.getDesignHistory(&x1, &x2)
         return _init_PVec(x1), _init_PVec(x2)
 
+cdef class CachedProblem(ProblemBase):
+    cdef ParOptCachedProblem *cached
+    def __cinit__(self, ProblemBase _prob, int max_entries=4):
+        """
+        Wrap a problem so that repeated evaluations at the same design
+        point are taken from a cache of recent evaluations
+
+        Args:
+            _prob: The problem to wrap
+            max_entries: The maximum number of cached design points
+        """
+        self.cached = new ParOptCachedProblem(_prob.ptr, max_entries)
+        self.cached.incref()
+        self.ptr = self.cached
+        return
+
+    def clearCache(self):
+        self.cached.clearCache()
+
+    def getCacheStats(self):
+        """
+        Get the number of objective and gradient cache hits and misses
+        """
+        cdef int obj_hits = 0
+        cdef int obj_misses = 0
+        cdef int grad_hits = 0
+        cdef int grad_misses = 0
+        self.cached.getCacheStats(&obj_hits, &obj_misses,
+                                  &grad_hits, &grad_misses)
+        return {'obj_hits': obj_hits, 'obj_misses': obj_misses,
+                'grad_hits': grad_hits, 'grad_misses': grad_misses}
+
+cdef class PresolvedProblem(ProblemBase):
+    cdef ParOptPresolvedProblem *pre
+    def __cinit__(self, ProblemBase _prob, double fixed_tol=0.0,
+                  double max_bound_value=1e20):
+        """
+        Wrap a problem so that the fixed variables and the redundant
+        constraints are removed from the problem passed to the optimizer
+
+        Args:
+            _prob: The problem to wrap
+            fixed_tol: Tolerance used to detect the fixed variables
+            max_bound_value: Bounds larger than this value are ignored
+        """
+        self.pre = new ParOptPresolvedProblem(_prob.ptr, fixed_tol,
+                                              max_bound_value)
+        self.pre.incref()
+        self.ptr = self.pre
+        return
+
+    def getPresolveStats(self):
+        """
+        Get the number of fixed variables and removed constraints
+        """
+        cdef int num_fixed = 0
+        cdef int num_dense_removed = 0
+        cdef int num_sparse_removed = 0
+        self.pre.getPresolveStats(&num_fixed, &num_dense_removed,
+                                  &num_sparse_removed)
+        return {'num_fixed': num_fixed,
+                'num_dense_removed': num_dense_removed,
+                'num_sparse_removed': num_sparse_removed}
+
+    def postsolve(self, PVec xr, zr=None, PVec zwr=None, PVec zlr=None,
+                  PVec zur=None):
+        """
+        Recover the solution and multipliers of the wrapped problem from
+        the solution of the reduced problem
+
+        Returns x, z, zw, zl and zu for the wrapped problem
+        """
+        cdef int ncon = 0
+        cdef int nwcon = 0
+        cdef ParOptProblem *prob = self.pre.getProblem()
+        cdef ParOptScalar *_zr = NULL
+        cdef ParOptVec *_zwr = NULL
+        cdef ParOptVec *_zlr = NULL
+        cdef ParOptVec *_zur = NULL
+        cdef ParOptVec *_zw = NULL
+        cdef np.ndarray zr_array
+        cdef np.ndarray z
+        cdef PVec x, zl, zu
+
+        # Copy the reduced multipliers to a contiguous array
+        if zr is not None:
+            zr_array = np.array(zr, dtype=dtype)
+            _zr = <ParOptScalar*>zr_array.data
+        if zwr is not None:
+            _zwr = zwr.ptr
+        if zlr is not None:
+            _zlr = zlr.ptr
+        if zur is not None:
+            _zur = zur.ptr
+
+        # Create the vectors for the wrapped problem
+        prob.getProblemSizes(NULL, &ncon, &nwcon)
+        x = _init_PVec(prob.createDesignVec())
+        z = np.zeros(ncon, dtype=dtype)
+        zw = None
+        if nwcon > 0:
+            zw = _init_PVec(prob.createConstraintVec())
+            _zw = (<PVec>zw).ptr
+        zl = _init_PVec(prob.createDesignVec())
+        zu = _init_PVec(prob.createDesignVec())
+
+        self.pre.postsolve(xr.ptr, _zr, _zwr, _zlr, _zur, x.ptr,
+                           <ParOptScalar*>z.data, _zw, zl.ptr, zu.ptr)
+
+        return x, z, zw, zl, zu
+
+cdef class ScaledProblem(ProblemBase):
+    cdef ParOptScaledProblem *scaled
+    def __cinit__(self, ProblemBase _prob, options=None):
+        """
+        Wrap a problem so that the objective, the dense constraints and
+        the design variables are scaled using the gradients at the
+        starting point
+
+        Args:
+            _prob: The problem to wrap
+            options: The scaling options
+        """
+        cdef MPI_Comm c_comm = _prob.ptr.getMPIComm()
+        cdef ParOptOptions *opts = new ParOptOptions(c_comm)
+        ParOptScaledProblemAddDefaultOptions(opts)
+        if options is not None:
+            addDictionaryToOptions(options, opts)
+
+        self.scaled = new ParOptScaledProblem(_prob.ptr, opts)
+        self.scaled.incref()
+        self.ptr = self.scaled
+        return
+
+    def updateScaling(self, PVec x=None):
+        """
+        Re-compute the scale factors at the given point, or at the
+        starting point of the wrapped problem
+        """
+        cdef ParOptVec *_x = NULL
+        if x is not None:
+            _x = x.ptr
+        return self.scaled.updateScaling(_x)
+
+    def getScaling(self):
+        """
+        Get the objective, constraint and design variable scale factors
+        """
+        cdef int ncon = 0
+        cdef double fscale = 1.0
+        cdef const double *cscale = NULL
+        cdef ParOptVec *dscale = NULL
+        self.scaled.getProblemSizes(NULL, &ncon, NULL)
+        self.scaled.getScaling(&fscale, &cscale, &dscale)
+
+        c = np.zeros(ncon)
+        for i in range(ncon):
+            c[i] = cscale[i]
+        return fscale, c, _init_PVec(dscale)
+
+    def unscaleSolution(self, PVec xs, zs=None, PVec zws=None,
+                        PVec zls=None, PVec zus=None):
+        """
+        Recover the solution and multipliers of the wrapped problem from
+        the solution of the scaled problem
+
+        Returns x, z, zw, zl and zu for the wrapped problem
+        """
+        cdef int ncon = 0
+        cdef int nwcon = 0
+        cdef ParOptProblem *prob = self.scaled.getProblem()
+        cdef ParOptScalar *_zs = NULL
+        cdef ParOptVec *_zws = NULL
+        cdef ParOptVec *_zls = NULL
+        cdef ParOptVec *_zus = NULL
+        cdef ParOptVec *_zw = NULL
+        cdef np.ndarray zs_array
+        cdef np.ndarray z
+        cdef PVec x, zl, zu
+
+        # Copy the scaled multipliers to a contiguous array
+        if zs is not None:
+            zs_array = np.array(zs, dtype=dtype)
+            _zs = <ParOptScalar*>zs_array.data
+        if zws is not None:
+            _zws = zws.ptr
+        if zls is not None:
+            _zls = zls.ptr
+        if zus is not None:
+            _zus = zus.ptr
+
+        # Create the vectors for the wrapped problem
+        prob.getProblemSizes(NULL, &ncon, &nwcon)
+        x = _init_PVec(prob.createDesignVec())
+        z = np.zeros(ncon, dtype=dtype)
+        zw = None
+        if nwcon > 0:
+            zw = _init_PVec(prob.createConstraintVec())
+            _zw = (<PVec>zw).ptr
+        zl = _init_PVec(prob.createDesignVec())
+        zu = _init_PVec(prob.createDesignVec())
+
+        self.scaled.unscaleSolution(xs.ptr, _zs, _zws, _zls, _zus, x.ptr,
+                                    <ParOptScalar*>z.data, _zw, zl.ptr,
+                                    zu.ptr)
+
+        return x, z, zw, zl, zu
+
 cdef class TrustRegionSubproblem:
     def __cinit__(self):
         self.ptr = NULL
@@ -1423,6 +1988,7 @@ cdef class QuadraticSubproblem(TrustRegionSubproblem):
 
 cdef class TrustRegion:
     cdef ParOptTrustRegion *tr
+    cdef ProblemFactory rg_factory
     def __cinit__(self, TrustRegionSubproblem prob, options):
         """
         Create a trust region optimization object
@@ -1458,6 +2024,29 @@ cdef class TrustRegion:
 
         return x
 
+    # Write out the trust region state to a checkpoint file
+    def writeCheckpointFile(self, fname, compress=False):
+        cdef char *filename = convert_to_chars(fname)
+        if filename is not None:
+            return self.tr.writeCheckpointFile(filename, compress)
+
+    def readCheckpointFile(self, fname):
+        cdef char *filename = convert_to_chars(fname)
+        if filename is not None:
+            return self.tr.readCheckpointFile(filename)
+
+    def setRadiusProblemFactory(self, ProblemFactory factory):
+        """
+        Set the factory used to evaluate the trial points for decreasing
+        trust region radii concurrently after a rejected step. The
+        number of groups is set by the tr_num_radius_groups option.
+        """
+        self.rg_factory = factory
+        if factory is not None:
+            self.tr.setRadiusProblemFactory(factory.ptr)
+        else:
+            self.tr.setRadiusProblemFactory(NULL)
+
 cdef class Optimizer:
     cdef ParOptOptimizer *ptr
     def __cinit__(self, ProblemBase problem, options):
@@ -35,6 +35,9 @@ cdef extern from "ParOptProblem.h":
         void getProblemSizes(int*, int*, int*)
         void checkGradients(double, ParOptVec*, int)
 
+    cdef cppclass ParOptProblemFactory(ParOptBase):
+        pass
+
 cdef extern from "ParOptQuasiNewton.h":
     enum ParOptBFGSUpdateType:
         PAROPT_SKIP_NEGATIVE_CURVATURE
@@ -88,6 +91,8 @@ cdef extern from "CyParOptProblem.h":
                                                         ParOptVec *x, ParOptScalar *z,
                                                         ParOptVec *zw,
                                                         ParOptVec *s, ParOptVec *y) except *
+    ctypedef ParOptProblem* (*createproblem)(void *_self,
+                                             MPI_Comm comm) except *
     ctypedef void (*evalsparsecon)(void *_self, int nvars, int nwcon,
                                    ParOptVec *x, ParOptVec *out) except *
     ctypedef void (*addsparsejacobian)(void *_self, int nvars, int nwcon,
@@ -108,6 +113,7 @@ cdef extern from "CyParOptProblem.h":
     cdef cppclass CyParOptBlockProblem(ParOptProblem):
         CyParOptBlockProblem(MPI_Comm, int)
         void setVarBoundOptions(int, int)
+        void setLinearity(int, const int*, int)
         void setSelfPointer(void *_self)
         void setGetVarsAndBounds(getvarsandbounds usr_func)
         void setEvalObjCon(evalobjcon usr_func)
@@ -123,6 +129,7 @@ cdef extern from "CyParOptProblem.h":
     cdef cppclass CyParOptSparseProblem(ParOptProblem):
         CyParOptSparseProblem(MPI_Comm)
         void setVarBoundOptions(int, int)
+        void setLinearity(int, const int*, int)
         void setSparseJacobianData(const int *, const int*)
         void setSelfPointer(void *_self)
         void setGetVarsAndBounds(getvarsandbounds usr_func)
@@ -132,6 +139,11 @@ cdef extern from "CyParOptProblem.h":
         void setEvalHessianDiag(evalhessiandiag usr_func)
         void setComputeQuasiNewtonUpdateCorrection(computequasinewtonupdatecorrection usr_func)
 
+    cdef cppclass CyParOptProblemFactory(ParOptProblemFactory):
+        CyParOptProblemFactory()
+        void setSelfPointer(void *_self)
+        void setCreateProblem(createproblem usr_func)
+
 cdef extern from "ParOptOptions.h":
     cppclass ParOptOptions(ParOptBase):
         ParOptOptions()
@@ -174,8 +186,11 @@ cdef extern from "ParOptInteriorPoint.h":
         void setQuasiNewton(ParOptCompactQuasiNewton*)
         void resetQuasiNewtonHessian()
         void resetDesignAndBounds()
+        void warmStartDesignAndBounds(ParOptVec*, ParOptScalar*, ParOptVec*,
+                                      ParOptVec*, ParOptVec*)
         int writeSolutionFile(const char*)
         int readSolutionFile(const char*)
+        void setLineSearchProblemFactory(ParOptProblemFactory*)
 
     void ParOptInteriorPointAddDefaultOptions"ParOptInteriorPoint::addDefaultOptions"(ParOptOptions*)
 
@@ -185,10 +200,68 @@ cdef extern from "ParOptMMA.h":
         void optimize(ParOptInteriorPoint*)
         void getOptimizedPoint(ParOptVec**)
         void getAsymptotes(ParOptVec**, ParOptVec**)
+        int evalObjCon(ParOptVec*, ParOptScalar*, ParOptScalar*)
+        int evalObjConGradient(ParOptVec*, ParOptVec*, ParOptVec**)
+        int evalHessianDiag(ParOptVec*, ParOptScalar*, ParOptVec*, ParOptVec*)
         void getDesignHistory(ParOptVec**, ParOptVec**)
 
     void ParOptMMAAddDefaultOptions"ParOptMMA::addDefaultOptions"(ParOptOptions*)
 
+cdef extern from "ParOptCachedProblem.h":
+    cdef cppclass ParOptCachedProblem(ParOptProblem):
+        ParOptCachedProblem(ParOptProblem*, int)
+        void clearCache()
+        void getCacheStats(int*, int*, int*, int*)
+
+cdef extern from "ParOptPresolvedProblem.h":
+    cdef cppclass ParOptPresolvedProblem(ParOptProblem):
+        ParOptPresolvedProblem(ParOptProblem*, double, double)
+        ParOptProblem* getProblem()
+        void getPresolveStats(int*, int*, int*)
+        int postsolve(ParOptVec*, ParOptScalar*, ParOptVec*, ParOptVec*,
+                      ParOptVec*, ParOptVec*, ParOptScalar*, ParOptVec*,
+                      ParOptVec*, ParOptVec*)
+
+cdef extern from "ParOptScaledProblem.h":
+    void ParOptScaledProblemAddDefaultOptions"ParOptScaledProblem::addDefaultOptions"(ParOptOptions*)
+    cdef cppclass ParOptScaledProblem(ParOptProblem):
+        ParOptScaledProblem(ParOptProblem*, ParOptOptions*)
+        ParOptProblem* getProblem()
+        int updateScaling(ParOptVec*)
+        void getScaling(double*, const double**, ParOptVec**)
+        void unscaleSolution(ParOptVec*, ParOptScalar*, ParOptVec*,
+                             ParOptVec*, ParOptVec*, ParOptVec*,
+                             ParOptScalar*, ParOptVec*, ParOptVec*,
+                             ParOptVec*)
+
+cdef extern from "ParOptAggregatedProblem.h":
+    void ParOptAggregatedProblemAddDefaultOptions"ParOptAggregatedProblem::addDefaultOptions"(ParOptOptions*)
+
+cdef extern from "CyParOptProblem.h":
+    ctypedef int (*evalobjconlocal)(void *_self, int nvars, int ncon,
+                                    int nlocal, ParOptVec *x,
+                                    ParOptScalar *fobj, ParOptScalar *cons,
+                                    ParOptScalar *lcons) except *
+    ctypedef int (*evalobjconlocalgradient)(void *_self, int nvars, int ncon,
+                                            int nlocal, ParOptVec *x,
+                                            ParOptVec *gobj, ParOptVec **A,
+                                            int num_groups, const int *groups,
+                                            const ParOptScalar *weights,
+                                            ParOptVec **Ag) except *
+
+    cdef cppclass CyParOptAggregatedProblem(ParOptProblem):
+        CyParOptAggregatedProblem(MPI_Comm, ParOptOptions*)
+        void setAggregatedProblemSizes(int, int, int, int)
+        void setAggregatedNumInequalities(int, int)
+        int getNumAggregationGroups()
+        int getNumLocalConstraints()
+        double getAggregationParameter()
+        int updateAggregation()
+        void setSelfPointer(void *_self)
+        void setGetVarsAndBounds(getvarsandbounds usr_func)
+        void setEvalObjConLocal(evalobjconlocal usr_func)
+        void setEvalObjConLocalGradient(evalobjconlocalgradient usr_func)
+
 cdef extern from "ParOptTrustRegion.h":
     cdef cppclass ParOptTrustRegionSubproblem(ParOptProblem):
         pass
@@ -207,6 +280,9 @@ cdef extern from "ParOptTrustRegion.h":
         void setPenaltyGammaMin(double)
         void optimize(ParOptInteriorPoint*)
         void getOptimizedPoint(ParOptVec**)
+        int writeCheckpointFile(const char*, int)
+        int readCheckpointFile(const char*)
+        void setRadiusProblemFactory(ParOptProblemFactory*)
 
     void ParOptTrustRegionAddDefaultOptions"ParOptTrustRegion::addDefaultOptions"(ParOptOptions*)
 
@@ -30,10 +30,17 @@ def plot_history(filename, savefig=False):
         "#17becf",
     ]
 
-    # Try to unpack values for the interior point code
-    header, values = ParOpt.unpack_output(filename)
+    # Binary history files record the solver that wrote them
+    solver = None
+    if ParOpt.is_history_file(filename):
+        solver, data = ParOpt.read_history(filename)
+        header = list(data.dtype.names)
+        values = [data[name] for name in header]
+    else:
+        # Try to unpack values for the interior point code
+        header, values = ParOpt.unpack_output(filename)
 
-    if len(values[0]) > 0:
+    if solver == "ip" or (solver is None and len(values[0]) > 0):
         # You can get more stuff out of this array
         iteration = np.linspace(1, len(values[0]), len(values[0]))
         objective = values[7]
@@ -62,14 +69,21 @@ def plot_history(filename, savefig=False):
         ax1.legend(lns, labs, loc=0)
         plt.title(filename)
     else:
-        # Unpack the output file
-        header, values = ParOpt.unpack_tr_output(filename)
+        if solver is None:
+            # Unpack the output file
+            header, values = ParOpt.unpack_tr_output(filename)
 
-        # Try to unpack and plot secondary tr outputs
-        header2, values2 = ParOpt.unpack_tr_2nd_output(filename)
-        have_2nd_tr_data = len(values2[0]) > 0
+            # Try to unpack and plot secondary tr outputs
+            header2, values2 = ParOpt.unpack_tr_2nd_output(filename)
+            have_2nd_tr_data = len(values2[0]) > 0
+        else:
+            # The model reductions are NaN unless set by the optimizer
+            header2, values2 = header, values
+            have_2nd_tr_data = solver == "tr" and not np.all(
+                np.isnan(values[header.index("ared(f)")])
+            )
 
-        if len(values[0]) > 0:
+        if solver == "tr" or (solver is None and len(values[0]) > 0):
             # You can get more stuff out of this array
             iteration = np.linspace(1, len(values[0]), len(values[0]))
             objective = values[header.index("fobj")]
@@ -136,7 +150,8 @@ def plot_history(filename, savefig=False):
 
         else:
             # Unpack the output file
-            header, values = ParOpt.unpack_mma_output(filename)
+            if solver is None:
+                header, values = ParOpt.unpack_mma_output(filename)
 
             # You can get more stuff out of this array
             iteration = np.linspace(1, len(values[0]), len(values[0]))
@@ -25,6 +25,11 @@ CyParOptBlockProblem::CyParOptBlockProblem(MPI_Comm _comm, int _nwblock)
   useLower = 1;
   useUpper = 1;
 
+  // By default, nothing is declared linear
+  objQuadratic = 0;
+  denseLinear = NULL;
+  sparseLinear = 0;
+
   // Set the initial values for the callbacks
   self = NULL;
   getvarsandbounds = NULL;
@@ -39,7 +44,11 @@ CyParOptBlockProblem::CyParOptBlockProblem(MPI_Comm _comm, int _nwblock)
   computequasinewtonupdatecorrection = NULL;
 }
 
-CyParOptBlockProblem::~CyParOptBlockProblem() {}
+CyParOptBlockProblem::~CyParOptBlockProblem() {
+  if (denseLinear) {
+    delete[] denseLinear;
+  }
+}
 
 /*
   Return the quasi-def block matrix instance associated with this problem
@@ -70,6 +79,45 @@ void CyParOptBlockProblem::setVarBoundOptions(int _useLower, int _useUpper) {
 int CyParOptBlockProblem::useLowerBounds() { return useLower; }
 int CyParOptBlockProblem::useUpperBounds() { return useUpper; }
 
+/**
+  Declare the linearity of the objective and the constraints
+
+  This must be called after the problem sizes are set. A NULL array
+  indicates that none of the dense constraints are linear.
+
+  @param _objQuadratic flag indicating a quadratic objective
+  @param _denseLinear flags for each of the dense constraints
+  @param _sparseLinear flag indicating linear sparse constraints
+*/
+void CyParOptBlockProblem::setLinearity(int _objQuadratic,
+                                        const int *_denseLinear,
+                                        int _sparseLinear) {
+  objQuadratic = _objQuadratic;
+  sparseLinear = _sparseLinear;
+  if (denseLinear) {
+    delete[] denseLinear;
+    denseLinear = NULL;
+  }
+  if (_denseLinear && ncon > 0) {
+    denseLinear = new int[ncon];
+    memcpy(denseLinear, _denseLinear, ncon * sizeof(int));
+  }
+}
+
+/*
+  Functions to indicate the linearity of the problem
+*/
+int CyParOptBlockProblem::isObjQuadratic() { return objQuadratic; }
+
+int CyParOptBlockProblem::isDenseConLinear(int index) {
+  if (denseLinear && index >= 0 && index < ncon) {
+    return denseLinear[index];
+  }
+  return 0;
+}
+
+int CyParOptBlockProblem::isSparseConLinear() { return sparseLinear; }
+
 /*
   Set the member callback functions that are required
 */
@@ -296,6 +344,11 @@ CyParOptSparseProblem::CyParOptSparseProblem(MPI_Comm _comm)
   useLower = 1;
   useUpper = 1;
 
+  // By default, nothing is declared linear
+  objQuadratic = 0;
+  denseLinear = NULL;
+  sparseLinear = 0;
+
   // Set the initial values for the callbacks
   self = NULL;
   getvarsandbounds = NULL;
@@ -306,7 +359,11 @@ CyParOptSparseProblem::CyParOptSparseProblem(MPI_Comm _comm)
   computequasinewtonupdatecorrection = NULL;
 }
 
-CyParOptSparseProblem::~CyParOptSparseProblem() {}
+CyParOptSparseProblem::~CyParOptSparseProblem() {
+  if (denseLinear) {
+    delete[] denseLinear;
+  }
+}
 
 /**
   Set options associated with the inequality constraints
@@ -325,6 +382,45 @@ void CyParOptSparseProblem::setVarBoundOptions(int _useLower, int _useUpper) {
 int CyParOptSparseProblem::useLowerBounds() { return useLower; }
 int CyParOptSparseProblem::useUpperBounds() { return useUpper; }
 
+/**
+  Declare the linearity of the objective and the constraints
+
+  This must be called after the problem sizes are set. A NULL array
+  indicates that none of the dense constraints are linear.
+
+  @param _objQuadratic flag indicating a quadratic objective
+  @param _denseLinear flags for each of the dense constraints
+  @param _sparseLinear flag indicating linear sparse constraints
+*/
+void CyParOptSparseProblem::setLinearity(int _objQuadratic,
+                                         const int *_denseLinear,
+                                         int _sparseLinear) {
+  objQuadratic = _objQuadratic;
+  sparseLinear = _sparseLinear;
+  if (denseLinear) {
+    delete[] denseLinear;
+    denseLinear = NULL;
+  }
+  if (_denseLinear && ncon > 0) {
+    denseLinear = new int[ncon];
+    memcpy(denseLinear, _denseLinear, ncon * sizeof(int));
+  }
+}
+
+/*
+  Functions to indicate the linearity of the problem
+*/
+int CyParOptSparseProblem::isObjQuadratic() { return objQuadratic; }
+
+int CyParOptSparseProblem::isDenseConLinear(int index) {
+  if (denseLinear && index >= 0 && index < ncon) {
+    return denseLinear[index];
+  }
+  return 0;
+}
+
+int CyParOptSparseProblem::isSparseConLinear() { return sparseLinear; }
+
 /*
   Set the member callback functions that are required
 */
@@ -458,3 +554,135 @@ void CyParOptSparseProblem::computeQuasiNewtonUpdateCorrection(
   // Evaluate the Hessian-vector callback
   computequasinewtonupdatecorrection(self, nvars, ncon, x, z, zw, s, y);
 }
+
+/**
+  The constructor for the ParOptAggregatedProblem wrapper.
+
+  This wrapper is used when generating a Python instance of a
+  ParOptAggregatedProblem class. The wrapper is instantiated by Cython
+  and callbacks are used to implement the required API.
+
+  @param _comm the MPI communicator
+  @param _options the aggregation options
+*/
+CyParOptAggregatedProblem::CyParOptAggregatedProblem(MPI_Comm _comm,
+                                                     ParOptOptions *_options)
+    : ParOptAggregatedProblem(_comm, _options) {
+  // Set the initial values for the callbacks
+  self = NULL;
+  getvarsandbounds = NULL;
+  evalobjconlocal = NULL;
+  evalobjconlocalgradient = NULL;
+}
+
+CyParOptAggregatedProblem::~CyParOptAggregatedProblem() {}
+
+/*
+  Return the quasi-def matrix associated with this problem. The wrapper
+  does not use sparse constraints.
+*/
+ParOptQuasiDefMat *CyParOptAggregatedProblem::createQuasiDefMat() {
+  return new ParOptQuasiDefBlockMat(this, 0);
+}
+
+void CyParOptAggregatedProblem::setSelfPointer(void *_self) { self = _self; }
+
+void CyParOptAggregatedProblem::setGetVarsAndBounds(
+    void (*func)(void *, int, ParOptVec *, ParOptVec *, ParOptVec *)) {
+  getvarsandbounds = func;
+}
+
+void CyParOptAggregatedProblem::setEvalObjConLocal(
+    int (*func)(void *, int, int, int, ParOptVec *, ParOptScalar *,
+                ParOptScalar *, ParOptScalar *)) {
+  evalobjconlocal = func;
+}
+
+void CyParOptAggregatedProblem::setEvalObjConLocalGradient(
+    int (*func)(void *, int, int, int, ParOptVec *, ParOptVec *, ParOptVec **,
+                int, const int *, const ParOptScalar *, ParOptVec **)) {
+  evalobjconlocalgradient = func;
+}
+
+/*
+  Get the variables and bounds from the problem
+*/
+void CyParOptAggregatedProblem::getVarsAndBounds(ParOptVec *x, ParOptVec *lb,
+                                                 ParOptVec *ub) {
+  if (!getvarsandbounds) {
+    fprintf(stderr, "getvarsandbounds callback not defined\n");
+    return;
+  }
+  getvarsandbounds(self, nvars, x, lb, ub);
+}
+
+/*
+  Evaluate the objective, the user-defined dense constraints and the
+  local constraints
+*/
+int CyParOptAggregatedProblem::evalObjConLocal(ParOptVec *x,
+                                               ParOptScalar *fobj,
+                                               ParOptScalar *cons,
+                                               ParOptScalar *lcons) {
+  if (!evalobjconlocal) {
+    fprintf(stderr, "evalobjconlocal callback not defined\n");
+    return 1;
+  }
+
+  // Evaluate the objective and constraints
+  int fail = evalobjconlocal(self, nvars, ncon - getNumAggregationGroups(),
+                             getNumLocalConstraints(), x, fobj, cons, lcons);
+  return fail;
+}
+
+/*
+  Evaluate the objective and constraint gradients along with the
+  gradients of the aggregated constraints
+*/
+int CyParOptAggregatedProblem::evalObjConLocalGradient(
+    ParOptVec *x, ParOptVec *g, ParOptVec **Ac, int num_groups,
+    const int *groups, const ParOptScalar *weights, ParOptVec **Ag) {
+  if (!evalobjconlocalgradient) {
+    fprintf(stderr, "evalobjconlocalgradient callback not defined\n");
+    return 1;
+  }
+
+  // Evaluate the gradients
+  int fail = evalobjconlocalgradient(
+      self, nvars, ncon - getNumAggregationGroups(), getNumLocalConstraints(),
+      x, g, Ac, num_groups, groups, weights, Ag);
+  return fail;
+}
+
+/**
+  The constructor for the ParOptProblemFactory wrapper.
+
+  This wrapper is used when generating a Python instance of a
+  ParOptProblemFactory class. The wrapper is instantiated by Cython
+  and a callback is used to create the problem instances.
+*/
+CyParOptProblemFactory::CyParOptProblemFactory() {
+  self = NULL;
+  createproblem = NULL;
+}
+
+CyParOptProblemFactory::~CyParOptProblemFactory() {}
+
+void CyParOptProblemFactory::setSelfPointer(void *_self) { self = _self; }
+
+void CyParOptProblemFactory::setCreateProblem(
+    ParOptProblem *(*func)(void *, MPI_Comm)) {
+  createproblem = func;
+}
+
+/*
+  Create a new problem instance on the given communicator
+*/
+ParOptProblem *CyParOptProblemFactory::createProblem(MPI_Comm comm) {
+  if (!createproblem) {
+    fprintf(stderr, "createproblem callback not defined\n");
+    return NULL;
+  }
+
+  return createproblem(self, comm);
+}
@@ -1,6 +1,7 @@
 #ifndef PAR_OPT_CYTHON_PROBLEM_H
 #define PAR_OPT_CYTHON_PROBLEM_H
 
+#include "ParOptAggregatedProblem.h"
 #include "ParOptProblem.h"
 
 /**
@@ -38,6 +39,14 @@ class CyParOptBlockProblem : public ParOptProblem {
   int useLowerBounds();
   int useUpperBounds();
 
+  // Declare linear constraints and a quadratic objective
+  // ----------------------------------------------------
+  void setLinearity(int _objQuadratic, const int *_denseLinear,
+                    int _sparseLinear);
+  int isObjQuadratic();
+  int isDenseConLinear(int index);
+  int isSparseConLinear();
+
   // Set the member callback functions that are required
   // ---------------------------------------------------
   void setSelfPointer(void *_self);
@@ -157,6 +166,11 @@ class CyParOptBlockProblem : public ParOptProblem {
   // Store information about the type of problem to solve
   int useLower;
   int useUpper;
+
+  // Linearity of the objective and constraints
+  int objQuadratic;
+  int *denseLinear;
+  int sparseLinear;
 };
 
 /**
@@ -190,6 +204,14 @@ class CyParOptSparseProblem : public ParOptSparseProblem {
   int useLowerBounds();
   int useUpperBounds();
 
+  // Declare linear constraints and a quadratic objective
+  // ----------------------------------------------------
+  void setLinearity(int _objQuadratic, const int *_denseLinear,
+                    int _sparseLinear);
+  int isObjQuadratic();
+  int isDenseConLinear(int index);
+  int isSparseConLinear();
+
   // Set the member callback functions that are required
   // ---------------------------------------------------
   void setSelfPointer(void *_self);
@@ -266,6 +288,101 @@ class CyParOptSparseProblem : public ParOptSparseProblem {
   // Store information about the type of problem to solve
   int useLower;
   int useUpper;
+
+  // Linearity of the objective and constraints
+  int objQuadratic;
+  int *denseLinear;
+  int sparseLinear;
+};
+
+/**
+  This code implements a simplified interface for the
+  ParOptAggregatedProblem that can be wrapped using Cython. The
+  objective, the user-defined dense constraints and the local
+  constraints, and their gradients, are evaluated through callbacks.
+  The local constraints are aggregated by the base class.
+*/
+class CyParOptAggregatedProblem : public ParOptAggregatedProblem {
+ public:
+  CyParOptAggregatedProblem(MPI_Comm _comm, ParOptOptions *_options);
+  ~CyParOptAggregatedProblem();
+
+  // Create the quasi-def matrix associated with the problem
+  // -------------------------------------------------------
+  ParOptQuasiDefMat *createQuasiDefMat();
+
+  // Set the member callback functions that are required
+  // ---------------------------------------------------
+  void setSelfPointer(void *_self);
+  void setGetVarsAndBounds(void (*func)(void *, int, ParOptVec *, ParOptVec *,
+                                        ParOptVec *));
+  void setEvalObjConLocal(int (*func)(void *, int, int, int, ParOptVec *,
+                                      ParOptScalar *, ParOptScalar *,
+                                      ParOptScalar *));
+  void setEvalObjConLocalGradient(int (*func)(void *, int, int, int,
+                                              ParOptVec *, ParOptVec *,
+                                              ParOptVec **, int, const int *,
+                                              const ParOptScalar *,
+                                              ParOptVec **));
+
+  // Get the variables and bounds from the problem
+  // ---------------------------------------------
+  void getVarsAndBounds(ParOptVec *x, ParOptVec *lb, ParOptVec *ub);
+
+  // Evaluate the objective and the dense and local constraints
+  // ----------------------------------------------------------
+  int evalObjConLocal(ParOptVec *x, ParOptScalar *fobj, ParOptScalar *cons,
+                      ParOptScalar *lcons);
+
+  // Evaluate the objective, constraint and aggregate gradients
+  // ----------------------------------------------------------
+  int evalObjConLocalGradient(ParOptVec *x, ParOptVec *g, ParOptVec **Ac,
+                              int num_groups, const int *groups,
+                              const ParOptScalar *weights, ParOptVec **Ag);
+
+ private:
+  // Public member function pointers to the callbacks that are
+  // required before class can be used
+  // ---------------------------------------------------------
+  void *self;
+  void (*getvarsandbounds)(void *self, int nvars, ParOptVec *x, ParOptVec *lb,
+                           ParOptVec *ub);
+  int (*evalobjconlocal)(void *self, int nvars, int ncon, int nlocal,
+                         ParOptVec *x, ParOptScalar *fobj, ParOptScalar *cons,
+                         ParOptScalar *lcons);
+  int (*evalobjconlocalgradient)(void *self, int nvars, int ncon, int nlocal,
+                                 ParOptVec *x, ParOptVec *g, ParOptVec **Ac,
+                                 int num_groups, const int *groups,
+                                 const ParOptScalar *weights, ParOptVec **Ag);
+};
+
+/**
+  This code implements a problem factory that can be wrapped using
+  Cython. The problem instances are created through a callback so that
+  the factory and the problem instances can be implemented in python.
+  The factory is used to evaluate trial points concurrently on groups
+  of processors.
+*/
+class CyParOptProblemFactory : public ParOptProblemFactory {
+ public:
+  CyParOptProblemFactory();
+  ~CyParOptProblemFactory();
+
+  // Set the member callback functions that are required
+  // ---------------------------------------------------
+  void setSelfPointer(void *_self);
+  void setCreateProblem(ParOptProblem *(*func)(void *, MPI_Comm));
+
+  // Create a new problem instance on the given communicator
+  // -------------------------------------------------------
+  ParOptProblem *createProblem(MPI_Comm comm);
+
+ private:
+  // Public member function pointers to the callbacks that are
+  // required before class can be used
+  // ---------------------------------------------------------
+  void *self;
+  ParOptProblem *(*createproblem)(void *self, MPI_Comm comm);
 };
 
 #endif  // PAR_OPT_CYTHON_PROBLEM_H
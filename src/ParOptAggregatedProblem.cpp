@@ -0,0 +1,440 @@
+#include "ParOptAggregatedProblem.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "ParOptComplexStep.h"
+
+/**
+  Create the aggregated problem
+
+  If no options are provided, the default options are used.
+
+  @param _comm is the MPI communicator
+  @param _options are the aggregation options
+*/
+ParOptAggregatedProblem::ParOptAggregatedProblem(MPI_Comm _comm,
+                                                 ParOptOptions *_options)
+    : ParOptProblem(_comm) {
+  options = _options;
+  if (!options) {
+    options = new ParOptOptions(_comm);
+    addDefaultOptions(options);
+  }
+  options->incref();
+
+  // Set the type of aggregation and grouping
+  use_pnorm = 0;
+  if (strcmp(options->getEnumOption("aggregation_type"), "pnorm") == 0) {
+    use_pnorm = 1;
+  }
+  group_by_value = 0;
+  if (strcmp(options->getEnumOption("aggregation_grouping"), "value") == 0) {
+    group_by_value = 1;
+  }
+
+  // Set the aggregation parameter and continuation settings
+  if (use_pnorm) {
+    param = options->getFloatOption("aggregation_pnorm");
+    max_param = options->getFloatOption("aggregation_max_pnorm");
+  } else {
+    param = options->getFloatOption("aggregation_ks_weight");
+    max_param = options->getFloatOption("aggregation_max_ks_weight");
+  }
+  if (max_param < param) {
+    max_param = param;
+  }
+  continuation_factor =
+      options->getFloatOption("aggregation_continuation_factor");
+
+  num_groups = options->getIntOption("aggregation_num_groups");
+  nlocal = ntotal = 0;
+  groups_init = 0;
+
+  groups = NULL;
+  group_count = NULL;
+  lcons = NULL;
+  weights = NULL;
+  gshift = NULL;
+  gsum = NULL;
+}
+
+ParOptAggregatedProblem::~ParOptAggregatedProblem() {
+  options->decref();
+  delete[] groups;
+  delete[] group_count;
+  delete[] lcons;
+  delete[] weights;
+  delete[] gshift;
+  delete[] gsum;
+}
+
+/**
+  Add the default options for the aggregation
+
+  @param options The options object
+*/
+void ParOptAggregatedProblem::addDefaultOptions(ParOptOptions *options) {
+  const char *agg_type[2] = {"ks", "pnorm"};
+  options->addEnumOption("aggregation_type", "ks", 2, agg_type,
+                         "The type of constraint aggregation function");
+
+  const char *grouping[2] = {"index", "value"};
+  options->addEnumOption(
+      "aggregation_grouping", "index", 2, grouping,
+      "Group the local constraints by index, or by their values so that "
+      "the most critical constraints are aggregated together");
+
+  options->addIntOption("aggregation_num_groups", 1, 1, 1000000,
+                        "Number of aggregated constraints");
+
+  options->addFloatOption("aggregation_ks_weight", 50.0, 1e-3, 1e20,
+                          "Initial KS aggregation weight");
+
+  options->addFloatOption("aggregation_max_ks_weight", 1000.0, 1e-3, 1e20,
+                          "Maximum KS aggregation weight for continuation");
+
+  options->addFloatOption("aggregation_pnorm", 8.0, 1.0, 1e4,
+                          "Initial p-norm aggregation exponent");
+
+  options->addFloatOption("aggregation_max_pnorm", 64.0, 1.0, 1e4,
+                          "Maximum p-norm exponent for continuation");
+
+  options->addFloatOption(
+      "aggregation_continuation_factor", 1.0, 1.0, 1e3,
+      "Factor applied to the aggregation parameter at each update");
+}
+
+/**
+  Get the options object associated with the aggregation
+*/
+ParOptOptions *ParOptAggregatedProblem::getOptions() { return options; }
+
+/**
+  Set the problem sizes including the number of local constraints
+
+  @param _nvars the number of local design variables
+  @param _ncon the global number of user-defined dense constraints
+  @param _nlocal the number of local constraints on this processor
+  @param _nwcon the local number of sparse separable constraints
+*/
+void ParOptAggregatedProblem::setAggregatedProblemSizes(int _nvars, int _ncon,
+                                                        int _nlocal,
+                                                        int _nwcon) {
+  nlocal = _nlocal;
+  MPI_Allreduce(&nlocal, &ntotal, 1, MPI_INT, MPI_SUM, comm);
+
+  // Do not use more groups than there are local constraints
+  num_groups = options->getIntOption("aggregation_num_groups");
+  if (ntotal > 0 && num_groups > ntotal) {
+    num_groups = ntotal;
+  }
+
+  setProblemSizes(_nvars, num_groups + _ncon, _nwcon);
+
+  delete[] groups;
+  delete[] group_count;
+  delete[] lcons;
+  delete[] weights;
+  delete[] gshift;
+  delete[] gsum;
+
+  groups = new int[nlocal];
+  group_count = new int[num_groups];
+  lcons = new ParOptScalar[nlocal];
+  weights = new ParOptScalar[nlocal];
+  gshift = new double[num_groups];
+  gsum = new ParOptScalar[num_groups];
+
+  memset(groups, 0, nlocal * sizeof(int));
+  memset(group_count, 0, num_groups * sizeof(int));
+  memset(lcons, 0, nlocal * sizeof(ParOptScalar));
+  memset(weights, 0, nlocal * sizeof(ParOptScalar));
+  groups_init = 0;
+}
+
+/**
+  Set the number of user-defined dense or sparse inequalities
+
+  The aggregated constraints are always inequalities.
+
+  @param _ninequality the number of user-defined dense inequalities
+  @param _nwinequality the block size of the separable constraints
+*/
+void ParOptAggregatedProblem::setAggregatedNumInequalities(int _ninequality,
+                                                           int _nwinequality) {
+  setNumInequalities(num_groups + _ninequality, _nwinequality);
+}
+
+/**
+  Get the number of aggregation groups
+*/
+int ParOptAggregatedProblem::getNumAggregationGroups() { return num_groups; }
+
+/**
+  Get the number of local constraints on this processor
+*/
+int ParOptAggregatedProblem::getNumLocalConstraints() { return nlocal; }
+
+/**
+  Get the current aggregation parameter
+*/
+double ParOptAggregatedProblem::getAggregationParameter() { return param; }
+
+/**
+  Update the aggregation parameter and the groups
+
+  @return flag indicating whether the aggregated constraints changed
+*/
+int ParOptAggregatedProblem::updateAggregation() {
+  int changed = 0;
+
+  // Apply the continuation to the aggregation parameter
+  double new_param = continuation_factor * param;
+  if (new_param > max_param) {
+    new_param = max_param;
+  }
+  if (new_param != param) {
+    param = new_param;
+    changed = 1;
+  }
+
+  // Re-group the constraints based on the last values
+  if (group_by_value && groups_init) {
+    computeGroups();
+    changed = 1;
+  }
+
+  // Re-compute the weights for the last point
+  if (changed && groups_init) {
+    ParOptScalar *agg = new ParOptScalar[num_groups];
+    aggregate(agg);
+    delete[] agg;
+  }
+
+  return changed;
+}
+
+/*
+  Assign the local constraints to groups.
+
+  When grouping by index, the global ordering of the local constraints
+  is split into contiguous groups of equal size. When grouping by
+  value, the constraints are ranked by their value using a global
+  histogram, so that the most critical constraints are placed in the
+  first group. Constraints within the same histogram bin are ranked
+  by processor and then by local index, so the groups have equal
+  sizes without a global sort.
+*/
+void ParOptAggregatedProblem::computeGroups() {
+  if (ntotal == 0) {
+    groups_init = 1;
+    return;
+  }
+
+  if (!group_by_value) {
+    int offset = 0;
+    MPI_Exscan(&nlocal, &offset, 1, MPI_INT, MPI_SUM, comm);
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0) {
+      offset = 0;
+    }
+
+    for (int j = 0; j < nlocal; j++) {
+      long long index = offset + j;
+      groups[j] = (int)((index * num_groups) / ntotal);
+    }
+  } else {
+    // Find the range of the constraint values
+    double range[2] = {1e300, 1e300};
+    for (int j = 0; j < nlocal; j++) {
+      double c = ParOptRealPart(lcons[j]);
+      if (c < range[0]) {
+        range[0] = c;
+      }
+      if (-c < range[1]) {
+        range[1] = -c;
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, range, 2, MPI_DOUBLE, MPI_MIN, comm);
+    double cmin = range[0];
+    double cmax = -range[1];
+
+    // Set the number of bins for the histogram
+    int nbins = 16 * num_groups;
+    if (nbins < 1024) {
+      nbins = 1024;
+    } else if (nbins > 65536) {
+      nbins = 65536;
+    }
+
+    int *count = new int[nbins];
+    int *start = new int[nbins];
+    int *offset = new int[nbins];
+    memset(count, 0, nbins * sizeof(int));
+    memset(offset, 0, nbins * sizeof(int));
+
+    double scale = 0.0;
+    if (cmax > cmin) {
+      scale = nbins / (cmax - cmin);
+    }
+    for (int j = 0; j < nlocal; j++) {
+      int b = (int)(scale * (ParOptRealPart(lcons[j]) - cmin));
+      if (b >= nbins) {
+        b = nbins - 1;
+      }
+      groups[j] = b;
+      count[b]++;
+    }
+
+    // Find the offset for this processor within each bin and the
+    // global starting rank of each bin
+    MPI_Exscan(count, offset, nbins, MPI_INT, MPI_SUM, comm);
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0) {
+      memset(offset, 0, nbins * sizeof(int));
+    }
+    MPI_Allreduce(count, start, nbins, MPI_INT, MPI_SUM, comm);
+    for (int b = 0, sum = 0; b < nbins; b++) {
+      int tmp = start[b];
+      start[b] = sum + offset[b];
+      sum += tmp;
+    }
+
+    for (int j = 0; j < nlocal; j++) {
+      long long index = start[groups[j]];
+      start[groups[j]]++;
+      groups[j] = (int)((index * num_groups) / ntotal);
+    }
+
+    delete[] count;
+    delete[] start;
+    delete[] offset;
+  }
+
+  // Count the number of constraints in each group
+  memset(group_count, 0, num_groups * sizeof(int));
+  for (int j = 0; j < nlocal; j++) {
+    group_count[groups[j]]++;
+  }
+  MPI_Allreduce(MPI_IN_PLACE, group_count, num_groups, MPI_INT, MPI_SUM,
+                comm);
+
+  groups_init = 1;
+}
+
+/*
+  Compute the aggregated constraint values and the weights for the
+  gradient of each aggregate.
+
+  The values in each group are shifted by the minimum value (KS) or
+  the maximum failure value (p-norm) before exponentiation to avoid
+  overflow. Empty groups are assigned the inactive value 1.
+*/
+void ParOptAggregatedProblem::aggregate(ParOptScalar *agg) {
+  // Find the shift for each group
+  for (int k = 0; k < num_groups; k++) {
+    gshift[k] = (use_pnorm ? 0.0 : 1e300);
+    gsum[k] = 0.0;
+  }
+  for (int j = 0; j < nlocal; j++) {
+    int k = groups[j];
+    if (use_pnorm) {
+      double s = fabs(1.0 - ParOptRealPart(lcons[j]));
+      if (s > gshift[k]) {
+        gshift[k] = s;
+      }
+    } else {
+      double c = ParOptRealPart(lcons[j]);
+      if (c < gshift[k]) {
+        gshift[k] = c;
+      }
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, gshift, num_groups, MPI_DOUBLE,
+                (use_pnorm ? MPI_MAX : MPI_MIN), comm);
+
+  // Compute the un-normalized weights and the sums for each group
+  for (int j = 0; j < nlocal; j++) {
+    int k = groups[j];
+    if (use_pnorm) {
+      if (gshift[k] > 0.0) {
+        ParOptScalar r = fabs(1.0 - lcons[j]) / gshift[k];
+        weights[j] = pow(r, param - 1.0);
+        gsum[k] += weights[j] * r;
+      } else {
+        weights[j] = 0.0;
+      }
+    } else {
+      weights[j] = exp(-param * (lcons[j] - gshift[k]));
+      gsum[k] += weights[j];
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, gsum, num_groups, PAROPT_MPI_TYPE, MPI_SUM,
+                comm);
+
+  // Compute the aggregated values. For the p-norm, gsum is replaced
+  // with the factor that normalizes the weights.
+  for (int k = 0; k < num_groups; k++) {
+    if (group_count[k] == 0) {
+      agg[k] = 1.0;
+    } else if (use_pnorm) {
+      if (gshift[k] > 0.0) {
+        agg[k] = 1.0 - gshift[k] * pow(gsum[k], 1.0 / param);
+        gsum[k] = pow(gsum[k], (1.0 - param) / param);
+      } else {
+        agg[k] = 1.0;
+      }
+    } else {
+      agg[k] = gshift[k] - log(gsum[k]) / param;
+      gsum[k] = 1.0 / gsum[k];
+    }
+  }
+
+  // Normalize the weights
+  for (int j = 0; j < nlocal; j++) {
+    int k = groups[j];
+    weights[j] *= gsum[k];
+    if (use_pnorm && ParOptRealPart(lcons[j]) > 1.0) {
+      weights[j] *= -1.0;
+    }
+  }
+}
+
+/*
+  Evaluate the objective, the aggregated constraints and the
+  user-defined dense constraints
+*/
+int ParOptAggregatedProblem::evalObjCon(ParOptVec *x, ParOptScalar *fobj,
+                                        ParOptScalar *cons) {
+  int fail = evalObjConLocal(x, fobj, &cons[num_groups], lcons);
+  if (fail) {
+    return fail;
+  }
+
+  // Assign the groups on the first evaluation
+  if (!groups_init) {
+    computeGroups();
+  }
+
+  aggregate(cons);
+
+  return 0;
+}
+
+/*
+  Evaluate the objective and constraint gradients. The weights from
+  the last call to evalObjCon() are used for the aggregated
+  constraint gradients.
+*/
+int ParOptAggregatedProblem::evalObjConGradient(ParOptVec *x, ParOptVec *g,
+                                                ParOptVec **Ac) {
+  for (int k = 0; k < num_groups; k++) {
+    Ac[k]->zeroEntries();
+  }
+
+  return evalObjConLocalGradient(x, g, &Ac[num_groups], num_groups, groups,
+                                 weights, Ac);
+}
@@ -0,0 +1,199 @@
+#ifndef PAR_OPT_AGGREGATED_PROBLEM_H
+#define PAR_OPT_AGGREGATED_PROBLEM_H
+
+#include "ParOptOptions.h"
+#include "ParOptProblem.h"
+
+/*
+  A problem class that aggregates a large set of local constraints
+  into a small number of dense constraints.
+
+  Problems such as stress-constrained topology optimization have a
+  constraint at every element, c_j(x) >= 0 for j = 1,...,N, with N in
+  the range of 10^5 to 10^6. Passing these as dense constraints is not
+  possible, and passing them as sparse constraints makes the Schur
+  complement factorization expensive. This class instead groups the
+  local constraints and replaces each group with a single aggregated
+  dense constraint, so that the size of the dense constraint system
+  stays fixed as the number of local constraints grows.
+
+  Two aggregation functions are available:
+
+  ks: The Kreisselmeier-Steinhauser function, a conservative smooth
+  approximation of the minimum of the constraint values,
+
+  c_k = m_k - log(sum_{j in k} exp(-rho*(c_j - m_k)))/rho
+
+  where m_k is the minimum constraint value in the group.
+
+  pnorm: The p-norm of the failure values s_j = 1 - c_j, which is
+  suitable for constraints written as c_j = 1 - sigma_j/sigma_allow,
+
+  c_k = 1 - (sum_{j in k} |s_j|^p)^(1/p)
+
+  The constraints can be grouped by their global index, or adaptively
+  by their values so that the most critical constraints are aggregated
+  together. The grouping and the aggregation parameter are only changed
+  when updateAggregation() is called. This should be done between
+  calls to the optimizer, since it changes the definition of the
+  aggregated constraints.
+
+  Instead of evalObjCon() and evalObjConGradient(), the user
+  implements evalObjConLocal() which also returns the local
+  constraint values, and evalObjConLocalGradient(). The gradient of
+  each aggregate is a weighted sum of the local constraint gradients.
+  The weights are passed to evalObjConLocalGradient() so that each
+  aggregate can be computed with a single adjoint solution.
+
+  The aggregated constraints are the first num_groups dense
+  constraints, followed by the user-defined dense constraints.
+
+  The aggregated constraint gradients are always formed as dense
+  vectors through evalObjConGradient(). The sparse gradient format
+  (getConGradientPattern() and evalObjConSparseGradient()) and the
+  matrix-free Jacobian products (useDenseJacobianProducts() and
+  addDenseJacobian()) are not supported, since they would bypass the
+  aggregation. Subclasses should not override these methods.
+*/
+class ParOptAggregatedProblem : public ParOptProblem {
+ public:
+  ParOptAggregatedProblem(MPI_Comm _comm, ParOptOptions *_options = NULL);
+  virtual ~ParOptAggregatedProblem();
+
+  // Get the default option values
+  static void addDefaultOptions(ParOptOptions *options);
+  ParOptOptions *getOptions();
+
+  /**
+    Set the problem sizes including the number of local constraints
+
+    @param _nvars the number of local design variables
+    @param _ncon the global number of user-defined dense constraints
+    @param _nlocal the number of local constraints on this processor
+    @param _nwcon the local number of sparse separable constraints
+  */
+  void setAggregatedProblemSizes(int _nvars, int _ncon, int _nlocal,
+                                 int _nwcon);
+
+  /**
+    Set the number of user-defined dense or sparse inequalities
+
+    @param _ninequality the number of user-defined dense inequalities
+    @param _nwinequality the block size of the separable constraints
+  */
+  void setAggregatedNumInequalities(int _ninequality, int _nwinequality);
+
+  /**
+    Get the number of aggregation groups
+
+    @return the number of aggregated dense constraints
+  */
+  int getNumAggregationGroups();
+
+  /**
+    Get the number of local constraints on this processor
+
+    @return the number of local constraints
+  */
+  int getNumLocalConstraints();
+
+  /**
+    Get the current aggregation parameter
+
+    @return the KS weight or p-norm exponent
+  */
+  double getAggregationParameter();
+
+  /**
+    Update the aggregation parameter and the groups
+
+    The aggregation parameter is increased by the continuation factor
+    up to its maximum value. If the grouping is based on the
+    constraint values, the groups are re-computed from the values at
+    the last call to evalObjCon().
+
+    @return flag indicating whether the aggregated constraints changed
+  */
+  int updateAggregation();
+
+  /**
+    Evaluate the objective, the user-defined dense constraints and the
+    local constraints
+
+    @param x is the design vector
+    @param fobj is the objective value
+    @param cons is the array of user-defined dense constraint values
+    @param lcons is the array of local constraint values
+    @return zero on success, non-zero fail flag on error
+  */
+  virtual int evalObjConLocal(ParOptVec *x, ParOptScalar *fobj,
+                              ParOptScalar *cons, ParOptScalar *lcons) = 0;
+
+  /**
+    Evaluate the objective and constraint gradients along with the
+    gradients of the aggregated constraints
+
+    The vectors Ag are zeroed on entry. The gradient of the k-th
+    aggregate must be added to Ag[k] as the sum of weights[j]
+    times the gradient of the j-th local constraint over all j with
+    groups[j] = k.
+
+    @param x is the design vector
+    @param g is the objective gradient
+    @param Ac is the array of user-defined dense constraint gradients
+    @param num_groups is the number of aggregation groups
+    @param groups is the group index of each local constraint
+    @param weights is the weight of each local constraint
+    @param Ag is the array of aggregated constraint gradients
+    @return zero on success, non-zero fail flag on error
+  */
+  virtual int evalObjConLocalGradient(ParOptVec *x, ParOptVec *g,
+                                      ParOptVec **Ac, int num_groups,
+                                      const int *groups,
+                                      const ParOptScalar *weights,
+                                      ParOptVec **Ag) = 0;
+
+  // Evaluate the objective and the aggregated constraints
+  int evalObjCon(ParOptVec *x, ParOptScalar *fobj, ParOptScalar *cons);
+
+  // Evaluate the objective and aggregated constraint gradients
+  int evalObjConGradient(ParOptVec *x, ParOptVec *g, ParOptVec **Ac);
+
+ private:
+  // Assign the local constraints to groups
+  void computeGroups();
+
+  // Compute the aggregated values and the gradient weights
+  void aggregate(ParOptScalar *agg);
+
+  // The options
+  ParOptOptions *options;
+
+  // The aggregation type and grouping
+  int use_pnorm;
+  int group_by_value;
+
+  // The aggregation parameter and the continuation settings
+  double param, max_param, continuation_factor;
+
+  // The number of groups and local constraints
+  int num_groups;
+  int nlocal, ntotal;
+
+  // Flag to indicate whether the groups have been assigned
+  int groups_init;
+
+  // The group of each local constraint and the global group sizes
+  int *groups;
+  int *group_count;
+
+  // The local constraint values and the aggregation weights
+  ParOptScalar *lcons;
+  ParOptScalar *weights;
+
+  // Work arrays for the group reductions
+  double *gshift;
+  ParOptScalar *gsum;
+};
+
+#endif  // PAR_OPT_AGGREGATED_PROBLEM_H
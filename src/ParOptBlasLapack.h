@@ -10,26 +10,43 @@
 #define BLASdaxpy zaxpy_
 #define BLASdscal zscal_
 #define BLAStpsv ztpsv_
+#define BLAStrsv ztrsv_
+#define BLASgemv zgemv_
 #define BLASgbmv zgbmv_
 #define BLASgemm zgemm_
+#define BLAStrsm ztrsm_
 #define BLASsyrk zsyrk_
 #define LAPACKdgetrf zgetrf_
 #define LAPACKdgetrs zgetrs_
 #define LAPACKdpptrf zpptrf_
 #define LAPACKdpptrs zpptrs_
+#define LAPACKdpotrf zpotrf_
+#define LAPACKdsptrf zsptrf_
+#define LAPACKdsptrs zsptrs_
+#define LAPACKdsytrf zsytrf_
+#define LAPACKdsytrs zsytrs_
 #else
 #define BLASddot ddot_
 #define BLASdnrm2 dnrm2_
 #define BLASdaxpy daxpy_
 #define BLASdscal dscal_
 #define BLAStpsv dtpsv_
+#define BLAStrsv dtrsv_
+#define BLASgemv dgemv_
 #define BLASgbmv dgbmv_
 #define BLASgemm dgemm_
+#define BLAStrsm dtrsm_
 #define BLASsyrk dsyrk_
 #define LAPACKdgetrf dgetrf_
 #define LAPACKdgetrs dgetrs_
 #define LAPACKdpptrf dpptrf_
 #define LAPACKdpptrs dpptrs_
+#define LAPACKdpotrf dpotrf_
+#define LAPACKdsptrf dsptrf_
+#define LAPACKdsptrs dsptrs_
+#define LAPACKdsytrf dsytrf_
+#define LAPACKdsytrs dsytrs_
+#define LAPACKdgeev dgeev_
 #endif  // PAROPT_USE_COMPLEX
 
 extern "C" {
@@ -49,6 +66,11 @@ extern void BLASsyrk(const char *uplo, const char *trans, int *n, int *k,
 extern void BLAStpsv(const char *uplo, const char *transa, const char *diag,
                      int *n, ParOptScalar *a, ParOptScalar *x, int *incx);
 
+// Solve A*x = b or A^T*x = b where A is a triangular matrix
+extern void BLAStrsv(const char *uplo, const char *transa, const char *diag,
+                     int *n, ParOptScalar *a, int *lda, ParOptScalar *x,
+                     int *incx);
+
 // Level 2 BLAS routines
 // y = alpha * A * x + beta * y, for a general matrix
 extern void BLASgemv(const char *c, int *m, int *n, ParOptScalar *alpha,
@@ -62,6 +84,11 @@ extern void BLASgemm(const char *ta, const char *tb, int *m, int *n, int *k,
                      ParOptScalar *b, int *ldb, ParOptScalar *beta,
                      ParOptScalar *c, int *ldc);
 
+// Solve op( A )*X = alpha*B or X*op( A ) = alpha*B, A triangular
+extern void BLAStrsm(const char *side, const char *uplo, const char *transa,
+                     const char *diag, int *m, int *n, ParOptScalar *alpha,
+                     ParOptScalar *a, int *lda, ParOptScalar *b, int *ldb);
+
 // General factorization routines
 extern void LAPACKdgetrf(int *m, int *n, ParOptScalar *a, int *lda, int *ipiv,
                          int *info);
@@ -69,10 +96,35 @@ extern void LAPACKdgetrs(const char *c, int *n, int *nrhs, ParOptScalar *a,
                          int *lda, int *ipiv, ParOptScalar *b, int *ldb,
                          int *info);
 
+// Symmetric indefinite factorization routines
+extern void LAPACKdsytrf(const char *uplo, int *n, ParOptScalar *a, int *lda,
+                         int *ipiv, ParOptScalar *work, int *lwork, int *info);
+extern void LAPACKdsytrs(const char *uplo, int *n, int *nrhs, ParOptScalar *a,
+                         int *lda, int *ipiv, ParOptScalar *b, int *ldb,
+                         int *info);
+
 // Factorization of packed-storage matrices
 extern void LAPACKdpptrf(const char *c, int *n, ParOptScalar *ap, int *info);
 extern void LAPACKdpptrs(const char *c, int *n, int *nrhs, ParOptScalar *ap,
                          ParOptScalar *rhs, int *ldrhs, int *info);
+
+// Cholesky factorization of a full-storage matrix
+extern void LAPACKdpotrf(const char *c, int *n, ParOptScalar *a, int *lda,
+                         int *info);
+
+// Symmetric indefinite factorization of packed-storage matrices
+extern void LAPACKdsptrf(const char *c, int *n, ParOptScalar *ap, int *ipiv,
+                         int *info);
+extern void LAPACKdsptrs(const char *c, int *n, int *nrhs, ParOptScalar *ap,
+                         int *ipiv, ParOptScalar *rhs, int *ldrhs, int *info);
+
+#ifndef PAROPT_USE_COMPLEX
+// Eigenvalues and eigenvectors of a general real matrix
+extern void LAPACKdgeev(const char *jobvl, const char *jobvr, int *n,
+                        double *a, int *lda, double *wr, double *wi,
+                        double *vl, int *ldvl, double *vr, int *ldvr,
+                        double *work, int *lwork, int *info);
+#endif  // PAROPT_USE_COMPLEX
 }
 
 #endif
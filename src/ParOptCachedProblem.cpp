@@ -0,0 +1,642 @@
+#include "ParOptCachedProblem.h"
+
+#include <string.h>
+
+/**
+  Create a cached problem that wraps the given problem
+
+  @param _prob The problem to wrap
+  @param _max_entries The maximum number of design points to store
+*/
+ParOptCachedProblem::ParOptCachedProblem(ParOptProblem *_prob,
+                                         int _max_entries)
+    : ParOptProblem(_prob->getMPIComm()) {
+  prob = _prob;
+  prob->incref();
+
+  // Set the problem sizes
+  int _nvars, _ncon, _nwcon;
+  prob->getProblemSizes(&_nvars, &_ncon, &_nwcon);
+  setProblemSizes(_nvars, _ncon, _nwcon);
+
+  // Set the number of inequalities
+  int _ninequality, _nwinequality;
+  prob->getNumInequalities(&_ninequality, &_nwinequality);
+  setNumInequalities(_ninequality, _nwinequality);
+
+  // Allocate the cache entries
+  max_entries = _max_entries;
+  if (max_entries < 1) {
+    max_entries = 1;
+  }
+  num_entries = 0;
+
+  lru = new int[max_entries];
+  xhash = new unsigned long[max_entries];
+  has_obj = new int[max_entries];
+  has_grad = new int[max_entries];
+  xvals = new ParOptVec *[max_entries];
+  fvals = new ParOptScalar[max_entries];
+  cvals = new ParOptScalar[max_entries * ncon];
+  gvals = new ParOptVec *[max_entries];
+  Avals = new ParOptVec *[max_entries * ncon];
+
+  // The gradients of the linear constraints are stored once
+  has_lin_grad = 0;
+  Alin = new ParOptVec *[ncon];
+  for (int i = 0; i < ncon; i++) {
+    Alin[i] = NULL;
+    if (prob->isDenseConLinear(i)) {
+      Alin[i] = prob->createDesignVec();
+      Alin[i]->incref();
+    }
+  }
+
+  for (int k = 0; k < max_entries; k++) {
+    lru[k] = -1;
+    xhash[k] = 0;
+    has_obj[k] = has_grad[k] = 0;
+    xvals[k] = prob->createDesignVec();
+    xvals[k]->incref();
+    gvals[k] = prob->createDesignVec();
+    gvals[k]->incref();
+    fvals[k] = 0.0;
+    for (int i = 0; i < ncon; i++) {
+      cvals[k * ncon + i] = 0.0;
+      Avals[k * ncon + i] = NULL;
+      if (!Alin[i]) {
+        Avals[k * ncon + i] = prob->createDesignVec();
+        Avals[k * ncon + i]->incref();
+      }
+    }
+  }
+
+  // The last point passed to the wrapped problem
+  has_last = 0;
+  has_last_grad = 0;
+  xlast_hash = 0;
+  xlast = prob->createDesignVec();
+  xlast->incref();
+
+  // The match flags for the entries plus the last point
+  match = new int[max_entries + 1];
+  last_match = 0;
+
+  ctemp = new ParOptScalar[ncon];
+
+  // Zero the statistics
+  obj_hits = obj_misses = 0;
+  grad_hits = grad_misses = 0;
+}
+
+ParOptCachedProblem::~ParOptCachedProblem() {
+  prob->decref();
+
+  for (int k = 0; k < max_entries; k++) {
+    xvals[k]->decref();
+    gvals[k]->decref();
+    for (int i = 0; i < ncon; i++) {
+      if (Avals[k * ncon + i]) {
+        Avals[k * ncon + i]->decref();
+      }
+    }
+  }
+  for (int i = 0; i < ncon; i++) {
+    if (Alin[i]) {
+      Alin[i]->decref();
+    }
+  }
+  delete[] Alin;
+  delete[] lru;
+  delete[] xhash;
+  delete[] has_obj;
+  delete[] has_grad;
+  delete[] xvals;
+  delete[] fvals;
+  delete[] cvals;
+  delete[] gvals;
+  delete[] Avals;
+
+  xlast->decref();
+  delete[] match;
+  delete[] ctemp;
+}
+
+/**
+  Clear all entries from the cache.
+
+  This should be called if the wrapped problem changes in a way that
+  invalidates the stored function values.
+*/
+void ParOptCachedProblem::clearCache() {
+  num_entries = 0;
+  has_last = 0;
+  has_last_grad = 0;
+  has_lin_grad = 0;
+  for (int k = 0; k < max_entries; k++) {
+    lru[k] = -1;
+    has_obj[k] = has_grad[k] = 0;
+  }
+}
+
+/**
+  Get the number of cache hits and misses
+
+  @param _obj_hits Number of objective/constraint evaluations from the cache
+  @param _obj_misses Number of objective/constraint evaluations forwarded
+  @param _grad_hits Number of gradient evaluations from the cache
+  @param _grad_misses Number of gradient evaluations forwarded
+*/
+void ParOptCachedProblem::getCacheStats(int *_obj_hits, int *_obj_misses,
+                                        int *_grad_hits, int *_grad_misses) {
+  if (_obj_hits) {
+    *_obj_hits = obj_hits;
+  }
+  if (_obj_misses) {
+    *_obj_misses = obj_misses;
+  }
+  if (_grad_hits) {
+    *_grad_hits = grad_hits;
+  }
+  if (_grad_misses) {
+    *_grad_misses = grad_misses;
+  }
+}
+
+/**
+  Print the cache statistics on the root processor
+
+  @param fp The file pointer
+*/
+void ParOptCachedProblem::printCacheStats(FILE *fp) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (fp && rank == 0) {
+    int nobj = obj_hits + obj_misses;
+    int ngrad = grad_hits + grad_misses;
+    double obj_rate = (nobj > 0 ? (100.0 * obj_hits) / nobj : 0.0);
+    double grad_rate = (ngrad > 0 ? (100.0 * grad_hits) / ngrad : 0.0);
+
+    fprintf(fp, "ParOptCachedProblem statistics:\n");
+    fprintf(fp, "%-12s %8s %8s %8s\n", "eval", "hits", "misses", "rate(%)");
+    fprintf(fp, "%-12s %8d %8d %8.2f\n", "obj/con", obj_hits, obj_misses,
+            obj_rate);
+    fprintf(fp, "%-12s %8d %8d %8.2f\n", "gradient", grad_hits, grad_misses,
+            grad_rate);
+    fflush(fp);
+  }
+}
+
+/*
+  Compute a 64-bit FNV-1a hash of the local vector components
+*/
+unsigned long ParOptCachedProblem::hashVec(ParOptVec *x) {
+  ParOptScalar *xarr;
+  int size = x->getArray(&xarr);
+
+  const unsigned char *bytes = (const unsigned char *)xarr;
+  size_t nbytes = size * sizeof(ParOptScalar);
+
+  unsigned long hash = 14695981039346656037UL;
+  for (size_t i = 0; i < nbytes; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211UL;
+  }
+
+  return hash;
+}
+
+/*
+  Find the most recently used entry that matches x on all processors.
+
+  The local match flags for all the entries and the last point passed
+  to the wrapped problem are combined in a single reduction. As a
+  result, the return value and last_match are consistent across all
+  processors.
+*/
+int ParOptCachedProblem::findEntry(ParOptVec *x) {
+  unsigned long hash = hashVec(x);
+
+  ParOptScalar *xarr;
+  int size = x->getArray(&xarr);
+  size_t nbytes = size * sizeof(ParOptScalar);
+
+  for (int k = 0; k < max_entries; k++) {
+    match[k] = 0;
+  }
+  for (int j = 0; j < num_entries; j++) {
+    int k = lru[j];
+    if (xhash[k] == hash) {
+      ParOptScalar *xk;
+      xvals[k]->getArray(&xk);
+      match[k] = (memcmp(xk, xarr, nbytes) == 0);
+    }
+  }
+
+  match[max_entries] = 0;
+  if (has_last && xlast_hash == hash) {
+    ParOptScalar *xl;
+    xlast->getArray(&xl);
+    match[max_entries] = (memcmp(xl, xarr, nbytes) == 0);
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, match, max_entries + 1, MPI_INT, MPI_MIN, comm);
+
+  last_match = match[max_entries];
+  for (int j = 0; j < num_entries; j++) {
+    if (match[lru[j]]) {
+      return lru[j];
+    }
+  }
+
+  return -1;
+}
+
+/*
+  Move the entry to the front of the LRU list
+*/
+void ParOptCachedProblem::touchEntry(int entry) {
+  int j = 0;
+  for (; j < num_entries; j++) {
+    if (lru[j] == entry) {
+      break;
+    }
+  }
+  for (; j > 0; j--) {
+    lru[j] = lru[j - 1];
+  }
+  lru[0] = entry;
+}
+
+/*
+  Allocate a new entry for x. This either uses an unused entry or
+  evicts the least recently used entry.
+*/
+int ParOptCachedProblem::allocEntry(ParOptVec *x) {
+  int entry = -1;
+  if (num_entries < max_entries) {
+    entry = num_entries;
+    lru[num_entries] = entry;
+    num_entries++;
+  } else {
+    entry = lru[num_entries - 1];
+  }
+  touchEntry(entry);
+
+  xvals[entry]->copyValues(x);
+  xhash[entry] = hashVec(x);
+  has_obj[entry] = 0;
+  has_grad[entry] = 0;
+
+  return entry;
+}
+
+/*
+  Record the last point passed to the wrapped problem's evalObjCon
+*/
+void ParOptCachedProblem::setLastPoint(ParOptVec *x) {
+  has_last = 1;
+  has_last_grad = 0;
+  xlast->copyValues(x);
+  xlast_hash = hashVec(x);
+}
+
+/*
+  Evaluate the wrapped problem at x if the last call to evalObjCon
+  was made at a different point. This must be called directly after
+  findEntry().
+*/
+int ParOptCachedProblem::syncProblem(ParOptVec *x, int *entry) {
+  if (last_match) {
+    return 0;
+  }
+
+  ParOptScalar fobj;
+  int fail = prob->evalObjCon(x, &fobj, ctemp);
+  if (fail) {
+    has_last = 0;
+    has_last_grad = 0;
+    return fail;
+  }
+  setLastPoint(x);
+
+  if (*entry < 0) {
+    *entry = allocEntry(x);
+  }
+  fvals[*entry] = fobj;
+  memcpy(&cvals[*entry * ncon], ctemp, ncon * sizeof(ParOptScalar));
+  has_obj[*entry] = 1;
+
+  return 0;
+}
+
+/*
+  Evaluate the objective and constraint functions
+*/
+int ParOptCachedProblem::evalObjCon(ParOptVec *x, ParOptScalar *fobj,
+                                    ParOptScalar *cons) {
+  int entry = findEntry(x);
+  if (entry >= 0 && has_obj[entry]) {
+    obj_hits++;
+    touchEntry(entry);
+    *fobj = fvals[entry];
+    memcpy(cons, &cvals[entry * ncon], ncon * sizeof(ParOptScalar));
+    return 0;
+  }
+
+  obj_misses++;
+  int fail = prob->evalObjCon(x, fobj, cons);
+  if (fail) {
+    has_last = 0;
+    return fail;
+  }
+  setLastPoint(x);
+
+  if (entry < 0) {
+    entry = allocEntry(x);
+  } else {
+    touchEntry(entry);
+  }
+  fvals[entry] = *fobj;
+  memcpy(&cvals[entry * ncon], cons, ncon * sizeof(ParOptScalar));
+  has_obj[entry] = 1;
+
+  return 0;
+}
+
+/*
+  Evaluate the objective and constraint gradients
+*/
+int ParOptCachedProblem::evalObjConGradient(ParOptVec *x, ParOptVec *g,
+                                            ParOptVec **Ac) {
+  // With sparse constraints, the wrapped problem must hold the state
+  // from a gradient evaluation at x
+  int entry = findEntry(x);
+  if (entry >= 0 && has_grad[entry] &&
+      (nwcon == 0 || (last_match && has_last_grad))) {
+    grad_hits++;
+    touchEntry(entry);
+    g->copyValues(gvals[entry]);
+    for (int i = 0; i < ncon; i++) {
+      if (Ac[i]) {
+        Ac[i]->copyValues(Alin[i] ? Alin[i] : Avals[entry * ncon + i]);
+      }
+    }
+    return 0;
+  }
+
+  grad_misses++;
+  int fail = syncProblem(x, &entry);
+  if (fail) {
+    return fail;
+  }
+
+  fail = prob->evalObjConGradient(x, g, Ac);
+  if (fail) {
+    return fail;
+  }
+  has_last_grad = 1;
+
+  if (entry < 0) {
+    entry = allocEntry(x);
+  } else {
+    touchEntry(entry);
+  }
+  gvals[entry]->copyValues(g);
+
+  // The gradients of the linear constraints are stored from the first
+  // evaluation. Later evaluations may pass a scratch vector that the
+  // wrapped problem leaves unset, so the stored values are returned.
+  int complete = 1;
+  for (int i = 0; i < ncon; i++) {
+    if (!Ac[i]) {
+      complete = 0;
+    } else if (!Alin[i]) {
+      Avals[entry * ncon + i]->copyValues(Ac[i]);
+    } else if (has_lin_grad) {
+      Ac[i]->copyValues(Alin[i]);
+    } else {
+      Alin[i]->copyValues(Ac[i]);
+    }
+  }
+  if (complete) {
+    has_lin_grad = 1;
+  }
+  has_grad[entry] = complete;
+
+  return 0;
+}
+
+/*
+  Get the non-zero pattern of the dense constraint gradients
+*/
+int ParOptCachedProblem::getConGradientPattern(const int **rowp,
+                                               const int **cols) {
+  return prob->getConGradientPattern(rowp, cols);
+}
+
+/*
+  Evaluate the objective gradient and the sparse constraint gradients.
+  These are not stored in the cache.
+*/
+int ParOptCachedProblem::evalObjConSparseGradient(ParOptVec *x, ParOptVec *g,
+                                                  ParOptScalar *Avals) {
+  grad_misses++;
+  int entry = findEntry(x);
+  int fail = syncProblem(x, &entry);
+  if (fail) {
+    return fail;
+  }
+
+  fail = prob->evalObjConSparseGradient(x, g, Avals);
+  if (!fail) {
+    has_last_grad = 1;
+  }
+  return fail;
+}
+
+/*
+  Indicate whether the dense constraint Jacobian is matrix-free
+*/
+int ParOptCachedProblem::useDenseJacobianProducts() {
+  return prob->useDenseJacobianProducts();
+}
+
+/*
+  Evaluate the objective gradient for a matrix-free Jacobian. This is
+  not stored in the cache.
+*/
+int ParOptCachedProblem::evalObjGradient(ParOptVec *x, ParOptVec *g) {
+  grad_misses++;
+  int entry = findEntry(x);
+  int fail = syncProblem(x, &entry);
+  if (fail) {
+    return fail;
+  }
+
+  fail = prob->evalObjGradient(x, g);
+  if (!fail) {
+    has_last_grad = 1;
+  }
+  return fail;
+}
+
+/*
+  Compute the dense constraint Jacobian-vector products at x
+*/
+void ParOptCachedProblem::addDenseJacobian(ParOptScalar alpha, ParOptVec *x,
+                                           int nvecs, ParOptVec **px,
+                                           ParOptScalar *out) {
+  int entry = findEntry(x);
+  syncProblem(x, &entry);
+  prob->addDenseJacobian(alpha, x, nvecs, px, out);
+}
+
+/*
+  Compute the dense constraint transpose Jacobian-vector products at x
+*/
+void ParOptCachedProblem::addDenseJacobianTranspose(ParOptScalar alpha,
+                                                    ParOptVec *x, int nvecs,
+                                                    const ParOptScalar *pz,
+                                                    ParOptVec **out) {
+  int entry = findEntry(x);
+  syncProblem(x, &entry);
+  prob->addDenseJacobianTranspose(alpha, x, nvecs, pz, out);
+}
+
+/*
+  Evaluate the product of the Hessian with a given vector
+*/
+int ParOptCachedProblem::evalHvecProduct(ParOptVec *x, ParOptScalar *z,
+                                         ParOptVec *zw, ParOptVec *px,
+                                         ParOptVec *hvec) {
+  int entry = findEntry(x);
+  int fail = syncProblem(x, &entry);
+  if (fail) {
+    return fail;
+  }
+  return prob->evalHvecProduct(x, z, zw, px, hvec);
+}
+
+/*
+  Evaluate the diagonal Hessian
+*/
+int ParOptCachedProblem::evalHessianDiag(ParOptVec *x, ParOptScalar *z,
+                                         ParOptVec *zw, ParOptVec *hdiag) {
+  int entry = findEntry(x);
+  int fail = syncProblem(x, &entry);
+  if (fail) {
+    return fail;
+  }
+  return prob->evalHessianDiag(x, z, zw, hdiag);
+}
+
+/*
+  Compute a correction to the quasi-Newton update
+*/
+void ParOptCachedProblem::computeQuasiNewtonUpdateCorrection(
+    ParOptVec *x, ParOptScalar *z, ParOptVec *zw, ParOptVec *s, ParOptVec *y) {
+  prob->computeQuasiNewtonUpdateCorrection(x, z, zw, s, y);
+}
+
+/*
+  Create a design vector
+*/
+ParOptVec *ParOptCachedProblem::createDesignVec() {
+  return prob->createDesignVec();
+}
+
+/*
+  Create the sparse constraint vector
+*/
+ParOptVec *ParOptCachedProblem::createConstraintVec() {
+  return prob->createConstraintVec();
+}
+
+/*
+  Create the quasi-definite matrix
+*/
+ParOptQuasiDefMat *ParOptCachedProblem::createQuasiDefMat() {
+  return prob->createQuasiDefMat();
+}
+
+/*
+  Get the communicator for the problem
+*/
+MPI_Comm ParOptCachedProblem::getMPIComm() { return prob->getMPIComm(); }
+
+/*
+  Functions to indicate the type of sparse constraints
+*/
+int ParOptCachedProblem::isSparseInequality() {
+  return prob->isSparseInequality();
+}
+
+int ParOptCachedProblem::useLowerBounds() { return prob->useLowerBounds(); }
+
+int ParOptCachedProblem::useUpperBounds() { return prob->useUpperBounds(); }
+
+/*
+  Functions to indicate the linearity of the objective and constraints
+*/
+int ParOptCachedProblem::isObjQuadratic() { return prob->isObjQuadratic(); }
+
+int ParOptCachedProblem::isDenseConLinear(int index) {
+  return prob->isDenseConLinear(index);
+}
+
+int ParOptCachedProblem::isSparseConLinear() {
+  return prob->isSparseConLinear();
+}
+
+/*
+  Get the variables and bounds from the problem
+*/
+void ParOptCachedProblem::getVarsAndBounds(ParOptVec *x, ParOptVec *lb,
+                                           ParOptVec *ub) {
+  prob->getVarsAndBounds(x, lb, ub);
+}
+
+/*
+  Evaluate the sparse constraints
+*/
+void ParOptCachedProblem::evalSparseCon(ParOptVec *x, ParOptVec *out) {
+  int entry = findEntry(x);
+  syncProblem(x, &entry);
+  prob->evalSparseCon(x, out);
+}
+
+/*
+  Compute the Jacobian-vector product out = J(x)*px
+*/
+void ParOptCachedProblem::addSparseJacobian(ParOptScalar alpha, ParOptVec *x,
+                                            ParOptVec *px, ParOptVec *out) {
+  prob->addSparseJacobian(alpha, x, px, out);
+}
+
+/*
+  Compute the transpose Jacobian-vector product out = J(x)^{T}*pzw
+*/
+void ParOptCachedProblem::addSparseJacobianTranspose(ParOptScalar alpha,
+                                                     ParOptVec *x,
+                                                     ParOptVec *pzw,
+                                                     ParOptVec *out) {
+  prob->addSparseJacobianTranspose(alpha, x, pzw, out);
+}
+
+/*
+  Add the inner product of the constraints to the matrix such
+  that A += J(x)*cvec*J(x)^{T} where cvec is a diagonal matrix
+*/
+void ParOptCachedProblem::addSparseInnerProduct(ParOptScalar alpha,
+                                                ParOptVec *x, ParOptVec *cvec,
+                                                ParOptScalar *A) {
+  prob->addSparseInnerProduct(alpha, x, cvec, A);
+}
+
+/*
+  Write the output from the wrapped problem
+*/
+void ParOptCachedProblem::writeOutput(int iter, ParOptVec *x) {
+  prob->writeOutput(iter, x);
+}
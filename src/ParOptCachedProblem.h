@@ -0,0 +1,197 @@
+#ifndef PAR_OPT_CACHED_PROBLEM_H
+#define PAR_OPT_CACHED_PROBLEM_H
+
+#include <stdio.h>
+
+#include "ParOptProblem.h"
+
+/*
+  A problem wrapper that caches the most recent function evaluations.
+
+  The optimizers frequently re-evaluate the objective, constraints and
+  their gradients at a point where they have just been computed (for
+  instance, the accepted point from the line search). When each
+  evaluation is expensive, this class can be wrapped around the user
+  problem to avoid the repeated calls.
+
+  The cache stores up to max_entries design points with their
+  objective, dense constraint values and (if they have been requested)
+  the objective and dense constraint gradients. Entries are evicted in
+  least-recently-used order. The gradients of the linear dense
+  constraints are stored once from the first gradient evaluation.
+
+  A point is only treated as a cache hit when the local portion of the
+  design vector matches on every processor. Each processor compares a
+  hash of its local values and then the values themselves, and the
+  result is combined with a single reduction so that all processors
+  take the same branch.
+
+  Evaluations that fail are never stored. Since many problem
+  implementations store state from the last call to evalObjCon (for
+  instance, the solution of a governing equation that is re-used to
+  evaluate the gradient), the wrapped problem is always re-evaluated
+  at x before evalObjConGradient, evalHvecProduct or evalHessianDiag
+  is forwarded, if the last call to evalObjCon was at a different point.
+
+  The sparse constraint Jacobian products are forwarded directly and
+  use the state of the wrapped problem from its last gradient
+  evaluation. For this reason, when the problem has sparse constraints
+  (nwcon > 0), gradients are only taken from the cache at the point of
+  the last gradient evaluation of the wrapped problem.
+
+  The sparse format of the dense constraint gradients and the
+  matrix-free dense constraint Jacobian are forwarded to the wrapped
+  problem without caching. The wrapped problem is re-evaluated at x
+  before the gradients or the Jacobian-vector products are forwarded,
+  if needed.
+*/
+class ParOptCachedProblem : public ParOptProblem {
+ public:
+  ParOptCachedProblem(ParOptProblem *_prob, int _max_entries = 4);
+  ~ParOptCachedProblem();
+
+  // Get the wrapped problem
+  ParOptProblem *getProblem() { return prob; }
+
+  // Clear all the entries in the cache
+  void clearCache();
+
+  // Get the cache statistics
+  void getCacheStats(int *_obj_hits, int *_obj_misses, int *_grad_hits,
+                     int *_grad_misses);
+
+  // Print the cache statistics
+  void printCacheStats(FILE *fp);
+
+  // Create the design vectors
+  ParOptVec *createDesignVec();
+  ParOptVec *createConstraintVec();
+  ParOptQuasiDefMat *createQuasiDefMat();
+
+  // Get the communicator for the problem
+  MPI_Comm getMPIComm();
+
+  // Function to indicate the type of sparse constraints
+  int isSparseInequality();
+  int useLowerBounds();
+  int useUpperBounds();
+
+  // Functions to indicate the linearity of the objective and constraints
+  int isObjQuadratic();
+  int isDenseConLinear(int index);
+  int isSparseConLinear();
+
+  // Get the variables and bounds from the problem
+  void getVarsAndBounds(ParOptVec *x, ParOptVec *lb, ParOptVec *ub);
+
+  // Evaluate the objective and constraints
+  int evalObjCon(ParOptVec *x, ParOptScalar *fobj, ParOptScalar *cons);
+
+  // Evaluate the objective and constraint gradients
+  int evalObjConGradient(ParOptVec *x, ParOptVec *g, ParOptVec **Ac);
+
+  // Sparse format of the dense constraint gradients
+  int getConGradientPattern(const int **rowp, const int **cols);
+  int evalObjConSparseGradient(ParOptVec *x, ParOptVec *g,
+                               ParOptScalar *Avals);
+
+  // Matrix-free dense constraint Jacobian
+  int useDenseJacobianProducts();
+  int evalObjGradient(ParOptVec *x, ParOptVec *g);
+  void addDenseJacobian(ParOptScalar alpha, ParOptVec *x, int nvecs,
+                        ParOptVec **px, ParOptScalar *out);
+  void addDenseJacobianTranspose(ParOptScalar alpha, ParOptVec *x, int nvecs,
+                                 const ParOptScalar *pz, ParOptVec **out);
+
+  // Evaluate the product of the Hessian with a given vector
+  int evalHvecProduct(ParOptVec *x, ParOptScalar *z, ParOptVec *zw,
+                      ParOptVec *px, ParOptVec *hvec);
+
+  // Evaluate the diagonal Hessian
+  int evalHessianDiag(ParOptVec *x, ParOptScalar *z, ParOptVec *zw,
+                      ParOptVec *hdiag);
+
+  // Compute a correction to the quasi-Newton update
+  void computeQuasiNewtonUpdateCorrection(ParOptVec *x, ParOptScalar *z,
+                                          ParOptVec *zw, ParOptVec *s,
+                                          ParOptVec *y);
+
+  // Evaluate the constraints
+  void evalSparseCon(ParOptVec *x, ParOptVec *out);
+
+  // Compute the Jacobian-vector product out = J(x)*px
+  void addSparseJacobian(ParOptScalar alpha, ParOptVec *x, ParOptVec *px,
+                         ParOptVec *out);
+
+  // Compute the transpose Jacobian-vector product out = J(x)^{T}*pzw
+  void addSparseJacobianTranspose(ParOptScalar alpha, ParOptVec *x,
+                                  ParOptVec *pzw, ParOptVec *out);
+
+  // Add the inner product of the constraints to the matrix such
+  // that A += J(x)*cvec*J(x)^{T} where cvec is a diagonal matrix
+  void addSparseInnerProduct(ParOptScalar alpha, ParOptVec *x, ParOptVec *cvec,
+                             ParOptScalar *A);
+
+  // Write the output from the wrapped problem
+  void writeOutput(int iter, ParOptVec *x);
+
+ private:
+  // Hash the local components of the vector
+  static unsigned long hashVec(ParOptVec *x);
+
+  // Find the cache entry that matches x on all processors (or -1)
+  int findEntry(ParOptVec *x);
+
+  // Move the entry to the front of the LRU ordering
+  void touchEntry(int entry);
+
+  // Get the least-recently-used entry and reset its contents
+  int allocEntry(ParOptVec *x);
+
+  // Make sure that the last call to prob->evalObjCon was at x
+  int syncProblem(ParOptVec *x, int *entry);
+
+  // Record the point passed to the wrapped problem's evalObjCon
+  void setLastPoint(ParOptVec *x);
+
+  // The wrapped problem
+  ParOptProblem *prob;
+
+  // The cached data for each entry
+  int max_entries;       // Maximum number of entries
+  int num_entries;       // Current number of valid entries
+  int *lru;              // The entry indices, most recently used first
+  unsigned long *xhash;  // The hash of the local design variables
+  int *has_obj;          // Flag indicating the objective/constraints are set
+  int *has_grad;         // Flag indicating the gradients are set
+  ParOptVec **xvals;     // The design points
+  ParOptScalar *fvals;   // The objective values
+  ParOptScalar *cvals;   // The constraint values (max_entries*ncon)
+  ParOptVec **gvals;     // The objective gradients
+  ParOptVec **Avals;     // The constraint gradients (max_entries*ncon)
+
+  // The gradients of the linear dense constraints. These are stored
+  // once and are NULL for the non-linear constraints.
+  int has_lin_grad;
+  ParOptVec **Alin;
+
+  // The last point passed to the wrapped problem's evalObjCon and a
+  // flag indicating that its gradient was evaluated at this point
+  int has_last;
+  int has_last_grad;
+  unsigned long xlast_hash;
+  ParOptVec *xlast;
+
+  // Work array for the collective hit detection
+  int *match;
+  int last_match;
+
+  // Temporary constraint values
+  ParOptScalar *ctemp;
+
+  // Cache statistics
+  int obj_hits, obj_misses;
+  int grad_hits, grad_misses;
+};
+
+#endif  // PAR_OPT_CACHED_PROBLEM_H
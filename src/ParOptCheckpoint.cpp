@@ -0,0 +1,993 @@
+#include "ParOptCheckpoint.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef PAROPT_USE_ZLIB
+#include <zlib.h>
+#endif  // PAROPT_USE_ZLIB
+
+/*
+  The layout constants for the checkpoint file
+*/
+static const char PAROPT_CHECKPOINT_MAGIC[8] = {'P', 'A', 'R', 'O',
+                                                'P', 'T', 'C', 'K'};
+static const int PAROPT_CHECKPOINT_VERSION = 1;
+static const int PAROPT_CHECKPOINT_BYTE_ORDER = 0x01020304;
+static const int PAROPT_CHECKPOINT_HEADER_SIZE = 64;
+static const int PAROPT_CHECKPOINT_INDEX_SIZE = 64;
+static const int PAROPT_CHECKPOINT_BLOCK_SIZE = 32;
+
+/*
+  The flags for each record
+*/
+static const int PAROPT_CHECKPOINT_DISTRIBUTED = 1;
+static const int PAROPT_CHECKPOINT_COMPRESSED = 2;
+
+/*
+  Get the size of an element of the given type
+*/
+static size_t ParOptCheckpointElementSize(int type) {
+  if (type == PAROPT_CHECKPOINT_INT) {
+    return sizeof(int);
+  }
+  return sizeof(ParOptScalar);
+}
+
+/*
+  Pack and unpack the fixed-width integers in the file
+*/
+static void ParOptCheckpointPackInt(char *ptr, int value) {
+  int32_t v = value;
+  memcpy(ptr, &v, sizeof(int32_t));
+}
+
+static void ParOptCheckpointPackInt64(char *ptr, int64_t value) {
+  memcpy(ptr, &value, sizeof(int64_t));
+}
+
+static int ParOptCheckpointUnpackInt(const char *ptr) {
+  int32_t v;
+  memcpy(&v, ptr, sizeof(int32_t));
+  return v;
+}
+
+static int64_t ParOptCheckpointUnpackInt64(const char *ptr) {
+  int64_t v;
+  memcpy(&v, ptr, sizeof(int64_t));
+  return v;
+}
+
+/**
+  Create an empty checkpoint
+
+  @param _comm the communicator for the file
+*/
+ParOptCheckpoint::ParOptCheckpoint(MPI_Comm _comm) {
+  comm = _comm;
+
+  nrecords = 0;
+  max_records = 0;
+  records = NULL;
+
+  buffer_size = 0;
+  max_buffer_size = 0;
+  buffer = NULL;
+
+  meta_size = 0;
+  meta = NULL;
+
+  compress = 0;
+  fp = MPI_FILE_NULL;
+  filename = NULL;
+  tmp_filename = NULL;
+
+  write_pending = 0;
+  write_fail = 0;
+  nrequests = 0;
+  requests = NULL;
+  write_offsets = NULL;
+  write_sizes = NULL;
+  write_data = NULL;
+}
+
+/**
+  Free the checkpoint data, completing any writes that are in progress
+*/
+ParOptCheckpoint::~ParOptCheckpoint() {
+  clear();
+  delete[] records;
+  delete[] buffer;
+  delete[] filename;
+  delete[] tmp_filename;
+}
+
+/**
+  Remove all the records from the checkpoint.
+
+  Any nonblocking write is completed and any file that has been read
+  is closed. The storage is retained for the next checkpoint.
+*/
+void ParOptCheckpoint::clear() {
+  finishWrite(1);
+  if (fp != MPI_FILE_NULL) {
+    MPI_File_close(&fp);
+  }
+
+  nrecords = 0;
+  buffer_size = 0;
+  meta_size = 0;
+  delete[] meta;
+  meta = NULL;
+
+  delete[] requests;
+  delete[] write_offsets;
+  delete[] write_sizes;
+  delete[] write_data;
+  requests = NULL;
+  write_offsets = NULL;
+  write_sizes = NULL;
+  write_data = NULL;
+}
+
+/*
+  Add a record to the list and copy the local data to the buffer
+*/
+void ParOptCheckpoint::addRecord(const char *name, int type, int distributed,
+                                 int64_t count, const void *data) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  if (strlen(name) >= sizeof(records[0].name)) {
+    if (rank == 0) {
+      fprintf(stderr, "ParOpt: Checkpoint record name %s is too long\n",
+              name);
+    }
+    return;
+  }
+
+  if (nrecords >= max_records) {
+    max_records = 2 * max_records + 16;
+    Record *temp = new Record[max_records];
+    if (records) {
+      memcpy(temp, records, nrecords * sizeof(Record));
+      delete[] records;
+    }
+    records = temp;
+  }
+
+  Record *rec = &records[nrecords];
+  nrecords++;
+  memset(rec, 0, sizeof(Record));
+  strcpy(rec->name, name);
+  rec->type = type;
+  rec->flags = (distributed ? PAROPT_CHECKPOINT_DISTRIBUTED : 0);
+  rec->length = count;
+
+  // Serial records are only stored on the root processor
+  rec->count = 0;
+  if (distributed || rank == 0) {
+    rec->count = count;
+  }
+  rec->nbytes = rec->count * ParOptCheckpointElementSize(type);
+  rec->buf_offset = buffer_size;
+
+  if (buffer_size + rec->nbytes > max_buffer_size) {
+    max_buffer_size = 2 * (buffer_size + rec->nbytes);
+    char *temp = new char[max_buffer_size];
+    if (buffer) {
+      memcpy(temp, buffer, buffer_size);
+      delete[] buffer;
+    }
+    buffer = temp;
+  }
+  if (rec->nbytes > 0) {
+    memcpy(&buffer[buffer_size], data, rec->nbytes);
+  }
+  buffer_size += rec->nbytes;
+}
+
+/**
+  Add an array of integers to the checkpoint
+
+  @param name the name of the record
+  @param n the number of values (must be the same on all processors)
+  @param values the values (only used on the root processor)
+*/
+void ParOptCheckpoint::addInts(const char *name, int n, const int *values) {
+  addRecord(name, PAROPT_CHECKPOINT_INT, 0, n, values);
+}
+
+/**
+  Add an array of scalars to the checkpoint
+
+  @param name the name of the record
+  @param n the number of values (must be the same on all processors)
+  @param values the values (only used on the root processor)
+*/
+void ParOptCheckpoint::addScalars(const char *name, int n,
+                                  const ParOptScalar *values) {
+  addRecord(name, PAROPT_CHECKPOINT_SCALAR, 0, n, values);
+}
+
+/**
+  Add a distributed vector to the checkpoint
+
+  @param name the name of the record
+  @param vec the vector
+*/
+void ParOptCheckpoint::addVec(const char *name, ParOptVec *vec) {
+  ParOptScalar *vals;
+  int n = vec->getArray(&vals);
+  addRecord(name, PAROPT_CHECKPOINT_SCALAR, 1, n, vals);
+}
+
+/**
+  Add the update pairs that define a quasi-Newton approximation.
+
+  The records are the number of pairs, the diagonal b0 and the S and Y
+  vectors. Approximations that do not provide their update pairs are
+  stored with no pairs.
+
+  @param prefix the prefix for the record names
+  @param qn the quasi-Newton approximation (may be NULL)
+*/
+void ParOptCheckpoint::addQuasiNewton(const char *prefix,
+                                      ParOptCompactQuasiNewton *qn) {
+  ParOptScalar b0 = 1.0;
+  ParOptVec **S = NULL, **Y = NULL;
+  int m = 0;
+  if (qn) {
+    m = qn->getUpdatePairs(&b0, &S, &Y);
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "%s_size", prefix);
+  addInts(name, 1, &m);
+  snprintf(name, sizeof(name), "%s_b0", prefix);
+  addScalars(name, 1, &b0);
+  for (int i = 0; i < m; i++) {
+    snprintf(name, sizeof(name), "%s_s%d", prefix, i);
+    addVec(name, S[i]);
+    snprintf(name, sizeof(name), "%s_y%d", prefix, i);
+    addVec(name, Y[i]);
+  }
+}
+
+/*
+  Compute the layout of the file, assemble the header, block tables and
+  index on the root processor and open the temporary file.
+
+  The local data for each record is written as one block. On exit, the
+  list of local writes is stored in write_offsets/write_sizes/write_data.
+*/
+int ParOptCheckpoint::setUpFile(const char *fname) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Set the names of the file and the temporary file
+  if (!filename || strcmp(filename, fname) != 0) {
+    delete[] filename;
+    delete[] tmp_filename;
+    filename = new char[strlen(fname) + 1];
+    strcpy(filename, fname);
+    tmp_filename = new char[strlen(fname) + 5];
+    sprintf(tmp_filename, "%s.tmp", fname);
+  }
+
+#ifdef PAROPT_USE_ZLIB
+  // Compress the local data for each record
+  if (compress) {
+    size_t zsize = 0;
+    for (int i = 0; i < nrecords; i++) {
+      zsize += compressBound(records[i].nbytes);
+    }
+    char *zbuffer = new char[zsize + 1];
+    size_t offset = 0;
+    for (int i = 0; i < nrecords; i++) {
+      uLongf len = compressBound(records[i].nbytes);
+      if (records[i].nbytes > 0) {
+        compress2((Bytef *)&zbuffer[offset], &len,
+                  (const Bytef *)&buffer[records[i].buf_offset],
+                  records[i].nbytes, Z_DEFAULT_COMPRESSION);
+      } else {
+        len = 0;
+      }
+      records[i].flags |= PAROPT_CHECKPOINT_COMPRESSED;
+      records[i].buf_offset = offset;
+      records[i].nbytes = len;
+      offset += len;
+    }
+    delete[] buffer;
+    buffer = zbuffer;
+    buffer_size = offset;
+    max_buffer_size = zsize + 1;
+  }
+#else
+  if (compress) {
+    if (rank == 0) {
+      fprintf(stderr,
+              "ParOpt Warning: Checkpoint compression requires zlib, "
+              "writing uncompressed file\n");
+    }
+    compress = 0;
+  }
+#endif  // PAROPT_USE_ZLIB
+
+  // Gather the number of entries and bytes for each record
+  int64_t *local = new int64_t[2 * nrecords + 1];
+  int64_t *all = new int64_t[size * (2 * nrecords + 1)];
+  for (int i = 0; i < nrecords; i++) {
+    local[2 * i] = records[i].count;
+    local[2 * i + 1] = records[i].nbytes;
+  }
+  MPI_Allgather(local, 2 * nrecords, MPI_INT64_T, all, 2 * nrecords,
+                MPI_INT64_T, comm);
+
+  // Allocate space for the local writes
+  delete[] write_offsets;
+  delete[] write_sizes;
+  delete[] write_data;
+  delete[] requests;
+  write_offsets = new MPI_Offset[2 * nrecords + 2];
+  write_sizes = new size_t[2 * nrecords + 2];
+  write_data = new char *[2 * nrecords + 2];
+  requests = new MPI_Request[2 * nrecords + 2];
+  nrequests = 0;
+
+  // Compute the layout of the file. Serial records are stored as a
+  // single block from the root processor.
+  int nwrites = 0;
+  int64_t offset = PAROPT_CHECKPOINT_HEADER_SIZE;
+  for (int i = 0; i < nrecords; i++) {
+    Record *rec = &records[i];
+    int distributed = (rec->flags & PAROPT_CHECKPOINT_DISTRIBUTED);
+    rec->nblocks = (distributed ? size : 1);
+    rec->offset = offset;
+    offset += rec->nblocks * PAROPT_CHECKPOINT_BLOCK_SIZE;
+
+    int64_t start = 0;
+    for (int j = 0; j < rec->nblocks; j++) {
+      if (j == rank) {
+        rec->start = start;
+        if (rec->nbytes > 0) {
+          write_offsets[nwrites] = offset;
+          write_sizes[nwrites] = rec->nbytes;
+          write_data[nwrites] = &buffer[rec->buf_offset];
+          nwrites++;
+        }
+      }
+      start += all[(2 * nrecords) * j + 2 * i];
+      offset += all[(2 * nrecords) * j + 2 * i + 1];
+    }
+    rec->length = start;
+  }
+  const int64_t index_offset = offset;
+  const int64_t file_size =
+      index_offset + nrecords * PAROPT_CHECKPOINT_INDEX_SIZE;
+
+  // Assemble the header, block tables and index on the root
+  delete[] meta;
+  meta = NULL;
+  meta_size = 0;
+  if (rank == 0) {
+    size_t table_size = 0;
+    for (int i = 0; i < nrecords; i++) {
+      table_size += records[i].nblocks * PAROPT_CHECKPOINT_BLOCK_SIZE;
+    }
+    meta_size = PAROPT_CHECKPOINT_HEADER_SIZE + table_size +
+                nrecords * PAROPT_CHECKPOINT_INDEX_SIZE;
+    meta = new char[meta_size];
+    memset(meta, 0, meta_size);
+
+    // The header
+    char *ptr = meta;
+    memcpy(ptr, PAROPT_CHECKPOINT_MAGIC, 8);
+    ParOptCheckpointPackInt(&ptr[8], PAROPT_CHECKPOINT_VERSION);
+    ParOptCheckpointPackInt(&ptr[12], PAROPT_CHECKPOINT_BYTE_ORDER);
+    ParOptCheckpointPackInt(&ptr[16], sizeof(ParOptScalar));
+    ParOptCheckpointPackInt(&ptr[20], nrecords);
+    ParOptCheckpointPackInt64(&ptr[24], index_offset);
+    write_offsets[nwrites] = 0;
+    write_sizes[nwrites] = PAROPT_CHECKPOINT_HEADER_SIZE;
+    write_data[nwrites] = ptr;
+    nwrites++;
+    ptr += PAROPT_CHECKPOINT_HEADER_SIZE;
+
+    // The block table for each record
+    for (int i = 0; i < nrecords; i++) {
+      Record *rec = &records[i];
+      char *table = ptr;
+      int64_t start = 0;
+      int64_t block_offset =
+          rec->offset + rec->nblocks * PAROPT_CHECKPOINT_BLOCK_SIZE;
+      for (int j = 0; j < rec->nblocks; j++) {
+        int64_t count = all[(2 * nrecords) * j + 2 * i];
+        int64_t nbytes = all[(2 * nrecords) * j + 2 * i + 1];
+        ParOptCheckpointPackInt64(&ptr[0], start);
+        ParOptCheckpointPackInt64(&ptr[8], count);
+        ParOptCheckpointPackInt64(&ptr[16], block_offset);
+        ParOptCheckpointPackInt64(&ptr[24], nbytes);
+        ptr += PAROPT_CHECKPOINT_BLOCK_SIZE;
+        start += count;
+        block_offset += nbytes;
+      }
+      write_offsets[nwrites] = rec->offset;
+      write_sizes[nwrites] = ptr - table;
+      write_data[nwrites] = table;
+      nwrites++;
+    }
+
+    // The record index
+    char *index = ptr;
+    for (int i = 0; i < nrecords; i++) {
+      Record *rec = &records[i];
+      memcpy(ptr, rec->name, sizeof(rec->name));
+      ParOptCheckpointPackInt(&ptr[32], rec->type);
+      ParOptCheckpointPackInt(&ptr[36], rec->flags);
+      ParOptCheckpointPackInt64(&ptr[40], rec->length);
+      ParOptCheckpointPackInt64(&ptr[48], rec->offset);
+      ParOptCheckpointPackInt(&ptr[56], rec->nblocks);
+      ptr += PAROPT_CHECKPOINT_INDEX_SIZE;
+    }
+    write_offsets[nwrites] = index_offset;
+    write_sizes[nwrites] = ptr - index;
+    write_data[nwrites] = index;
+    nwrites++;
+  }
+  nrequests = nwrites;
+
+  delete[] local;
+  delete[] all;
+
+  // Open the temporary file and set its final size
+  if (fp != MPI_FILE_NULL) {
+    MPI_File_close(&fp);
+  }
+  if (MPI_File_open(comm, tmp_filename, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS) {
+    fp = MPI_FILE_NULL;
+    return 1;
+  }
+  MPI_File_set_size(fp, file_size);
+
+  return 0;
+}
+
+/**
+  Write the records to a file with blocking MPI-IO.
+
+  @param fname the name of the file
+  @param _compress flag to compress the data (requires zlib)
+  @return zero on success, non-zero on failure
+*/
+int ParOptCheckpoint::write(const char *fname, int _compress) {
+  finishWrite(1);
+
+  compress = _compress;
+  if (setUpFile(fname)) {
+    return 1;
+  }
+
+  // The default file view has a byte displacement, so the offsets
+  // are given in bytes
+  int fail = 0;
+  for (int i = 0; i < nrequests; i++) {
+    if (MPI_File_write_at(fp, write_offsets[i], write_data[i],
+                          (int)write_sizes[i], MPI_BYTE,
+                          MPI_STATUS_IGNORE) != MPI_SUCCESS) {
+      fail = 1;
+    }
+  }
+
+  return closeWrite(fail);
+}
+
+/**
+  Start writing the records to a file with nonblocking MPI-IO.
+
+  The records must not be modified until finishWrite() indicates that
+  the write has completed.
+
+  @param fname the name of the file
+  @param _compress flag to compress the data (requires zlib)
+  @return zero on success, non-zero on failure
+*/
+int ParOptCheckpoint::startWrite(const char *fname, int _compress) {
+  int fail = finishWrite(1);
+  if (fail) {
+    return fail;
+  }
+
+  compress = _compress;
+  if (setUpFile(fname)) {
+    return 1;
+  }
+
+  write_fail = 0;
+  for (int i = 0; i < nrequests; i++) {
+    if (MPI_File_iwrite_at(fp, write_offsets[i], write_data[i],
+                           (int)write_sizes[i], MPI_BYTE,
+                           &requests[i]) != MPI_SUCCESS) {
+      requests[i] = MPI_REQUEST_NULL;
+      write_fail = 1;
+    }
+  }
+  write_pending = 1;
+
+  return 0;
+}
+
+/**
+  Complete the nonblocking write, if one is in progress.
+
+  When wait is zero, this only tests whether the writes on all
+  processors have completed and returns without blocking otherwise.
+  This call is collective.
+
+  @param wait flag to wait for the writes to complete
+  @return zero on success, non-zero on failure
+*/
+int ParOptCheckpoint::finishWrite(int wait) {
+  if (!write_pending) {
+    return 0;
+  }
+
+  int fail = write_fail;
+  if (wait) {
+    if (MPI_Waitall(nrequests, requests, MPI_STATUSES_IGNORE)) {
+      fail = 1;
+    }
+  } else {
+    int complete = 1;
+    if (MPI_Testall(nrequests, requests, &complete, MPI_STATUSES_IGNORE)) {
+      fail = 1;
+    }
+
+    // The file can only be closed once all processors have completed
+    int all_complete = 0;
+    MPI_Allreduce(&complete, &all_complete, 1, MPI_INT, MPI_MIN, comm);
+    if (!all_complete) {
+      write_fail = fail;
+      return 0;
+    }
+  }
+
+  write_pending = 0;
+  return closeWrite(fail);
+}
+
+/*
+  Close the temporary file and replace the checkpoint file if the
+  writes succeeded on all processors
+*/
+int ParOptCheckpoint::closeWrite(int fail) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  MPI_File_close(&fp);
+  nrequests = 0;
+
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+  if (!fail && rank == 0) {
+    if (rename(tmp_filename, filename) != 0) {
+      fail = 1;
+    }
+  }
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+
+  return fail;
+}
+
+/**
+  Check whether the file is a checkpoint file
+
+  @param comm the communicator
+  @param fname the name of the file
+  @return 1 if the file starts with the checkpoint header, 0 otherwise
+*/
+int ParOptCheckpoint::isCheckpointFile(MPI_Comm comm, const char *fname) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int is_checkpoint = 0;
+  if (rank == 0) {
+    FILE *f = fopen(fname, "rb");
+    if (f) {
+      char magic[8];
+      if (fread(magic, 1, 8, f) == 8 &&
+          memcmp(magic, PAROPT_CHECKPOINT_MAGIC, 8) == 0) {
+        is_checkpoint = 1;
+      }
+      fclose(f);
+    }
+  }
+  MPI_Bcast(&is_checkpoint, 1, MPI_INT, 0, comm);
+
+  return is_checkpoint;
+}
+
+/**
+  Open a checkpoint file and read the record index.
+
+  The file remains open so that the records can be read with the get
+  functions. It is closed by clear() or when the object is deleted.
+
+  @param fname the name of the file
+  @return zero on success, non-zero on failure
+*/
+int ParOptCheckpoint::read(const char *fname) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  clear();
+
+  if (MPI_File_open(comm, fname, MPI_MODE_RDONLY, MPI_INFO_NULL, &fp) !=
+      MPI_SUCCESS) {
+    fp = MPI_FILE_NULL;
+    if (rank == 0) {
+      fprintf(stderr, "ParOpt: Could not open checkpoint file %s\n", fname);
+    }
+    return 1;
+  }
+
+  // Read and check the header on the root processor
+  int fail = 0;
+  int num = 0;
+  char *index = NULL;
+  if (rank == 0) {
+    char header[PAROPT_CHECKPOINT_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    MPI_File_read_at(fp, 0, header, PAROPT_CHECKPOINT_HEADER_SIZE, MPI_BYTE,
+                     MPI_STATUS_IGNORE);
+    if (memcmp(header, PAROPT_CHECKPOINT_MAGIC, 8) != 0) {
+      fprintf(stderr, "ParOpt: %s is not a checkpoint file\n", fname);
+      fail = 1;
+    } else if (ParOptCheckpointUnpackInt(&header[12]) !=
+               PAROPT_CHECKPOINT_BYTE_ORDER) {
+      fprintf(stderr,
+              "ParOpt: Checkpoint file %s has a different byte order\n",
+              fname);
+      fail = 1;
+    } else if (ParOptCheckpointUnpackInt(&header[8]) >
+               PAROPT_CHECKPOINT_VERSION) {
+      fprintf(stderr,
+              "ParOpt: Checkpoint file %s version %d is not supported\n",
+              fname, ParOptCheckpointUnpackInt(&header[8]));
+      fail = 1;
+    } else if (ParOptCheckpointUnpackInt(&header[16]) !=
+               (int)sizeof(ParOptScalar)) {
+      fprintf(stderr,
+              "ParOpt: Checkpoint file %s scalar type does not match\n",
+              fname);
+      fail = 1;
+    } else {
+      num = ParOptCheckpointUnpackInt(&header[20]);
+      int64_t index_offset = ParOptCheckpointUnpackInt64(&header[24]);
+      index = new char[num * PAROPT_CHECKPOINT_INDEX_SIZE + 1];
+      MPI_File_read_at(fp, index_offset, index,
+                       num * PAROPT_CHECKPOINT_INDEX_SIZE, MPI_BYTE,
+                       MPI_STATUS_IGNORE);
+    }
+  }
+
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+  if (fail) {
+    MPI_File_close(&fp);
+    return fail;
+  }
+
+  // Broadcast the record index
+  MPI_Bcast(&num, 1, MPI_INT, 0, comm);
+  if (rank != 0) {
+    index = new char[num * PAROPT_CHECKPOINT_INDEX_SIZE + 1];
+  }
+  MPI_Bcast(index, num * PAROPT_CHECKPOINT_INDEX_SIZE, MPI_BYTE, 0, comm);
+
+  // Set the records from the index
+  if (num > max_records) {
+    delete[] records;
+    max_records = num;
+    records = new Record[max_records];
+  }
+  nrecords = num;
+  for (int i = 0; i < nrecords; i++) {
+    const char *ptr = &index[i * PAROPT_CHECKPOINT_INDEX_SIZE];
+    Record *rec = &records[i];
+    memset(rec, 0, sizeof(Record));
+    memcpy(rec->name, ptr, sizeof(rec->name));
+    rec->name[sizeof(rec->name) - 1] = '\0';
+    rec->type = ParOptCheckpointUnpackInt(&ptr[32]);
+    rec->flags = ParOptCheckpointUnpackInt(&ptr[36]);
+    rec->length = ParOptCheckpointUnpackInt64(&ptr[40]);
+    rec->offset = ParOptCheckpointUnpackInt64(&ptr[48]);
+    rec->nblocks = ParOptCheckpointUnpackInt(&ptr[56]);
+  }
+  delete[] index;
+
+  return 0;
+}
+
+/*
+  Find the record with the given name
+*/
+ParOptCheckpoint::Record *ParOptCheckpoint::findRecord(const char *name) {
+  for (int i = 0; i < nrecords; i++) {
+    if (strcmp(records[i].name, name) == 0) {
+      return &records[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+  Get the global length of a record in the file that has been read
+
+  @param name the name of the record
+  @return the global length or -1 if the record does not exist
+*/
+int ParOptCheckpoint::getRecordLength(const char *name) {
+  Record *rec = findRecord(name);
+  if (rec) {
+    return rec->length;
+  }
+  return -1;
+}
+
+/*
+  Read the entries [start, start + count) of a record.
+
+  The block table is read on the root processor. When collective is
+  set, all processors call this function and the table is broadcast,
+  otherwise this is only called on the root processor. The entries are
+  read from the blocks that overlap the range, so the range does not
+  need to match the layout of the blocks in the file.
+*/
+int ParOptCheckpoint::readRecord(Record *rec, int64_t start, int64_t count,
+                                 void *data, int collective) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Read the block table
+  char *table = new char[rec->nblocks * PAROPT_CHECKPOINT_BLOCK_SIZE + 1];
+  if (rank == 0) {
+    MPI_File_read_at(fp, rec->offset, table,
+                     rec->nblocks * PAROPT_CHECKPOINT_BLOCK_SIZE, MPI_BYTE,
+                     MPI_STATUS_IGNORE);
+  }
+  if (collective) {
+    MPI_Bcast(table, rec->nblocks * PAROPT_CHECKPOINT_BLOCK_SIZE, MPI_BYTE, 0,
+              comm);
+  }
+
+  const size_t elem_size = ParOptCheckpointElementSize(rec->type);
+  int fail = 0;
+
+#ifndef PAROPT_USE_ZLIB
+  if (rec->flags & PAROPT_CHECKPOINT_COMPRESSED) {
+    if (rank == 0) {
+      fprintf(stderr,
+              "ParOpt: Checkpoint record %s is compressed, but zlib is not "
+              "available\n",
+              rec->name);
+    }
+    delete[] table;
+    return 1;
+  }
+#endif  // PAROPT_USE_ZLIB
+
+  for (int j = 0; j < rec->nblocks; j++) {
+    const char *ptr = &table[j * PAROPT_CHECKPOINT_BLOCK_SIZE];
+    int64_t bstart = ParOptCheckpointUnpackInt64(&ptr[0]);
+    int64_t bcount = ParOptCheckpointUnpackInt64(&ptr[8]);
+    int64_t boffset = ParOptCheckpointUnpackInt64(&ptr[16]);
+
+    // Find the overlap between the block and the range
+    int64_t lo = (bstart > start ? bstart : start);
+    int64_t hi = (bstart + bcount < start + count ? bstart + bcount
+                                                  : start + count);
+    if (lo >= hi) {
+      continue;
+    }
+
+    char *dest = &((char *)data)[(lo - start) * elem_size];
+    if (rec->flags & PAROPT_CHECKPOINT_COMPRESSED) {
+#ifdef PAROPT_USE_ZLIB
+      // Read and decompress the entire block
+      int64_t bbytes = ParOptCheckpointUnpackInt64(&ptr[24]);
+      char *zdata = new char[bbytes + 1];
+      char *bdata = new char[bcount * elem_size + 1];
+      if (MPI_File_read_at(fp, boffset, zdata, bbytes, MPI_BYTE,
+                           MPI_STATUS_IGNORE) != MPI_SUCCESS) {
+        fail = 1;
+      } else {
+        uLongf len = bcount * elem_size;
+        if (uncompress((Bytef *)bdata, &len, (const Bytef *)zdata, bbytes) !=
+                Z_OK ||
+            len != (uLongf)(bcount * elem_size)) {
+          fail = 1;
+        } else {
+          memcpy(dest, &bdata[(lo - bstart) * elem_size],
+                 (hi - lo) * elem_size);
+        }
+      }
+      delete[] zdata;
+      delete[] bdata;
+#endif  // PAROPT_USE_ZLIB
+    } else {
+      if (MPI_File_read_at(fp, boffset + (lo - bstart) * elem_size, dest,
+                           (hi - lo) * elem_size, MPI_BYTE,
+                           MPI_STATUS_IGNORE) != MPI_SUCCESS) {
+        fail = 1;
+      }
+    }
+  }
+
+  delete[] table;
+
+  return fail;
+}
+
+/**
+  Read an array of integers from the file
+
+  @param name the name of the record
+  @param n the expected number of values
+  @param values the values (set on all processors)
+  @return zero on success, non-zero on failure
+*/
+int ParOptCheckpoint::getInts(const char *name, int n, int *values) {
+  Record *rec = findRecord(name);
+  if (!rec || rec->type != PAROPT_CHECKPOINT_INT || rec->length != n ||
+      fp == MPI_FILE_NULL) {
+    return 1;
+  }
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int fail = 0;
+  if (rank == 0) {
+    fail = readRecord(rec, 0, n, values, 0);
+  }
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+  if (!fail) {
+    MPI_Bcast(values, n, MPI_INT, 0, comm);
+  }
+
+  return fail;
+}
+
+/**
+  Read an array of scalars from the file
+
+  @param name the name of the record
+  @param n the expected number of values
+  @param values the values (set on all processors)
+  @return zero on success, non-zero on failure
+*/
+int ParOptCheckpoint::getScalars(const char *name, int n,
+                                 ParOptScalar *values) {
+  Record *rec = findRecord(name);
+  if (!rec || rec->type != PAROPT_CHECKPOINT_SCALAR || rec->length != n ||
+      fp == MPI_FILE_NULL) {
+    return 1;
+  }
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int fail = 0;
+  if (rank == 0) {
+    fail = readRecord(rec, 0, n, values, 0);
+  }
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+  if (!fail) {
+    MPI_Bcast(values, n, PAROPT_MPI_TYPE, 0, comm);
+  }
+
+  return fail;
+}
+
+/**
+  Read a distributed vector from the file.
+
+  The global index of the first local entry is the sum of the local
+  sizes on the lower ranks. The number of processors and the parallel
+  layout may differ from those used to write the file, but the global
+  length must match. This call is collective.
+
+  @param name the name of the record
+  @param vec the vector
+  @return zero on success, non-zero on failure
+*/
+int ParOptCheckpoint::getVec(const char *name, ParOptVec *vec) {
+  Record *rec = findRecord(name);
+  if (!rec || rec->type != PAROPT_CHECKPOINT_SCALAR || fp == MPI_FILE_NULL) {
+    return 1;
+  }
+
+  // Find the global range of the local entries
+  ParOptScalar *vals;
+  int64_t n = vec->getArray(&vals);
+  int64_t start = 0, length = 0;
+  MPI_Exscan(&n, &start, 1, MPI_INT64_T, MPI_SUM, comm);
+  MPI_Allreduce(&n, &length, 1, MPI_INT64_T, MPI_SUM, comm);
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank == 0) {
+    start = 0;
+  }
+
+  if (length != rec->length) {
+    if (rank == 0) {
+      fprintf(stderr,
+              "ParOpt: Checkpoint record %s has length %ld, expected %ld\n",
+              name, (long)rec->length, (long)length);
+    }
+    return 1;
+  }
+
+  int fail = readRecord(rec, start, n, vals, 1);
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+
+  return fail;
+}
+
+/**
+  Read the update pairs into a quasi-Newton approximation.
+
+  If the file does not contain any update pairs, the approximation is
+  not modified.
+
+  @param prefix the prefix for the record names
+  @param prob the problem used to create the design vectors
+  @param qn the quasi-Newton approximation
+  @return zero on success, non-zero on failure
+*/
+int ParOptCheckpoint::getQuasiNewton(const char *prefix, ParOptProblem *prob,
+                                     ParOptCompactQuasiNewton *qn) {
+  char name[64];
+  int m = 0;
+  snprintf(name, sizeof(name), "%s_size", prefix);
+  if (!qn || getRecordLength(name) != 1 || getInts(name, 1, &m) || m == 0) {
+    return 0;
+  }
+
+  ParOptScalar b0 = 1.0;
+  snprintf(name, sizeof(name), "%s_b0", prefix);
+  int fail = getScalars(name, 1, &b0);
+
+  // Read the S and Y vectors
+  ParOptVec **S = new ParOptVec *[m];
+  ParOptVec **Y = new ParOptVec *[m];
+  for (int i = 0; i < m; i++) {
+    S[i] = prob->createDesignVec();
+    S[i]->incref();
+    Y[i] = prob->createDesignVec();
+    Y[i]->incref();
+    if (!fail) {
+      snprintf(name, sizeof(name), "%s_s%d", prefix, i);
+      fail = getVec(name, S[i]);
+    }
+    if (!fail) {
+      snprintf(name, sizeof(name), "%s_y%d", prefix, i);
+      fail = getVec(name, Y[i]);
+    }
+  }
+
+  if (!fail) {
+    fail = qn->setUpdatePairs(b0, m, S, Y);
+  }
+
+  for (int i = 0; i < m; i++) {
+    S[i]->decref();
+    Y[i]->decref();
+  }
+  delete[] S;
+  delete[] Y;
+
+  return fail;
+}
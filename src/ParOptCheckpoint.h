@@ -0,0 +1,159 @@
+#ifndef PAR_OPT_CHECKPOINT_H
+#define PAR_OPT_CHECKPOINT_H
+
+#include <stdint.h>
+
+#include "ParOptQuasiNewton.h"
+#include "ParOptVec.h"
+
+/*
+  The element types for the records in a checkpoint file
+*/
+enum ParOptCheckpointType {
+  PAROPT_CHECKPOINT_INT = 1,
+  PAROPT_CHECKPOINT_SCALAR = 2
+};
+
+/*
+  A self-describing binary checkpoint file.
+
+  The file consists of a sequence of named records. Each record is
+  either a serial array of integers or scalars that is the same on all
+  processors, or a distributed vector. The data for a record is stored
+  as a series of blocks. A serial array is stored as a single block
+  written by the root processor, while a distributed vector is stored
+  with one block per processor, in the order of the global index. The
+  global index of the first entry owned by a processor is the sum of
+  the local sizes on the lower ranks.
+
+  The file layout is:
+
+  header: "PAROPTCK", version, byte-order marker, sizeof(ParOptScalar),
+          the number of records and the offset of the record index
+  data:   for each record, a block table followed by the blocks
+  index:  for each record, the name, type, flags, global length, the
+          number of blocks and the offset of the block table
+
+  A distributed vector can be read on any number of processors. Each
+  processor reads the parts of the blocks that overlap its range of
+  global indices, so the data is redistributed by the global index.
+
+  The blocks can be compressed with zlib when the library is built
+  with PAROPT_USE_ZLIB. Reading a compressed file without zlib fails.
+
+  The records are copied into an internal buffer when they are added,
+  so the data can be modified before the file is written. The file can
+  be written either with blocking or nonblocking MPI-IO. In both cases,
+  the data is written to filename.tmp, which is renamed to filename
+  once all the writes have completed, so an existing file is only
+  replaced by a complete file.
+*/
+class ParOptCheckpoint : public ParOptBase {
+ public:
+  ParOptCheckpoint(MPI_Comm _comm);
+  ~ParOptCheckpoint();
+
+  // Remove all the records
+  void clear();
+
+  // Add serial records, the values are only used on the root
+  void addInts(const char *name, int n, const int *values);
+  void addScalars(const char *name, int n, const ParOptScalar *values);
+
+  // Add a distributed vector record
+  void addVec(const char *name, ParOptVec *vec);
+
+  // Add the update pairs from a quasi-Newton approximation
+  void addQuasiNewton(const char *prefix, ParOptCompactQuasiNewton *qn);
+
+  // Write the records to a file
+  int write(const char *filename, int compress = 0);
+
+  // Start writing the records to a file with nonblocking writes
+  int startWrite(const char *filename, int compress = 0);
+  int finishWrite(int wait);
+  int isWritePending() { return write_pending; }
+
+  // Read the record index from a file
+  int read(const char *filename);
+
+  // Check whether a file is a checkpoint file
+  static int isCheckpointFile(MPI_Comm comm, const char *filename);
+
+  // Get the global length of a record (-1 if it does not exist)
+  int getRecordLength(const char *name);
+
+  // Read serial records, the values are set on all processors
+  int getInts(const char *name, int n, int *values);
+  int getScalars(const char *name, int n, ParOptScalar *values);
+
+  // Read a distributed vector record
+  int getVec(const char *name, ParOptVec *vec);
+
+  // Read the update pairs into a quasi-Newton approximation
+  int getQuasiNewton(const char *prefix, ParOptProblem *prob,
+                     ParOptCompactQuasiNewton *qn);
+
+ private:
+  // The data that describes a record
+  class Record {
+   public:
+    char name[32];      // The name of the record
+    int type;           // The type of element
+    int flags;          // Flags for distributed/compressed records
+    int64_t length;     // The global length of the record
+    int64_t offset;     // The offset of the block table in the file
+    int nblocks;        // The number of blocks
+    int64_t start;      // The global start of the local block
+    int64_t count;      // The number of local entries
+    int64_t nbytes;     // The number of local bytes in the buffer
+    size_t buf_offset;  // The offset of the local data in the buffer
+  };
+
+  // Add a record to the list and copy its local data to the buffer
+  void addRecord(const char *name, int type, int distributed, int64_t count,
+                 const void *data);
+
+  // Find a record by name
+  Record *findRecord(const char *name);
+
+  // Compute the file layout and assemble the header and tables
+  int setUpFile(const char *filename);
+
+  // Read the data for a record with the given global range
+  int readRecord(Record *rec, int64_t start, int64_t count, void *data,
+                 int collective);
+
+  // Close the file and rename the temporary file after writing
+  int closeWrite(int fail);
+
+  // The communicator for the file
+  MPI_Comm comm;
+
+  // The records
+  int nrecords, max_records;
+  Record *records;
+
+  // The buffer for the local data
+  size_t buffer_size, max_buffer_size;
+  char *buffer;
+
+  // The header, block tables and index written by the root
+  size_t meta_size;
+  char *meta;
+
+  // Data for the file
+  int compress;
+  MPI_File fp;
+  char *filename, *tmp_filename;
+
+  // Data for the nonblocking writes
+  int write_pending, write_fail;
+  int nrequests;
+  MPI_Request *requests;
+  MPI_Offset *write_offsets;
+  size_t *write_sizes;
+  char **write_data;
+};
+
+#endif  // PAR_OPT_CHECKPOINT_H
@@ -0,0 +1,264 @@
+#include "ParOptHistory.h"
+
+#include <math.h>
+#include <string.h>
+
+/*
+  The layout constants for the history file
+*/
+static const char PAROPT_HISTORY_MAGIC[8] = {'P', 'A', 'R', 'O',
+                                             'P', 'T', 'H', 'S'};
+static const int PAROPT_HISTORY_VERSION = 1;
+static const int PAROPT_HISTORY_BYTE_ORDER = 0x01020304;
+static const int PAROPT_HISTORY_HEADER_SIZE = 64;
+static const int PAROPT_HISTORY_COLUMN_SIZE = 40;
+static const int PAROPT_HISTORY_ENTRY_SIZE = 8;
+
+/*
+  Pack a fixed-width integer for the header
+*/
+static void ParOptHistoryPackInt(char *ptr, int value) {
+  int32_t v = value;
+  memcpy(ptr, &v, sizeof(int32_t));
+}
+
+/**
+  Create a history file with no columns
+
+  @param _comm the communicator for the optimizer
+  @param _solver the name of the solver written to the header
+*/
+ParOptHistory::ParOptHistory(MPI_Comm _comm, const char *_solver) {
+  comm = _comm;
+
+  memset(solver, '\0', sizeof(solver));
+  if (_solver) {
+    strncpy(solver, _solver, sizeof(solver) - 1);
+  }
+
+  ncolumns = 0;
+  max_columns = 0;
+  names = NULL;
+  types = NULL;
+  row = NULL;
+  last_column = -1;
+  fp = NULL;
+}
+
+/**
+  Close the file and free the data
+*/
+ParOptHistory::~ParOptHistory() {
+  close();
+  delete[] names;
+  delete[] types;
+  delete[] row;
+}
+
+/**
+  Add a column to the history.
+
+  Columns cannot be added once the file has been opened.
+
+  @param name the name of the column (at most 31 characters)
+  @param type the type of the column
+  @return the index of the column or -1 on failure
+*/
+int ParOptHistory::addColumn(const char *name, ParOptHistoryType type) {
+  if (row) {
+    fprintf(stderr, "ParOpt: Cannot add column %s to an open history file\n",
+            name);
+    return -1;
+  }
+  if (strlen(name) >= sizeof(names[0])) {
+    fprintf(stderr, "ParOpt: History column name %s is too long\n", name);
+    return -1;
+  }
+
+  if (ncolumns >= max_columns) {
+    max_columns = (max_columns < 16 ? 16 : 2 * max_columns);
+    char(*new_names)[32] = new char[max_columns][32];
+    int *new_types = new int[max_columns];
+    memcpy(new_names, names, ncolumns * sizeof(names[0]));
+    memcpy(new_types, types, ncolumns * sizeof(int));
+    delete[] names;
+    delete[] types;
+    names = new_names;
+    types = new_types;
+  }
+
+  memset(names[ncolumns], '\0', sizeof(names[0]));
+  strcpy(names[ncolumns], name);
+  types[ncolumns] = type;
+  ncolumns++;
+
+  return ncolumns - 1;
+}
+
+/**
+  Open the history file and write the header.
+
+  The schema is fixed once the file is opened. The file is only opened
+  on the root processor, but all processors may set the values and
+  call writeRow().
+
+  @param filename the name of the history file
+  @return zero on success, non-zero on failure
+*/
+int ParOptHistory::open(const char *filename) {
+  close();
+
+  if (!row) {
+    row = new char[ncolumns * PAROPT_HISTORY_ENTRY_SIZE];
+  }
+  resetRow();
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (rank != 0) {
+    return 0;
+  }
+
+  fp = fopen(filename, "wb");
+  if (!fp) {
+    fprintf(stderr, "ParOpt: Could not open history file %s\n", filename);
+    return 1;
+  }
+
+  int header_size =
+      PAROPT_HISTORY_HEADER_SIZE + ncolumns * PAROPT_HISTORY_COLUMN_SIZE;
+  char *header = new char[header_size];
+  memset(header, '\0', header_size);
+
+  memcpy(header, PAROPT_HISTORY_MAGIC, sizeof(PAROPT_HISTORY_MAGIC));
+  ParOptHistoryPackInt(&header[8], PAROPT_HISTORY_VERSION);
+  ParOptHistoryPackInt(&header[12], PAROPT_HISTORY_BYTE_ORDER);
+  ParOptHistoryPackInt(&header[16], header_size);
+  ParOptHistoryPackInt(&header[20], ncolumns * PAROPT_HISTORY_ENTRY_SIZE);
+  ParOptHistoryPackInt(&header[24], ncolumns);
+  memcpy(&header[32], solver, sizeof(solver));
+
+  for (int i = 0; i < ncolumns; i++) {
+    char *ptr = &header[PAROPT_HISTORY_HEADER_SIZE +
+                        i * PAROPT_HISTORY_COLUMN_SIZE];
+    memcpy(ptr, names[i], sizeof(names[0]));
+    ParOptHistoryPackInt(&ptr[32], types[i]);
+    ParOptHistoryPackInt(&ptr[36], i * PAROPT_HISTORY_ENTRY_SIZE);
+  }
+
+  int fail = 0;
+  if (fwrite(header, 1, header_size, fp) != (size_t)header_size) {
+    fprintf(stderr, "ParOpt: Failed to write history file %s\n", filename);
+    fclose(fp);
+    fp = NULL;
+    fail = 1;
+  } else {
+    fflush(fp);
+  }
+  delete[] header;
+
+  return fail;
+}
+
+/**
+  Close the history file
+*/
+void ParOptHistory::close() {
+  if (fp) {
+    fclose(fp);
+    fp = NULL;
+  }
+}
+
+/*
+  Find the index of the column. The columns are usually set in order,
+  so start the search after the last column that was set.
+*/
+int ParOptHistory::findColumn(const char *name) {
+  for (int k = 1; k <= ncolumns; k++) {
+    int i = (last_column + k) % ncolumns;
+    if (strcmp(names[i], name) == 0) {
+      last_column = i;
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*
+  Set the integer columns to zero and the floating point columns to NaN
+*/
+void ParOptHistory::resetRow() {
+  for (int i = 0; i < ncolumns; i++) {
+    char *ptr = &row[i * PAROPT_HISTORY_ENTRY_SIZE];
+    if (types[i] == PAROPT_HISTORY_INT) {
+      int64_t v = 0;
+      memcpy(ptr, &v, sizeof(v));
+    } else {
+      double v = NAN;
+      memcpy(ptr, &v, sizeof(v));
+    }
+  }
+  last_column = -1;
+}
+
+/**
+  Set an integer value in the current row
+
+  @param name the name of the column
+  @param value the value
+*/
+void ParOptHistory::setInt(const char *name, int value) {
+  if (fp) {
+    int i = findColumn(name);
+    if (i >= 0) {
+      char *ptr = &row[i * PAROPT_HISTORY_ENTRY_SIZE];
+      if (types[i] == PAROPT_HISTORY_INT) {
+        int64_t v = value;
+        memcpy(ptr, &v, sizeof(v));
+      } else {
+        double v = value;
+        memcpy(ptr, &v, sizeof(v));
+      }
+    }
+  }
+}
+
+/**
+  Set a floating point value in the current row
+
+  @param name the name of the column
+  @param value the value
+*/
+void ParOptHistory::setDouble(const char *name, double value) {
+  if (fp) {
+    int i = findColumn(name);
+    if (i >= 0) {
+      char *ptr = &row[i * PAROPT_HISTORY_ENTRY_SIZE];
+      if (types[i] == PAROPT_HISTORY_INT) {
+        int64_t v = (int64_t)value;
+        memcpy(ptr, &v, sizeof(v));
+      } else {
+        memcpy(ptr, &value, sizeof(value));
+      }
+    }
+  }
+}
+
+/**
+  Append the current row to the file and reset the values.
+
+  The file is flushed so that the row can be read immediately.
+*/
+void ParOptHistory::writeRow() {
+  if (fp) {
+    size_t row_size = ncolumns * PAROPT_HISTORY_ENTRY_SIZE;
+    if (fwrite(row, 1, row_size, fp) != row_size) {
+      fprintf(stderr, "ParOpt: Failed to write to the history file\n");
+      close();
+      return;
+    }
+    fflush(fp);
+    resetRow();
+  }
+}
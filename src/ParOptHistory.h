@@ -0,0 +1,90 @@
+#ifndef PAR_OPT_HISTORY_H
+#define PAR_OPT_HISTORY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ParOptVec.h"
+
+/*
+  The types of the columns in a history file
+*/
+enum ParOptHistoryType { PAROPT_HISTORY_INT = 1, PAROPT_HISTORY_DOUBLE = 2 };
+
+/*
+  A binary, columnar iteration history file.
+
+  The optimizers write one row to the history file per iteration, in
+  addition to the text output. The file begins with a header that
+  describes the schema, followed by the rows, which are appended to the
+  end of the file and flushed after every iteration. Each row has the
+  same size, so the history can be read while the optimization is in
+  progress and mapped directly into memory as an array of records.
+
+  The file layout is:
+
+  header:  "PAROPTHS", version, byte-order marker, the header size, the
+           row size, the number of columns, a reserved entry and the
+           name of the solver (32 characters)
+  columns: for each column, the name (32 characters), type and offset
+           of the column within a row
+  rows:    the rows, each row_size bytes
+
+  All the header entries are 32-bit integers. Integer columns are
+  stored as 64-bit integers and floating point columns as doubles, so
+  each column takes 8 bytes. A final, partially written row should be
+  ignored by the reader. Values that are not set in an iteration are
+  written as zero for integer columns and NaN for floating point
+  columns.
+
+  The file is only written by the root processor.
+*/
+class ParOptHistory : public ParOptBase {
+ public:
+  ParOptHistory(MPI_Comm _comm, const char *_solver);
+  ~ParOptHistory();
+
+  // Add a column to the schema, this must be done before open()
+  int addColumn(const char *name, ParOptHistoryType type);
+
+  // Open the file and write the header
+  int open(const char *filename);
+  void close();
+  int isOpen() { return fp != NULL; }
+
+  // Set the values for the current row
+  void setInt(const char *name, int value);
+  void setDouble(const char *name, double value);
+
+  // Append the current row to the file and reset the values
+  void writeRow();
+
+ private:
+  // Find the index of a column by name
+  int findColumn(const char *name);
+
+  // Reset the values in the row
+  void resetRow();
+
+  // The communicator
+  MPI_Comm comm;
+
+  // The name of the solver
+  char solver[32];
+
+  // The columns
+  int ncolumns, max_columns;
+  char (*names)[32];
+  int *types;
+
+  // The current row
+  char *row;
+
+  // The last column that was set
+  int last_column;
+
+  // The file pointer (only on the root)
+  FILE *fp;
+};
+
+#endif  // PAR_OPT_HISTORY_H
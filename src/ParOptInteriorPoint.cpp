@@ -25,6 +25,218 @@ ParOptScalar min2(const ParOptScalar a, const ParOptScalar b) {
   return b;
 }
 
+/*
+  Compute the on-processor contribution to the norm of a vector. This
+  is the maximum absolute value for the infinity norm, the sum of the
+  absolute values for the l1 norm and the sum of the squares for the
+  l2 norm. The contributions are combined across processors by the
+  caller.
+*/
+static double ParOptLocalNorm(ParOptNormType norm_type, ParOptVec *vec) {
+  ParOptScalar *x;
+  int size = vec->getArray(&x);
+
+  double res = 0.0;
+  if (norm_type == PAROPT_INFTY_NORM) {
+    for (int i = 0; i < size; i++) {
+      if (fabs(ParOptRealPart(x[i])) > res) {
+        res = fabs(ParOptRealPart(x[i]));
+      }
+    }
+  } else if (norm_type == PAROPT_L1_NORM) {
+    for (int i = 0; i < size; i++) {
+      res += fabs(ParOptRealPart(x[i]));
+    }
+  } else {  // norm_type == PAROPT_L2_NORM
+    for (int i = 0; i < size; i++) {
+      res += ParOptRealPart(x[i]) * ParOptRealPart(x[i]);
+    }
+  }
+
+  return res;
+}
+
+/*
+  Replace the vector stored in the pointer, updating the reference counts
+*/
+static void ParOptReplaceVec(ParOptVec **vec, ParOptVec *new_vec) {
+  new_vec->incref();
+  if (*vec) {
+    (*vec)->decref();
+  }
+  *vec = new_vec;
+}
+
+/*
+  Create a compressed bound multiplier vector for the bounded variables
+  new_index[0:nnew] from the multipliers zold for the bounded variables
+  old_index[0:nold]. Both index sets are in ascending order. Entries for
+  variables that were not previously bounded are set to zero.
+*/
+static ParOptVec *ParOptRemapBoundVec(MPI_Comm comm, ParOptVec *zold,
+                                      int nold, const int *old_index,
+                                      int nnew, const int *new_index) {
+  ParOptVec *znew = new ParOptBasicVec(comm, nnew);
+
+  if (zold) {
+    ParOptScalar *zoldvals, *znewvals;
+    zold->getArray(&zoldvals);
+    znew->getArray(&znewvals);
+
+    for (int j = 0, k = 0; k < nnew; k++) {
+      while (j < nold && old_index[j] < new_index[k]) {
+        j++;
+      }
+      if (j < nold && old_index[j] == new_index[k]) {
+        znewvals[k] = zoldvals[j];
+      }
+    }
+  }
+
+  return znew;
+}
+
+/*
+  Get the offset of the block column kb within the local storage of a
+  lower triangular n x n matrix with a 1D block-cyclic column
+  distribution. Block column kb, consisting of the columns
+  kb*nb <= j < min((kb+1)*nb, n), is stored on processor kb % size. Each
+  processor stores its block columns in increasing order, each one in
+  column-major order from the diagonal entry down to row n-1.
+*/
+static int ParOptBlockCyclicOffset(int n, int nb, int rank, int size,
+                                   int kb) {
+  int offset = 0;
+  for (int k = rank; k < kb; k += size) {
+    int c0 = k * nb;
+    int w = (n - c0 < nb ? n - c0 : nb);
+    offset += (n - c0) * w;
+  }
+  return offset;
+}
+
+/*
+  Compute the Cholesky factorization A = L*L^{T} of a symmetric
+  positive definite matrix stored in the 1D block-cyclic format.
+
+  This is a right-looking algorithm: the owner of each block column
+  factors the diagonal block, computes the sub-diagonal panel and
+  broadcasts the panel. Every processor then updates the block columns
+  that it owns to the right of the panel.
+
+  The function returns a non-zero value on all processors if the matrix
+  is not positive definite.
+*/
+static int ParOptBlockCyclicCholesky(MPI_Comm comm, int n, int nb,
+                                     ParOptScalar *A) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  ParOptScalar *panel = new ParOptScalar[n * nb];
+
+  int info = 0;
+  int nblocks = (n + nb - 1) / nb;
+  for (int kb = 0; kb < nblocks; kb++) {
+    int owner = kb % size;
+    int c0 = kb * nb;
+    int w = (n - c0 < nb ? n - c0 : nb);
+    int m = n - c0;
+
+    // Factor the diagonal block and compute L21 = A21*L11^{-T}
+    ParOptScalar *L = panel;
+    if (rank == owner) {
+      L = &A[ParOptBlockCyclicOffset(n, nb, rank, size, kb)];
+      LAPACKdpotrf("L", &w, L, &m, &info);
+      if (info == 0 && m > w) {
+        int mr = m - w;
+        ParOptScalar one = 1.0;
+        BLAStrsm("R", "L", "T", "N", &mr, &w, &one, L, &m, &L[w], &m);
+      }
+    }
+
+    MPI_Bcast(&info, 1, MPI_INT, owner, comm);
+    if (info != 0) {
+      break;
+    }
+    MPI_Bcast(L, m * w, PAROPT_MPI_TYPE, owner, comm);
+
+    // Update the trailing block columns owned by this processor
+    int jb = kb + 1 + (rank - (kb + 1) % size + size) % size;
+    for (; jb < nblocks; jb += size) {
+      int cj = jb * nb;
+      int wj = (n - cj < nb ? n - cj : nb);
+      int mj = n - cj;
+      ParOptScalar *Aj = &A[ParOptBlockCyclicOffset(n, nb, rank, size, jb)];
+      ParOptScalar *Lj = &L[cj - c0];
+
+      ParOptScalar alpha = -1.0, beta = 1.0;
+      BLASgemm("N", "T", &mj, &wj, &w, &alpha, Lj, &m, Lj, &m, &beta, Aj,
+               &mj);
+    }
+  }
+
+  delete[] panel;
+
+  return info;
+}
+
+/*
+  Solve L*L^{T}*x = b in place using the factor computed by
+  ParOptBlockCyclicCholesky. The right-hand-side must be the same on
+  all processors on entry and the solution is the same on all
+  processors on exit.
+*/
+static void ParOptBlockCyclicSolve(MPI_Comm comm, int n, int nb,
+                                   ParOptScalar *A, ParOptScalar *x) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  int one = 1;
+  ParOptScalar alpha = -1.0, beta = 1.0;
+  int nblocks = (n + nb - 1) / nb;
+
+  // Solve L*y = b. The owner of each block column updates the
+  // remainder of the right-hand-side and broadcasts it.
+  for (int kb = 0; kb < nblocks; kb++) {
+    int owner = kb % size;
+    int c0 = kb * nb;
+    int w = (n - c0 < nb ? n - c0 : nb);
+    int m = n - c0;
+
+    if (rank == owner) {
+      ParOptScalar *L = &A[ParOptBlockCyclicOffset(n, nb, rank, size, kb)];
+      BLAStrsv("L", "N", "N", &w, L, &m, &x[c0], &one);
+      if (m > w) {
+        int mr = m - w;
+        BLASgemv("N", &mr, &w, &alpha, &L[w], &m, &x[c0], &one, &beta,
+                 &x[c0 + w], &one);
+      }
+    }
+    MPI_Bcast(&x[c0], m, PAROPT_MPI_TYPE, owner, comm);
+  }
+
+  // Solve L^{T}*x = y
+  for (int kb = nblocks - 1; kb >= 0; kb--) {
+    int owner = kb % size;
+    int c0 = kb * nb;
+    int w = (n - c0 < nb ? n - c0 : nb);
+    int m = n - c0;
+
+    if (rank == owner) {
+      ParOptScalar *L = &A[ParOptBlockCyclicOffset(n, nb, rank, size, kb)];
+      if (m > w) {
+        int mr = m - w;
+        BLASgemv("T", &mr, &w, &alpha, &L[w], &m, &x[c0 + w], &one, &beta,
+                 &x[c0], &one);
+      }
+      BLAStrsv("L", "T", "N", &w, L, &m, &x[c0], &one);
+    }
+    MPI_Bcast(&x[c0], w, PAROPT_MPI_TYPE, owner, comm);
+  }
+}
+
 ParOptInteriorPoint::ParOptVars::ParOptVars() {
   x = NULL;
   zl = NULL;
@@ -89,11 +301,8 @@ void ParOptInteriorPoint::ParOptVars::initialize(ParOptProblem *prob) {
   x = prob->createDesignVec();
   x->incref();
 
-  // Allocate storage space for the variables etc.
-  zl = prob->createDesignVec();
-  zl->incref();
-  zu = prob->createDesignVec();
-  zu->incref();
+  // Note that the bound multipliers zl/zu are allocated once the
+  // bounds are known in initBoundIndices()
 
   // Allocate space for the sparse constraints
   zw = prob->createConstraintVec();
@@ -251,9 +460,17 @@ ParOptInteriorPoint::ParOptInteriorPoint(ParOptProblem *_prob,
   xtemp = prob->createDesignVec();
   xtemp->incref();
 
-  // Allocate space for the Dmatrix
-  Gmat = new ParOptScalar[ncon * ncon];
-  gpiv = new int[ncon];
+  // Allocate space for the Schur complement of the dense constraints.
+  // The matrix itself is allocated when it is first factored.
+  gmat_dist = 0;
+  gmat_chol = 0;
+  gmat_block_size = 0;
+  gmat_dist_size = 0;
+  gdiag = new ParOptScalar[ncon];
+  gwork = new ParOptScalar[ncon];
+  Gmat = NULL;
+  gpiv = NULL;
+  Gdist = NULL;
 
   // Allocate the quasi-Newton approximation
   const char *qn_type = options->getEnumOption("qn_type");
@@ -320,6 +537,17 @@ ParOptInteriorPoint::ParOptInteriorPoint(ParOptProblem *_prob,
   Cdiag = prob->createConstraintVec();
   Cdiag->incref();
 
+  // The indices of the bounded variables are set in initBoundIndices()
+  compact_bounds = options->getBoolOption("compact_bound_multipliers");
+  num_lower_bounds = 0;
+  num_upper_bounds = 0;
+  lower_bound_index = NULL;
+  upper_bound_index = NULL;
+
+  // The design-length bound multipliers are allocated on demand
+  zl_full = NULL;
+  zu_full = NULL;
+
   mat = prob->createQuasiDefMat();
   mat->incref();
 
@@ -334,11 +562,27 @@ ParOptInteriorPoint::ParOptInteriorPoint(ParOptProblem *_prob,
   g = prob->createDesignVec();
   g->incref();
 
-  Ac = new ParOptVec *[ncon];
-  for (int i = 0; i < ncon; i++) {
-    Ac[i] = prob->createDesignVec();
-    Ac[i]->incref();
-  }
+  Ac = NULL;
+  ac_nnz = -1;
+  ac_rowp = ac_cols = NULL;
+  ac_vals = NULL;
+  ac_vec = NULL;
+  ac_prod = new ParOptScalar[ncon];
+  ac_matfree = 0;
+  ac_block_size = 0;
+  ac_x = NULL;
+  ac_qn_init = 0;
+  ac_batch = NULL;
+  ac_zwork = NULL;
+  initConGradients();
+
+  // The linearity of the problem is set at the start of optimize()
+  con_linear = new int[ncon];
+  memset(con_linear, 0, ncon * sizeof(int));
+  num_linear_cons = 0;
+  linear_grad_init = 0;
+  constant_hessian = 0;
+  ac_eval = new ParOptVec *[ncon];
 
   // Set the default penalty values
   const double gamma = options->getFloatOption("penalty_gamma");
@@ -375,6 +619,7 @@ ParOptInteriorPoint::ParOptInteriorPoint(ParOptProblem *_prob,
 
   // Set parameters that will be over-written later
   barrier_param = options->getFloatOption("init_barrier_param");
+  barrier_strategy = PAROPT_MONOTONE;
   rho_penalty_search = options->getFloatOption("init_rho_penalty_search");
 
   // Zero the number of evals
@@ -391,6 +636,20 @@ ParOptInteriorPoint::ParOptInteriorPoint(ParOptProblem *_prob,
   gmres_awproj = NULL;
   gmres_Q = NULL;
   gmres_W = NULL;
+  gmres_recycle_size = 0;
+  gmres_num_recycled = 0;
+  gmres_Hraw = NULL;
+  gmres_B = NULL;
+  gmres_uc = NULL;
+  gmres_U = NULL;
+  gmres_C = NULL;
+  gmres_Z = NULL;
+
+  // Initialize the GMRES preconditioner data
+  gmres_precon_type = PAROPT_GMRES_PRECON_QUASI_NEWTON;
+  hprecon = NULL;
+  gmres_hdiag = NULL;
+  gmres_precon_age = 0;
 
   // Check if we're going to use an optimization problem with an inexact
   // optimization method.
@@ -399,6 +658,33 @@ ParOptInteriorPoint::ParOptInteriorPoint(ParOptProblem *_prob,
     setGMRESSubspaceSize(m);
   }
 
+  // The dense KKT data is allocated when the optimization begins
+  dense_kkt = 0;
+  dense_kkt_qn = -1;
+  dense_kkt_size = 0;
+  dense_kkt_max_size = 0;
+  dense_K = NULL;
+  dense_rhs = NULL;
+  dense_work = NULL;
+  dense_lwork = 0;
+  dense_piv = NULL;
+
+  // The checkpoint records are allocated when they are first written
+  checkpoint_file = NULL;
+  checkpoint_restart = 0;
+  warm_start = 0;
+
+  // Set the default information about the parallel line search
+  ls_factory = NULL;
+  ls_num_groups = 0;
+  ls_num_groups = 0;
+  ls_groups = NULL;
+  ls_alpha = NULL;
+  ls_fobj = NULL;
+  ls_con = NULL;
+  ls_fail = NULL;
+  ls_accept = -1;
+
   // By default, set the file pointer to stdout. If a filename is specified,
   // set the new filename.
   outfp = NULL;
@@ -411,6 +697,13 @@ ParOptInteriorPoint::ParOptInteriorPoint(ParOptProblem *_prob,
     setOutputFile(filename);
   }
 
+  // Set the binary history file, if any
+  history = NULL;
+  const char *history_file = options->getStringOption("history_file");
+  if (history_file) {
+    setHistoryFile(history_file);
+  }
+
   // Initialize the design variables and bounds
   initAndCheckDesignAndBounds();
 
@@ -441,6 +734,12 @@ ParOptInteriorPoint::ParOptInteriorPoint(ParOptProblem *_prob,
    Free the data allocated during the creation of the object
 */
 ParOptInteriorPoint::~ParOptInteriorPoint() {
+  // Complete any checkpoint still in progress
+  if (checkpoint_file) {
+    finishCheckpoint(1);
+    checkpoint_file->decref();
+  }
+
   prob->decref();
   options->decref();
   if (qn) {
@@ -463,8 +762,17 @@ ParOptInteriorPoint::~ParOptInteriorPoint() {
   }
 
   // Delete the Schur complement for the dense constraints
-  delete[] Gmat;
-  delete[] gpiv;
+  delete[] gdiag;
+  delete[] gwork;
+  if (Gmat) {
+    delete[] Gmat;
+  }
+  if (gpiv) {
+    delete[] gpiv;
+  }
+  if (Gdist) {
+    delete[] Gdist;
+  }
 
   // Delete the Schur complement for the quasi-Newton matrix
   if (Ce) {
@@ -487,6 +795,20 @@ ParOptInteriorPoint::~ParOptInteriorPoint() {
   Dinv->decref();
   Cdiag->decref();
 
+  // Delete the indices of the bounded variables
+  if (lower_bound_index) {
+    delete[] lower_bound_index;
+  }
+  if (upper_bound_index) {
+    delete[] upper_bound_index;
+  }
+  if (zl_full) {
+    zl_full->decref();
+  }
+  if (zu_full) {
+    zu_full->decref();
+  }
+
   // Free the variable ranges
   delete[] var_range;
   delete[] wcon_range;
@@ -496,13 +818,41 @@ ParOptInteriorPoint::~ParOptInteriorPoint() {
     hdiag->decref();
   }
 
+  // Free the GMRES preconditioner data
+  if (hprecon) {
+    hprecon->decref();
+  }
+  if (gmres_hdiag) {
+    gmres_hdiag->decref();
+  }
+
   // Delete the constraint/gradient information
   delete[] c;
   g->decref();
-  for (int i = 0; i < ncon; i++) {
-    Ac[i]->decref();
+  if (Ac) {
+    for (int i = 0; i < ncon; i++) {
+      Ac[i]->decref();
+    }
+    delete[] Ac;
+  }
+  if (ac_rowp) {
+    delete[] ac_rowp;
+    delete[] ac_cols;
+    delete[] ac_vals;
+  }
+  if (ac_vec) {
+    ac_vec->decref();
+  }
+  delete[] ac_prod;
+  delete[] con_linear;
+  delete[] ac_eval;
+  if (ac_batch) {
+    for (int i = 0; i < ac_block_size; i++) {
+      ac_batch[i]->decref();
+    }
+    delete[] ac_batch;
+    delete[] ac_zwork;
   }
-  delete[] Ac;
 
   // Delete the GMRES information if any
   if (gmres_subspace_size > 0) {
@@ -520,12 +870,49 @@ ParOptInteriorPoint::~ParOptInteriorPoint() {
       gmres_W[i]->decref();
     }
     delete[] gmres_W;
+
+    // Delete the recycled subspace
+    if (gmres_recycle_size > 0) {
+      delete[] gmres_Hraw;
+      delete[] gmres_B;
+      delete[] gmres_uc;
+      for (int i = 0; i < gmres_recycle_size; i++) {
+        gmres_U[i]->decref();
+        gmres_C[i]->decref();
+      }
+      delete[] gmres_U;
+      delete[] gmres_C;
+      gmres_Z->decref();
+    }
+  }
+
+  // Delete the dense KKT data if any
+  if (dense_K) {
+    delete[] dense_K;
+  }
+  if (dense_rhs) {
+    delete[] dense_rhs;
+  }
+  if (dense_work) {
+    delete[] dense_work;
+  }
+  if (dense_piv) {
+    delete[] dense_piv;
+  }
+
+  // Free the parallel line search data
+  freeLineSearchGroups();
+  if (ls_factory) {
+    ls_factory->decref();
   }
 
   // Close the output file if it's not stdout
   if (outfp && outfp != stdout) {
     fclose(outfp);
   }
+  if (history) {
+    history->decref();
+  }
 }
 
 /**
@@ -537,6 +924,9 @@ void ParOptInteriorPoint::addDefaultOptions(ParOptOptions *options) {
   // Set the string options
   options->addStringOption("output_file", "paropt.out", "Output file name");
 
+  options->addStringOption("history_file", NULL,
+                           "Binary iteration history file name");
+
   options->addStringOption("problem_name", NULL, "The problem name");
 
   // Set the float options
@@ -621,6 +1011,15 @@ void ParOptInteriorPoint::addDefaultOptions(ParOptOptions *options) {
       "start_affine_multiplier_min", 1.0, 0.0, 1e20,
       "Minimum multiplier for the affine step initialization strategy");
 
+  options->addFloatOption(
+      "warm_start_bound_frac", 0.01, 0.0, 0.5,
+      "Fraction of the bound range used to move a warm-start point into the "
+      "interior of the bounds");
+
+  options->addFloatOption(
+      "warm_start_multiplier_min", 1e-6, 0.0, 1e20,
+      "Minimum multiplier and slack value for a warm-started optimization");
+
   // Set the boolean options
   options->addBoolOption("use_line_search", 1,
                          "Perform or skip the line search");
@@ -646,6 +1045,20 @@ void ParOptInteriorPoint::addDefaultOptions(ParOptOptions *options) {
       "use_qn_gmres_precon", 1,
       "Use or do not use the quasi-Newton method as a preconditioner");
 
+  options->addBoolOption(
+      "use_async_checkpoint", 0,
+      "Write the checkpoint file with nonblocking MPI-IO while the "
+      "optimization continues, replacing the previous file on completion");
+
+  options->addBoolOption(
+      "compress_checkpoint", 0,
+      "Compress the data in the checkpoint file (requires zlib)");
+
+  options->addBoolOption(
+      "compact_bound_multipliers", 0,
+      "Store the bound multipliers only for the variables with finite "
+      "bounds, instead of as design vectors created by the problem");
+
   options->addFloatOption("gradient_check_step_length", 1e-6, 0.0, 1.0,
                           "Step length used to check the gradient");
 
@@ -661,6 +1074,11 @@ void ParOptInteriorPoint::addDefaultOptions(ParOptOptions *options) {
   options->addIntOption("max_line_iters", 10, 1, 100,
                         "Maximum number of line search iterations");
 
+  options->addIntOption(
+      "num_line_search_groups", 1, 1, 1000,
+      "Number of processor groups used to evaluate trial step lengths "
+      "concurrently during the line search (requires a problem factory)");
+
   options->addIntOption("iterative_refinement_steps", 1, 0, 10,
                         "Number of iterative refinement steps performed in the "
                         "KKT system solution procedure");
@@ -668,6 +1086,39 @@ void ParOptInteriorPoint::addDefaultOptions(ParOptOptions *options) {
   options->addIntOption("gmres_subspace_size", 0, 0, 1000,
                         "The subspace size for GMRES");
 
+  options->addIntOption(
+      "gmres_recycle_size", 0, 0, 1000,
+      "Number of harmonic Ritz vectors recycled from one GMRES solve to "
+      "the next to deflate the slowly converging eigenspace");
+
+  options->addIntOption(
+      "gmres_precon_refresh", 1, 1, 1000000,
+      "Number of inexact Newton steps between updates of the exact Hessian "
+      "diagonal or the user-supplied Hessian approximation used to "
+      "precondition GMRES");
+
+  options->addIntOption(
+      "dense_kkt_max_size", 500, 0, 10000,
+      "Use a dense factorization of the KKT system when the number of "
+      "design variables plus dense constraints is at most this size. "
+      "The matrix is stored on the root processor. Zero disables the "
+      "dense factorization");
+
+  options->addIntOption("jacobian_product_block_size", 16, 1, 1000,
+                        "Number of vectors in each batched product with "
+                        "the dense constraint Jacobian when the problem "
+                        "provides Jacobian-vector products");
+
+  options->addIntOption(
+      "gmat_distributed_size", 1000, 0, 1000000,
+      "Factor the Schur complement for the dense constraints across all "
+      "processors when the number of dense constraints is at least this "
+      "size (0 to disable)");
+
+  options->addIntOption("gmat_block_size", 64, 1, 4096,
+                        "Block size for the distributed factorization of "
+                        "the Schur complement for the dense constraints");
+
   options->addIntOption("write_output_frequency", 10, 0, 1000000,
                         "Write out the solution file and checkpoint file "
                         "at this frequency");
@@ -724,6 +1175,15 @@ void ParOptInteriorPoint::addDefaultOptions(ParOptOptions *options) {
   options->addEnumOption(
       "starting_point_strategy", "affine_step", 3, start_options,
       "Initialize the Lagrange multiplier estimates and slack variables");
+
+  const char *gmres_precon_options[3] = {"quasi_newton", "diag_hessian",
+                                         "user"};
+  options->addEnumOption(
+      "gmres_precon_type", "quasi_newton", 3, gmres_precon_options,
+      "The Hessian approximation used to precondition GMRES: the "
+      "quasi-Newton approximation, the exact Hessian diagonal (as a "
+      "correction to the quasi-Newton approximation if use_qn_gmres_precon "
+      "is set) or the user-supplied preconditioner");
 }
 
 /**
@@ -760,6 +1220,9 @@ void ParOptInteriorPoint::resetProblemInstance(ParOptProblem *problem) {
     problem->incref();
     prob->decref();
     prob = problem;
+
+    // The new problem may use a different format for the gradients
+    initConGradients();
   }
 }
 
@@ -784,6 +1247,11 @@ void ParOptInteriorPoint::getProblemSizes(int *_nvars, int *_ncon,
    NULL are not assigned. If no output is available, for instance if
    use_lower == False, then NULL is assigned to the output.
 
+   The bound multipliers are stored internally only for the variables
+   that have the bound. The vectors zl/zu returned here are copies
+   expanded to the length of the design vector that are updated on
+   each call, with zero entries for the variables without the bound.
+
    @param _x the design variable values
    @param _z the dense constraint multipliers
    @param _zw the sparse constraint multipliers
@@ -804,16 +1272,19 @@ void ParOptInteriorPoint::getOptimizedPoint(ParOptVec **_x, ParOptScalar **_z,
     *_zw = NULL;
     *_zw = variables.zw;
   }
+  if ((_zl && use_lower) || (_zu && use_upper)) {
+    expandBoundMultipliers();
+  }
   if (_zl) {
     *_zl = NULL;
     if (use_lower) {
-      *_zl = variables.zl;
+      *_zl = zl_full;
     }
   }
   if (_zu) {
     *_zu = NULL;
     if (use_upper) {
-      *_zu = variables.zu;
+      *_zu = zu_full;
     }
   }
 }
@@ -874,113 +1345,254 @@ void ParOptInteriorPoint::printOptionSummary(FILE *fp) {
   }
 }
 
-/**
-   Write out the design variables, Lagrange multipliers and
-   slack variables to a binary file in parallel.
+/*
+  Add the optimizer state to the checkpoint records.
 
-   @param filename is the name of the file to write
+  The records contain the design variables, the multipliers and slack
+  variables, the barrier and penalty parameters, the barrier strategy
+  and the update pairs of the quasi-Newton approximation. The bound
+  multipliers are stored in the design-length layout so that the file
+  does not depend on the bounds.
 */
-int ParOptInteriorPoint::writeSolutionFile(const char *filename) {
-  char *fname = new char[strlen(filename) + 1];
-  strcpy(fname, filename);
+void ParOptInteriorPoint::addCheckpointRecords(ParOptCheckpoint *ck) {
+  int size;
+  MPI_Comm_size(comm, &size);
 
-  int fail = 1;
-  MPI_File fp = NULL;
-  MPI_File_open(comm, fname, MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL,
-                &fp);
+  // The problem sizes
+  int var_sizes[3];
+  var_sizes[0] = var_range[size];
+  var_sizes[1] = wcon_range[size];
+  var_sizes[2] = ncon;
+  ck->addInts("sizes", 3, var_sizes);
+
+  // The barrier strategy and parameters
+  int strategy = barrier_strategy;
+  ParOptScalar barrier = barrier_param;
+  ParOptScalar rho = rho_penalty_search;
+  ck->addInts("barrier_strategy", 1, &strategy);
+  ck->addScalars("barrier_param", 1, &barrier);
+  ck->addScalars("rho_penalty_search", 1, &rho);
+
+  // The penalty parameters for the dense constraints
+  ParOptScalar *gamma = new ParOptScalar[2 * ncon];
+  for (int i = 0; i < ncon; i++) {
+    gamma[i] = penalty_gamma_s[i];
+    gamma[ncon + i] = penalty_gamma_t[i];
+  }
+  ck->addScalars("penalty_gamma", 2 * ncon, gamma);
+  delete[] gamma;
+
+  // The multipliers and slack variables for the dense constraints
+  ck->addScalars("s", ncon, variables.s);
+  ck->addScalars("t", ncon, variables.t);
+  ck->addScalars("z", ncon, variables.z);
+  ck->addScalars("zs", ncon, variables.zs);
+  ck->addScalars("zt", ncon, variables.zt);
+
+  // The design variables and bound multipliers
+  expandBoundMultipliers();
+  ck->addVec("x", variables.x);
+  ck->addVec("zl", zl_full);
+  ck->addVec("zu", zu_full);
+
+  // The sparse constraint variables and penalty parameters
+  if (wcon_range[size] > 0) {
+    ck->addVec("zw", variables.zw);
+    ck->addVec("sw", variables.sw);
+    ck->addVec("tw", variables.tw);
+    ck->addVec("zsw", variables.zsw);
+    ck->addVec("ztw", variables.ztw);
+    ck->addVec("penalty_gamma_sw", penalty_gamma_sw);
+    ck->addVec("penalty_gamma_tw", penalty_gamma_tw);
+  }
+
+  // The quasi-Newton update pairs
+  ck->addQuasiNewton("qn", qn);
+}
 
-  if (fp) {
-    // Calculate the total number of variable across all processors
-    int size, rank;
-    MPI_Comm_rank(comm, &rank);
-    MPI_Comm_size(comm, &size);
+/*
+  Set the optimizer state from the checkpoint records.
 
-    // Successfull opened the file
-    fail = 0;
+  On success, the next call to optimize() continues from this state:
+  the barrier parameter, barrier strategy and penalty parameter are
+  not reset and the starting point strategy is skipped.
+*/
+int ParOptInteriorPoint::readCheckpointRecords(ParOptCheckpoint *ck) {
+  int size, rank;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
 
-    // Write the problem sizes on the root processor
+  int var_sizes[3];
+  int fail = ck->getInts("sizes", 3, var_sizes);
+  if (!fail &&
+      (var_sizes[0] != var_range[size] || var_sizes[1] != wcon_range[size] ||
+       var_sizes[2] != ncon)) {
     if (rank == opt_root) {
-      int var_sizes[3];
-      var_sizes[0] = var_range[size];
-      var_sizes[1] = wcon_range[size];
-      var_sizes[2] = ncon;
+      fprintf(stderr,
+              "ParOpt: Problem size incompatible with solution file\n");
+    }
+    return 1;
+  }
 
-      MPI_File_write(fp, var_sizes, 3, MPI_INT, MPI_STATUS_IGNORE);
-      MPI_File_write(fp, &barrier_param, 1, PAROPT_MPI_TYPE, MPI_STATUS_IGNORE);
-      MPI_File_write(fp, variables.s, ncon, PAROPT_MPI_TYPE, MPI_STATUS_IGNORE);
-      MPI_File_write(fp, variables.t, ncon, PAROPT_MPI_TYPE, MPI_STATUS_IGNORE);
-      MPI_File_write(fp, variables.z, ncon, PAROPT_MPI_TYPE, MPI_STATUS_IGNORE);
-      MPI_File_write(fp, variables.zs, ncon, PAROPT_MPI_TYPE,
-                     MPI_STATUS_IGNORE);
-      MPI_File_write(fp, variables.zt, ncon, PAROPT_MPI_TYPE,
-                     MPI_STATUS_IGNORE);
+  int strategy = 0;
+  ParOptScalar barrier = 0.0, rho = 0.0;
+  ParOptScalar *gamma = new ParOptScalar[2 * ncon];
+  fail = (fail || ck->getInts("barrier_strategy", 1, &strategy) ||
+          ck->getScalars("barrier_param", 1, &barrier) ||
+          ck->getScalars("rho_penalty_search", 1, &rho) ||
+          ck->getScalars("penalty_gamma", 2 * ncon, gamma) ||
+          ck->getScalars("s", ncon, variables.s) ||
+          ck->getScalars("t", ncon, variables.t) ||
+          ck->getScalars("z", ncon, variables.z) ||
+          ck->getScalars("zs", ncon, variables.zs) ||
+          ck->getScalars("zt", ncon, variables.zt));
+
+  // Read the distributed vectors. The bound multipliers are stored in
+  // the design-length layout.
+  if (!fail) {
+    expandBoundMultipliers();
+    fail = (ck->getVec("x", variables.x) || ck->getVec("zl", zl_full) ||
+            ck->getVec("zu", zu_full));
+    compressBoundMultipliers();
+  }
+  if (!fail && wcon_range[size] > 0) {
+    fail = (ck->getVec("zw", variables.zw) || ck->getVec("sw", variables.sw) ||
+            ck->getVec("tw", variables.tw) ||
+            ck->getVec("zsw", variables.zsw) ||
+            ck->getVec("ztw", variables.ztw) ||
+            ck->getVec("penalty_gamma_sw", penalty_gamma_sw) ||
+            ck->getVec("penalty_gamma_tw", penalty_gamma_tw));
+  }
+  if (!fail) {
+    fail = ck->getQuasiNewton("qn", prob, qn);
+  }
+
+  if (!fail) {
+    barrier_param = ParOptRealPart(barrier);
+    rho_penalty_search = ParOptRealPart(rho);
+    barrier_strategy = (ParOptBarrierStrategy)strategy;
+    for (int i = 0; i < ncon; i++) {
+      penalty_gamma_s[i] = ParOptRealPart(gamma[i]);
+      penalty_gamma_t[i] = ParOptRealPart(gamma[ncon + i]);
     }
+    checkpoint_restart = 1;
+  } else if (rank == opt_root) {
+    fprintf(stderr, "ParOpt: Failed to read the checkpoint records\n");
+  }
+  delete[] gamma;
 
-    size_t offset = 3 * sizeof(int) + (5 * ncon + 1) * sizeof(ParOptScalar);
+  return fail;
+}
 
-    // Use the native representation for the data
-    char datarep[] = "native";
+/**
+   Write out the optimizer state to a binary checkpoint file in
+   parallel.
 
-    // Extract the design variables
-    ParOptScalar *xvals;
-    int xsize = variables.x->getArray(&xvals);
-    MPI_File_set_view(fp, offset, PAROPT_MPI_TYPE, PAROPT_MPI_TYPE, datarep,
-                      MPI_INFO_NULL);
-    MPI_File_write_at_all(fp, var_range[rank], xvals, xsize, PAROPT_MPI_TYPE,
-                          MPI_STATUS_IGNORE);
-    offset += var_range[size] * sizeof(ParOptScalar);
+   The file stores the design variables, multipliers and slack
+   variables together with the barrier and penalty parameters and the
+   quasi-Newton update pairs, so that the optimization can be restarted
+   with readSolutionFile(). The file can be read on a different number
+   of processors. The data is compressed if the option
+   compress_checkpoint is set.
 
-    // Extract the lower Lagrange multipliers
-    ParOptScalar *zlvals, *zuvals;
-    variables.zl->getArray(&zlvals);
-    variables.zu->getArray(&zuvals);
-    MPI_File_set_view(fp, offset, PAROPT_MPI_TYPE, PAROPT_MPI_TYPE, datarep,
-                      MPI_INFO_NULL);
-    MPI_File_write_at_all(fp, var_range[rank], zlvals, xsize, PAROPT_MPI_TYPE,
-                          MPI_STATUS_IGNORE);
-    offset += var_range[size] * sizeof(ParOptScalar);
+   @param filename is the name of the file to write
+*/
+int ParOptInteriorPoint::writeSolutionFile(const char *filename) {
+  // Complete any checkpoint in progress before the records are reused.
+  // A failure only affects the earlier checkpoint, so it is reported
+  // and the requested file is still written.
+  if (finishCheckpoint(1)) {
+    fprintf(stderr, "ParOpt: Checkpoint file creation failed\n");
+  }
+  if (!checkpoint_file) {
+    checkpoint_file = new ParOptCheckpoint(comm);
+    checkpoint_file->incref();
+  }
 
-    // Write out the upper Lagrange multipliers
-    MPI_File_set_view(fp, offset, PAROPT_MPI_TYPE, PAROPT_MPI_TYPE, datarep,
-                      MPI_INFO_NULL);
-    MPI_File_write_at_all(fp, var_range[rank], zuvals, xsize, PAROPT_MPI_TYPE,
-                          MPI_STATUS_IGNORE);
-    offset += var_range[size] * sizeof(ParOptScalar);
+  checkpoint_file->clear();
+  addCheckpointRecords(checkpoint_file);
 
-    // Write out the extra constraint bounds
-    if (wcon_range[size] > 0) {
-      ParOptScalar *zwvals, *swvals;
-      int nwsize = variables.zw->getArray(&zwvals);
-      variables.sw->getArray(&swvals);
-      MPI_File_set_view(fp, offset, PAROPT_MPI_TYPE, PAROPT_MPI_TYPE, datarep,
-                        MPI_INFO_NULL);
-      MPI_File_write_at_all(fp, wcon_range[rank], zwvals, nwsize,
-                            PAROPT_MPI_TYPE, MPI_STATUS_IGNORE);
-      offset += wcon_range[size] * sizeof(ParOptScalar);
+  const int compress = options->getBoolOption("compress_checkpoint");
+  return checkpoint_file->write(filename, compress);
+}
 
-      MPI_File_set_view(fp, offset, PAROPT_MPI_TYPE, PAROPT_MPI_TYPE, datarep,
-                        MPI_INFO_NULL);
-      MPI_File_write_at_all(fp, wcon_range[rank], swvals, nwsize,
-                            PAROPT_MPI_TYPE, MPI_STATUS_IGNORE);
-    }
-    MPI_File_close(&fp);
+/*
+  Start writing the checkpoint file asynchronously.
+
+  The optimizer state is copied to the checkpoint records and written
+  with nonblocking MPI-IO, so the optimization proceeds while the data
+  is written. The file has the same format as the file produced by
+  writeSolutionFile(). A checkpoint that is still in progress is
+  completed before the records are reused.
+
+  @param filename is the name of the checkpoint file
+  @return the failure flag for the previous checkpoint or this one
+*/
+int ParOptInteriorPoint::startCheckpoint(const char *filename) {
+  // Complete the previous checkpoint
+  int fail = finishCheckpoint(1);
+  if (fail) {
+    return fail;
   }
 
-  delete[] fname;
+  if (!checkpoint_file) {
+    checkpoint_file = new ParOptCheckpoint(comm);
+    checkpoint_file->incref();
+  }
 
-  return fail;
+  checkpoint_file->clear();
+  addCheckpointRecords(checkpoint_file);
+
+  const int compress = options->getBoolOption("compress_checkpoint");
+  return checkpoint_file->startWrite(filename, compress);
+}
+
+/*
+  Complete the asynchronous checkpoint, if one is in progress.
+
+  When wait is zero, this only tests whether the writes on all
+  processors have completed, and returns without blocking otherwise.
+  After the writes have completed, the temporary file is renamed to
+  the checkpoint file.
+
+  @param wait is a flag to wait for the writes to complete
+  @return the failure flag for the checkpoint
+*/
+int ParOptInteriorPoint::finishCheckpoint(int wait) {
+  if (!checkpoint_file) {
+    return 0;
+  }
+  return checkpoint_file->finishWrite(wait);
 }
 
 /**
    Read in the design variables, Lagrange multipliers and slack
    variables from a binary file.
 
+   Files written by writeSolutionFile() restore the full optimizer
+   state and may have been written on a different number of
+   processors. The next call to optimize() then continues from this
+   state. Files in the older fixed layout, without the checkpoint
+   header, only contain the variables and must be read on the same
+   number of processors.
+
    This function requires that the same problem structure as the
    original problem.
 
    @param filename is the name of the file input
 */
 int ParOptInteriorPoint::readSolutionFile(const char *filename) {
+  if (ParOptCheckpoint::isCheckpointFile(comm, filename)) {
+    ParOptCheckpoint *ck = new ParOptCheckpoint(comm);
+    ck->incref();
+    int fail = ck->read(filename);
+    if (!fail) {
+      fail = readCheckpointRecords(ck);
+    }
+    ck->decref();
+    return fail;
+  }
+
   char *fname = new char[strlen(filename) + 1];
   strcpy(fname, filename);
 
@@ -1063,10 +1675,12 @@ int ParOptInteriorPoint::readSolutionFile(const char *filename) {
                          MPI_STATUS_IGNORE);
     offset += var_range[size] * sizeof(ParOptScalar);
 
-    // Extract the lower Lagrange multipliers
+    // Extract the lower Lagrange multipliers. These are stored in the
+    // design-length layout and compressed once both have been read.
+    expandBoundMultipliers();
     ParOptScalar *zlvals, *zuvals;
-    variables.zl->getArray(&zlvals);
-    variables.zu->getArray(&zuvals);
+    zl_full->getArray(&zlvals);
+    zu_full->getArray(&zuvals);
     MPI_File_set_view(fp, offset, PAROPT_MPI_TYPE, PAROPT_MPI_TYPE, datarep,
                       MPI_INFO_NULL);
     MPI_File_read_at_all(fp, var_range[rank], zlvals, xsize, PAROPT_MPI_TYPE,
@@ -1079,6 +1693,7 @@ int ParOptInteriorPoint::readSolutionFile(const char *filename) {
     MPI_File_read_at_all(fp, var_range[rank], zuvals, xsize, PAROPT_MPI_TYPE,
                          MPI_STATUS_IGNORE);
     offset += var_range[size] * sizeof(ParOptScalar);
+    compressBoundMultipliers();
 
     // Read in the extra constraint Lagrange multipliers
     if (wcon_range[size] > 0) {
@@ -1234,6 +1849,26 @@ void ParOptInteriorPoint::setQuasiNewton(ParOptCompactQuasiNewton *_qn) {
   }
 }
 
+/**
+   Set the user-supplied preconditioner for the GMRES solution.
+
+   The preconditioner is only used when gmres_precon_type is set to
+   user. It must be compatible with the quasi-definite matrix of the
+   problem, since it replaces it during the inexact Newton steps.
+
+   @param _hprecon the approximate Hessian preconditioner
+*/
+void ParOptInteriorPoint::setHessianPrecon(ParOptHessianPrecon *_hprecon) {
+  if (_hprecon) {
+    _hprecon->incref();
+  }
+  if (hprecon) {
+    hprecon->decref();
+  }
+  hprecon = _hprecon;
+  gmres_precon_age = 0;
+}
+
 /**
    Reset the Quasi-Newton Hessian approximation if it is used.
 */
@@ -1247,32 +1882,260 @@ void ParOptInteriorPoint::resetQuasiNewtonHessian() {
    Reset the design variables and bounds.
 */
 void ParOptInteriorPoint::resetDesignAndBounds() {
+  checkpoint_restart = 0;
+  warm_start = 0;
   prob->getVarsAndBounds(variables.x, lb, ub);
+  initBoundIndices();
 }
 
 /**
-   Set the size of the GMRES subspace and allocate the vectors
-   required. Note that the old subspace information is deleted before
-   the new subspace data is allocated.
-
-   @param m the GMRES subspace size.
+   Reset the bounds and warm start the next optimization from a point.
+
+   The bounds are read from the problem, but the design variables are
+   set to the given point, moved into the interior of the new bounds
+   by warm_start_bound_frac times the bound range. The multipliers are
+   set to the given values, and those that are not given are retained
+   from the previous optimization. The slack variables are rebuilt and
+   the starting point strategy is skipped. The initial barrier parameter
+   is matched to the complementarity at the warm-start point. This is
+   intended for sequences of closely related problems, such as the
+   trust-region subproblems.
+
+   @param x the design point (if NULL, the current design is used)
+   @param z the dense constraint multipliers (may be NULL)
+   @param zw the sparse constraint multipliers (may be NULL)
+   @param zl the design-length lower bound multipliers (may be NULL)
+   @param zu the design-length upper bound multipliers (may be NULL)
 */
-void ParOptInteriorPoint::setGMRESSubspaceSize(int m) {
-  if (gmres_H) {
-    delete[] gmres_H;
-    delete[] gmres_alpha;
-    delete[] gmres_res;
-    delete[] gmres_y;
-    delete[] gmres_fproj;
-    delete[] gmres_aproj;
-    delete[] gmres_awproj;
-    delete[] gmres_Q;
+void ParOptInteriorPoint::warmStartDesignAndBounds(ParOptVec *x,
+                                                   ParOptScalar *z,
+                                                   ParOptVec *zw,
+                                                   ParOptVec *zl,
+                                                   ParOptVec *zu) {
+  const double max_bound_value = options->getFloatOption("max_bound_value");
+  const double warm_start_bound_frac =
+      options->getFloatOption("warm_start_bound_frac");
 
-    for (int i = 0; i < gmres_subspace_size; i++) {
-      gmres_W[i]->decref();
-    }
-    delete[] gmres_W;
-  }
+  checkpoint_restart = 0;
+  warm_start = 1;
+
+  // Get the new bounds. The starting point from the problem is ignored.
+  prob->getVarsAndBounds(update.x, lb, ub);
+  initBoundIndices();
+  if (x) {
+    variables.x->copyValues(x);
+  }
+
+  // Set the multipliers that are provided
+  if (z) {
+    memcpy(variables.z, z, ncon * sizeof(ParOptScalar));
+  }
+  if (zw) {
+    variables.zw->copyValues(zw);
+  }
+  if ((zl && use_lower) || (zu && use_upper)) {
+    expandBoundMultipliers();
+    if (zl && use_lower) {
+      zl_full->copyValues(zl);
+    }
+    if (zu && use_upper) {
+      zu_full->copyValues(zu);
+    }
+    compressBoundMultipliers();
+  }
+
+  // Move the point into the interior of the bounds
+  ParOptScalar *xvals, *lbvals, *ubvals;
+  variables.x->getArray(&xvals);
+  lb->getArray(&lbvals);
+  ub->getArray(&ubvals);
+
+  for (int i = 0; i < nvars; i++) {
+    int has_lower =
+        (use_lower && ParOptRealPart(lbvals[i]) > -max_bound_value);
+    int has_upper = (use_upper && ParOptRealPart(ubvals[i]) < max_bound_value);
+    if (has_lower && has_upper) {
+      ParOptScalar delta = warm_start_bound_frac * (ubvals[i] - lbvals[i]);
+      xvals[i] = max2(lbvals[i] + delta, min2(ubvals[i] - delta, xvals[i]));
+    } else if (has_lower) {
+      ParOptScalar delta =
+          warm_start_bound_frac * max2(1.0, fabs(ParOptRealPart(lbvals[i])));
+      xvals[i] = max2(lbvals[i] + delta, xvals[i]);
+    } else if (has_upper) {
+      ParOptScalar delta =
+          warm_start_bound_frac * max2(1.0, fabs(ParOptRealPart(ubvals[i])));
+      xvals[i] = min2(ubvals[i] - delta, xvals[i]);
+    }
+  }
+}
+
+/**
+   Set the problem factory used for the parallel line search.
+
+   When the option num_line_search_groups is greater than one, the
+   processors are split into groups and the factory is used to create
+   a problem instance on each group. After the first trial point is
+   rejected, the line search evaluates a sequence of decreasing trial
+   step lengths concurrently, one on each group, and accepts the largest
+   step length that satisfies the sufficient decrease condition. The
+   option is read at each line search, so the number of groups can be
+   changed between iterations.
+
+   When the step length is accepted from a group, the gradients are
+   also evaluated on that group and the problem instance is not
+   evaluated at the new point. This is not done when the Jacobian or
+   Hessian of the problem instance is used at the new point (with the
+   sparse or matrix-free constraint gradients, the Hessian-vector
+   products or the Hessian diagonal).
+
+   Note that the parallel line search is not used for problems with
+   sparse constraints.
+
+   @param factory The problem factory
+*/
+void ParOptInteriorPoint::setLineSearchProblemFactory(
+    ParOptProblemFactory *factory) {
+  if (factory) {
+    factory->incref();
+  }
+  if (ls_factory) {
+    ls_factory->decref();
+  }
+  ls_factory = factory;
+
+  // Free the old groups, these will be re-created when required
+  freeLineSearchGroups();
+}
+
+/*
+  Split the processors into groups and create the problem instances
+  for the parallel line search
+*/
+void ParOptInteriorPoint::initLineSearchGroups() {
+  freeLineSearchGroups();
+
+  ls_num_groups = options->getIntOption("num_line_search_groups");
+  if (!ls_factory || ls_num_groups <= 1 || nwcon > 0) {
+    return;
+  }
+
+  int size;
+  MPI_Comm_size(comm, &size);
+  if (size <= 1) {
+    return;
+  }
+
+  ls_groups =
+      new ParOptProblemGroups(comm, ls_factory, ls_num_groups, nvars, ncon);
+  ls_groups->incref();
+
+  int num_groups = ls_groups->getNumGroups();
+  if (num_groups == 0) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == opt_root) {
+      fprintf(stderr,
+              "ParOpt: Incompatible line search problem instance, "
+              "using the sequential line search\n");
+    }
+    freeLineSearchGroups();
+    ls_factory->decref();
+    ls_factory = NULL;
+    return;
+  }
+
+  // Allocate space for the trial point data
+  ls_alpha = new double[num_groups];
+  ls_fobj = new ParOptScalar[num_groups];
+  ls_con = new ParOptScalar[num_groups * ncon];
+  ls_fail = new int[num_groups];
+}
+
+/*
+  Free the data allocated for the parallel line search
+*/
+void ParOptInteriorPoint::freeLineSearchGroups() {
+  if (ls_groups) {
+    ls_groups->decref();
+  }
+  delete[] ls_alpha;
+  delete[] ls_fobj;
+  delete[] ls_con;
+  delete[] ls_fail;
+
+  ls_num_groups = 0;
+  ls_groups = NULL;
+  ls_alpha = NULL;
+  ls_fobj = NULL;
+  ls_con = NULL;
+  ls_fail = NULL;
+  ls_accept = -1;
+}
+
+/*
+  Evaluate the objective and constraints at the trial points
+  x + ls_alpha[k]*px for k = 0,...,nalpha-1 concurrently.
+
+  Each processor forms its local part of every trial point, and only
+  sends these values to the processors of the group that evaluates the
+  point. The results are shared between all processors.
+*/
+void ParOptInteriorPoint::evalLineSearchGroups(int nalpha) {
+  ParOptScalar *xvals, *pvals, *lbvals, *ubvals;
+  variables.x->getArray(&xvals);
+  update.x->getArray(&pvals);
+  lb->getArray(&lbvals);
+  ub->getArray(&ubvals);
+
+  for (int k = 0; k < nalpha; k++) {
+    ParOptScalar *tvals = ls_groups->getTrialPoint(k);
+    memcpy(tvals, xvals, nvars * sizeof(ParOptScalar));
+    computeStep(nvars, tvals, ls_alpha[k], pvals, lbvals, NULL, ubvals, NULL);
+  }
+
+  ls_groups->evalObjCon(nalpha, ls_fail, ls_fobj, ls_con);
+}
+
+/**
+   Set the size of the GMRES subspace and allocate the vectors
+   required. Note that the old subspace information is deleted before
+   the new subspace data is allocated.
+
+   @param m the GMRES subspace size.
+*/
+void ParOptInteriorPoint::setGMRESSubspaceSize(int m) {
+  if (gmres_H) {
+    delete[] gmres_H;
+    delete[] gmres_alpha;
+    delete[] gmres_res;
+    delete[] gmres_y;
+    delete[] gmres_fproj;
+    delete[] gmres_aproj;
+    delete[] gmres_awproj;
+    delete[] gmres_Q;
+
+    for (int i = 0; i < gmres_subspace_size; i++) {
+      gmres_W[i]->decref();
+    }
+    delete[] gmres_W;
+
+    if (gmres_recycle_size > 0) {
+      delete[] gmres_Hraw;
+      delete[] gmres_B;
+      delete[] gmres_uc;
+      for (int i = 0; i < gmres_recycle_size; i++) {
+        gmres_U[i]->decref();
+        gmres_C[i]->decref();
+      }
+      delete[] gmres_U;
+      delete[] gmres_C;
+      gmres_Z->decref();
+    }
+  }
+
+  // The recycled subspace is discarded when the subspace is re-allocated
+  gmres_recycle_size = 0;
+  gmres_num_recycled = 0;
 
   if (m > 0) {
     gmres_subspace_size = m;
@@ -1290,6 +2153,32 @@ void ParOptInteriorPoint::setGMRESSubspaceSize(int m) {
       gmres_W[i] = prob->createDesignVec();
       gmres_W[i]->incref();
     }
+
+    // Allocate the recycled subspace. This requires the unrotated
+    // Hessenberg matrix and the products C^{T}*W.
+    int k = options->getIntOption("gmres_recycle_size");
+#ifdef PAROPT_USE_COMPLEX
+    k = 0;
+#endif  // PAROPT_USE_COMPLEX
+    if (k > m) {
+      k = m;
+    }
+    if (k > 0) {
+      gmres_recycle_size = k;
+      gmres_Hraw = new ParOptScalar[(m + 1) * (m + 2) / 2];
+      gmres_B = new ParOptScalar[k * m];
+      gmres_uc = new ParOptScalar[k];
+      gmres_U = new ParOptVec *[k];
+      gmres_C = new ParOptVec *[k];
+      for (int i = 0; i < k; i++) {
+        gmres_U[i] = prob->createDesignVec();
+        gmres_U[i]->incref();
+        gmres_C[i] = prob->createDesignVec();
+        gmres_C[i]->incref();
+      }
+      gmres_Z = prob->createDesignVec();
+      gmres_Z->incref();
+    }
   } else {
     gmres_subspace_size = 0;
   }
@@ -1316,6 +2205,42 @@ void ParOptInteriorPoint::setOutputFile(const char *filename) {
   }
 }
 
+/**
+   Set the binary iteration history file.
+
+   The history contains one row per iteration with the same values as
+   the text output file. Passing NULL closes the file.
+
+   @param filename the history file name
+*/
+void ParOptInteriorPoint::setHistoryFile(const char *filename) {
+  if (!history) {
+    history = new ParOptHistory(comm, "ip");
+    history->incref();
+    history->addColumn("iter", PAROPT_HISTORY_INT);
+    history->addColumn("nobj", PAROPT_HISTORY_INT);
+    history->addColumn("ngrd", PAROPT_HISTORY_INT);
+    history->addColumn("nhvc", PAROPT_HISTORY_INT);
+    history->addColumn("alpha", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("alphx", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("alphz", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("fobj", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("|opt|", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("|infes|", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("|dual|", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("mu", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("comp", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("dmerit", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("rho", PAROPT_HISTORY_DOUBLE);
+  }
+
+  if (filename) {
+    history->open(filename);
+  } else {
+    history->close();
+  }
+}
+
 /**
    Compute the residual of the KKT system. This code utilizes the data
    stored internally in the ParOpt optimizer.
@@ -1336,24 +2261,15 @@ void ParOptInteriorPoint::setOutputFile(const char *filename) {
 */
 void ParOptInteriorPoint::computeKKTRes(ParOptVars &vars, double barrier,
                                         ParOptVars &res) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   const double rel_bound_barrier = options->getFloatOption("rel_bound_barrier");
 
   // Assemble the negative of the residual of the first KKT equation:
   // -(g(x) - Ac^{T}*z - Aw^{T}*zw - zl + zu)
-  if (use_lower) {
-    res.x->copyValues(vars.zl);
-  } else {
-    res.x->zeroEntries();
-  }
-  if (use_upper) {
-    res.x->axpy(-1.0, vars.zu);
-  }
+  res.x->zeroEntries();
+  addBoundMultipliers(1.0, vars, res.x);
   res.x->axpy(-1.0, g);
 
-  for (int i = 0; i < ncon; i++) {
-    res.x->axpy(vars.z[i], Ac[i]);
-  }
+  addConGradients(1.0, vars.z, res.x);
 
   if (nwcon > 0) {
     // Add rx = rx + Aw^{T}*zw
@@ -1420,13 +2336,11 @@ void ParOptInteriorPoint::computeKKTRes(ParOptVars &vars, double barrier,
     ParOptScalar *rzlvals;
     res.zl->getArray(&rzlvals);
 
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        rzlvals[i] =
-            -((xvals[i] - lbvals[i]) * zlvals[i] - rel_bound_barrier * barrier);
-      } else {
-        rzlvals[i] = 0.0;
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      rzlvals[kz] =
+          -((xvals[i] - lbvals[i]) * zlvals[kz] - rel_bound_barrier * barrier);
     }
   }
   if (use_upper) {
@@ -1434,13 +2348,11 @@ void ParOptInteriorPoint::computeKKTRes(ParOptVars &vars, double barrier,
     ParOptScalar *rzuvals;
     res.zu->getArray(&rzuvals);
 
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        rzuvals[i] =
-            -((ubvals[i] - xvals[i]) * zuvals[i] - rel_bound_barrier * barrier);
-      } else {
-        rzuvals[i] = 0.0;
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      rzuvals[kz] =
+          -((ubvals[i] - xvals[i]) * zuvals[kz] - rel_bound_barrier * barrier);
     }
   }
 }
@@ -1452,7 +2364,6 @@ void ParOptInteriorPoint::addKKTResStep(ParOptVars &vars, ParOptVars &step,
                                         ParOptVars &res, ParOptVec *xtmp,
                                         int inexact_newton_step) {
   const double qn_sigma = options->getFloatOption("qn_sigma");
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   const int sequential_linear_method =
       options->getBoolOption("sequential_linear_method");
   const int use_diag_hessian = options->getBoolOption("use_diag_hessian");
@@ -1478,15 +2389,8 @@ void ParOptInteriorPoint::addKKTResStep(ParOptVars &vars, ParOptVars &step,
       res.x->axpy(-qn_sigma, step.x);
     }
   }
-  for (int i = 0; i < ncon; i++) {
-    res.x->axpy(step.z[i], Ac[i]);
-  }
-  if (use_lower) {
-    res.x->axpy(1.0, step.zl);
-  }
-  if (use_upper) {
-    res.x->axpy(-1.0, step.zu);
-  }
+  addConGradients(1.0, step.z, res.x);
+  addBoundMultipliers(1.0, step, res.x);
 
   if (nwcon > 0) {
     // Add the contribution res.x += Aw^{T} * step.zw
@@ -1532,8 +2436,9 @@ void ParOptInteriorPoint::addKKTResStep(ParOptVars &vars, ParOptVars &step,
     }
   }
 
+  multConGradients(step.x, 0, ac_prod);
   for (int i = 0; i < ncon; i++) {
-    res.z[i] -= (Ac[i]->dot(step.x) - step.s[i] + step.t[i]);
+    res.z[i] -= (ac_prod[i] - step.s[i] + step.t[i]);
     res.s[i] += (step.zs[i] - step.z[i]);
     res.t[i] += (step.zt[i] + step.z[i]);
     res.zs[i] -= (step.s[i] * vars.zs[i] + vars.s[i] * step.zs[i]);
@@ -1561,11 +2466,11 @@ void ParOptInteriorPoint::addKKTResStep(ParOptVars &vars, ParOptVars &step,
     ParOptScalar *rzlvals;
     res.zl->getArray(&rzlvals);
 
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        rzlvals[i] -=
-            ((xvals[i] - lbvals[i]) * pzlvals[i] + pxvals[i] * zlvals[i]);
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      rzlvals[kz] -=
+          ((xvals[i] - lbvals[i]) * pzlvals[kz] + pxvals[i] * zlvals[kz]);
     }
   }
   if (use_upper) {
@@ -1573,11 +2478,11 @@ void ParOptInteriorPoint::addKKTResStep(ParOptVars &vars, ParOptVars &step,
     ParOptScalar *rzuvals;
     res.zu->getArray(&rzuvals);
 
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        rzuvals[i] -=
-            ((ubvals[i] - xvals[i]) * pzuvals[i] - pxvals[i] * zuvals[i]);
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      rzuvals[kz] -=
+          ((ubvals[i] - xvals[i]) * pzuvals[kz] - pxvals[i] * zuvals[kz]);
     }
   }
 }
@@ -1589,53 +2494,56 @@ void ParOptInteriorPoint::computeResNorm(ParOptNormType norm_type,
                                          ParOptVars &res, double *max_prime,
                                          double *max_dual, double *max_infeas,
                                          double *res_norm) {
-  // Zero the values of the maximum residuals
-  *max_prime = 0.0;
-  *max_dual = 0.0;
-  *max_infeas = 0.0;
+  // Compute the on-processor contributions from the distributed
+  // residuals so that they can be combined in a single reduction.
+  // Note that the contributions from the sparse slack variables use
+  // the l1 norm for the l2 norm type.
+  ParOptNormType slack_norm_type = norm_type;
+  if (norm_type == PAROPT_L2_NORM) {
+    slack_norm_type = PAROPT_L1_NORM;
+  }
+
+  double local[8], norms[8];
+  local[0] = ParOptLocalNorm(norm_type, res.x);
+  local[1] = ParOptLocalNorm(norm_type, res.zw);
+  local[2] = ParOptLocalNorm(slack_norm_type, res.sw);
+  local[3] = ParOptLocalNorm(slack_norm_type, res.tw);
+  local[4] = ParOptLocalNorm(slack_norm_type, res.zsw);
+  local[5] = ParOptLocalNorm(slack_norm_type, res.ztw);
+  local[6] = 0.0;
+  if (use_lower) {
+    local[6] = ParOptLocalNorm(norm_type, res.zl);
+  }
+  local[7] = 0.0;
+  if (use_upper) {
+    local[7] = ParOptLocalNorm(norm_type, res.zu);
+  }
 
-  // Compute the residuals in the KKT condition
-  // Account for the contributions to the norms
   if (norm_type == PAROPT_INFTY_NORM) {
-    *max_prime = res.x->maxabs();
-    *max_infeas = res.zw->maxabs();
+    MPI_Allreduce(local, norms, 8, MPI_DOUBLE, MPI_MAX, comm);
+  } else {
+    MPI_Allreduce(local, norms, 8, MPI_DOUBLE, MPI_SUM, comm);
+  }
 
-    double dual_sw = res.sw->maxabs();
-    double dual_tw = res.tw->maxabs();
-    double dual_zsw = res.zsw->maxabs();
-    double dual_ztw = res.ztw->maxabs();
-    if (dual_sw > *max_dual) {
-      *max_dual = dual_sw;
-    }
-    if (dual_tw > *max_dual) {
-      *max_dual = dual_tw;
-    }
-    if (dual_zsw > *max_dual) {
-      *max_dual = dual_zsw;
-    }
-    if (dual_ztw > *max_dual) {
-      *max_dual = dual_ztw;
+  // Account for the contributions to the norms
+  *max_prime = norms[0];
+  *max_infeas = norms[1];
+  *max_dual = 0.0;
+  if (norm_type == PAROPT_INFTY_NORM) {
+    for (int i = 2; i < 8; i++) {
+      if (norms[i] > *max_dual) {
+        *max_dual = norms[i];
+      }
     }
   } else if (norm_type == PAROPT_L1_NORM) {
-    *max_prime = res.x->l1norm();
-    *max_infeas = res.zw->l1norm();
-
-    *max_dual += res.sw->l1norm();
-    *max_dual += res.tw->l1norm();
-    *max_dual += res.zsw->l1norm();
-    *max_dual += res.ztw->l1norm();
+    for (int i = 2; i < 8; i++) {
+      *max_dual += norms[i];
+    }
   } else {  // norm_type == PAROPT_L2_NORM
-    double prime_rx = res.x->norm();
-    double prime_rzw = res.zw->norm();
-    *max_prime = prime_rx * prime_rx;
-    *max_infeas = prime_rzw * prime_rzw;
-
-    double dual_sw = res.sw->l1norm();
-    double dual_tw = res.tw->l1norm();
-    double dual_zsw = res.zsw->l1norm();
-    double dual_ztw = res.ztw->l1norm();
-    *max_dual += (dual_sw * dual_sw + dual_tw * dual_tw + dual_zsw * dual_zsw +
-                  dual_ztw * dual_ztw);
+    for (int i = 2; i < 6; i++) {
+      *max_dual += norms[i] * norms[i];
+    }
+    *max_dual += norms[6] + norms[7];
   }
 
   if (norm_type == PAROPT_INFTY_NORM) {
@@ -1676,33 +2584,6 @@ void ParOptInteriorPoint::computeResNorm(ParOptNormType norm_type,
     *max_dual += dual;
   }
 
-  if (use_lower) {
-    if (norm_type == PAROPT_INFTY_NORM) {
-      double dual_zl = res.zl->maxabs();
-      if (dual_zl > *max_dual) {
-        *max_dual = dual_zl;
-      }
-    } else if (norm_type == PAROPT_L1_NORM) {
-      *max_dual += res.zl->l1norm();
-    } else {  // norm_type == PAROPT_L2_NORM
-      double dual_zl = res.zl->norm();
-      *max_dual += dual_zl * dual_zl;
-    }
-  }
-  if (use_upper) {
-    if (norm_type == PAROPT_INFTY_NORM) {
-      double dual_zu = res.zu->maxabs();
-      if (ParOptRealPart(dual_zu) > ParOptRealPart(*max_dual)) {
-        *max_dual = dual_zu;
-      }
-    } else if (norm_type == PAROPT_L1_NORM) {
-      *max_dual += res.zu->l1norm();
-    } else {  // norm_type == PAROPT_L2_NORM
-      double dual_zu = res.zu->norm();
-      *max_dual += dual_zu * dual_zu;
-    }
-  }
-
   // If this is the l2 norm, take the square root
   if (norm_type == PAROPT_L2_NORM) {
     *max_dual = sqrt(*max_dual);
@@ -1728,7 +2609,6 @@ void ParOptInteriorPoint::computeResNorm(ParOptNormType norm_type,
 */
 void ParOptInteriorPoint::addMehrotraCorrectorResidual(ParOptVars &step,
                                                        ParOptVars &res) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
 
   // Add the contribution from the sparse constraints
   if (nwcon > 0) {
@@ -1768,10 +2648,10 @@ void ParOptInteriorPoint::addMehrotraCorrectorResidual(ParOptVars &step,
     ParOptScalar *rzlvals;
     res.zl->getArray(&rzlvals);
 
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        rzlvals[i] -= pxvals[i] * pzlvals[i];
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      rzlvals[kz] -= pxvals[i] * pzlvals[kz];
     }
   }
 
@@ -1780,10 +2660,10 @@ void ParOptInteriorPoint::addMehrotraCorrectorResidual(ParOptVars &step,
     ParOptScalar *rzuvals;
     res.zu->getArray(&rzuvals);
 
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        rzuvals[i] += pxvals[i] * pzuvals[i];
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      rzuvals[kz] += pxvals[i] * pzuvals[kz];
     }
   }
 }
@@ -1804,6 +2684,205 @@ double ParOptInteriorPoint::computeStepNorm(ParOptNormType norm_type,
   return step_norm;
 }
 
+/*
+  Assemble the Schur complement for the dense constraints
+
+  G = diag{gdiag} + (A, 0) * D0^{-1} * (A, 0)^{T}
+
+  using the current factorization of the quasi-definite matrix D0. Only
+  the lower triangle is stored. Each column requires one application of
+  D0^{-1} and one collective multiple dot product. With matrix-free
+  Jacobian-vector products, the columns are instead computed in blocks
+  with one batched transpose product and one batched product per block.
+  The column is stored in packed format on the root processor, or in
+  the block-cyclic format on the processor that owns it when the
+  distributed factorization is used.
+*/
+void ParOptInteriorPoint::assembleGmat(ParOptVec *xtmp, ParOptVec *wtmp) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  if (gmat_dist) {
+    memset(Gdist, 0, gmat_dist_size * sizeof(ParOptScalar));
+  }
+
+  // The number of columns computed at the same time
+  const int nb = (ac_matfree ? ac_block_size : 1);
+
+  for (int j = 0; j < ncon; j++) {
+    if (ac_matfree) {
+      // Compute the next block of columns with the batched products
+      int k = (j % nb);
+      if (k == 0) {
+        int nj = (ncon - j < nb ? ncon - j : nb);
+        memset(ac_zwork, 0, nj * ncon * sizeof(ParOptScalar));
+        for (int i = 0; i < nj; i++) {
+          ac_zwork[i * ncon + j + i] = 1.0;
+          ac_batch[i]->zeroEntries();
+        }
+        prob->addDenseJacobianTranspose(1.0, ac_x, nj, ac_zwork, ac_batch);
+
+        for (int i = 0; i < nj; i++) {
+          mat->apply(ac_batch[i], xtmp, wtmp);
+          ac_batch[i]->copyValues(xtmp);
+        }
+
+        memset(ac_zwork, 0, nj * ncon * sizeof(ParOptScalar));
+        prob->addDenseJacobian(1.0, ac_x, nj, ac_batch, ac_zwork);
+      }
+      memcpy(gwork, &ac_zwork[k * ncon + j],
+             (ncon - j) * sizeof(ParOptScalar));
+    } else {
+      mat->apply(getConGradient(j), xtmp, wtmp);
+      multConGradients(xtmp, j, gwork);
+    }
+    gwork[0] += gdiag[j];
+
+    if (gmat_dist) {
+      int kb = j / gmat_block_size;
+      if (kb % size == rank) {
+        int c0 = kb * gmat_block_size;
+        int m = ncon - c0;
+        ParOptScalar *col =
+            &Gdist[ParOptBlockCyclicOffset(ncon, gmat_block_size, rank, size,
+                                           kb) +
+                   (j - c0) * (m + 1)];
+        memcpy(col, gwork, (ncon - j) * sizeof(ParOptScalar));
+      }
+    } else if (rank == opt_root) {
+      ParOptScalar *col = &Gmat[j * ncon - (j * (j - 1)) / 2];
+      memcpy(col, gwork, (ncon - j) * sizeof(ParOptScalar));
+    }
+  }
+}
+
+/*
+  Assemble and factor the Schur complement for the dense constraints.
+
+  The matrix G is symmetric and, when the entries of Dinv are positive,
+  it is also positive definite. In this case, a Cholesky factorization
+  is used. When the number of dense constraints is at least
+  gmat_distributed_size, the lower triangle is distributed in a 1D
+  block-cyclic format over the processors and the factorization is
+  performed in parallel. Otherwise the packed lower triangle is stored
+  and factored on the root processor alone.
+
+  If the diagonal is not positive or the Cholesky factorization fails,
+  the packed matrix is re-assembled on the root processor and factored
+  with the symmetric indefinite (Bunch-Kaufman) factorization instead.
+*/
+void ParOptInteriorPoint::factorGmat(ParOptVec *xtmp, ParOptVec *wtmp) {
+  if (ncon == 0) {
+    return;
+  }
+
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  const int dist_size = options->getIntOption("gmat_distributed_size");
+
+  // Check whether the matrix is guaranteed to be positive definite
+  ParOptScalar *dvals;
+  int n = Dinv->getArray(&dvals);
+  gmat_chol = 1;
+  for (int i = 0; i < n; i++) {
+    if (ParOptRealPart(dvals[i]) <= 0.0) {
+      gmat_chol = 0;
+      break;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &gmat_chol, 1, MPI_INT, MPI_MIN, comm);
+
+  gmat_dist = 0;
+  if (gmat_chol && size > 1 && dist_size > 0 && ncon >= dist_size) {
+    gmat_dist = 1;
+  }
+
+  if (gmat_dist) {
+    // Allocate the local block columns
+    int nb = options->getIntOption("gmat_block_size");
+    int nblocks = (ncon + nb - 1) / nb;
+    int local_size = ParOptBlockCyclicOffset(ncon, nb, rank, size, nblocks);
+    if (!Gdist || nb != gmat_block_size || local_size != gmat_dist_size) {
+      if (Gdist) {
+        delete[] Gdist;
+      }
+      Gdist = new ParOptScalar[local_size > 0 ? local_size : 1];
+      gmat_block_size = nb;
+      gmat_dist_size = local_size;
+    }
+
+    assembleGmat(xtmp, wtmp);
+    int info = ParOptBlockCyclicCholesky(comm, ncon, gmat_block_size, Gdist);
+    if (info == 0) {
+      return;
+    }
+
+    gmat_dist = 0;
+    gmat_chol = 0;
+  }
+
+  // Allocate the packed storage on the root processor
+  if (rank == opt_root && !Gmat) {
+    Gmat = new ParOptScalar[(ncon * (ncon + 1)) / 2];
+    gpiv = new int[ncon];
+  }
+
+  if (gmat_chol) {
+    assembleGmat(xtmp, wtmp);
+
+    int info = 0;
+    if (rank == opt_root) {
+      LAPACKdpptrf("L", &ncon, Gmat, &info);
+    }
+    MPI_Bcast(&info, 1, MPI_INT, opt_root, comm);
+    if (info == 0) {
+      return;
+    }
+
+    gmat_chol = 0;
+  }
+
+  assembleGmat(xtmp, wtmp);
+  if (rank == opt_root) {
+    int info = 0;
+    LAPACKdsptrf("L", &ncon, Gmat, gpiv, &info);
+  }
+}
+
+/*
+  Solve G*x = r in place using the factorization from factorGmat.
+
+  The right-hand-side is only required on the root processor. On exit,
+  the solution is the same on all processors.
+*/
+void ParOptInteriorPoint::solveGmat(ParOptScalar *r) {
+  if (ncon == 0) {
+    return;
+  }
+
+  if (gmat_dist) {
+    MPI_Bcast(r, ncon, PAROPT_MPI_TYPE, opt_root, comm);
+    ParOptBlockCyclicSolve(comm, ncon, gmat_block_size, Gdist, r);
+  } else {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    if (rank == opt_root) {
+      int one = 1, info = 0;
+      if (gmat_chol) {
+        LAPACKdpptrs("L", &ncon, &one, Gmat, r, &ncon, &info);
+      } else {
+        LAPACKdsptrs("L", &ncon, &one, Gmat, gpiv, r, &ncon, &info);
+      }
+    }
+
+    MPI_Bcast(r, ncon, PAROPT_MPI_TYPE, opt_root, comm);
+  }
+}
+
 /*
   This function computes the terms required to solve the KKT system
   using a bordering method.  The initialization process computes the
@@ -1830,16 +2909,20 @@ double ParOptInteriorPoint::computeStepNorm(ParOptNormType norm_type,
   which is required to compute the solution of the KKT step.
 */
 void ParOptInteriorPoint::setUpKKTDiagSystem(ParOptVars &vars, ParOptVec *xtmp,
-                                             ParOptVec *wtmp, int use_qn) {
+                                             ParOptVec *wtmp, int use_qn,
+                                             ParOptVec *hdiag_precon) {
   // Diagonal coefficient used for the quasi-Newton Hessian aprpoximation
   const double qn_sigma = options->getFloatOption("qn_sigma");
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   const int use_diag_hessian = options->getBoolOption("use_diag_hessian");
 
-  // Retrive the diagonal entry for the BFGS update
+  // Retrive the diagonal entry for the BFGS update and the diagonal
+  // correction used in the GMRES preconditioner (if any)
   ParOptScalar b0 = 0.0;
-  ParOptScalar *h = NULL;
-  if (hdiag && use_diag_hessian) {
+  ParOptScalar *h = NULL, *hc = NULL;
+  if (hdiag_precon) {
+    hdiag_precon->getArray(&hc);
+  }
+  if (hdiag && use_diag_hessian && !hc) {
     hdiag->getArray(&h);
   } else if (qn && use_qn) {
     const ParOptScalar *d, *M;
@@ -1860,55 +2943,42 @@ void ParOptInteriorPoint::setUpKKTDiagSystem(ParOptVars &vars, ParOptVec *xtmp,
   ParOptScalar *dvals;
   Dinv->getArray(&dvals);
 
-  // Set the values of the c matrix
-  if (use_lower && use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (h) {
-        b0 = h[i];
-      }
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value &&
-          ParOptRealPart(ubvals[i]) < max_bound_value) {
-        dvals[i] = 1.0 / (b0 + qn_sigma + zlvals[i] / (xvals[i] - lbvals[i]) +
-                          zuvals[i] / (ubvals[i] - xvals[i]));
-      } else if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        dvals[i] = 1.0 / (b0 + qn_sigma + zlvals[i] / (xvals[i] - lbvals[i]));
-      } else if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        dvals[i] = 1.0 / (b0 + qn_sigma + zuvals[i] / (ubvals[i] - xvals[i]));
-      } else {
-        dvals[i] = 1.0 / (b0 + qn_sigma);
-      }
-    }
-  } else if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (h) {
-        b0 = h[i];
-      }
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        dvals[i] = 1.0 / (b0 + qn_sigma + zlvals[i] / (xvals[i] - lbvals[i]));
-      } else {
-        dvals[i] = 1.0 / (b0 + qn_sigma);
-      }
-    }
-  } else if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (h) {
-        b0 = h[i];
-      }
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        dvals[i] = 1.0 / (b0 + qn_sigma + zuvals[i] / (ubvals[i] - xvals[i]));
-      } else {
-        dvals[i] = 1.0 / (b0 + qn_sigma);
-      }
+  // Set the diagonal contribution from the Hessian approximation
+  for (int i = 0; i < nvars; i++) {
+    if (h) {
+      b0 = h[i];
     }
-  } else {
-    for (int i = 0; i < nvars; i++) {
-      if (h) {
-        b0 = h[i];
-      }
-      dvals[i] = 1.0 / (b0 + qn_sigma);
+    dvals[i] = b0 + qn_sigma;
+    if (hc) {
+      dvals[i] += hc[i];
     }
   }
 
+  // Add the contributions from the lower and upper bounds
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int i = lower_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    dvals[i] += zlvals[kz] / (xvals[i] - lbvals[i]);
+  }
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int i = upper_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    dvals[i] += zuvals[kz] / (ubvals[i] - xvals[i]);
+  }
+
+  // Invert the diagonal
+  for (int i = 0; i < nvars; i++) {
+    dvals[i] = 1.0 / dvals[i];
+  }
+
+  // In the dense mode, the KKT matrix is assembled from Dinv and
+  // factored when the step is computed. Flag the old factorization as
+  // out of date and skip the Schur complement.
+  if (dense_kkt) {
+    dense_kkt_qn = -1;
+    return;
+  }
+
   Cdiag->zeroEntries();
   if (nwcon > 0) {
     // Compute C = Zsw^{-1} * Sw + Ztw^{-1} * Tw
@@ -1929,45 +2999,11 @@ void ParOptInteriorPoint::setUpKKTDiagSystem(ParOptVars &vars, ParOptVec *xtmp,
   // Factor the quasi-definite matrix
   mat->factor(vars.x, Dinv, Cdiag);
 
-  // Set the value of the G matrix
-  memset(Gmat, 0, ncon * ncon * sizeof(ParOptScalar));
-
-  // Now, compute the Schur complement with the Dmatrix
-  for (int j = 0; j < ncon; j++) {
-    mat->apply(Ac[j], xtmp, wtmp);
-
-    for (int i = j; i < ncon; i++) {
-      Gmat[i + ncon * j] += Ac[i]->dot(xtmp);
-    }
-  }
-
-  // Populate the remainder of the matrix because it is
-  // symmetric
-  for (int j = 0; j < ncon; j++) {
-    for (int i = j + 1; i < ncon; i++) {
-      Gmat[j + ncon * i] = Gmat[i + ncon * j];
-    }
-  }
-
-  if (ncon > 0) {
-    int rank;
-    MPI_Comm_rank(comm, &rank);
-
-    // Add the diagonal component to the matrix
-    if (rank == opt_root) {
-      for (int i = 0; i < ncon; i++) {
-        Gmat[i * (ncon + 1)] += vars.s[i] / vars.zs[i] + vars.t[i] / vars.zt[i];
-      }
-    }
-
-    // Broadcast the result to all processors. Note that this ensures
-    // that the factorization will be the same on all processors
-    MPI_Bcast(Gmat, ncon * ncon, PAROPT_MPI_TYPE, opt_root, comm);
-
-    // Factor the matrix for future use
-    int info = 0;
-    LAPACKdgetrf(&ncon, &ncon, Gmat, &ncon, gpiv, &info);
+  // Compute and factor the Schur complement with the D matrix
+  for (int i = 0; i < ncon; i++) {
+    gdiag[i] = vars.s[i] / vars.zs[i] + vars.t[i] / vars.zt[i];
   }
+  factorGmat(xtmp, wtmp);
 }
 
 /*
@@ -2074,7 +3110,6 @@ void ParOptInteriorPoint::setUpKKTDiagSystem(ParOptVars &vars, ParOptVec *xtmp,
 void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVars &b,
                                              ParOptVars &y, ParOptVec *d1,
                                              ParOptVec *d2) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
 
   // Get the arrays for the variables and upper/lower bounds
   ParOptScalar *xvals, *lbvals, *ubvals;
@@ -2093,17 +3128,17 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVars &b,
   ParOptScalar *d1vals;
   d1->getArray(&d1vals);
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        d1vals[i] += (bzlvals[i] / (xvals[i] - lbvals[i]));
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      d1vals[i] += (bzlvals[kz] / (xvals[i] - lbvals[i]));
     }
   }
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        d1vals[i] -= (bzuvals[i] / (ubvals[i] - xvals[i]));
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      d1vals[i] -= (bzuvals[kz] / (ubvals[i] - xvals[i]));
     }
   }
 
@@ -2140,7 +3175,7 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVars &b,
 
   // Now, compute yz = A^{T} * y.x
   memset(y.z, 0, ncon * sizeof(ParOptScalar));
-  y.x->mdot(Ac, ncon, y.z);
+  multConGradients(y.x, 0, y.z);
 
   if (ncon > 0) {
     int rank;
@@ -2154,12 +3189,9 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVars &b,
         y.z[i] = (b.z[i] + (b.zs[i] + vars.s[i] * b.s[i]) / vars.zs[i] -
                   (b.zt[i] + vars.t[i] * b.t[i]) / vars.zt[i] - y.z[i]);
       }
-
-      int one = 1, info = 0;
-      LAPACKdgetrs("N", &ncon, &one, Gmat, &ncon, gpiv, y.z, &ncon, &info);
     }
 
-    MPI_Bcast(y.z, ncon, PAROPT_MPI_TYPE, opt_root, comm);
+    solveGmat(y.z);
 
     // Compute the step in the slack variables
     for (int i = 0; i < ncon; i++) {
@@ -2170,9 +3202,7 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVars &b,
     }
   }
 
-  for (int i = 0; i < ncon; i++) {
-    d1->axpy(y.z[i], Ac[i]);
-  }
+  addConGradients(1.0, y.z, d1);
 
   mat->apply(d1, d2, y.x, y.zw);
 
@@ -2220,24 +3250,20 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVars &b,
 
   // Compute the steps in the bound Lagrange multipliers
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        yzlvals[i] =
-            (bzlvals[i] - zlvals[i] * yxvals[i]) / (xvals[i] - lbvals[i]);
-      } else {
-        yzlvals[i] = 0.0;
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      yzlvals[kz] =
+          (bzlvals[kz] - zlvals[kz] * yxvals[i]) / (xvals[i] - lbvals[i]);
     }
   }
 
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        yzuvals[i] =
-            (bzuvals[i] + zuvals[i] * yxvals[i]) / (ubvals[i] - xvals[i]);
-      } else {
-        yzuvals[i] = 0.0;
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      yzuvals[kz] =
+          (bzuvals[kz] + zuvals[kz] * yxvals[i]) / (ubvals[i] - xvals[i]);
     }
   }
 }
@@ -2257,7 +3283,6 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVars &b,
 void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
                                              ParOptVars &y, ParOptVec *d1,
                                              ParOptVec *d2) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
 
   // Get the arrays for the variables and upper/lower bounds
   ParOptScalar *xvals, *lbvals, *ubvals;
@@ -2276,7 +3301,7 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
 
   // Now, compute yz = A^{T} * y.x
   memset(y.z, 0, ncon * sizeof(ParOptScalar));
-  y.x->mdot(Ac, ncon, y.z);
+  multConGradients(y.x, 0, y.z);
 
   if (ncon > 0) {
     int rank;
@@ -2289,12 +3314,9 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
       for (int i = 0; i < ncon; i++) {
         y.z[i] = -y.z[i];
       }
-
-      int one = 1, info = 0;
-      LAPACKdgetrs("N", &ncon, &one, Gmat, &ncon, gpiv, y.z, &ncon, &info);
     }
 
-    MPI_Bcast(y.z, ncon, PAROPT_MPI_TYPE, opt_root, comm);
+    solveGmat(y.z);
 
     // Compute the step in the slack variables
     for (int i = 0; i < ncon; i++) {
@@ -2305,9 +3327,7 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
     }
   }
 
-  for (int i = 0; i < ncon; i++) {
-    d1->axpy(y.z[i], Ac[i]);
-  }
+  addConGradients(1.0, y.z, d1);
 
   mat->apply(d1, d2, y.x, y.zw);
 
@@ -2348,22 +3368,18 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
 
   // Compute the steps in the bound Lagrange multipliers
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        yzlvals[i] = -(zlvals[i] * yxvals[i]) / (xvals[i] - lbvals[i]);
-      } else {
-        yzlvals[i] = 0.0;
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      yzlvals[kz] = -(zlvals[kz] * yxvals[i]) / (xvals[i] - lbvals[i]);
     }
   }
 
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        yzuvals[i] = (zuvals[i] * yxvals[i]) / (ubvals[i] - xvals[i]);
-      } else {
-        yzuvals[i] = 0.0;
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      yzuvals[kz] = (zuvals[kz] * yxvals[i]) / (ubvals[i] - xvals[i]);
     }
   }
 }
@@ -2399,7 +3415,7 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
 
   // Now, compute yz = A^{T} * y.x
   memset(yz, 0, ncon * sizeof(ParOptScalar));
-  yx->mdot(Ac, ncon, yz);
+  multConGradients(yx, 0, yz);
 
   if (ncon > 0) {
     int rank;
@@ -2412,17 +3428,12 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
       for (int i = 0; i < ncon; i++) {
         yz[i] = -yz[i];
       }
-
-      int one = 1, info = 0;
-      LAPACKdgetrs("N", &ncon, &one, Gmat, &ncon, gpiv, yz, &ncon, &info);
     }
 
-    MPI_Bcast(yz, ncon, PAROPT_MPI_TYPE, opt_root, comm);
+    solveGmat(yz);
   }
 
-  for (int i = 0; i < ncon; i++) {
-    d1->axpy(yz[i], Ac[i]);
-  }
+  addConGradients(1.0, yz, d1);
 
   mat->apply(d1, yx, yzw);
 }
@@ -2442,7 +3453,6 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
                                              ParOptScalar alpha, ParOptVars &b,
                                              ParOptVars &y, ParOptVec *d1,
                                              ParOptVec *d2) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
 
   // Get the arrays for the variables and upper/lower bounds
   ParOptScalar *xvals, *lbvals, *ubvals;
@@ -2462,17 +3472,17 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
   ParOptScalar *d1vals;
   d1->getArray(&d1vals);
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        d1vals[i] += alpha * (bzlvals[i] / (xvals[i] - lbvals[i]));
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      d1vals[i] += alpha * (bzlvals[kz] / (xvals[i] - lbvals[i]));
     }
   }
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        d1vals[i] -= alpha * (bzuvals[i] / (ubvals[i] - xvals[i]));
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      d1vals[i] -= alpha * (bzuvals[kz] / (ubvals[i] - xvals[i]));
     }
   }
 
@@ -2509,7 +3519,7 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
 
   // Now, compute yz = A^{T} * y.x
   memset(y.z, 0, ncon * sizeof(ParOptScalar));
-  y.x->mdot(Ac, ncon, y.z);
+  multConGradients(y.x, 0, y.z);
 
   if (ncon > 0) {
     int rank;
@@ -2525,12 +3535,9 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
                       (b.zt[i] + vars.t[i] * b.t[i]) / vars.zt[i]) -
              y.z[i]);
       }
-
-      int one = 1, info = 0;
-      LAPACKdgetrs("N", &ncon, &one, Gmat, &ncon, gpiv, y.z, &ncon, &info);
     }
 
-    MPI_Bcast(y.z, ncon, PAROPT_MPI_TYPE, opt_root, comm);
+    solveGmat(y.z);
 
     // Compute the step in the slack variables
     for (int i = 0; i < ncon; i++) {
@@ -2541,9 +3548,7 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
     }
   }
 
-  for (int i = 0; i < ncon; i++) {
-    d1->axpy(y.z[i], Ac[i]);
-  }
+  addConGradients(1.0, y.z, d1);
 
   mat->apply(d1, d2, y.x, y.zw);
 
@@ -2591,24 +3596,20 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
 
   // Compute the steps in the bound Lagrange multipliers
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        yzlvals[i] = (alpha * bzlvals[i] - zlvals[i] * yxvals[i]) /
-                     (xvals[i] - lbvals[i]);
-      } else {
-        yzlvals[i] = 0.0;
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      yzlvals[kz] = (alpha * bzlvals[kz] - zlvals[kz] * yxvals[i]) /
+                   (xvals[i] - lbvals[i]);
     }
   }
 
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        yzuvals[i] = (alpha * bzuvals[i] + zuvals[i] * yxvals[i]) /
-                     (ubvals[i] - xvals[i]);
-      } else {
-        yzuvals[i] = 0.0;
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      yzuvals[kz] = (alpha * bzuvals[kz] + zuvals[kz] * yxvals[i]) /
+                   (ubvals[i] - xvals[i]);
     }
   }
 }
@@ -2634,6 +3635,12 @@ void ParOptInteriorPoint::solveKKTDiagSystem(ParOptVars &vars, ParOptVec *bx,
 void ParOptInteriorPoint::setUpKKTSystem(ParOptVars &vars, ParOptScalar *ztmp,
                                          ParOptVec *xtmp1, ParOptVec *xtmp2,
                                          ParOptVec *wtmp, int use_qn) {
+  // The dense factorization is deferred to computeKKTStep(), since the
+  // step may be computed without the quasi-Newton terms
+  if (dense_kkt) {
+    return;
+  }
+
   if (qn && use_qn) {
     // Get the size of the limited-memory BFGS subspace
     ParOptScalar b0;
@@ -2680,59 +3687,367 @@ void ParOptInteriorPoint::setUpKKTSystem(ParOptVars &vars, ParOptScalar *ztmp,
 
   y <- [ K + Z*diag{d}*M^{-1}*diag{d}*Z^{T} ]^{-1}*x,
 
-  which can be written in terms of the operations y <- K^{-1}*x and
-  r <- Ce^{-1}*S. Where Ce is given by:
+  which can be written in terms of the operations y <- K^{-1}*x and
+  r <- Ce^{-1}*S. Where Ce is given by:
+
+  Ce = Z^{T}*K^{-1}*Z - diag{d}^{-1}*M*diag{d}^{-1}
+
+  The code computes the following:
+
+  y <- K^{-1}*x - K^{-1}*Z*Ce^{-1}*Z^{T}*K^{-1}*x
+
+  The code computes the following:
+
+  1. p = K^{-1}*r
+  2. ztemp = Z^{T}*p
+  3. ztemp <- Ce^{-1}*ztemp
+  4. rx = Z^{T}*ztemp
+  5. p -= K^{-1}*rx
+*/
+void ParOptInteriorPoint::computeKKTStep(ParOptVars &vars, ParOptVars &res,
+                                         ParOptVars &step, ParOptScalar *ztmp,
+                                         ParOptVec *xtmp1, ParOptVec *xtmp2,
+                                         ParOptVec *wtmp, int use_qn) {
+  if (dense_kkt) {
+    // Factor the dense KKT matrix, unless the factorization is already
+    // up to date, then solve for the step
+    int qn_flag = (qn && use_qn) ? 1 : 0;
+    if (dense_kkt_qn != qn_flag) {
+      factorDenseKKTSystem(vars, use_qn);
+    }
+    solveDenseKKTSystem(vars, res, step, xtmp1);
+    return;
+  }
+
+  // Get the size of the limited-memory BFGS subspace
+  ParOptScalar b0;
+  const ParOptScalar *d, *M;
+  ParOptVec **Z;
+  int size = 0;
+  if (qn && use_qn) {
+    size = qn->getCompactMat(&b0, &d, &M, &Z);
+  }
+
+  // After this point the residuals are no longer required.
+  solveKKTDiagSystem(vars, res, step, xtmp1, wtmp);
+
+  if (size > 0) {
+    // dz = Z^{T}*px
+    step.x->mdot(Z, size, ztmp);
+
+    // Compute dz <- Ce^{-1}*dz
+    int one = 1, info = 0;
+    LAPACKdgetrs("N", &size, &one, Ce, &size, cpiv, ztmp, &size, &info);
+
+    // Compute rx = Z^{T}*dz
+    xtmp1->zeroEntries();
+    for (int i = 0; i < size; i++) {
+      xtmp1->axpy(ztmp[i], Z[i]);
+    }
+
+    // Solve the digaonal system again, this time simplifying
+    // the result due to the structure of the right-hand-side
+    solveKKTDiagSystem(vars, xtmp1, res, xtmp2, wtmp);
+
+    // Add the final contributions
+    step.subtract(res);
+  }
+}
+
+/*
+  Decide whether to solve the KKT system using a dense factorization
+  and allocate the storage that is required.
+
+  For problems with relatively few design variables and many dense
+  constraints, the bordered approach used in setUpKKTDiagSystem() and
+  setUpKKTSystem() requires ncon + size solves with the diagonal
+  system and two LU factorizations to compute each step. Instead, the
+  dense mode assembles the reduced KKT matrix explicitly
+
+  K = [ D              A^{T}   Z*diag{d} ]
+  .   [ A              -C0     0         ]
+  .   [ diag{d}*Z^{T}  0       M         ]
+
+  where D = Dinv^{-1} and C0 = Zs^{-1}*S + Zt^{-1}*T. Eliminating the
+  last block row recovers the compact quasi-Newton term
+  -Z*diag{d}*M^{-1}*diag{d}*Z^{T} in the (1,1) block. The matrix is
+  symmetric but indefinite and is factored once with the LAPACK
+  Bunch-Kaufman factorization dsytrf.
+
+  The matrix is gathered, factored and solved on the root processor.
+  The dense mode is only used when there are no sparse constraints,
+  when the KKT system is not solved with GMRES (use_hvec_product) and
+  when the number of design variables plus dense constraints is at
+  most dense_kkt_max_size.
+*/
+void ParOptInteriorPoint::initDenseKKTSystem(int use_hvec_product) {
+  const int max_size = options->getIntOption("dense_kkt_max_size");
+
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  dense_kkt = 0;
+  dense_kkt_qn = -1;
+  if (wcon_range[size] == 0 && !use_hvec_product &&
+      nvars_total + ncon <= max_size) {
+    dense_kkt = 1;
+  }
+
+  // Find the maximum dimension of the dense KKT matrix
+  int n = 0;
+  if (dense_kkt) {
+    n = nvars_total + ncon;
+    if (qn) {
+      n += qn->getMaxLimitedMemorySize();
+    }
+  }
+
+  if (n != dense_kkt_max_size) {
+    if (dense_K) {
+      delete[] dense_K;
+    }
+    if (dense_rhs) {
+      delete[] dense_rhs;
+    }
+    if (dense_work) {
+      delete[] dense_work;
+    }
+    if (dense_piv) {
+      delete[] dense_piv;
+    }
+    dense_K = NULL;
+    dense_rhs = NULL;
+    dense_work = NULL;
+    dense_lwork = 0;
+    dense_piv = NULL;
+    dense_kkt_max_size = n;
+
+    if (n > 0) {
+      dense_rhs = new ParOptScalar[n];
+
+      if (rank == opt_root) {
+        dense_K = new ParOptScalar[n * n];
+        dense_piv = new int[n];
+
+        // Query the optimal size of the work array
+        ParOptScalar work_size = 0.0;
+        int lwork = -1, info = 0;
+        LAPACKdsytrf("U", &n, dense_K, &n, dense_piv, &work_size, &lwork,
+                     &info);
+        dense_lwork = (int)ParOptRealPart(work_size);
+        if (dense_lwork < n) {
+          dense_lwork = n;
+        }
+        dense_work = new ParOptScalar[dense_lwork];
+      }
+    }
+  }
+}
+
+/*
+  Assemble and factor the dense KKT matrix described above. The
+  diagonal Dinv must be computed first by setUpKKTDiagSystem(). Only
+  the upper triangular part of the matrix is assembled, so that each
+  column of the constraint and quasi-Newton blocks can be gathered
+  directly from the distributed vectors.
+*/
+void ParOptInteriorPoint::factorDenseKKTSystem(ParOptVars &vars, int use_qn) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Get the compact quasi-Newton approximation
+  ParOptScalar b0;
+  const ParOptScalar *d = NULL, *M = NULL;
+  ParOptVec **Z = NULL;
+  int qn_size = 0;
+  if (qn && use_qn) {
+    qn_size = qn->getCompactMat(&b0, &d, &M, &Z);
+  }
+
+  // Set the dimension of the matrix
+  const int n = nvars_total;
+  int N = n + ncon + qn_size;
+  ParOptScalar *K = dense_K;
+  if (rank == opt_root) {
+    memset(K, 0, N * N * sizeof(ParOptScalar));
+  }
+
+  // Compute the counts/offsets from the variable ranges
+  int *counts = new int[size];
+  for (int k = 0; k < size; k++) {
+    counts[k] = var_range[k + 1] - var_range[k];
+  }
+
+  // Gather the diagonal and set D = Dinv^{-1}
+  ParOptScalar *dvals;
+  Dinv->getArray(&dvals);
+  MPI_Gatherv(dvals, nvars, PAROPT_MPI_TYPE, dense_rhs, counts, var_range,
+              PAROPT_MPI_TYPE, opt_root, comm);
+  if (rank == opt_root) {
+    for (int i = 0; i < n; i++) {
+      K[i * (N + 1)] = 1.0 / dense_rhs[i];
+    }
+  }
+
+  // Gather the constraint gradients into the columns of the matrix
+  for (int j = 0; j < ncon; j++) {
+    ParOptScalar *avals;
+    getConGradient(j)->getArray(&avals);
+    MPI_Gatherv(avals, nvars, PAROPT_MPI_TYPE, K ? &K[N * (n + j)] : NULL,
+                counts, var_range, PAROPT_MPI_TYPE, opt_root, comm);
+    if (rank == opt_root) {
+      K[(n + j) * (N + 1)] =
+          -(vars.s[j] / vars.zs[j] + vars.t[j] / vars.zt[j]);
+    }
+  }
+
+  // Gather the quasi-Newton vectors and add the small matrix M
+  for (int j = 0; j < qn_size; j++) {
+    const int col = n + ncon + j;
+    ParOptScalar *zvals;
+    Z[j]->getArray(&zvals);
+    MPI_Gatherv(zvals, nvars, PAROPT_MPI_TYPE, K ? &K[N * col] : NULL, counts,
+                var_range, PAROPT_MPI_TYPE, opt_root, comm);
+    if (rank == opt_root) {
+      for (int i = 0; i < n; i++) {
+        K[i + N * col] *= d[j];
+      }
+      for (int i = 0; i <= j; i++) {
+        K[(n + ncon + i) + N * col] = M[i + qn_size * j];
+      }
+    }
+  }
+
+  delete[] counts;
+
+  // Factor the matrix on the root processor
+  if (rank == opt_root) {
+    int info = 0;
+    LAPACKdsytrf("U", &N, K, &N, dense_piv, dense_work, &dense_lwork, &info);
+    if (info != 0) {
+      fprintf(stderr, "ParOpt: Dense KKT factorization failed with info = %d\n",
+              info);
+    }
+  }
+
+  dense_kkt_size = N;
+  dense_kkt_qn = (qn && use_qn) ? 1 : 0;
+}
+
+/*
+  Solve the KKT system y <- K^{-1}*b using the dense factorization.
+
+  The right-hand-side d1 is formed in the same manner as in
+  solveKKTDiagSystem(). The full right-hand-side is gathered on the
+  root processor, the design variable components of the solution are
+  scattered back and the remaining components of y are computed from
+  the steps in the design variables and dense constraint multipliers.
+*/
+void ParOptInteriorPoint::solveDenseKKTSystem(ParOptVars &vars, ParOptVars &b,
+                                              ParOptVars &y, ParOptVec *d1) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
 
-  Ce = Z^{T}*K^{-1}*Z - diag{d}^{-1}*M*diag{d}^{-1}
+  // Get the arrays for the variables and upper/lower bounds
+  ParOptScalar *xvals, *lbvals, *ubvals;
+  vars.x->getArray(&xvals);
+  lb->getArray(&lbvals);
+  ub->getArray(&ubvals);
 
-  The code computes the following:
+  // Get the arrays for the right-hand-sides
+  ParOptScalar *bzlvals, *bzuvals;
+  b.zl->getArray(&bzlvals);
+  b.zu->getArray(&bzuvals);
 
-  y <- K^{-1}*x - K^{-1}*Z*Ce^{-1}*Z^{T}*K^{-1}*x
+  // Compute d1 = bx + (X - Xl)^{-1}*bzl - (Xu - X)^{-1}*bzu
+  d1->copyValues(b.x);
 
-  The code computes the following:
+  ParOptScalar *d1vals;
+  d1->getArray(&d1vals);
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int i = lower_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    d1vals[i] += (bzlvals[kz] / (xvals[i] - lbvals[i]));
+  }
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int i = upper_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    d1vals[i] -= (bzuvals[kz] / (ubvals[i] - xvals[i]));
+  }
 
-  1. p = K^{-1}*r
-  2. ztemp = Z^{T}*p
-  3. ztemp <- Ce^{-1}*ztemp
-  4. rx = Z^{T}*ztemp
-  5. p -= K^{-1}*rx
-*/
-void ParOptInteriorPoint::computeKKTStep(ParOptVars &vars, ParOptVars &res,
-                                         ParOptVars &step, ParOptScalar *ztmp,
-                                         ParOptVec *xtmp1, ParOptVec *xtmp2,
-                                         ParOptVec *wtmp, int use_qn) {
-  // Get the size of the limited-memory BFGS subspace
-  ParOptScalar b0;
-  const ParOptScalar *d, *M;
-  ParOptVec **Z;
-  int size = 0;
-  if (qn && use_qn) {
-    size = qn->getCompactMat(&b0, &d, &M, &Z);
+  // Compute the counts/offsets from the variable ranges
+  int *counts = new int[size];
+  for (int k = 0; k < size; k++) {
+    counts[k] = var_range[k + 1] - var_range[k];
   }
 
-  // After this point the residuals are no longer required.
-  solveKKTDiagSystem(vars, res, step, xtmp1, wtmp);
+  // Gather the right-hand-side on the root processor
+  const int n = nvars_total;
+  MPI_Gatherv(d1vals, nvars, PAROPT_MPI_TYPE, dense_rhs, counts, var_range,
+              PAROPT_MPI_TYPE, opt_root, comm);
 
-  if (size > 0) {
-    // dz = Z^{T}*px
-    step.x->mdot(Z, size, ztmp);
+  if (rank == opt_root) {
+    // Set the right-hand-side for the dense constraints
+    // d3 = bz + Zs^{-1}*(bzs + S*bs) - Zt^{-1}*(bzt + T*bt)
+    for (int i = 0; i < ncon; i++) {
+      dense_rhs[n + i] = (b.z[i] + (b.zs[i] + vars.s[i] * b.s[i]) / vars.zs[i] -
+                          (b.zt[i] + vars.t[i] * b.t[i]) / vars.zt[i]);
+    }
+    for (int i = n + ncon; i < dense_kkt_size; i++) {
+      dense_rhs[i] = 0.0;
+    }
 
-    // Compute dz <- Ce^{-1}*dz
     int one = 1, info = 0;
-    LAPACKdgetrs("N", &size, &one, Ce, &size, cpiv, ztmp, &size, &info);
+    LAPACKdsytrs("U", &dense_kkt_size, &one, dense_K, &dense_kkt_size,
+                 dense_piv, dense_rhs, &dense_kkt_size, &info);
 
-    // Compute rx = Z^{T}*dz
-    xtmp1->zeroEntries();
-    for (int i = 0; i < size; i++) {
-      xtmp1->axpy(ztmp[i], Z[i]);
+    // The solution contains -yz
+    for (int i = 0; i < ncon; i++) {
+      y.z[i] = -dense_rhs[n + i];
     }
+  }
 
-    // Solve the digaonal system again, this time simplifying
-    // the result due to the structure of the right-hand-side
-    solveKKTDiagSystem(vars, xtmp1, res, xtmp2, wtmp);
+  // Distribute the step in the design variables and multipliers
+  ParOptScalar *yxvals;
+  y.x->getArray(&yxvals);
+  MPI_Scatterv(dense_rhs, counts, var_range, PAROPT_MPI_TYPE, yxvals, nvars,
+               PAROPT_MPI_TYPE, opt_root, comm);
+  MPI_Bcast(y.z, ncon, PAROPT_MPI_TYPE, opt_root, comm);
+  delete[] counts;
 
-    // Add the final contributions
-    step.subtract(res);
+  // Compute the step in the slack variables
+  for (int i = 0; i < ncon; i++) {
+    y.zs[i] = y.z[i] - b.s[i];
+    y.zt[i] = -b.t[i] - y.z[i];
+    y.s[i] = (b.zs[i] - vars.s[i] * y.zs[i]) / vars.zs[i];
+    y.t[i] = (b.zt[i] - vars.t[i] * y.zt[i]) / vars.zt[i];
+  }
+
+  // Retrieve the lagrange multipliers
+  ParOptScalar *zlvals, *zuvals;
+  vars.zl->getArray(&zlvals);
+  vars.zu->getArray(&zuvals);
+
+  // Retrieve the lagrange multiplier update vectors
+  ParOptScalar *yzlvals, *yzuvals;
+  y.zl->getArray(&yzlvals);
+  y.zu->getArray(&yzuvals);
+
+  // Compute the steps in the bound Lagrange multipliers
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int i = lower_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    yzlvals[kz] =
+        (bzlvals[kz] - zlvals[kz] * yxvals[i]) / (xvals[i] - lbvals[i]);
+  }
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int i = upper_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    yzuvals[kz] =
+        (bzuvals[kz] + zuvals[kz] * yxvals[i]) / (ubvals[i] - xvals[i]);
   }
 }
 
@@ -2740,7 +4055,6 @@ void ParOptInteriorPoint::computeKKTStep(ParOptVars &vars, ParOptVars &res,
   Compute the complementarity at the current solution
 */
 ParOptScalar ParOptInteriorPoint::computeComp(ParOptVars &vars) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   double rel_bound_barrier = options->getFloatOption("rel_bound_barrier");
 
   // Retrieve the values of the design variables, lower/upper bounds
@@ -2756,21 +4070,21 @@ ParOptScalar ParOptInteriorPoint::computeComp(ParOptVars &vars) {
   ParOptScalar product = 0.0, sum = 0.0;
 
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        product += zlvals[i] * (xvals[i] - lbvals[i]);
-        sum += 1.0;
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      product += zlvals[kz] * (xvals[i] - lbvals[i]);
     }
+    sum += num_lower_bounds;
   }
 
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        product += zuvals[i] * (ubvals[i] - xvals[i]);
-        sum += 1.0;
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      product += zuvals[kz] * (ubvals[i] - xvals[i]);
     }
+    sum += num_upper_bounds;
   }
 
   // Modify the complementarity by the bound scalar factor
@@ -2826,7 +4140,6 @@ ParOptScalar ParOptInteriorPoint::computeCompStep(ParOptVars &vars,
                                                   double alpha_x,
                                                   double alpha_z,
                                                   ParOptVars &step) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   double rel_bound_barrier = options->getFloatOption("rel_bound_barrier");
 
   // Retrieve the values of the design variables, lower/upper bounds
@@ -2847,23 +4160,23 @@ ParOptScalar ParOptInteriorPoint::computeCompStep(ParOptVars &vars,
   // Sum up the complementarity from each individual processor
   ParOptScalar product = 0.0, sum = 0.0;
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        ParOptScalar xnew = xvals[i] + alpha_x * pxvals[i];
-        product += (zlvals[i] + alpha_z * pzlvals[i]) * (xnew - lbvals[i]);
-        sum += 1.0;
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      ParOptScalar xnew = xvals[i] + alpha_x * pxvals[i];
+      product += (zlvals[kz] + alpha_z * pzlvals[kz]) * (xnew - lbvals[i]);
     }
+    sum += num_lower_bounds;
   }
 
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        ParOptScalar xnew = xvals[i] + alpha_x * pxvals[i];
-        product += (zuvals[i] + alpha_z * pzuvals[i]) * (ubvals[i] - xnew);
-        sum += 1.0;
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      int kz = (compact_bounds ? k : i);
+      ParOptScalar xnew = xvals[i] + alpha_x * pxvals[i];
+      product += (zuvals[kz] + alpha_z * pzuvals[kz]) * (ubvals[i] - xnew);
     }
+    sum += num_upper_bounds;
   }
 
   // Modify the complementarity by the bound scalar factor
@@ -2954,27 +4267,49 @@ void ParOptInteriorPoint::computeMaxStep(ParOptVars &vars, double tau,
   lb->getArray(&lbvals);
   ub->getArray(&ubvals);
 
-  // Check the design variable step
-  if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(pxvals[i]) < 0.0) {
-        double numer = ParOptRealPart(xvals[i] - lbvals[i]);
-        double alpha = -tau * numer / ParOptRealPart(pxvals[i]);
-        if (alpha < max_x) {
-          max_x = alpha;
-        }
+  // Retrieve the values of the lower/upper Lagrange multipliers
+  ParOptScalar *zlvals, *zuvals, *pzlvals, *pzuvals;
+  vars.zl->getArray(&zlvals);
+  vars.zu->getArray(&zuvals);
+  step.zl->getArray(&pzlvals);
+  step.zu->getArray(&pzuvals);
+
+  // Check the design variable and multiplier steps for the bounds in
+  // a single pass over the variables with lower and upper bounds
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int i = lower_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    if (ParOptRealPart(pxvals[i]) < 0.0) {
+      double numer = ParOptRealPart(xvals[i] - lbvals[i]);
+      double alpha = -tau * numer / ParOptRealPart(pxvals[i]);
+      if (alpha < max_x) {
+        max_x = alpha;
+      }
+    }
+    if (ParOptRealPart(pzlvals[kz]) < 0.0) {
+      double numer = ParOptRealPart(zlvals[kz]);
+      double alpha = -tau * numer / ParOptRealPart(pzlvals[kz]);
+      if (alpha < max_z) {
+        max_z = alpha;
       }
     }
   }
 
-  if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(pxvals[i]) > 0.0) {
-        double numer = ParOptRealPart(ubvals[i] - xvals[i]);
-        double alpha = tau * numer / ParOptRealPart(pxvals[i]);
-        if (alpha < max_x) {
-          max_x = alpha;
-        }
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int i = upper_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    if (ParOptRealPart(pxvals[i]) > 0.0) {
+      double numer = ParOptRealPart(ubvals[i] - xvals[i]);
+      double alpha = tau * numer / ParOptRealPart(pxvals[i]);
+      if (alpha < max_x) {
+        max_x = alpha;
+      }
+    }
+    if (ParOptRealPart(pzuvals[kz]) < 0.0) {
+      double numer = ParOptRealPart(zuvals[kz]);
+      double alpha = -tau * numer / ParOptRealPart(pzuvals[kz]);
+      if (alpha < max_z) {
+        max_z = alpha;
       }
     }
   }
@@ -3060,37 +4395,6 @@ void ParOptInteriorPoint::computeMaxStep(ParOptVars &vars, double tau,
     }
   }
 
-  // Retrieve the values of the lower/upper Lagrange multipliers
-  ParOptScalar *zlvals, *zuvals, *pzlvals, *pzuvals;
-  vars.zl->getArray(&zlvals);
-  vars.zu->getArray(&zuvals);
-  step.zl->getArray(&pzlvals);
-  step.zu->getArray(&pzuvals);
-
-  // Check the step for the lower/upper Lagrange multipliers
-  if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(pzlvals[i]) < 0.0) {
-        double numer = ParOptRealPart(zlvals[i]);
-        double alpha = -tau * numer / ParOptRealPart(pzlvals[i]);
-        if (alpha < max_z) {
-          max_z = alpha;
-        }
-      }
-    }
-  }
-  if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(pzuvals[i]) < 0.0) {
-        double numer = ParOptRealPart(zuvals[i]);
-        double alpha = -tau * numer / ParOptRealPart(pzuvals[i]);
-        if (alpha < max_z) {
-          max_z = alpha;
-        }
-      }
-    }
-  }
-
   // Compute the minimum step sizes from across all processors
   double input[2], output[2];
   input[0] = max_x;
@@ -3290,7 +4594,7 @@ void ParOptInteriorPoint::checkMeritFuncGradient(ParOptVec *xpt, double dh) {
     return;
   }
 
-  int fail_gobj = prob->evalObjConGradient(variables.x, g, Ac);
+  int fail_gobj = evalObjConGradient(variables.x);
   ngeval++;
   if (fail_gobj) {
     fprintf(stderr, "ParOpt: Gradient evaluation failed\n");
@@ -3470,9 +4774,10 @@ ParOptScalar ParOptInteriorPoint::evalInfeasDeriv(ParOptVars &vars,
   // Compute the infeasibility and directional derivative
   ParOptScalar dense_infeas = 0.0;
   ParOptScalar pdense_infeas = 0.0;
+  multConGradients(step.x, 0, ac_prod);
   for (int i = 0; i < ncon; i++) {
     ParOptScalar cval = (c[i] - vars.s[i] + vars.t[i]);
-    ParOptScalar pcval = (Ac[i]->dot(step.x) - step.s[i] + step.t[i]);
+    ParOptScalar pcval = (ac_prod[i] - step.s[i] + step.t[i]);
 
     dense_infeas += cval * cval;
     pdense_infeas += cval * pcval;
@@ -3525,7 +4830,6 @@ ParOptScalar ParOptInteriorPoint::evalMeritFunc(
     ParOptScalar fk, const ParOptScalar *ck, ParOptVec *xk,
     const ParOptScalar *sk, const ParOptScalar *tk, ParOptVec *swk,
     ParOptVec *twk) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   double rel_bound_barrier = options->getFloatOption("rel_bound_barrier");
 
   // Get the value of the lower/upper bounds and variables
@@ -3541,25 +4845,23 @@ ParOptScalar ParOptInteriorPoint::evalMeritFunc(
   ParOptScalar pos_result = 0.0, neg_result = 0.0;
 
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        if (ParOptRealPart(xvals[i] - lbvals[i]) > 1.0) {
-          pos_result += log(xvals[i] - lbvals[i]);
-        } else {
-          neg_result += log(xvals[i] - lbvals[i]);
-        }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      if (ParOptRealPart(xvals[i] - lbvals[i]) > 1.0) {
+        pos_result += log(xvals[i] - lbvals[i]);
+      } else {
+        neg_result += log(xvals[i] - lbvals[i]);
       }
     }
   }
 
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        if (ParOptRealPart(ubvals[i] - xvals[i]) > 1.0) {
-          pos_result += log(ubvals[i] - xvals[i]);
-        } else {
-          neg_result += log(ubvals[i] - xvals[i]);
-        }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      if (ParOptRealPart(ubvals[i] - xvals[i]) > 1.0) {
+        pos_result += log(ubvals[i] - xvals[i]);
+      } else {
+        neg_result += log(ubvals[i] - xvals[i]);
       }
     }
   }
@@ -3568,12 +4870,15 @@ ParOptScalar ParOptInteriorPoint::evalMeritFunc(
   pos_result *= rel_bound_barrier;
   neg_result *= rel_bound_barrier;
 
-  // Add the contributions to the log-barrier terms from
-  // weighted-sum sparse constraints
+  // Add the contributions to the log-barrier terms and the penalty
+  // terms from weighted-sum sparse constraints
+  ParOptScalar penalty = 0.0;
   if (nwcon > 0) {
-    ParOptScalar *sw, *tw;
+    ParOptScalar *sw, *tw, *gamma_sw, *gamma_tw;
     swk->getArray(&sw);
     twk->getArray(&tw);
+    penalty_gamma_sw->getArray(&gamma_sw);
+    penalty_gamma_tw->getArray(&gamma_tw);
 
     for (int i = 0; i < nwcon; i++) {
       if (ParOptRealPart(sw[i]) > 1.0) {
@@ -3586,19 +4891,22 @@ ParOptScalar ParOptInteriorPoint::evalMeritFunc(
       } else {
         neg_result += log(tw[i]);
       }
+      penalty += gamma_sw[i] * sw[i] + gamma_tw[i] * tw[i];
     }
   }
 
   // Sum up the result from all processors
-  ParOptScalar input[2];
-  ParOptScalar result[2];
+  ParOptScalar input[3];
+  ParOptScalar result[3];
   input[0] = pos_result;
   input[1] = neg_result;
-  MPI_Reduce(input, result, 2, PAROPT_MPI_TYPE, MPI_SUM, opt_root, comm);
+  input[2] = penalty;
+  MPI_Reduce(input, result, 3, PAROPT_MPI_TYPE, MPI_SUM, opt_root, comm);
 
   // Extract the result of the summation over all processors
   pos_result = result[0];
   neg_result = result[1];
+  penalty = result[2];
 
   // Add the contribution from the slack variables
   for (int i = 0; i < ncon; i++) {
@@ -3622,9 +4930,9 @@ ParOptScalar ParOptInteriorPoint::evalMeritFunc(
   ParOptScalar infeas = evalInfeas(ck, xk, sk, tk, swk, twk, wtemp);
 
   // The values of the merit function and its derivative
-  ParOptScalar merit =
-      fk + (penalty_gamma_sw->dot(swk) + penalty_gamma_tw->dot(twk)) -
-      barrier_param * (pos_result + neg_result) + rho_penalty_search * infeas;
+  ParOptScalar merit = fk + penalty -
+                       barrier_param * (pos_result + neg_result) +
+                       rho_penalty_search * infeas;
 
   for (int i = 0; i < ncon; i++) {
     merit += (penalty_gamma_s[i] * sk[i] + penalty_gamma_t[i] * tk[i]);
@@ -3658,7 +4966,6 @@ void ParOptInteriorPoint::evalMeritInitDeriv(ParOptVars &vars, ParOptVars &step,
       options->getFloatOption("min_rho_penalty_search");
   const double penalty_descent_fraction =
       options->getFloatOption("penalty_descent_fraction");
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   double rel_bound_barrier = options->getFloatOption("rel_bound_barrier");
   const double abs_res_tol = options->getFloatOption("abs_res_tol");
   const int use_diag_hessian = options->getBoolOption("use_diag_hessian");
@@ -3681,37 +4988,35 @@ void ParOptInteriorPoint::evalMeritInitDeriv(ParOptVars &vars, ParOptVars &step,
   ParOptScalar pos_presult = 0.0, neg_presult = 0.0;
 
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        if (ParOptRealPart(xvals[i] - lbvals[i]) > 1.0) {
-          pos_result += log(xvals[i] - lbvals[i]);
-        } else {
-          neg_result += log(xvals[i] - lbvals[i]);
-        }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      if (ParOptRealPart(xvals[i] - lbvals[i]) > 1.0) {
+        pos_result += log(xvals[i] - lbvals[i]);
+      } else {
+        neg_result += log(xvals[i] - lbvals[i]);
+      }
 
-        if (ParOptRealPart(pxvals[i]) > 0.0) {
-          pos_presult += pxvals[i] / (xvals[i] - lbvals[i]);
-        } else {
-          neg_presult += pxvals[i] / (xvals[i] - lbvals[i]);
-        }
+      if (ParOptRealPart(pxvals[i]) > 0.0) {
+        pos_presult += pxvals[i] / (xvals[i] - lbvals[i]);
+      } else {
+        neg_presult += pxvals[i] / (xvals[i] - lbvals[i]);
       }
     }
   }
 
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        if (ParOptRealPart(ubvals[i] - xvals[i]) > 1.0) {
-          pos_result += log(ubvals[i] - xvals[i]);
-        } else {
-          neg_result += log(ubvals[i] - xvals[i]);
-        }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      if (ParOptRealPart(ubvals[i] - xvals[i]) > 1.0) {
+        pos_result += log(ubvals[i] - xvals[i]);
+      } else {
+        neg_result += log(ubvals[i] - xvals[i]);
+      }
 
-        if (ParOptRealPart(pxvals[i]) > 0.0) {
-          neg_presult -= pxvals[i] / (ubvals[i] - xvals[i]);
-        } else {
-          pos_presult -= pxvals[i] / (ubvals[i] - xvals[i]);
-        }
+      if (ParOptRealPart(pxvals[i]) > 0.0) {
+        neg_presult -= pxvals[i] / (ubvals[i] - xvals[i]);
+      } else {
+        pos_presult -= pxvals[i] / (ubvals[i] - xvals[i]);
       }
     }
   }
@@ -3722,8 +5027,19 @@ void ParOptInteriorPoint::evalMeritInitDeriv(ParOptVars &vars, ParOptVars &step,
   pos_presult *= rel_bound_barrier;
   neg_presult *= rel_bound_barrier;
 
-  // Add the contributions to the log-barrier terms from
-  // weighted-sum sparse constraints
+  // Compute the local contribution to the objective directional
+  // derivative
+  ParOptScalar *gvals;
+  g->getArray(&gvals);
+
+  ParOptScalar gproj = 0.0;
+  for (int i = 0; i < nvars; i++) {
+    gproj += gvals[i] * pxvals[i];
+  }
+
+  // Add the contributions to the log-barrier terms and the penalty
+  // terms from weighted-sum sparse constraints
+  ParOptScalar penalty = 0.0, ppenalty = 0.0;
   if (nwcon > 0) {
     ParOptScalar *sw, *tw, *psw, *ptw;
     vars.sw->getArray(&sw);
@@ -3731,6 +5047,10 @@ void ParOptInteriorPoint::evalMeritInitDeriv(ParOptVars &vars, ParOptVars &step,
     step.sw->getArray(&psw);
     step.tw->getArray(&ptw);
 
+    ParOptScalar *gamma_sw, *gamma_tw;
+    penalty_gamma_sw->getArray(&gamma_sw);
+    penalty_gamma_tw->getArray(&gamma_tw);
+
     for (int i = 0; i < nwcon; i++) {
       if (ParOptRealPart(sw[i]) > 1.0) {
         pos_result += log(sw[i]);
@@ -3753,24 +5073,33 @@ void ParOptInteriorPoint::evalMeritInitDeriv(ParOptVars &vars, ParOptVars &step,
       } else {
         neg_presult += ptw[i] / tw[i];
       }
+
+      penalty += gamma_sw[i] * sw[i] + gamma_tw[i] * tw[i];
+      ppenalty += gamma_sw[i] * psw[i] + gamma_tw[i] * ptw[i];
     }
   }
 
   // Sum up the result from all processors
-  ParOptScalar input[4];
-  ParOptScalar result[4];
+  ParOptScalar input[7];
+  ParOptScalar result[7];
   input[0] = pos_result;
   input[1] = neg_result;
   input[2] = pos_presult;
   input[3] = neg_presult;
+  input[4] = gproj;
+  input[5] = penalty;
+  input[6] = ppenalty;
 
-  MPI_Reduce(input, result, 4, PAROPT_MPI_TYPE, MPI_SUM, opt_root, comm);
+  MPI_Reduce(input, result, 7, PAROPT_MPI_TYPE, MPI_SUM, opt_root, comm);
 
   // Extract the result of the summation over all processors
   pos_result = result[0];
   neg_result = result[1];
   pos_presult = result[2];
   neg_presult = result[3];
+  gproj = result[4];
+  penalty = result[5];
+  ppenalty = result[6];
 
   // Add the contribution from the slack variables
   for (int i = 0; i < ncon; i++) {
@@ -3821,14 +5150,12 @@ void ParOptInteriorPoint::evalMeritInitDeriv(ParOptVars &vars, ParOptVars &step,
     pTBp = 0.5 * xtmp->dot(step.x);
   }
 
-  // The values of the merit function and its derivative
+  // The values of the merit function and its derivative. Note that
+  // these are only correct on the root processor.
   ParOptScalar merit =
-      fobj + (penalty_gamma_sw->dot(vars.sw) + penalty_gamma_tw->dot(vars.tw)) -
-      barrier_param * (pos_result + neg_result);
+      fobj + penalty - barrier_param * (pos_result + neg_result);
   ParOptScalar pmerit =
-      g->dot(step.x) +
-      (penalty_gamma_sw->dot(step.sw) + penalty_gamma_tw->dot(step.tw)) -
-      barrier_param * (pos_presult + neg_presult);
+      gproj + ppenalty - barrier_param * (pos_presult + neg_presult);
 
   for (int i = 0; i < ncon; i++) {
     merit += (penalty_gamma_s[i] * vars.s[i] + penalty_gamma_t[i] * vars.t[i]);
@@ -3923,6 +5250,29 @@ void ParOptInteriorPoint::evalMeritInitDeriv(ParOptVars &vars, ParOptVars &step,
   rho_penalty_search = ParOptRealPart(input[2]);
 }
 
+/*
+  Set the trial point in the line search residual.x = x + alpha*px and
+  the corresponding slack variables
+*/
+void ParOptInteriorPoint::computeLineSearchPoint(double alpha) {
+  // Set rx = x + alpha*px
+  residual.x->copyValues(variables.x);
+  computeStepVec(residual.x, alpha, update.x, lb, NULL, ub, NULL);
+
+  // Set rsw = sw + alpha*psw and rtw = tw + alpha*ptw
+  ParOptScalar zero = 0.0;
+  residual.sw->copyValues(variables.sw);
+  computeStepVec(residual.sw, alpha, update.sw, NULL, &zero, NULL, NULL);
+  residual.tw->copyValues(variables.tw);
+  computeStepVec(residual.tw, alpha, update.tw, NULL, &zero, NULL, NULL);
+
+  // Set rs = s + alpha*ps and rt = t + alpha*pt
+  memcpy(residual.s, variables.s, ncon * sizeof(ParOptScalar));
+  computeStep(ncon, residual.s, alpha, update.s, NULL, &zero, NULL, NULL);
+  memcpy(residual.t, variables.t, ncon * sizeof(ParOptScalar));
+  computeStep(ncon, residual.t, alpha, update.t, NULL, &zero, NULL, NULL);
+}
+
 /**
   Perform a backtracking line search from the current point along the
   specified direction. Note that this is a very simple line search
@@ -3946,6 +5296,8 @@ int ParOptInteriorPoint::lineSearch(double alpha_min, double *_alpha,
   const double function_precision =
       options->getFloatOption("function_precision");
   const int output_level = options->getIntOption("output_level");
+  const int use_hvec_product = options->getBoolOption("use_hvec_product");
+  const int use_diag_hessian = options->getBoolOption("use_diag_hessian");
 
   // Perform a backtracking line search until the sufficient decrease
   // conditions are satisfied
@@ -3960,25 +5312,24 @@ int ParOptInteriorPoint::lineSearch(double alpha_min, double *_alpha,
   ParOptScalar best_merit = 0.0;
   double best_alpha = -1.0;
 
-  // Set pointers for the variables and search direction and temp variables
-  ParOptVec *x = variables.x;
+  // The step length where the problem was last evaluated
+  double eval_alpha = -1.0;
+
+  // Set up the processor groups for the parallel line search when the
+  // number of groups has changed
+  ls_accept = -1;
+  if (ls_factory && ls_num_groups !=
+                        options->getIntOption("num_line_search_groups")) {
+    initLineSearchGroups();
+  }
+  int num_groups = (ls_groups ? ls_groups->getNumGroups() : 0);
+
+  // Set pointers for the search direction and the trial point
   ParOptVec *px = update.x;
   ParOptVec *rx = residual.x;
-
-  ParOptScalar *s = variables.s;
-  ParOptScalar *ps = update.s;
   ParOptScalar *rs = residual.s;
-
-  ParOptScalar *t = variables.t;
-  ParOptScalar *pt = update.t;
   ParOptScalar *rt = residual.t;
-
-  ParOptVec *sw = variables.sw;
-  ParOptVec *psw = update.sw;
   ParOptVec *rsw = residual.sw;
-
-  ParOptVec *tw = variables.tw;
-  ParOptVec *ptw = update.tw;
   ParOptVec *rtw = residual.tw;
 
   int rank;
@@ -3995,82 +5346,170 @@ int ParOptInteriorPoint::lineSearch(double alpha_min, double *_alpha,
 
   int j = 0;
   for (; j < max_line_iters; j++) {
-    // Set rx = x + alpha*px
-    rx->copyValues(x);
-    computeStepVec(rx, alpha, px, lb, NULL, ub, NULL);
-
-    // Set rsw = sw + alpha*psw and rtw = tw + alpha*ptw
-    ParOptScalar zero = 0.0;
-    rsw->copyValues(sw);
-    computeStepVec(rsw, alpha, psw, NULL, &zero, NULL, NULL);
-    rtw->copyValues(tw);
-    computeStepVec(rtw, alpha, ptw, NULL, &zero, NULL, NULL);
-
-    // Set rs = s + alpha*ps and rt = t + alpha*pt
-    memcpy(rs, s, ncon * sizeof(ParOptScalar));
-    computeStep(ncon, rs, alpha, ps, NULL, &zero, NULL, NULL);
-    memcpy(rt, t, ncon * sizeof(ParOptScalar));
-    computeStep(ncon, rt, alpha, pt, NULL, &zero, NULL, NULL);
+    if (j > 0 && num_groups > 0) {
+      // Select a decreasing sequence of step lengths, one for each
+      // processor group, and evaluate them concurrently
+      int nalpha = 0;
+      double alpha_k = alpha;
+      while (nalpha < num_groups) {
+        ls_alpha[nalpha] = alpha_k;
+        nalpha++;
+        if (alpha_k <= alpha_min) {
+          fail |= PAROPT_LINE_SEARCH_MIN_STEP;
+          break;
+        }
+        alpha_k = 0.5 * alpha_k;
+        if (alpha_k < alpha_min) {
+          alpha_k = alpha_min;
+        }
+      }
 
-    // Evaluate the objective and constraints at the new point
-    int fail_obj = prob->evalObjCon(rx, &fobj, c);
-    neval++;
+      evalLineSearchGroups(nalpha);
+      neval += nalpha;
 
-    if (fail_obj) {
-      fprintf(stderr,
-              "ParOpt: Evaluation failed during line search, "
-              "trying new point\n");
-
-      // Multiply alpha by 1/10 to avoid the undefined region
-      alpha *= 0.1;
-      continue;
-    }
-
-    // Evaluate the merit function
-    merit = evalMeritFunc(fobj, c, rx, rs, rt, rsw, rtw);
-
-    // Print out the merit function and step at the current iterate
-    if (outfp && rank == opt_root && output_level > 0) {
-      fprintf(outfp, "%5d %7.1e %25.16e %12.5e\n", j + 1, alpha,
-              ParOptRealPart(merit), ParOptRealPart((merit - m0) / alpha));
-    }
-
-    // If the best alpha value is negative, then this must be the
-    // first successful evaluation. Otherwise, if this merit value
-    // is better than previous merit function values, store the new
-    // best merit function value.
-    if (best_alpha < 0.0 ||
-        ParOptRealPart(merit) < ParOptRealPart(best_merit)) {
-      best_alpha = alpha;
-      best_merit = merit;
-    }
-
-    // Check the sufficient decrease condition. Note that this is
-    // relaxed by the specified function precision. This allows
-    // acceptance of steps that violate the sufficient decrease
-    // condition within the precision limit of the objective/merit
-    // function.
-    if (ParOptRealPart(merit) - armijo_constant * alpha * ParOptRealPart(dm0) <
-        (ParOptRealPart(m0) + function_precision)) {
-      // If this is the minimum alpha value, then we're at the minimum
-      // line search step and we have had success
-      if (fail & PAROPT_LINE_SEARCH_MIN_STEP) {
-        fail = PAROPT_LINE_SEARCH_SUCCESS | PAROPT_LINE_SEARCH_MIN_STEP;
-      } else {
-        // We have successfully found a point
-        fail = PAROPT_LINE_SEARCH_SUCCESS;
+      // Find the largest step length that satisfies the sufficient
+      // decrease condition
+      int accept = -1;
+      double last_alpha = -1.0;
+      for (int k = 0; k < nalpha; k++) {
+        if (ls_fail[k]) {
+          fprintf(stderr,
+                  "ParOpt: Evaluation failed during line search, "
+                  "trying new point\n");
+          continue;
+        }
+
+        computeLineSearchPoint(ls_alpha[k]);
+        merit = evalMeritFunc(ls_fobj[k], &ls_con[k * ncon], rx, rs, rt, rsw,
+                              rtw);
+        last_alpha = ls_alpha[k];
+
+        if (outfp && rank == opt_root && output_level > 0) {
+          fprintf(outfp, "%5d %7.1e %25.16e %12.5e\n", j + 1, ls_alpha[k],
+                  ParOptRealPart(merit),
+                  ParOptRealPart((merit - m0) / ls_alpha[k]));
+        }
+
+        if (best_alpha < 0.0 ||
+            ParOptRealPart(merit) < ParOptRealPart(best_merit)) {
+          best_alpha = ls_alpha[k];
+          best_merit = merit;
+        }
+
+        if (ParOptRealPart(merit) -
+                armijo_constant * ls_alpha[k] * ParOptRealPart(dm0) <
+            (ParOptRealPart(m0) + function_precision)) {
+          accept = k;
+          break;
+        }
       }
 
-      // The line search may be successful but the merit function value may
-      // not have resulted in no improvement.
-      if ((ParOptRealPart(merit) <= ParOptRealPart(m0) + function_precision) &&
-          (ParOptRealPart(merit) + function_precision >= ParOptRealPart(m0))) {
-        fail |= PAROPT_LINE_SEARCH_NO_IMPROVEMENT;
+      if (accept >= 0) {
+        alpha = ls_alpha[accept];
+
+        // The gradients at the accepted point can be evaluated on its
+        // group, so the point is not evaluated again with the problem
+        // instance, unless the instance is used to evaluate the
+        // Jacobian or the Hessian at the new point
+        if (!ac_matfree && ac_nnz < 0 && !use_hvec_product &&
+            !use_diag_hessian) {
+          ls_accept = accept;
+          eval_alpha = alpha;
+          fobj = ls_fobj[accept];
+          memcpy(c, &ls_con[accept * ncon], ncon * sizeof(ParOptScalar));
+        }
+
+        if (alpha <= alpha_min) {
+          fail = PAROPT_LINE_SEARCH_SUCCESS | PAROPT_LINE_SEARCH_MIN_STEP;
+        } else {
+          fail = PAROPT_LINE_SEARCH_SUCCESS;
+        }
+
+        if ((ParOptRealPart(merit) <=
+             ParOptRealPart(m0) + function_precision) &&
+            (ParOptRealPart(merit) + function_precision >=
+             ParOptRealPart(m0))) {
+          fail |= PAROPT_LINE_SEARCH_NO_IMPROVEMENT;
+        }
+        break;
+      } else if (last_alpha < 0.0) {
+        // All the evaluations failed, reduce the step length
+        alpha = 0.1 * ls_alpha[nalpha - 1];
+        continue;
+      } else if (fail & PAROPT_LINE_SEARCH_MIN_STEP) {
+        break;
+      }
+
+      // Continue the line search from the smallest step length
+      alpha = last_alpha;
+    } else {
+      // Set the trial point rx = x + alpha*px and the slack variables
+      computeLineSearchPoint(alpha);
+
+      // Evaluate the objective and constraints at the new point
+      int fail_obj = prob->evalObjCon(rx, &fobj, c);
+      eval_alpha = alpha;
+      neval++;
+
+      if (fail_obj) {
+        fprintf(stderr,
+                "ParOpt: Evaluation failed during line search, "
+                "trying new point\n");
+
+        // Multiply alpha by 1/10 to avoid the undefined region
+        alpha *= 0.1;
+        continue;
+      }
+
+      // Evaluate the merit function
+      merit = evalMeritFunc(fobj, c, rx, rs, rt, rsw, rtw);
+
+      // Print out the merit function and step at the current iterate
+      if (outfp && rank == opt_root && output_level > 0) {
+        fprintf(outfp, "%5d %7.1e %25.16e %12.5e\n", j + 1, alpha,
+                ParOptRealPart(merit), ParOptRealPart((merit - m0) / alpha));
+      }
+
+      // If the best alpha value is negative, then this must be the
+      // first successful evaluation. Otherwise, if this merit value
+      // is better than previous merit function values, store the new
+      // best merit function value.
+      if (best_alpha < 0.0 ||
+          ParOptRealPart(merit) < ParOptRealPart(best_merit)) {
+        best_alpha = alpha;
+        best_merit = merit;
+      }
+
+      // Check the sufficient decrease condition. Note that this is
+      // relaxed by the specified function precision. This allows
+      // acceptance of steps that violate the sufficient decrease
+      // condition within the precision limit of the objective/merit
+      // function.
+      if (ParOptRealPart(merit) -
+              armijo_constant * alpha * ParOptRealPart(dm0) <
+          (ParOptRealPart(m0) + function_precision)) {
+        // If this is the minimum alpha value, then we're at the minimum
+        // line search step and we have had success
+        if (fail & PAROPT_LINE_SEARCH_MIN_STEP) {
+          fail = PAROPT_LINE_SEARCH_SUCCESS | PAROPT_LINE_SEARCH_MIN_STEP;
+        } else {
+          // We have successfully found a point
+          fail = PAROPT_LINE_SEARCH_SUCCESS;
+        }
+
+        // The line search may be successful but the merit function value may
+        // not have resulted in no improvement.
+        if ((ParOptRealPart(merit) <=
+             ParOptRealPart(m0) + function_precision) &&
+            (ParOptRealPart(merit) + function_precision >=
+             ParOptRealPart(m0))) {
+          fail |= PAROPT_LINE_SEARCH_NO_IMPROVEMENT;
+        }
+        break;
+      } else if (fail & PAROPT_LINE_SEARCH_MIN_STEP) {
+        // If this is the minimum alpha value, then quit the line search loop
+        break;
       }
-      break;
-    } else if (fail & PAROPT_LINE_SEARCH_MIN_STEP) {
-      // If this is the minimum alpha value, then quit the line search loop
-      break;
     }
 
     // Update the new value of alpha
@@ -4121,30 +5560,28 @@ int ParOptInteriorPoint::lineSearch(double alpha_min, double *_alpha,
       fail |= PAROPT_LINE_SEARCH_NO_IMPROVEMENT;
     }
 
-    // If we're about to accept the best alpha value, then we have
-    // to re-evaluate the function at this point since the gradient
-    // will be evaluated here next, and we always have to evaluate
-    // function then gradient.
-    if (alpha != best_alpha) {
-      alpha = best_alpha;
+    alpha = best_alpha;
+  }
 
-      // Set rx = x + alpha*px
-      rx->copyValues(x);
-      computeStepVec(rx, alpha, px, lb, NULL, ub, NULL);
+  // If we're about to accept a point where the problem instance was
+  // not last evaluated (either the best alpha value or a point
+  // evaluated on a processor group whose gradients cannot be used),
+  // then we have to re-evaluate the function at this point since the
+  // gradient will be evaluated here next, and we always have to
+  // evaluate function then gradient.
+  if (alpha >= 0.0 && alpha != eval_alpha) {
+    computeLineSearchPoint(alpha);
 
-      // Evaluate the objective and constraints at the new point
-      int fail_obj = prob->evalObjCon(rx, &fobj, c);
-      neval++;
+    // Evaluate the objective and constraints at the new point
+    int fail_obj = prob->evalObjCon(rx, &fobj, c);
+    neval++;
 
-      // This should not happen, since we've already evaluated
-      // the function at this point at a previous line search
-      // iteration.
-      if (fail_obj) {
-        fprintf(stderr, "ParOpt: Evaluation failed during line search\n");
-        fail = PAROPT_LINE_SEARCH_FAILURE;
-      }
-    } else {
-      alpha = best_alpha;
+    // This should not happen, since we've already evaluated
+    // the function at this point at a previous line search
+    // iteration.
+    if (fail_obj) {
+      fprintf(stderr, "ParOpt: Evaluation failed during line search\n");
+      fail = PAROPT_LINE_SEARCH_FAILURE;
     }
   }
 
@@ -4155,6 +5592,36 @@ int ParOptInteriorPoint::lineSearch(double alpha_min, double *_alpha,
   return fail;
 }
 
+/*
+  Compute the contribution of the matrix-free dense constraint Jacobian
+  at the current point to the quasi-Newton update.
+
+  The Jacobian-vector products use the Jacobian at the point of the
+  last call to evalObjCon, so they must be computed before the line
+  search evaluates the trial points. This computes
+
+  y_qn = -g + A^{T}*z,    ac_vec = A^{T}*pz
+
+  so that the gradient of the Lagrangian with the multipliers after a
+  step of length alpha is -y_qn - alpha*ac_vec.
+*/
+void ParOptInteriorPoint::initMatFreeQuasiNewtonUpdate(ParOptVars &vars,
+                                                       ParOptVars &step) {
+  const int use_quasi_newton_update =
+      options->getBoolOption("use_quasi_newton_update");
+
+  ac_qn_init = 0;
+  if (ac_matfree && qn && use_quasi_newton_update) {
+    y_qn->copyValues(g);
+    y_qn->scale(-1.0);
+    addConGradients(1.0, vars.z, y_qn);
+
+    ac_vec->zeroEntries();
+    addConGradients(1.0, step.z, ac_vec);
+    ac_qn_init = 1;
+  }
+}
+
 /**
   Compute the step, evaluate the objective and constraints and their gradients
   at the new point and update the quasi-Newton approximation.
@@ -4172,6 +5639,14 @@ int ParOptInteriorPoint::computeStepAndUpdate(ParOptVars &vars, double alpha,
                                               int perform_qn_update) {
   const int use_quasi_newton_update =
       options->getBoolOption("use_quasi_newton_update");
+  const int use_hvec_product = options->getBoolOption("use_hvec_product");
+
+  // When the Hessian of the Lagrangian is constant and the problem
+  // provides its exact products, the curvature is already known and
+  // the quasi-Newton approximation is not updated
+  if (constant_hessian && use_hvec_product) {
+    perform_qn_update = 0;
+  }
 
   // Set the new values of the variables
   ParOptScalar zero = 0.0;
@@ -4197,11 +5672,15 @@ int ParOptInteriorPoint::computeStepAndUpdate(ParOptVars &vars, double alpha,
   // Compute the negative gradient of the Lagrangian using the
   // old gradient information with the new multiplier estimates
   if (qn && perform_qn_update && use_quasi_newton_update) {
-    y_qn->copyValues(g);
-    y_qn->scale(-1.0);
+    if (ac_qn_init && !eval_obj_con) {
+      // The products with the matrix-free Jacobian at the old point
+      // were computed before the line search
+      y_qn->axpy(alpha, ac_vec);
+    } else {
+      y_qn->copyValues(g);
+      y_qn->scale(-1.0);
 
-    for (int i = 0; i < ncon; i++) {
-      y_qn->axpy(vars.z[i], Ac[i]);
+      addConGradients(1.0, vars.z, y_qn);
     }
 
     // Add the term: Aw^{T}*zw
@@ -4210,6 +5689,8 @@ int ParOptInteriorPoint::computeStepAndUpdate(ParOptVars &vars, double alpha,
     }
   }
 
+  ac_qn_init = 0;
+
   // Apply the step to the design variables only
   // after computing the contribution of the constraint
   // Jacobian to the BFGS update
@@ -4227,7 +5708,7 @@ int ParOptInteriorPoint::computeStepAndUpdate(ParOptVars &vars, double alpha,
   }
 
   // Evaluate the derivative at the new point
-  int fail_gobj = prob->evalObjConGradient(vars.x, g, Ac);
+  int fail_gobj = evalObjConGradient(vars.x);
   ngeval++;
   if (fail_gobj) {
     fprintf(stderr,
@@ -4246,9 +5727,7 @@ int ParOptInteriorPoint::computeStepAndUpdate(ParOptVars &vars, double alpha,
 
       // Finish computing the difference in gradients
       y_qn->axpy(1.0, g);
-      for (int i = 0; i < ncon; i++) {
-        y_qn->axpy(-vars.z[i], Ac[i]);
-      }
+      addConGradients(-1.0, vars.z, y_qn);
 
       // Add the term: -Aw^{T}*zw
       if (nwcon > 0) {
@@ -4277,8 +5756,14 @@ int ParOptInteriorPoint::computeStepAndUpdate(ParOptVars &vars, double alpha,
 void ParOptInteriorPoint::initAndCheckDesignAndBounds() {
   const double max_bound_value = options->getFloatOption("max_bound_value");
 
-  // Get the design variables and bounds
-  prob->getVarsAndBounds(variables.x, lb, ub);
+  // Get the design variables and bounds. The design variables read
+  // from a checkpoint file or set for a warm start replace the starting
+  // point of the problem.
+  if (checkpoint_restart || warm_start) {
+    prob->getVarsAndBounds(update.x, lb, ub);
+  } else {
+    prob->getVarsAndBounds(variables.x, lb, ub);
+  }
 
   // Check the design variables and bounds, move things that
   // don't make sense and print some warnings
@@ -4343,20 +5828,473 @@ void ParOptInteriorPoint::initAndCheckDesignAndBounds() {
     }
   }
 
-  // Set the largrange multipliers with bounds outside the limits to
-  // zero. This ensures that they have no effect because they will not
-  // be updated once the optimization begins.
-  ParOptScalar *zlvals, *zuvals;
+  // Record which variables have finite lower/upper bounds and set up
+  // the storage for the bound multipliers
+  initBoundIndices();
+}
+
+/*
+  Find the local indices of the variables with finite lower and upper
+  bounds.
+
+  The bounds are classified once here, rather than on every call to
+  the kernels that compute the residuals, the diagonal KKT system,
+  the complementarity and the maximum step. These loop directly over
+  the bounded variables without testing the bound values against
+  max_bound_value. A variable with both bounds appears in both index
+  sets and a free variable appears in neither. When the lower or upper
+  bounds are not used, the corresponding index set is empty.
+
+  With the compact_bound_multipliers option, the bound multipliers
+  zl/zu are stored in a compressed layout where entry k corresponds to
+  the design variable lower_bound_index[k] (or upper_bound_index[k]).
+  When the set of bounded variables changes, the multipliers are
+  re-allocated. The values of the multipliers for variables that
+  remain bounded are retained and the remaining multipliers are set to
+  zero. Otherwise, the multipliers are design vectors created by the
+  problem, and the entries for the variables without the bound are
+  not used.
+
+  This must be called whenever the bounds are modified.
+*/
+void ParOptInteriorPoint::initBoundIndices() {
+  const double max_bound_value = options->getFloatOption("max_bound_value");
+
+  ParOptScalar *lbvals, *ubvals;
+  lb->getArray(&lbvals);
+  ub->getArray(&ubvals);
+
+  // Count up the number of bounded variables
+  int nlower = 0, nupper = 0;
+  for (int i = 0; i < nvars; i++) {
+    if (use_lower && ParOptRealPart(lbvals[i]) > -max_bound_value) {
+      nlower++;
+    }
+    if (use_upper && ParOptRealPart(ubvals[i]) < max_bound_value) {
+      nupper++;
+    }
+  }
+
+  // Find the indices of the bounded variables
+  int *lower_index = new int[nlower];
+  int *upper_index = new int[nupper];
+  nlower = nupper = 0;
+  for (int i = 0; i < nvars; i++) {
+    if (use_lower && ParOptRealPart(lbvals[i]) > -max_bound_value) {
+      lower_index[nlower] = i;
+      nlower++;
+    }
+    if (use_upper && ParOptRealPart(ubvals[i]) < max_bound_value) {
+      upper_index[nupper] = i;
+      nupper++;
+    }
+  }
+
+  // Re-allocate the lower bound multipliers if the layout changed
+  if (!variables.zl || nlower != num_lower_bounds ||
+      memcmp(lower_index, lower_bound_index, nlower * sizeof(int)) != 0) {
+    if (compact_bounds) {
+      ParOptReplaceVec(&variables.zl,
+                       ParOptRemapBoundVec(comm, variables.zl,
+                                           num_lower_bounds, lower_bound_index,
+                                           nlower, lower_index));
+      ParOptReplaceVec(&residual.zl, new ParOptBasicVec(comm, nlower));
+      ParOptReplaceVec(&update.zl, new ParOptBasicVec(comm, nlower));
+      ParOptReplaceVec(&refine.zl, new ParOptBasicVec(comm, nlower));
+    } else if (!variables.zl) {
+      ParOptReplaceVec(&variables.zl, prob->createDesignVec());
+      ParOptReplaceVec(&residual.zl, prob->createDesignVec());
+      ParOptReplaceVec(&update.zl, prob->createDesignVec());
+      ParOptReplaceVec(&refine.zl, prob->createDesignVec());
+    } else {
+      residual.zl->zeroEntries();
+      update.zl->zeroEntries();
+      refine.zl->zeroEntries();
+    }
+  }
+  if (lower_bound_index) {
+    delete[] lower_bound_index;
+  }
+  num_lower_bounds = nlower;
+  lower_bound_index = lower_index;
+
+  // Re-allocate the upper bound multipliers if the layout changed
+  if (!variables.zu || nupper != num_upper_bounds ||
+      memcmp(upper_index, upper_bound_index, nupper * sizeof(int)) != 0) {
+    if (compact_bounds) {
+      ParOptReplaceVec(&variables.zu,
+                       ParOptRemapBoundVec(comm, variables.zu,
+                                           num_upper_bounds, upper_bound_index,
+                                           nupper, upper_index));
+      ParOptReplaceVec(&residual.zu, new ParOptBasicVec(comm, nupper));
+      ParOptReplaceVec(&update.zu, new ParOptBasicVec(comm, nupper));
+      ParOptReplaceVec(&refine.zu, new ParOptBasicVec(comm, nupper));
+    } else if (!variables.zu) {
+      ParOptReplaceVec(&variables.zu, prob->createDesignVec());
+      ParOptReplaceVec(&residual.zu, prob->createDesignVec());
+      ParOptReplaceVec(&update.zu, prob->createDesignVec());
+      ParOptReplaceVec(&refine.zu, prob->createDesignVec());
+    } else {
+      residual.zu->zeroEntries();
+      update.zu->zeroEntries();
+      refine.zu->zeroEntries();
+    }
+  }
+  if (upper_bound_index) {
+    delete[] upper_bound_index;
+  }
+  num_upper_bounds = nupper;
+  upper_bound_index = upper_index;
+}
+
+/*
+  Copy the compressed bound multipliers into the design-length vectors
+  zl_full/zu_full. The entries for variables without the bound are zero.
+*/
+void ParOptInteriorPoint::expandBoundMultipliers() {
+  if (!zl_full) {
+    zl_full = prob->createDesignVec();
+    zl_full->incref();
+    zu_full = prob->createDesignVec();
+    zu_full->incref();
+  }
+
+  ParOptScalar *zlvals, *zuvals, *zlfull, *zufull;
   variables.zl->getArray(&zlvals);
   variables.zu->getArray(&zuvals);
+  zl_full->getArray(&zlfull);
+  zu_full->getArray(&zufull);
 
-  for (int i = 0; i < nvars; i++) {
-    if (ParOptRealPart(lbvals[i]) <= -max_bound_value) {
-      zlvals[i] = 0.0;
+  zl_full->zeroEntries();
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int i = lower_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    zlfull[i] = zlvals[kz];
+  }
+  zu_full->zeroEntries();
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int i = upper_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    zufull[i] = zuvals[kz];
+  }
+}
+
+/*
+  Set the compressed bound multipliers from the design-length vectors
+  zl_full/zu_full. The entries for variables without the bound are
+  ignored.
+*/
+void ParOptInteriorPoint::compressBoundMultipliers() {
+  ParOptScalar *zlvals, *zuvals, *zlfull, *zufull;
+  variables.zl->getArray(&zlvals);
+  variables.zu->getArray(&zuvals);
+  zl_full->getArray(&zlfull);
+  zu_full->getArray(&zufull);
+
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int i = lower_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    zlvals[kz] = zlfull[i];
+  }
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int i = upper_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    zuvals[kz] = zufull[i];
+  }
+}
+
+/*
+  Add the contribution from the bound multipliers to a design vector
+
+  out += alpha*(zl - zu)
+
+  where the compressed multipliers are added to the entries of the
+  bounded variables.
+*/
+void ParOptInteriorPoint::addBoundMultipliers(ParOptScalar alpha,
+                                              ParOptVars &vars,
+                                              ParOptVec *out) {
+  ParOptScalar *outvals, *zlvals, *zuvals;
+  out->getArray(&outvals);
+  vars.zl->getArray(&zlvals);
+  vars.zu->getArray(&zuvals);
+
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int i = lower_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    outvals[i] += alpha * zlvals[kz];
+  }
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int i = upper_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    outvals[i] -= alpha * zuvals[kz];
+  }
+}
+
+/*
+  Allocate the storage for the dense constraint gradients.
+
+  If the problem provides Jacobian-vector products for the dense
+  constraints, the gradients are not stored. Instead, a block of work
+  vectors is allocated for the batched products. If the problem
+  provides a non-zero pattern for the dense constraint gradients, only
+  the local non-zero entries are stored. Otherwise, each constraint
+  gradient is stored as a design vector in Ac.
+*/
+void ParOptInteriorPoint::initConGradients() {
+  if (Ac) {
+    for (int i = 0; i < ncon; i++) {
+      Ac[i]->decref();
+    }
+    delete[] Ac;
+    Ac = NULL;
+  }
+  if (ac_rowp) {
+    delete[] ac_rowp;
+    delete[] ac_cols;
+    delete[] ac_vals;
+    ac_rowp = ac_cols = NULL;
+    ac_vals = NULL;
+  }
+  if (ac_vec) {
+    ac_vec->decref();
+    ac_vec = NULL;
+  }
+  if (ac_batch) {
+    for (int i = 0; i < ac_block_size; i++) {
+      ac_batch[i]->decref();
+    }
+    delete[] ac_batch;
+    delete[] ac_zwork;
+    ac_batch = NULL;
+    ac_zwork = NULL;
+  }
+  ac_x = NULL;
+  ac_qn_init = 0;
+
+  // All processors must use the same form of the Jacobian
+  ac_matfree = (prob->useDenseJacobianProducts() ? 1 : 0);
+  MPI_Allreduce(MPI_IN_PLACE, &ac_matfree, 1, MPI_INT, MPI_MIN, comm);
+
+  if (ac_matfree) {
+    ac_nnz = -1;
+    ac_block_size = options->getIntOption("jacobian_product_block_size");
+    if (ac_block_size > ncon) {
+      ac_block_size = (ncon > 0 ? ncon : 1);
+    }
+
+    ac_vec = prob->createDesignVec();
+    ac_vec->incref();
+    ac_batch = new ParOptVec *[ac_block_size];
+    for (int i = 0; i < ac_block_size; i++) {
+      ac_batch[i] = prob->createDesignVec();
+      ac_batch[i]->incref();
+    }
+    ac_zwork = new ParOptScalar[ac_block_size * ncon + 1];
+    return;
+  }
+
+  const int *rowp, *cols;
+  ac_nnz = prob->getConGradientPattern(&rowp, &cols);
+
+  // Check that the pattern is consistent
+  if (ac_nnz >= 0) {
+    int fail = (!rowp || (ac_nnz > 0 && !cols));
+    if (!fail) {
+      fail = (rowp[0] != 0 || rowp[ncon] != ac_nnz);
+      for (int i = 0; i < ncon; i++) {
+        if (rowp[i + 1] < rowp[i]) {
+          fail = 1;
+        }
+      }
+    }
+    for (int jp = 0; !fail && jp < ac_nnz; jp++) {
+      if (cols[jp] < 0 || cols[jp] >= nvars) {
+        fail = 1;
+      }
+    }
+    if (fail) {
+      fprintf(stderr,
+              "ParOpt: Invalid constraint gradient pattern, using dense "
+              "constraint gradients\n");
+      ac_nnz = -1;
+    }
+  }
+
+  // All processors must use the same storage format
+  MPI_Allreduce(MPI_IN_PLACE, &ac_nnz, 1, MPI_INT, MPI_MIN, comm);
+
+  if (ac_nnz >= 0) {
+    prob->getConGradientPattern(&rowp, &cols);
+    ac_nnz = rowp[ncon];
+    ac_rowp = new int[ncon + 1];
+    ac_cols = new int[ac_nnz > 0 ? ac_nnz : 1];
+    ac_vals = new ParOptScalar[ac_nnz > 0 ? ac_nnz : 1];
+    memcpy(ac_rowp, rowp, (ncon + 1) * sizeof(int));
+    if (ac_nnz > 0) {
+      memcpy(ac_cols, cols, ac_nnz * sizeof(int));
+    }
+    memset(ac_vals, 0, ac_nnz * sizeof(ParOptScalar));
+
+    ac_vec = prob->createDesignVec();
+    ac_vec->incref();
+  } else {
+    Ac = new ParOptVec *[ncon];
+    for (int i = 0; i < ncon; i++) {
+      Ac[i] = prob->createDesignVec();
+      Ac[i]->incref();
+    }
+  }
+}
+
+/*
+  Find the linear dense constraints and check whether the Hessian of
+  the Lagrangian is constant. The gradients of the linear constraints
+  are evaluated again at the next gradient evaluation.
+*/
+void ParOptInteriorPoint::initLinearity() {
+  num_linear_cons = 0;
+  for (int i = 0; i < ncon; i++) {
+    con_linear[i] = (prob->isDenseConLinear(i) ? 1 : 0);
+    num_linear_cons += con_linear[i];
+  }
+  linear_grad_init = 0;
+
+  constant_hessian = 0;
+  if (prob->isObjQuadratic() && num_linear_cons == ncon &&
+      (nwcon == 0 || prob->isSparseConLinear())) {
+    constant_hessian = 1;
+  }
+}
+
+/*
+  Evaluate the objective and dense constraint gradients at x
+
+  After the first successful evaluation, the stored gradients of the
+  linear dense constraints are not overwritten again.
+*/
+int ParOptInteriorPoint::evalObjConGradient(ParOptVec *x) {
+  int fail = 0;
+  if (ac_matfree) {
+    ac_x = x;
+    fail = prob->evalObjGradient(x, g);
+  } else if (ac_nnz >= 0) {
+    fail = prob->evalObjConSparseGradient(x, g, ac_vals);
+  } else if (num_linear_cons > 0 && linear_grad_init) {
+    // The gradients of the linear constraints are written to a scratch
+    // vector and discarded so that the stored values are kept
+    if (!ac_vec) {
+      ac_vec = prob->createDesignVec();
+      ac_vec->incref();
+    }
+    for (int i = 0; i < ncon; i++) {
+      ac_eval[i] = (con_linear[i] ? ac_vec : Ac[i]);
+    }
+    if (ls_accept >= 0) {
+      fail = ls_groups->evalObjConGradient(ls_accept, g, ac_eval);
+    } else {
+      fail = prob->evalObjConGradient(x, g, ac_eval);
+    }
+  } else if (ls_accept >= 0) {
+    // The point was accepted by the parallel line search, so the
+    // gradients are evaluated on the group that evaluated the point
+    fail = ls_groups->evalObjConGradient(ls_accept, g, Ac);
+  } else {
+    fail = prob->evalObjConGradient(x, g, Ac);
+  }
+  ls_accept = -1;
+
+  if (!fail) {
+    linear_grad_init = 1;
+  }
+
+  return fail;
+}
+
+/*
+  Get the i-th dense constraint gradient as a design vector. With the
+  sparse format or the Jacobian-vector products, the gradient is
+  computed in a work vector that is over-written by the next call.
+*/
+ParOptVec *ParOptInteriorPoint::getConGradient(int i) {
+  if (ac_matfree) {
+    memset(ac_zwork, 0, ncon * sizeof(ParOptScalar));
+    ac_zwork[i] = 1.0;
+    ac_vec->zeroEntries();
+    prob->addDenseJacobianTranspose(1.0, ac_x, 1, ac_zwork, &ac_vec);
+    return ac_vec;
+  } else if (ac_nnz < 0) {
+    return Ac[i];
+  }
+
+  ParOptScalar *avals;
+  ac_vec->zeroEntries();
+  ac_vec->getArray(&avals);
+  for (int jp = ac_rowp[i]; jp < ac_rowp[i + 1]; jp++) {
+    avals[ac_cols[jp]] = ac_vals[jp];
+  }
+
+  return ac_vec;
+}
+
+/*
+  Add the dense constraint gradients to a design vector:
+
+  out += alpha*Ac^{T}*z
+*/
+void ParOptInteriorPoint::addConGradients(ParOptScalar alpha,
+                                          const ParOptScalar *z,
+                                          ParOptVec *out) {
+  if (ac_matfree) {
+    prob->addDenseJacobianTranspose(alpha, ac_x, 1, z, &out);
+  } else if (ac_nnz < 0) {
+    for (int i = 0; i < ncon; i++) {
+      out->axpy(alpha * z[i], Ac[i]);
+    }
+  } else {
+    ParOptScalar *outvals;
+    out->getArray(&outvals);
+    for (int i = 0; i < ncon; i++) {
+      ParOptScalar scale = alpha * z[i];
+      for (int jp = ac_rowp[i]; jp < ac_rowp[i + 1]; jp++) {
+        outvals[ac_cols[jp]] += scale * ac_vals[jp];
+      }
     }
-    if (ParOptRealPart(ubvals[i]) >= max_bound_value) {
-      zuvals[i] = 0.0;
+  }
+}
+
+/*
+  Compute the products of the dense constraint gradients with a design
+  vector for the constraints start <= i < ncon:
+
+  out[i - start] = Ac[i]^{T}*px
+
+  This is a collective call and requires a single reduction.
+*/
+void ParOptInteriorPoint::multConGradients(ParOptVec *px, int start,
+                                           ParOptScalar *out) {
+  int n = ncon - start;
+  if (n <= 0) {
+    return;
+  }
+
+  if (ac_matfree) {
+    memset(ac_zwork, 0, ncon * sizeof(ParOptScalar));
+    prob->addDenseJacobian(1.0, ac_x, 1, &px, ac_zwork);
+    memcpy(out, &ac_zwork[start], n * sizeof(ParOptScalar));
+  } else if (ac_nnz < 0) {
+    px->mdot(&Ac[start], n, out);
+  } else {
+    ParOptScalar *pxvals;
+    px->getArray(&pxvals);
+    for (int i = start; i < ncon; i++) {
+      ParOptScalar sum = 0.0;
+      for (int jp = ac_rowp[i]; jp < ac_rowp[i + 1]; jp++) {
+        sum += ac_vals[jp] * pxvals[ac_cols[jp]];
+      }
+      out[i - start] = sum;
     }
+    MPI_Allreduce(MPI_IN_PLACE, out, n, PAROPT_MPI_TYPE, MPI_SUM, comm);
   }
 }
 
@@ -4429,8 +6367,6 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
   // switch to the specified strategy after the first barrier problem is
   // solved
   const char *barrier_name = options->getEnumOption("barrier_strategy");
-  ParOptBarrierStrategy barrier_strategy = PAROPT_MONOTONE;
-
   ParOptBarrierStrategy input_barrier_strategy =
       PAROPT_COMPLEMENTARITY_FRACTION;
   if (strcmp(barrier_name, "monotone") == 0) {
@@ -4441,11 +6377,14 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
     input_barrier_strategy = PAROPT_MEHROTRA_PREDICTOR_CORRECTOR;
   }
 
-  // Set the initial barrier parameter
-  barrier_param = options->getFloatOption("init_barrier_param");
-
-  // Set the initial value of the penalty parameter for the line search
-  rho_penalty_search = options->getFloatOption("init_rho_penalty_search");
+  // Set the initial barrier parameter and the initial value of the
+  // penalty parameter for the line search, unless the optimization is
+  // restarted from the state read from a checkpoint file
+  if (!checkpoint_restart) {
+    barrier_strategy = PAROPT_MONOTONE;
+    barrier_param = options->getFloatOption("init_barrier_param");
+    rho_penalty_search = options->getFloatOption("init_rho_penalty_search");
+  }
 
   // Maximum number of iterations (major since we sometimes use GMRES an
   // the inner loop)
@@ -4470,12 +6409,25 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
 
   // Check if the GMRES subspace is large enough
   int m = options->getIntOption("gmres_subspace_size");
-  if (m != gmres_subspace_size) {
+  int k = options->getIntOption("gmres_recycle_size");
+  if (k > m) {
+    k = m;
+  }
+  if (m != gmres_subspace_size || k != gmres_recycle_size) {
     setGMRESSubspaceSize(m);
   }
 
+  // Find the linear constraints and whether the Hessian is constant
+  initLinearity();
+
+  // Discard the recycled GMRES subspace from any previous optimization
+  gmres_num_recycled = 0;
+
   // Get settings related to the Hessian-vector products
   const int use_hvec_product = options->getBoolOption("use_hvec_product");
+
+  // Decide whether to use the dense factorization of the KKT system
+  initDenseKKTSystem(use_hvec_product);
   const double nk_switch_tol = options->getFloatOption("nk_switch_tol");
   const double eisenstat_walker_gamma =
       options->getFloatOption("eisenstat_walker_gamma");
@@ -4484,6 +6436,33 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
   const double max_gmres_rtol = options->getFloatOption("max_gmres_rtol");
   const double gmres_atol = options->getFloatOption("gmres_atol");
   const int use_qn_gmres_precon = options->getBoolOption("use_qn_gmres_precon");
+  const int gmres_precon_refresh =
+      options->getIntOption("gmres_precon_refresh");
+
+  // Set the preconditioner for GMRES. The user-supplied preconditioner
+  // falls back to the quasi-Newton approximation if none is set.
+  const char *gmres_precon_name = options->getEnumOption("gmres_precon_type");
+  gmres_precon_type = PAROPT_GMRES_PRECON_QUASI_NEWTON;
+  if (strcmp(gmres_precon_name, "diag_hessian") == 0) {
+    gmres_precon_type = PAROPT_GMRES_PRECON_DIAG_HESSIAN;
+  } else if (strcmp(gmres_precon_name, "user") == 0) {
+    if (hprecon) {
+      gmres_precon_type = PAROPT_GMRES_PRECON_USER;
+    } else if (use_hvec_product && rank == opt_root) {
+      fprintf(stderr,
+              "ParOpt Warning: No user preconditioner set, using the "
+              "quasi-Newton GMRES preconditioner\n");
+    }
+  }
+
+  // Allocate the exact Hessian diagonal for the preconditioner
+  if (!gmres_hdiag && gmres_precon_type == PAROPT_GMRES_PRECON_DIAG_HESSIAN) {
+    gmres_hdiag = prob->createDesignVec();
+    gmres_hdiag->incref();
+  }
+
+  // Update the Hessian approximation at the first inexact Newton step
+  gmres_precon_age = 0;
 
   // Iterative refinement steps
   const int iterative_refinement_steps =
@@ -4514,6 +6493,8 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
   // Frequency at which the output is written to a file
   const int write_output_frequency =
       options->getIntOption("write_output_frequency");
+  const int use_async_checkpoint =
+      options->getBoolOption("use_async_checkpoint");
 
   // Set the output level
   const int output_level = options->getIntOption("output_level");
@@ -4553,14 +6534,20 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
             "ParOpt: Initial function and constraint evaluation failed\n");
     return fail_obj;
   }
-  int fail_gobj = prob->evalObjConGradient(variables.x, g, Ac);
+  int fail_gobj = evalObjConGradient(variables.x);
   ngeval++;
   if (fail_gobj) {
     fprintf(stderr, "ParOpt: Initial gradient evaluation failed\n");
     return fail_obj;
   }
 
-  if (starting_point_strategy == PAROPT_AFFINE_STEP) {
+  // The multipliers read from a checkpoint file are used as they are
+  if (checkpoint_restart) {
+    checkpoint_restart = 0;
+  } else if (warm_start) {
+    warm_start = 0;
+    initWarmStartMultipliers(variables);
+  } else if (starting_point_strategy == PAROPT_AFFINE_STEP) {
     initAffineStepMultipliers(variables, residual, update);
   } else if (starting_point_strategy == PAROPT_LEAST_SQUARES_MULTIPLIERS) {
     initLeastSquaresMultipliers(variables, residual, update.x);
@@ -4607,7 +6594,7 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
   for (int k = 0; k < max_major_iters; k++, niter++) {
     // Keep track if the quasi-Newton Hessian was reset
     int qn_hessian_reset = 0;
-    if (qn && !sequential_linear_method) {
+    if (qn && !sequential_linear_method && !constant_hessian) {
       if (k > 0 && k % hessian_reset_freq == 0 && use_quasi_newton_update) {
         // Reset the quasi-Newton Hessian approximation
         qn->reset();
@@ -4617,11 +6604,23 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
 
     // Print out the current solution progress using the
     // hook in the problem definition
+    if (checkpoint && finishCheckpoint(0)) {
+      // The asynchronous checkpoint from a previous iteration failed
+      fprintf(stderr, "ParOpt: Checkpoint file %s creation failed\n",
+              checkpoint);
+      checkpoint = NULL;
+    }
     if (write_output_frequency > 0 && k % write_output_frequency == 0) {
       if (checkpoint) {
         // Write the checkpoint file, if it fails once, set
         // the file pointer to null so it won't print again
-        if (writeSolutionFile(checkpoint)) {
+        int fail = 0;
+        if (use_async_checkpoint) {
+          fail = startCheckpoint(checkpoint);
+        } else {
+          fail = writeSolutionFile(checkpoint);
+        }
+        if (fail) {
           fprintf(stderr, "ParOpt: Checkpoint file %s creation failed\n",
                   checkpoint);
           checkpoint = NULL;
@@ -4804,6 +6803,30 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
       fflush(outfp);
     }
 
+    // Append the iteration to the binary history
+    if (history) {
+      history->setInt("iter", k);
+      history->setInt("nobj", neval);
+      history->setInt("ngrd", ngeval);
+      history->setInt("nhvc", nhvec);
+      if (k > 0) {
+        history->setDouble("alpha", alpha_prev);
+        history->setDouble("alphx", alpha_xprev);
+        history->setDouble("alphz", alpha_zprev);
+      }
+      history->setDouble("fobj", ParOptRealPart(fobj));
+      history->setDouble("|opt|", max_prime);
+      history->setDouble("|infes|", max_infeas);
+      history->setDouble("|dual|", max_dual);
+      history->setDouble("mu", barrier_param);
+      history->setDouble("comp", ParOptRealPart(comp));
+      if (k > 0) {
+        history->setDouble("dmerit", ParOptRealPart(dm0_prev));
+        history->setDouble("rho", rho_penalty_search);
+      }
+      history->writeRow();
+    }
+
     // Check for convergence. We apply two different convergence
     // criteria at this point: the first based on the norm of
     // the KKT condition residuals, and the second based on the
@@ -4861,40 +6884,75 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
         // Set the flag which determines whether or not to use
         // the quasi-Newton method as a preconditioner
         int use_qn = 1;
-        if (sequential_linear_method || !use_qn_gmres_precon) {
+        if (sequential_linear_method || !use_qn_gmres_precon ||
+            gmres_precon_type == PAROPT_GMRES_PRECON_USER) {
           use_qn = 0;
         }
 
-        // Set up the KKT diagonal system
-        setUpKKTDiagSystem(variables, s_qn, wtemp, use_qn);
+        // Update the exact Hessian diagonal or the user-supplied
+        // Hessian approximation used in the preconditioner
+        int precon_fail = 0;
+        if (gmres_precon_type != PAROPT_GMRES_PRECON_QUASI_NEWTON &&
+            (gmres_precon_age == 0 ||
+             gmres_precon_age >= gmres_precon_refresh)) {
+          precon_fail = updateGMRESPrecon(variables, use_qn);
+          gmres_precon_age = 0;
+        }
+
+        if (precon_fail) {
+          if (rank == opt_root) {
+            fprintf(stderr,
+                    "ParOpt: GMRES preconditioner update failed, using a "
+                    "quasi-Newton step\n");
+          }
+        } else {
+          gmres_precon_age++;
+
+          // The user-supplied preconditioner replaces the quasi-definite
+          // matrix from the problem for the inexact Newton step
+          ParOptQuasiDefMat *prob_mat = mat;
+          ParOptVec *hdiag_precon = NULL;
+          if (gmres_precon_type == PAROPT_GMRES_PRECON_USER) {
+            mat = hprecon;
+          } else if (gmres_precon_type == PAROPT_GMRES_PRECON_DIAG_HESSIAN) {
+            hdiag_precon = gmres_hdiag;
+          }
 
-        // Set up the full KKT system
-        setUpKKTSystem(variables, ztemp, s_qn, y_qn, wtemp, use_qn);
+          // Set up the KKT diagonal system
+          setUpKKTDiagSystem(variables, s_qn, wtemp, use_qn, hdiag_precon);
 
-        // Compute the inexact step using GMRES
-        gmres_iters =
-            computeKKTGMRESStep(variables, residual, update, ztemp, y_qn, s_qn,
-                                wtemp, gmres_rtol, gmres_atol, use_qn);
+          // Set up the full KKT system
+          setUpKKTSystem(variables, ztemp, s_qn, y_qn, wtemp, use_qn);
 
-        if (abs_step_tol > 0.0) {
-          step_norm_prev = computeStepNorm(norm_type, update);
-        }
+          // Compute the inexact step using GMRES
+          gmres_iters =
+              computeKKTGMRESStep(variables, residual, update, ztemp, y_qn,
+                                  s_qn, wtemp, gmres_rtol, gmres_atol, use_qn);
+          mat = prob_mat;
 
-        if (gmres_iters < 0) {
-          // Print out an error code that we've failed
-          if (rank == opt_root && output_level > 0) {
-            fprintf(outfp, "      %9s\n", "step failed");
+          if (abs_step_tol > 0.0) {
+            step_norm_prev = computeStepNorm(norm_type, update);
           }
 
-          // Recompute the residual of the KKT system - the residual
-          // was destroyed during the failed GMRES iteration
-          computeKKTRes(variables, barrier_param, residual);
-          computeResNorm(norm_type, residual, &max_prime, &max_dual,
-                         &max_infeas, &res_norm);
-        } else {
-          // We've successfully computed a KKT step using
-          // exact Hessian-vector products
-          inexact_newton_step = 1;
+          if (gmres_iters < 0) {
+            // Print out an error code that we've failed
+            if (rank == opt_root && output_level > 0) {
+              fprintf(outfp, "      %9s\n", "step failed");
+            }
+
+            // Recompute the residual of the KKT system - the residual
+            // was destroyed during the failed GMRES iteration
+            computeKKTRes(variables, barrier_param, residual);
+            computeResNorm(norm_type, residual, &max_prime, &max_dual,
+                           &max_infeas, &res_norm);
+
+            // Update the preconditioner at the next inexact Newton step
+            gmres_precon_age = 0;
+          } else {
+            // We've successfully computed a KKT step using
+            // exact Hessian-vector products
+            inexact_newton_step = 1;
+          }
         }
       }
     }
@@ -5192,6 +7250,12 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
           if (alpha_min > 0.5) {
             alpha_min = 0.5;
           }
+
+          // The line search evaluates the problem at the trial points, so
+          // compute the matrix-free Jacobian products at the current point
+          if (ac_matfree) {
+            initMatFreeQuasiNewtonUpdate(variables, update);
+          }
           line_fail = lineSearch(alpha_min, &alpha, m0, dm0);
 
           // If the step length is less than the design precision
@@ -5328,6 +7392,12 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
     }
   }
 
+  // Complete the last asynchronous checkpoint
+  if (checkpoint && finishCheckpoint(1)) {
+    fprintf(stderr, "ParOpt: Checkpoint file %s creation failed\n",
+            checkpoint);
+  }
+
   // Success - we completed the optimization
   return 0;
 }
@@ -5366,18 +7436,9 @@ int ParOptInteriorPoint::optimize(const char *checkpoint) {
 void ParOptInteriorPoint::initLeastSquaresMultipliers(ParOptVars &vars,
                                                       ParOptVars &res,
                                                       ParOptVec *yx) {
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   const double init_barrier_param =
       options->getFloatOption("init_barrier_param");
 
-  // Set the largrange multipliers with bounds outside the
-  // limits to zero
-  ParOptScalar *lbvals, *ubvals, *zlvals, *zuvals;
-  lb->getArray(&lbvals);
-  ub->getArray(&ubvals);
-  vars.zl->getArray(&zlvals);
-  vars.zu->getArray(&zuvals);
-
   // Set the Largrange multipliers associated with the
   // the lower/upper bounds to the initial barrier parameter
   vars.zl->set(init_barrier_param);
@@ -5401,16 +7462,6 @@ void ParOptInteriorPoint::initLeastSquaresMultipliers(ParOptVars &vars,
     vars.zt[i] = init_barrier_param;
   }
 
-  // Zero the multipliers for bounds that are out-of-range
-  for (int i = 0; i < nvars; i++) {
-    if (ParOptRealPart(lbvals[i]) <= -max_bound_value) {
-      zlvals[i] = 0.0;
-    }
-    if (ParOptRealPart(ubvals[i]) >= max_bound_value) {
-      zuvals[i] = 0.0;
-    }
-  }
-
   double small = 1e-4;
 
   // Set the components of the diagonal matrix
@@ -5428,51 +7479,16 @@ void ParOptInteriorPoint::initLeastSquaresMultipliers(ParOptVars &vars,
   // Factor the quasi-definite matrix
   mat->factor(vars.x, Dinv, Cdiag);
 
-  // Set the value of the G matrix
-  memset(Gmat, 0, ncon * ncon * sizeof(ParOptScalar));
-
-  // Now, compute the Schur complement with the Dmatrix
-  for (int j = 0; j < ncon; j++) {
-    mat->apply(Ac[j], res.x, res.zw);
-
-    for (int i = j; i < ncon; i++) {
-      Gmat[i + ncon * j] += Ac[i]->dot(res.x);
-    }
-  }
-
-  // Populate the remainder of the matrix because it is
-  // symmetric
-  for (int j = 0; j < ncon; j++) {
-    for (int i = j + 1; i < ncon; i++) {
-      Gmat[j + ncon * i] = Gmat[i + ncon * j];
-    }
-  }
-
-  if (ncon > 0) {
-    int rank;
-    MPI_Comm_rank(comm, &rank);
-
-    // Add the diagonal component to the matrix
-    if (rank == opt_root) {
-      for (int i = 0; i < ncon; i++) {
-        Gmat[i * (ncon + 1)] += small;
-      }
-    }
-
-    // Broadcast the result to all processors. Note that this ensures
-    // that the factorization will be the same on all processors
-    MPI_Bcast(Gmat, ncon * ncon, PAROPT_MPI_TYPE, opt_root, comm);
-
-    // Factor the matrix for future use
-    int info = 0;
-    LAPACKdgetrf(&ncon, &ncon, Gmat, &ncon, gpiv, &info);
+  // Compute and factor the Schur complement with the D matrix
+  for (int i = 0; i < ncon; i++) {
+    gdiag[i] = small;
   }
+  factorGmat(res.x, res.zw);
 
   // Compute the right-hand-side
   // Note that we scale the right-hand-side to get rhs = -(g - zl + zu)
   res.x->copyValues(g);
-  res.x->axpy(-1.0, vars.zl);
-  res.x->axpy(1.0, vars.zu);
+  addBoundMultipliers(-1.0, vars, res.x);
   res.x->scale(-1.0);
 
   // Compute the terms from the weighting constraints
@@ -5483,7 +7499,7 @@ void ParOptInteriorPoint::initLeastSquaresMultipliers(ParOptVars &vars,
 
   // Now, compute yz = A^{T} * y.x
   memset(vars.z, 0, ncon * sizeof(ParOptScalar));
-  yx->mdot(Ac, ncon, vars.z);
+  multConGradients(yx, 0, vars.z);
 
   if (ncon > 0) {
     int rank;
@@ -5494,17 +7510,12 @@ void ParOptInteriorPoint::initLeastSquaresMultipliers(ParOptVars &vars,
       for (int i = 0; i < ncon; i++) {
         vars.z[i] = -vars.z[i];
       }
-
-      int one = 1, info = 0;
-      LAPACKdgetrs("N", &ncon, &one, Gmat, &ncon, gpiv, vars.z, &ncon, &info);
     }
 
-    MPI_Bcast(vars.z, ncon, PAROPT_MPI_TYPE, opt_root, comm);
+    solveGmat(vars.z);
   }
 
-  for (int i = 0; i < ncon; i++) {
-    res.x->axpy(vars.z[i], Ac[i]);
-  }
+  addConGradients(1.0, vars.z, res.x);
 
   mat->apply(res.x, res.zw, yx, vars.zw);
 
@@ -5539,7 +7550,6 @@ void ParOptInteriorPoint::initAffineStepMultipliers(ParOptVars &vars,
   // Set the minimum allowable multiplier
   const double start_affine_multiplier_min =
       options->getFloatOption("start_affine_multiplier_min");
-  const double max_bound_value = options->getFloatOption("max_bound_value");
   const int sequential_linear_method =
       options->getBoolOption("sequential_linear_method");
   const int use_qn_gmres_precon = options->getBoolOption("use_qn_gmres_precon");
@@ -5549,24 +7559,6 @@ void ParOptInteriorPoint::initAffineStepMultipliers(ParOptVars &vars,
   // method
   initLeastSquaresMultipliers(vars, res, step.x);
 
-  // Set the largrange multipliers with bounds outside the
-  // limits to zero
-  ParOptScalar *lbvals, *ubvals, *zlvals, *zuvals;
-  lb->getArray(&lbvals);
-  ub->getArray(&ubvals);
-  vars.zl->getArray(&zlvals);
-  vars.zu->getArray(&zuvals);
-
-  // Zero the multipliers for bounds that are out-of-range
-  for (int i = 0; i < nvars; i++) {
-    if (ParOptRealPart(lbvals[i]) <= -max_bound_value) {
-      zlvals[i] = 0.0;
-    }
-    if (ParOptRealPart(ubvals[i]) >= max_bound_value) {
-      zuvals[i] = 0.0;
-    }
-  }
-
   // Find the affine scaling step
   computeKKTRes(vars, 0.0, res);
 
@@ -5632,22 +7624,20 @@ void ParOptInteriorPoint::initAffineStepMultipliers(ParOptVars &vars,
     ParOptScalar *zlvals, *pzlvals;
     vars.zl->getArray(&zlvals);
     step.zl->getArray(&pzlvals);
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        zlvals[i] = max2(start_affine_multiplier_min,
-                         fabs(ParOptRealPart(zlvals[i] + pzlvals[i])));
-      }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int kz = (compact_bounds ? k : lower_bound_index[k]);
+      zlvals[kz] = max2(start_affine_multiplier_min,
+                       fabs(ParOptRealPart(zlvals[kz] + pzlvals[kz])));
     }
   }
   if (use_upper) {
     ParOptScalar *zuvals, *pzuvals;
     vars.zu->getArray(&zuvals);
     step.zu->getArray(&pzuvals);
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        zuvals[i] = max2(start_affine_multiplier_min,
-                         fabs(ParOptRealPart(zuvals[i] + pzuvals[i])));
-      }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int kz = (compact_bounds ? k : upper_bound_index[k]);
+      zuvals[kz] = max2(start_affine_multiplier_min,
+                       fabs(ParOptRealPart(zuvals[kz] + pzuvals[kz])));
     }
   }
 
@@ -5655,6 +7645,115 @@ void ParOptInteriorPoint::initAffineStepMultipliers(ParOptVars &vars,
   barrier_param = ParOptRealPart(computeComp(vars));
 }
 
+/*
+  Initialize the slack variables and multipliers for a warm start.
+
+  The multipliers z and zw and the bound multipliers from the previous
+  optimization are retained. The slack variables are set so that the
+  constraints c(x) - s + t = 0 are satisfied at the new point, and the
+  slack multipliers are set from the dual feasibility conditions with
+  the current penalty parameters. All values are kept above
+  warm_start_multiplier_min.
+
+  The barrier parameter is set to the average complementarity. To keep
+  the point well-centered, the multipliers are then modified so that
+  each complementarity product lies within a factor of 10 of the
+  barrier parameter.
+*/
+void ParOptInteriorPoint::initWarmStartMultipliers(ParOptVars &vars) {
+  const double warm_start_multiplier_min =
+      options->getFloatOption("warm_start_multiplier_min");
+  const double rel_bound_barrier = options->getFloatOption("rel_bound_barrier");
+  const double init_barrier_param =
+      options->getFloatOption("init_barrier_param");
+  const double abs_res_tol = options->getFloatOption("abs_res_tol");
+  const double mult_min = warm_start_multiplier_min;
+
+  // Set the dense slack variables and their multipliers
+  for (int i = 0; i < ncon; i++) {
+    vars.s[i] = max2(0.0, c[i]) + mult_min;
+    vars.t[i] = max2(0.0, -c[i]) + mult_min;
+    vars.zs[i] = max2(mult_min, penalty_gamma_s[i] + vars.z[i]);
+    vars.zt[i] = max2(mult_min, penalty_gamma_t[i] - vars.z[i]);
+  }
+
+  ParOptScalar *sw = NULL, *tw = NULL, *zsw = NULL, *ztw = NULL;
+  if (nwcon > 0) {
+    ParOptScalar *cw, *zw, *gamma_sw, *gamma_tw;
+    prob->evalSparseCon(vars.x, wtemp);
+    wtemp->getArray(&cw);
+    vars.zw->getArray(&zw);
+    vars.sw->getArray(&sw);
+    vars.tw->getArray(&tw);
+    vars.zsw->getArray(&zsw);
+    vars.ztw->getArray(&ztw);
+    penalty_gamma_sw->getArray(&gamma_sw);
+    penalty_gamma_tw->getArray(&gamma_tw);
+
+    for (int i = 0; i < nwcon; i++) {
+      sw[i] = max2(0.0, cw[i]) + mult_min;
+      tw[i] = max2(0.0, -cw[i]) + mult_min;
+      zsw[i] = max2(mult_min, gamma_sw[i] + zw[i]);
+      ztw[i] = max2(mult_min, gamma_tw[i] - zw[i]);
+    }
+  }
+
+  ParOptScalar *xvals, *lbvals, *ubvals, *zlvals, *zuvals;
+  vars.x->getArray(&xvals);
+  lb->getArray(&lbvals);
+  ub->getArray(&ubvals);
+  vars.zl->getArray(&zlvals);
+  vars.zu->getArray(&zuvals);
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int kz = (compact_bounds ? k : lower_bound_index[k]);
+    zlvals[kz] = max2(mult_min, zlvals[kz]);
+  }
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int kz = (compact_bounds ? k : upper_bound_index[k]);
+    zuvals[kz] = max2(mult_min, zuvals[kz]);
+  }
+
+  // Match the barrier parameter to the complementarity, but do not
+  // start with a larger value than a cold start
+  double mu = ParOptRealPart(computeComp(vars));
+  if (mu > init_barrier_param) {
+    mu = init_barrier_param;
+  }
+  if (mu < 0.1 * abs_res_tol) {
+    mu = 0.1 * abs_res_tol;
+  }
+
+  // Modify the multipliers so that the products lie in [0.1*mu, 10*mu]
+  for (int i = 0; i < ncon; i++) {
+    vars.zs[i] =
+        max2(0.1 * mu / vars.s[i], min2(10.0 * mu / vars.s[i], vars.zs[i]));
+    vars.zt[i] =
+        max2(0.1 * mu / vars.t[i], min2(10.0 * mu / vars.t[i], vars.zt[i]));
+  }
+  for (int i = 0; i < nwcon; i++) {
+    zsw[i] = max2(0.1 * mu / sw[i], min2(10.0 * mu / sw[i], zsw[i]));
+    ztw[i] = max2(0.1 * mu / tw[i], min2(10.0 * mu / tw[i], ztw[i]));
+  }
+
+  double mu_bound = rel_bound_barrier * mu;
+  for (int k = 0; k < num_lower_bounds; k++) {
+    int i = lower_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    ParOptScalar d = xvals[i] - lbvals[i];
+    zlvals[kz] =
+        max2(0.1 * mu_bound / d, min2(10.0 * mu_bound / d, zlvals[kz]));
+  }
+  for (int k = 0; k < num_upper_bounds; k++) {
+    int i = upper_bound_index[k];
+    int kz = (compact_bounds ? k : i);
+    ParOptScalar d = ubvals[i] - xvals[i];
+    zuvals[kz] =
+        max2(0.1 * mu_bound / d, min2(10.0 * mu_bound / d, zuvals[kz]));
+  }
+
+  barrier_param = mu;
+}
+
 /*
   Evaluate the directional derivative of the objective and barrier
   terms (the merit function without the penalty term)
@@ -5669,7 +7768,6 @@ void ParOptInteriorPoint::initAffineStepMultipliers(ParOptVars &vars,
 ParOptScalar ParOptInteriorPoint::evalObjBarrierDeriv(ParOptVars &vars,
                                                       ParOptVars &step) {
   const double rel_bound_barrier = options->getFloatOption("rel_bound_barrier");
-  const double max_bound_value = options->getFloatOption("max_bound_value");
 
   // Retrieve the values of the design variables, the design
   // variable step, and the lower/upper bounds
@@ -5683,25 +7781,23 @@ ParOptScalar ParOptInteriorPoint::evalObjBarrierDeriv(ParOptVars &vars,
   ParOptScalar pos_presult = 0.0, neg_presult = 0.0;
 
   if (use_lower) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(lbvals[i]) > -max_bound_value) {
-        if (ParOptRealPart(pxvals[i]) > 0.0) {
-          pos_presult += rel_bound_barrier * pxvals[i] / (xvals[i] - lbvals[i]);
-        } else {
-          neg_presult += rel_bound_barrier * pxvals[i] / (xvals[i] - lbvals[i]);
-        }
+    for (int k = 0; k < num_lower_bounds; k++) {
+      int i = lower_bound_index[k];
+      if (ParOptRealPart(pxvals[i]) > 0.0) {
+        pos_presult += rel_bound_barrier * pxvals[i] / (xvals[i] - lbvals[i]);
+      } else {
+        neg_presult += rel_bound_barrier * pxvals[i] / (xvals[i] - lbvals[i]);
       }
     }
   }
 
   if (use_upper) {
-    for (int i = 0; i < nvars; i++) {
-      if (ParOptRealPart(ubvals[i]) < max_bound_value) {
-        if (ParOptRealPart(pxvals[i]) > 0.0) {
-          neg_presult -= rel_bound_barrier * pxvals[i] / (ubvals[i] - xvals[i]);
-        } else {
-          pos_presult -= rel_bound_barrier * pxvals[i] / (ubvals[i] - xvals[i]);
-        }
+    for (int k = 0; k < num_upper_bounds; k++) {
+      int i = upper_bound_index[k];
+      if (ParOptRealPart(pxvals[i]) > 0.0) {
+        neg_presult -= rel_bound_barrier * pxvals[i] / (ubvals[i] - xvals[i]);
+      } else {
+        pos_presult -= rel_bound_barrier * pxvals[i] / (ubvals[i] - xvals[i]);
       }
     }
   }
@@ -5771,6 +7867,396 @@ ParOptScalar ParOptInteriorPoint::evalObjBarrierDeriv(ParOptVars &vars,
   return pmerit;
 }
 
+/*
+  Apply the right-preconditioned KKT operator to a vector in the GMRES
+  subspace. The vector consists of the design components win and the
+  remaining components alpha*res, where res holds the residuals of the
+  multipliers and slack variables. The output is
+
+  wout = win + (H - B)*px
+
+  where px is the design component of the preconditioned vector. The
+  directional derivatives of the merit function and the constraint
+  infeasibility along the preconditioned vector are also returned.
+*/
+void ParOptInteriorPoint::applyGMRESOperator(
+    ParOptVars &vars, ParOptVars &res, ParOptVars &step, ParOptVec *win,
+    ParOptScalar alpha, ParOptVec *wout, ParOptScalar *ztmp, ParOptVec *xtmp1,
+    ParOptVec *xtmp2, ParOptVec *wtmp, int use_qn, ParOptScalar cscale,
+    ParOptScalar cwscale, ParOptScalar *fproj, ParOptScalar *aproj,
+    ParOptScalar *awproj) {
+  // Compute M^{-1}*[ win, alpha*yc, ... ]
+  // Get the size of the limited-memory BFGS subspace
+  ParOptScalar b0;
+  const ParOptScalar *d, *M;
+  ParOptVec **Z;
+  int size = 0;
+  if (qn && use_qn) {
+    size = qn->getCompactMat(&b0, &d, &M, &Z);
+  }
+
+  // Solve the first part of the equation
+  solveKKTDiagSystem(vars, win, alpha, res, step, xtmp2, wtmp);
+
+  if (size > 0) {
+    // dz = Z^{T}*xt1
+    step.x->mdot(Z, size, ztmp);
+
+    // Compute dz <- Ce^{-1}*dz
+    int one = 1, info = 0;
+    LAPACKdgetrs("N", &size, &one, Ce, &size, cpiv, ztmp, &size, &info);
+
+    // Compute rx = Z^{T}*dz
+    xtmp2->zeroEntries();
+    for (int k = 0; k < size; k++) {
+      xtmp2->axpy(ztmp[k], Z[k]);
+    }
+
+    // Solve the digaonal system again, this time simplifying the
+    // result due to the structure of the right-hand-side.  Note
+    // that this call uses wout as a temporary vector.
+    solveKKTDiagSystem(vars, xtmp2, xtmp1, ztmp, wout, wtmp);
+
+    // Add the final contributions
+    step.x->axpy(-1.0, xtmp1);
+  }
+
+  // px now contains the current estimate of the step in the design
+  // variables.
+  *fproj = evalObjBarrierDeriv(vars, step);
+
+  // Compute the directional derivative of the l2 constraint infeasibility
+  // along the direction px.
+  *aproj = 0.0;
+  multConGradients(step.x, 0, ac_prod);
+  for (int j = 0; j < ncon; j++) {
+    ParOptScalar cj_deriv = (ac_prod[j] - step.s[j] + step.t[j]);
+    *aproj -= cscale * res.z[j] * cj_deriv;
+  }
+
+  // Add the contributions from the sparse constraints (if any are defined)
+  *awproj = 0.0;
+  if (nwcon > 0) {
+    // rzw = -(cw - sw + tw)
+    xtmp1->zeroEntries();
+    prob->addSparseJacobianTranspose(1.0, vars.x, res.zw, xtmp1);
+    *awproj = -cwscale * step.x->dot(xtmp1);
+    *awproj += cwscale * res.zw->dot(step.sw);
+    *awproj -= cwscale * res.zw->dot(step.tw);
+  }
+
+  // Compute the vector product with the exact Hessian
+  prob->evalHvecProduct(vars.x, vars.z, vars.zw, step.x, wout);
+  nhvec++;
+
+  // Add the term -B*px
+  if (gmres_precon_type == PAROPT_GMRES_PRECON_USER) {
+    hprecon->multAdd(-1.0, step.x, wout);
+  } else {
+    if (qn && use_qn) {
+      qn->multAdd(-1.0, step.x, wout);
+    }
+    if (gmres_precon_type == PAROPT_GMRES_PRECON_DIAG_HESSIAN) {
+      ParOptScalar *pxvals, *hvals, *wvals;
+      step.x->getArray(&pxvals);
+      gmres_hdiag->getArray(&hvals);
+      wout->getArray(&wvals);
+      for (int i = 0; i < nvars; i++) {
+        wvals[i] -= hvals[i] * pxvals[i];
+      }
+    }
+  }
+
+  // Add the term from the diagonal
+  wout->axpy(1.0, win);
+}
+
+/*
+  Update the Hessian approximation used to precondition GMRES.
+
+  For the user-supplied preconditioner, this calls its update at the
+  current point. For the diagonal preconditioner, this evaluates the
+  exact diagonal of the Hessian, h, and stores the correction
+
+  hc = max(h - diag(B), 0)
+
+  where B is the quasi-Newton approximation (or zero if it is not
+  used). The preconditioner then uses the approximation B + diag(hc),
+  which matches the exact diagonal wherever the quasi-Newton
+  approximation underestimates it. The diagonal of the compact
+  representation B = b0*I - Z*diag{d}*M^{-1}*diag{d}*Z^{T} is computed
+  row by row from the small matrix diag{d}*M^{-1}*diag{d}.
+*/
+int ParOptInteriorPoint::updateGMRESPrecon(ParOptVars &vars, int use_qn) {
+  if (gmres_precon_type == PAROPT_GMRES_PRECON_USER) {
+    return hprecon->update(vars.x, vars.z, vars.zw);
+  }
+
+  int fail = prob->evalHessianDiag(vars.x, vars.z, vars.zw, gmres_hdiag);
+  if (fail) {
+    return fail;
+  }
+
+  ParOptScalar *hvals;
+  gmres_hdiag->getArray(&hvals);
+
+  if (qn && use_qn) {
+    ParOptScalar b0;
+    const ParOptScalar *d, *M;
+    ParOptVec **Z;
+    int size = qn->getCompactMat(&b0, &d, &M, &Z);
+
+    for (int i = 0; i < nvars; i++) {
+      hvals[i] -= b0;
+    }
+
+    if (size > 0) {
+      // Compute Minv = diag{d}*M^{-1}*diag{d}
+      ParOptScalar *Minv = new ParOptScalar[size * size];
+      ParOptScalar *Mfact = new ParOptScalar[size * size];
+      int *piv = new int[size];
+      memcpy(Mfact, M, size * size * sizeof(ParOptScalar));
+      memset(Minv, 0, size * size * sizeof(ParOptScalar));
+      for (int i = 0; i < size; i++) {
+        Minv[i * (size + 1)] = 1.0;
+      }
+
+      int info = 0;
+      LAPACKdgetrf(&size, &size, Mfact, &size, piv, &info);
+      LAPACKdgetrs("N", &size, &size, Mfact, &size, piv, Minv, &size, &info);
+      for (int j = 0; j < size; j++) {
+        for (int i = 0; i < size; i++) {
+          Minv[i + j * size] *= d[i] * d[j];
+        }
+      }
+
+      // Add the diagonal of Z*Minv*Z^{T}
+      ParOptScalar **zvals = new ParOptScalar *[size];
+      for (int i = 0; i < size; i++) {
+        Z[i]->getArray(&zvals[i]);
+      }
+      for (int k = 0; k < nvars; k++) {
+        for (int j = 0; j < size; j++) {
+          ParOptScalar t = 0.0;
+          for (int i = 0; i < size; i++) {
+            t += Minv[i + j * size] * zvals[i][k];
+          }
+          hvals[k] += t * zvals[j][k];
+        }
+      }
+
+      delete[] Minv;
+      delete[] Mfact;
+      delete[] piv;
+      delete[] zvals;
+    }
+  }
+
+  // Discard the negative entries so that the preconditioner remains
+  // positive definite with the barrier terms
+  for (int i = 0; i < nvars; i++) {
+    if (ParOptRealPart(hvals[i]) < 0.0) {
+      hvals[i] = 0.0;
+    }
+  }
+
+  return 0;
+}
+
+/*
+  Form the recycled subspace for the next call to GMRES from the
+  harmonic Ritz vectors of the current solve.
+
+  The deflated directions Z_m = P*V_m used by the flexible GMRES
+  iteration satisfy the Arnoldi relation
+
+  A*Z_m = V_{m+1}*Hbar
+
+  where Hbar is the unrotated Hessenberg matrix. The harmonic Ritz
+  pairs satisfy the generalized eigenproblem
+
+  Hbar^{T}*Hbar*y = theta*H_m^{T}*y
+
+  where H_m is the leading square block of Hbar. The vectors Z_m*y with
+  the smallest values of |theta| approximate the eigenvectors that slow
+  the convergence of GMRES, and their images A*Z_m*y = V_{m+1}*Hbar*y
+  are known without any additional Hessian-vector products.
+
+  No vectors are kept if the solve converged in fewer iterations than
+  the size of the recycled subspace, since the Krylov subspace then
+  contains too little information about the slowly converging
+  eigenspace, and the deflation of a poor subspace increases the
+  number of iterations in the next solve.
+
+  On entry, gmres_U must contain the differences U - C of the previous
+  recycled subspace. On exit, the design components of the new vectors
+  are stored in gmres_C and their images are stored in gmres_U, with the
+  images orthonormal. The number of new vectors is returned.
+*/
+int ParOptInteriorPoint::updateGMRESRecycleSpace(int nrecycle, int niters) {
+#ifdef PAROPT_USE_COMPLEX
+  return 0;
+#else
+  const int k = gmres_recycle_size;
+  const int m = niters;
+  const int n = m;
+  const int nrows = m + 1;
+  if (m <= k) {
+    return 0;
+  }
+
+  // Form Hbar, stored column-major
+  double *G = new double[nrows * n];
+  memset(G, 0, nrows * n * sizeof(double));
+  for (int i = 0; i < m; i++) {
+    int hptr = (i + 1) * (i + 2) / 2 - 1;
+    for (int j = 0; j <= i + 1; j++) {
+      G[j + nrows * i] = gmres_Hraw[j + hptr];
+    }
+  }
+
+  // Form P = Hbar^{T}*Hbar and Q = H_m^{T}
+  double *P = new double[n * n];
+  double *Q = new double[n * n];
+  double one = 1.0, zero = 0.0;
+  int nr = nrows, nn = n;
+  BLASgemm("T", "N", &nn, &nn, &nr, &one, G, &nr, G, &nr, &zero, P, &nn);
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < n; i++) {
+      Q[i + n * j] = G[j + nrows * i];
+    }
+  }
+
+  // Compute P^{-1}*Q whose eigenvalues are 1/theta
+  int *ipiv = new int[n];
+  int info = 0;
+  LAPACKdgetrf(&nn, &nn, P, &nn, ipiv, &info);
+  if (info == 0) {
+    LAPACKdgetrs("N", &nn, &nn, P, &nn, ipiv, Q, &nn, &info);
+  }
+
+  // The selected eigenvectors
+  int nvecs = 0;
+  double *Y = new double[n * k];
+
+  if (info == 0) {
+    double *wr = new double[n];
+    double *wi = new double[n];
+    double *vr = new double[n * n];
+    int lwork = 8 * n;
+    double *work = new double[lwork];
+    LAPACKdgeev("N", "V", &nn, Q, &nn, wr, wi, NULL, &nn, vr, &nn, work,
+                &lwork, &info);
+
+    if (info == 0) {
+      // Select the eigenvalues of P^{-1}*Q with the largest magnitude.
+      // Complex conjugate pairs contribute the real and imaginary parts
+      // of the eigenvector.
+      int *selected = new int[n];
+      memset(selected, 0, n * sizeof(int));
+      while (nvecs < k) {
+        int index = -1;
+        double max_abs = 0.0;
+        for (int j = 0; j < n; j++) {
+          double mag = sqrt(wr[j] * wr[j] + wi[j] * wi[j]);
+          if (!selected[j] && (wi[j] >= 0.0) && mag > max_abs) {
+            index = j;
+            max_abs = mag;
+          }
+        }
+        if (index < 0) {
+          break;
+        }
+
+        int nz = (wi[index] > 0.0 ? 2 : 1);
+        selected[index] = 1;
+        if (nz == 2) {
+          selected[index + 1] = 1;
+          if (nvecs + 2 > k) {
+            continue;
+          }
+        }
+
+        memcpy(&Y[n * nvecs], &vr[n * index], nz * n * sizeof(double));
+        nvecs += nz;
+      }
+      delete[] selected;
+    }
+
+    delete[] wr;
+    delete[] wi;
+    delete[] vr;
+    delete[] work;
+  }
+
+  // Compute the design components of the new vectors Z_m*y, where
+  // Z_m = V_m + (U - C)*B, and store them in gmres_C
+  double *t = new double[nrows];
+  for (int l = 0; l < nvecs; l++) {
+    const double *y = &Y[n * l];
+    ParOptVec *u = gmres_C[l];
+    u->zeroEntries();
+    for (int i = 0; i < m; i++) {
+      u->axpy(y[i], gmres_W[i]);
+    }
+    for (int j = 0; j < nrecycle; j++) {
+      double bj = 0.0;
+      for (int i = 0; i < m; i++) {
+        bj += gmres_B[j + k * i] * y[i];
+      }
+      u->axpy(bj, gmres_U[j]);
+    }
+  }
+
+  // Compute the images V_{m+1}*Hbar*y and store them in gmres_U
+  for (int l = 0; l < nvecs; l++) {
+    int inc = 1;
+    BLASgemv("N", &nr, &nn, &one, G, &nr, &Y[n * l], &inc, &zero, t, &inc);
+    ParOptVec *c = gmres_U[l];
+    c->zeroEntries();
+    for (int i = 0; i < nrows; i++) {
+      c->axpy(t[i], gmres_W[i]);
+    }
+  }
+
+  // Orthonormalize the images, applying the same operations to the
+  // vectors, and drop the vectors that are numerically dependent
+  int nnew = 0;
+  for (int l = 0; l < nvecs; l++) {
+    ParOptVec *u = gmres_C[l];
+    ParOptVec *c = gmres_U[l];
+    gmres_C[l] = gmres_C[nnew];
+    gmres_U[l] = gmres_U[nnew];
+    gmres_C[nnew] = u;
+    gmres_U[nnew] = c;
+
+    ParOptScalar cnorm0 = sqrt(c->dot(c));
+    for (int j = 0; j < nnew; j++) {
+      ParOptScalar r = c->dot(gmres_U[j]);
+      c->axpy(-r, gmres_U[j]);
+      u->axpy(-r, gmres_C[j]);
+    }
+
+    ParOptScalar cnorm = sqrt(c->dot(c));
+    if (ParOptRealPart(cnorm) > 1e-10 * ParOptRealPart(cnorm0)) {
+      ParOptScalar scale = 1.0 / cnorm;
+      c->scale(scale);
+      u->scale(scale);
+      nnew++;
+    }
+  }
+
+  delete[] G;
+  delete[] P;
+  delete[] Q;
+  delete[] Y;
+  delete[] t;
+  delete[] ipiv;
+
+  return nnew;
+#endif  // PAROPT_USE_COMPLEX
+}
+
 /*
   This function approximately solves the linearized KKT system with
   Hessian-vector products using right-preconditioned GMRES.  This
@@ -5888,6 +8374,17 @@ int ParOptInteriorPoint::computeKKTGMRESStep(ParOptVars &vars, ParOptVars &res,
     }
   }
 
+  // The recycled subspace U and its orthonormal image C = A*U from the
+  // previous solve. Since the operator changes between solves, C is
+  // only an approximation of A*U. The subspace is used in the deflated
+  // directions z = P*w = w + (U - C)*C^{T}*w, so that A*z ~= w for w in
+  // the range of C. The deflated directions change the preconditioner,
+  // so the flexible form of GMRES is used, but the solution is exact
+  // for any choice of U and C.
+  ParOptVec **U = gmres_U;
+  ParOptVec **C = gmres_C;
+  int nrecycle = gmres_num_recycled;
+
   // Initialize the residual norm
   gres[0] = bnorm;
   W[0]->copyValues(res.x);
@@ -5905,80 +8402,30 @@ int ParOptInteriorPoint::computeKKTGMRESStep(ParOptVars &vars, ParOptVars &res,
     fprintf(outfp, "%5s %4s %4s %7s %7s %8s %8s gmres rtol: %7.1e\n", "gmres",
             "nhvc", "iter", "res", "rel", "fproj", "cproj", rtol);
     fprintf(outfp, "      %4d %4d %7.1e %7.1e\n", nhvec, 0,
-            fabs(ParOptRealPart(gres[0])), 1.0);
+            fabs(ParOptRealPart(gres[0])),
+            fabs(ParOptRealPart(gres[0] / bnorm)));
   }
 
   for (int i = 0; i < gmres_subspace_size; i++) {
-    // Compute M^{-1}*[ W[i], alpha[i]*yc, ... ]
-    // Get the size of the limited-memory BFGS subspace
-    ParOptScalar b0;
-    const ParOptScalar *d, *M;
-    ParOptVec **Z;
-    int size = 0;
-    if (qn && use_qn) {
-      size = qn->getCompactMat(&b0, &d, &M, &Z);
-    }
-
-    // Solve the first part of the equation
-    solveKKTDiagSystem(vars, W[i], alpha[i] / bnorm, res, step, xtmp2, wtmp);
-
-    if (size > 0) {
-      // dz = Z^{T}*xt1
-      step.x->mdot(Z, size, ztmp);
-
-      // Compute dz <- Ce^{-1}*dz
-      int one = 1, info = 0;
-      LAPACKdgetrs("N", &size, &one, Ce, &size, cpiv, ztmp, &size, &info);
-
-      // Compute rx = Z^{T}*dz
-      xtmp2->zeroEntries();
-      for (int k = 0; k < size; k++) {
-        xtmp2->axpy(ztmp[k], Z[k]);
-      }
-
-      // Solve the digaonal system again, this time simplifying the
-      // result due to the structure of the right-hand-side.  Note
-      // that this call uses W[i+1] as a temporary vector.
-      solveKKTDiagSystem(vars, xtmp2, xtmp1, ztmp, W[i + 1], wtmp);
-
-      // Add the final contributions
-      step.x->axpy(-1.0, xtmp1);
-    }
-
-    // px now contains the current estimate of the step in the design
-    // variables.
-    fproj[i] = evalObjBarrierDeriv(vars, step);
-
-    // Compute the directional derivative of the l2 constraint infeasibility
-    // along the direction px.
-    aproj[i] = 0.0;
-    for (int j = 0; j < ncon; j++) {
-      ParOptScalar cj_deriv = (Ac[j]->dot(step.x) - step.s[j] + step.t[j]);
-      aproj[i] -= cscale * res.z[j] * cj_deriv;
-    }
-
-    // Add the contributions from the sparse constraints (if any are defined)
-    awproj[i] = 0.0;
-    if (nwcon > 0) {
-      // rzw = -(cw - sw + tw)
-      xtmp1->zeroEntries();
-      prob->addSparseJacobianTranspose(1.0, vars.x, res.zw, xtmp1);
-      awproj[i] = -cwscale * step.x->dot(xtmp1);
-      awproj[i] += cwscale * res.zw->dot(step.sw);
-      awproj[i] -= cwscale * res.zw->dot(step.tw);
-    }
-
-    // Compute the vector product with the exact Hessian
-    prob->evalHvecProduct(vars.x, vars.z, vars.zw, step.x, W[i + 1]);
-    nhvec++;
-
-    // Add the term -B*W[i]
-    if (qn && use_qn) {
-      qn->multAdd(-1.0, step.x, W[i + 1]);
-    }
-
-    // Add the term from the diagonal
-    W[i + 1]->axpy(1.0, W[i]);
+    // Compute the deflated direction Z = W[i] + (U - C)*C^{T}*W[i].
+    // The vectors in C have no components in the multipliers and
+    // slacks.
+    ParOptVec *win = W[i];
+    if (nrecycle > 0) {
+      ParOptScalar *b = &gmres_B[gmres_recycle_size * i];
+      W[i]->mdot(C, nrecycle, b);
+      gmres_Z->copyValues(W[i]);
+      for (int l = 0; l < nrecycle; l++) {
+        gmres_Z->axpy(b[l], U[l]);
+        gmres_Z->axpy(-b[l], C[l]);
+      }
+      win = gmres_Z;
+    }
+
+    // Compute W[i+1] = A*[ win, alpha[i]*yc, ... ]
+    applyGMRESOperator(vars, res, step, win, alpha[i] / bnorm, W[i + 1], ztmp,
+                       xtmp1, xtmp2, wtmp, use_qn, cscale, cwscale, &fproj[i],
+                       &aproj[i], &awproj[i]);
 
     // Set the value of the scalar
     alpha[i + 1] = alpha[i];
@@ -6000,6 +8447,13 @@ int ParOptInteriorPoint::computeKKTGMRESStep(ParOptVars &vars, ParOptVars &res,
     W[i + 1]->scale(1.0 / H[i + 1 + hptr]);
     alpha[i + 1] *= 1.0 / H[i + 1 + hptr];
 
+    // Save the unrotated Hessenberg column for the recycled subspace
+    if (gmres_recycle_size > 0) {
+      for (int j = 0; j <= i + 1; j++) {
+        gmres_Hraw[j + hptr] = H[j + hptr];
+      }
+    }
+
     // Apply the existing part of Q to the new components of the
     // Hessenberg matrix
     for (int k = 0; k < i; k++) {
@@ -6081,6 +8535,33 @@ int ParOptInteriorPoint::computeKKTGMRESStep(ParOptVars &vars, ParOptVars &res,
     gres[i] = gres[i] / H[i + hptr];
   }
 
+  // The contribution of the deflated directions to the solution is
+  // (U - C)*B*y. Compute it and store U - C for the recycled subspace.
+  if (nrecycle > 0) {
+    ParOptScalar *uc = gmres_uc;
+    for (int l = 0; l < nrecycle; l++) {
+      uc[l] = 0.0;
+      for (int j = 0; j < niters; j++) {
+        uc[l] += gmres_B[l + gmres_recycle_size * j] * gres[j];
+      }
+    }
+
+    gmres_Z->zeroEntries();
+    for (int l = 0; l < nrecycle; l++) {
+      U[l]->axpy(-1.0, C[l]);
+      gmres_Z->axpy(uc[l], U[l]);
+    }
+  }
+
+  // Form the recycled subspace for the next solve. This must be done
+  // before the Arnoldi vectors are overwritten. The new vectors are
+  // stored in C and their images in U.
+  if (gmres_recycle_size > 0) {
+    gmres_num_recycled = updateGMRESRecycleSpace(nrecycle, niters);
+    gmres_U = C;
+    gmres_C = U;
+  }
+
   // Compute the linear combination of the vectors
   // that will be the output
   W[0]->scale(gres[0]);
@@ -6091,6 +8572,11 @@ int ParOptInteriorPoint::computeKKTGMRESStep(ParOptVars &vars, ParOptVars &res,
     gamma += gres[i] * alpha[i];
   }
 
+  // Add the contribution from the deflated directions
+  if (nrecycle > 0) {
+    W[0]->axpy(1.0, gmres_Z);
+  }
+
   // Normalize the gamma parameter
   gamma /= bnorm;
 
@@ -6154,8 +8640,9 @@ int ParOptInteriorPoint::computeKKTGMRESStep(ParOptVars &vars, ParOptVars &res,
   // Add the contributions from the objective and dense constraints
   ParOptScalar fpr = evalObjBarrierDeriv(vars, step);
   ParOptScalar cpr = 0.0;
+  multConGradients(step.x, 0, ac_prod);
   for (int i = 0; i < ncon; i++) {
-    ParOptScalar deriv = (Ac[i]->dot(step.x) - step.s[i] + step.t[i]);
+    ParOptScalar deriv = (ac_prod[i] - step.s[i] + step.t[i]);
     cpr += cscale * (c[i] - vars.s[i] + vars.t[i]) * deriv;
   }
 
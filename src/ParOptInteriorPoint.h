@@ -3,8 +3,11 @@
 
 #include <stdio.h>
 
+#include "ParOptCheckpoint.h"
+#include "ParOptHistory.h"
 #include "ParOptOptions.h"
 #include "ParOptProblem.h"
+#include "ParOptProblemGroups.h"
 #include "ParOptQuasiNewton.h"
 #include "ParOptScaledQuasiNewton.h"
 #include "ParOptSparseMat.h"
@@ -34,6 +37,12 @@ enum ParOptStartingPointStrategy {
   PAROPT_AFFINE_STEP
 };
 
+enum ParOptGMRESPreconType {
+  PAROPT_GMRES_PRECON_QUASI_NEWTON,
+  PAROPT_GMRES_PRECON_DIAG_HESSIAN,
+  PAROPT_GMRES_PRECON_USER
+};
+
 /*
   ParOptInteriorPoint is a parallel interior-point optimizer
   implemented in C++ for large-scale constrained optimization.
@@ -123,7 +132,10 @@ enum ParOptStartingPointStrategy {
   method utilizes the limited-memory BFGS or SR1 quasi-Newton
   approximation as a preconditioner. The preconditioned operator,
   K*K_{B}^{-1}, takes a special form where only entries associated
-  with the design vector need to be stored.
+  with the design vector need to be stored. The exact Hessian diagonal
+  or a user-supplied approximation (ParOptHessianPrecon) can be used
+  in place of, or in addition to, the quasi-Newton approximation by
+  setting gmres_precon_type.
 */
 class ParOptInteriorPoint : public ParOptBase {
  public:
@@ -180,6 +192,10 @@ class ParOptInteriorPoint : public ParOptBase {
   // -----------------------------------------------
   void setUseDiagHessian(int truth);
 
+  // Set a user-supplied preconditioner for the GMRES solution
+  // ---------------------------------------------------------
+  void setHessianPrecon(ParOptHessianPrecon *_hprecon);
+
   // Quasi-Newton options
   // --------------------
   void setQuasiNewton(ParOptCompactQuasiNewton *_qn);
@@ -188,6 +204,13 @@ class ParOptInteriorPoint : public ParOptBase {
   // Reset the design point and the bounds using the problem instance
   // ----------------------------------------------------------------
   void resetDesignAndBounds();
+  void warmStartDesignAndBounds(ParOptVec *x, ParOptScalar *z = NULL,
+                                ParOptVec *zw = NULL, ParOptVec *zl = NULL,
+                                ParOptVec *zu = NULL);
+
+  // Set the problem factory used for the parallel line search
+  // ---------------------------------------------------------
+  void setLineSearchProblemFactory(ParOptProblemFactory *factory);
 
   // Write out the design variables to a binary format (fast MPI/IO)
   // ---------------------------------------------------------------
@@ -229,9 +252,18 @@ class ParOptInteriorPoint : public ParOptBase {
   // Set the size of the GMRES subspace
   void setGMRESSubspaceSize(int m);
 
+  // Write and read the checkpoint file
+  void addCheckpointRecords(ParOptCheckpoint *ck);
+  int readCheckpointRecords(ParOptCheckpoint *ck);
+  int startCheckpoint(const char *filename);
+  int finishCheckpoint(int wait);
+
   // Set the output file name and write the options summary
   void setOutputFile(const char *filename);
 
+  // Set the binary iteration history file
+  void setHistoryFile(const char *filename);
+
   // Print out the optimizer options to a file
   void printOptionSummary(FILE *fp);
 
@@ -241,11 +273,38 @@ class ParOptInteriorPoint : public ParOptBase {
   // Check and initialize the design variables and their bounds
   void initAndCheckDesignAndBounds();
 
+  // Find the variables with finite lower/upper bounds
+  void initBoundIndices();
+
+  // Copy the bound multipliers to/from the design-length vectors
+  void expandBoundMultipliers();
+  void compressBoundMultipliers();
+
   // Initialize the multipliers
   void initLeastSquaresMultipliers(ParOptVars &vars, ParOptVars &res,
                                    ParOptVec *yx);
   void initAffineStepMultipliers(ParOptVars &vars, ParOptVars &res,
                                  ParOptVars &step);
+  void initWarmStartMultipliers(ParOptVars &vars);
+
+  // Add the bound multipliers to a design vector: out += alpha*(zl - zu)
+  void addBoundMultipliers(ParOptScalar alpha, ParOptVars &vars,
+                           ParOptVec *out);
+
+  // Allocate storage for the dense or sparse constraint gradients
+  void initConGradients();
+
+  // Query which of the objective and constraints are linear/quadratic
+  void initLinearity();
+
+  // Evaluate the objective and dense constraint gradients
+  int evalObjConGradient(ParOptVec *x);
+
+  // Operations with the dense constraint gradients
+  ParOptVec *getConGradient(int i);
+  void addConGradients(ParOptScalar alpha, const ParOptScalar *z,
+                       ParOptVec *out);
+  void multConGradients(ParOptVec *px, int start, ParOptScalar *out);
 
   // Compute the negative of the KKT residuals - return
   // the maximum primal, dual residuals and the max infeasibility
@@ -268,7 +327,12 @@ class ParOptInteriorPoint : public ParOptBase {
 
   // Set up the diagonal KKT system
   void setUpKKTDiagSystem(ParOptVars &vars, ParOptVec *xtmp, ParOptVec *wtmp,
-                          int use_qn);
+                          int use_qn, ParOptVec *hdiag_precon = NULL);
+
+  // Form, factor and solve with the dense constraint Schur complement
+  void assembleGmat(ParOptVec *xtmp, ParOptVec *wtmp);
+  void factorGmat(ParOptVec *xtmp, ParOptVec *wtmp);
+  void solveGmat(ParOptScalar *r);
 
   // Solve the diagonal KKT system
   void solveKKTDiagSystem(ParOptVars &vars, ParOptVars &b, ParOptVars &y,
@@ -292,11 +356,32 @@ class ParOptInteriorPoint : public ParOptBase {
   void setUpKKTSystem(ParOptVars &vars, ParOptScalar *ztmp, ParOptVec *xtmp1,
                       ParOptVec *xtmp2, ParOptVec *wtmp, int use_qn);
 
+  // Set up, factor and solve the dense form of the KKT system
+  void initDenseKKTSystem(int use_hvec_product);
+  void factorDenseKKTSystem(ParOptVars &vars, int use_qn);
+  void solveDenseKKTSystem(ParOptVars &vars, ParOptVars &b, ParOptVars &y,
+                           ParOptVec *d1);
+
   // Solve for the KKT step
   void computeKKTStep(ParOptVars &vars, ParOptVars &res, ParOptVars &step,
                       ParOptScalar *ztmp, ParOptVec *xtmp1, ParOptVec *xtmp2,
                       ParOptVec *wtmp, int use_qn);
 
+  // Apply the preconditioned KKT operator in the GMRES subspace
+  void applyGMRESOperator(ParOptVars &vars, ParOptVars &res, ParOptVars &step,
+                          ParOptVec *win, ParOptScalar alpha, ParOptVec *wout,
+                          ParOptScalar *ztmp, ParOptVec *xtmp1,
+                          ParOptVec *xtmp2, ParOptVec *wtmp, int use_qn,
+                          ParOptScalar cscale, ParOptScalar cwscale,
+                          ParOptScalar *fproj, ParOptScalar *aproj,
+                          ParOptScalar *awproj);
+
+  // Form the recycled subspace from the harmonic Ritz vectors
+  int updateGMRESRecycleSpace(int nrecycle, int niters);
+
+  // Update the Hessian approximation used in the GMRES preconditioner
+  int updateGMRESPrecon(ParOptVars &vars, int use_qn);
+
   // Compute the full KKT step
   int computeKKTGMRESStep(ParOptVars &vars, ParOptVars &res, ParOptVars &step,
                           ParOptScalar *ztmp, ParOptVec *xtmp1,
@@ -322,15 +407,26 @@ class ParOptInteriorPoint : public ParOptBase {
                    const ParOptScalar *lower_value, const ParOptScalar *ubvals,
                    const ParOptScalar *upper_value);
 
+  // Set the trial point in the line search
+  void computeLineSearchPoint(double alpha);
+
   // Perform the line search
   int lineSearch(double alpha_min, double *_alpha, ParOptScalar m0,
                  ParOptScalar dm0);
 
+  // Set up, free and evaluate the processor groups for the line search
+  void initLineSearchGroups();
+  void freeLineSearchGroups();
+  void evalLineSearchGroups(int nalpha);
+
   // Scale the step by the distance-to-the-boundary rule
   int scaleKKTStep(ParOptVars &vars, ParOptVars &step, double tau,
                    ParOptScalar comp, int inexact_newton_step, double *_alpha_x,
                    double *_alpha_z);
 
+  // Compute the matrix-free Jacobian products for the quasi-Newton update
+  void initMatFreeQuasiNewtonUpdate(ParOptVars &vars, ParOptVars &step);
+
   // Perform a primal/dual update and optionally upate the quasi-Newton Hessian
   int computeStepAndUpdate(ParOptVars &vars, double alpha, ParOptVars &step,
                            int eval_obj_con, int perform_qn_update);
@@ -381,7 +477,7 @@ class ParOptInteriorPoint : public ParOptBase {
     // The variables in the optimization problem
     int ncon;
     ParOptVec *x;               // The design point
-    ParOptVec *zl, *zu;         // Multipliers for the upper/lower bounds
+    ParOptVec *zl, *zu;         // Multipliers for the bounded variables
     ParOptScalar *z, *zs, *zt;  // Multipliers for the dense constraints
     ParOptVec *zw, *zsw, *ztw;  // Multipliers for the sparse constraints
     ParOptScalar *s, *t;        // Slack variables
@@ -423,10 +519,48 @@ class ParOptInteriorPoint : public ParOptBase {
   // The lower/upper bounds on the variables
   ParOptVec *lb, *ub;
 
+  // Flag to indicate whether the bound multipliers are stored only
+  // for the bounded variables
+  int compact_bounds;
+
+  // The local indices of the variables with finite lower/upper bounds
+  int num_lower_bounds, num_upper_bounds;
+  int *lower_bound_index, *upper_bound_index;
+
+  // The bound multipliers expanded to the length of the design vector
+  ParOptVec *zl_full, *zu_full;
+
   // The objective, gradient, constraints, and constraint gradients
   ParOptScalar fobj, *c;
   ParOptVec *g, **Ac;
 
+  // The dense constraint gradients in the local sparse format. These
+  // are only used when the problem provides a non-zero pattern, in
+  // which case Ac is not allocated.
+  int ac_nnz;              // Number of local non-zeros (-1 if dense)
+  int *ac_rowp, *ac_cols;  // The pattern in compressed sparse row format
+  ParOptScalar *ac_vals;   // The non-zero entries
+  ParOptVec *ac_vec;       // An expanded constraint gradient or scratch
+  ParOptScalar *ac_prod;   // The products of the gradients with a vector
+
+  // Linearity of the dense constraints. The gradients of the linear
+  // constraints are only stored once in each call to optimize()
+  int *con_linear;         // Flag for each linear dense constraint
+  int num_linear_cons;     // The number of linear dense constraints
+  int linear_grad_init;    // Flag to indicate the gradients are set
+  int constant_hessian;    // The Hessian of the Lagrangian is constant
+  ParOptVec **ac_eval;     // The gradient vectors passed to the problem
+
+  // Data for the matrix-free Jacobian-vector products. These are used
+  // when the problem only provides products with the dense constraint
+  // Jacobian, in which case Ac is not allocated either.
+  int ac_matfree;          // Flag to indicate the matrix-free products
+  int ac_block_size;       // Number of vectors in each batched product
+  ParOptVec *ac_x;         // The point of the last gradient evaluation
+  ParOptVec **ac_batch;    // Work vectors for the batched products
+  ParOptScalar *ac_zwork;  // Work array of length ac_block_size*ncon
+  int ac_qn_init;          // Flag: the products for the update are set
+
   // The l1-penalty parameters for the dense constraints and sparse constraints
   double *penalty_gamma_s, *penalty_gamma_t;
   ParOptVec *penalty_gamma_sw, *penalty_gamma_tw;
@@ -437,13 +571,31 @@ class ParOptInteriorPoint : public ParOptBase {
   ParOptVec *Dinv, *Cdiag;
 
   // The Schur complement for the dense constraints
-  ParOptScalar *Gmat;
-  int *gpiv;
+  int gmat_dist;        // Flag to indicate the distributed factorization
+  int gmat_chol;        // Flag to indicate a Cholesky factorization
+  int gmat_block_size;  // The block size for the distributed storage
+  int gmat_dist_size;   // Size of the local block columns
+  ParOptScalar *gdiag;  // The diagonal contribution to the matrix
+  ParOptScalar *gwork;  // Work array of length ncon
+  ParOptScalar *Gmat;   // Packed lower triangle (root only)
+  int *gpiv;            // Pivots for the indefinite factorization
+  ParOptScalar *Gdist;  // The local block columns of the lower triangle
 
   // The Schur complement for the quasi-Newton Hessian approximation
   ParOptScalar *Ce;
   int *cpiv;
 
+  // Data for the dense direct solution of the KKT system
+  int dense_kkt;               // Flag to indicate whether to use dense mode
+  int dense_kkt_qn;            // QN flag of the factorization (-1 if none)
+  int dense_kkt_size;          // The dimension of the factored matrix
+  int dense_kkt_max_size;      // The maximum (allocated) dimension
+  ParOptScalar *dense_K;       // The factored matrix (root only)
+  ParOptScalar *dense_rhs;     // The right-hand-side/solution
+  ParOptScalar *dense_work;    // Work array for the factorization
+  int dense_lwork;             // The size of the work array
+  int *dense_piv;              // The pivots from the factorization
+
   // Storage for the Quasi-Newton updates
   ParOptCompactQuasiNewton *qn;
   ParOptVec *y_qn, *s_qn;
@@ -457,8 +609,9 @@ class ParOptInteriorPoint : public ParOptBase {
   // Flags to indicate whether to use the upper/lower bounds
   int use_lower, use_upper;
 
-  // The barrier parameter
+  // The barrier parameter and the current barrier strategy
   double barrier_param;
+  ParOptBarrierStrategy barrier_strategy;
 
   // Penalty parameter for the line search
   double rho_penalty_search;
@@ -469,8 +622,42 @@ class ParOptInteriorPoint : public ParOptBase {
   ParOptScalar *gmres_y, *gmres_fproj, *gmres_aproj, *gmres_awproj;
   ParOptVec **gmres_W;
 
+  // The recycled subspace U and its image C = A*U from the previous
+  // GMRES solve, and the work vector for the deflated directions
+  int gmres_recycle_size, gmres_num_recycled;
+  ParOptScalar *gmres_Hraw, *gmres_B, *gmres_uc;
+  ParOptVec **gmres_U, **gmres_C, *gmres_Z;
+
+  // The preconditioner for GMRES, the exact Hessian diagonal or
+  // user-supplied approximation and the steps since the last update
+  ParOptGMRESPreconType gmres_precon_type;
+  ParOptHessianPrecon *hprecon;
+  ParOptVec *gmres_hdiag;
+  int gmres_precon_age;
+
+  // The records for the checkpoint file and a flag to indicate that
+  // the next optimization restarts from the state read from a file
+  ParOptCheckpoint *checkpoint_file;
+  int checkpoint_restart;
+
+  // Flag to indicate that the next optimization is warm started
+  int warm_start;
+
+  // Data for the parallel line search
+  ParOptProblemFactory *ls_factory;
+  int ls_num_groups;               // The requested number of groups
+  ParOptProblemGroups *ls_groups;  // The processor groups
+  double *ls_alpha;                // The trial step lengths
+  ParOptScalar *ls_fobj;           // The objective at the trial points
+  ParOptScalar *ls_con;            // The constraints at the trial points
+  int *ls_fail;                    // Failure flags at the trial points
+  int ls_accept;                   // The group with the accepted point
+
   // The file pointer to use for printing things out
   FILE *outfp;
+
+  // The binary iteration history
+  ParOptHistory *history;
 };
 
 #endif  // PAR_OPT_INTERIOR_POINT_H
@@ -22,6 +22,40 @@ inline ParOptScalar max2(ParOptScalar a, ParOptScalar b) {
   }
 }
 
+/*
+  The number of design variables processed at a time in the fused
+  approximation kernels. The per-variable terms for a block are kept in
+  cache and reused for each of the constraints.
+*/
+static const int PAROPT_MMA_BLOCK_SIZE = 256;
+
+/*
+  Compute the coefficients of the MMA approximation of the objective
+  for a single design variable
+*/
+static inline void ParOptMMAObjCoef(ParOptScalar x, ParOptScalar L,
+                                    ParOptScalar U, ParOptScalar g, double eps,
+                                    double delta, ParOptScalar *p,
+                                    ParOptScalar *q) {
+  ParOptScalar gpos = max2(0.0, g);
+  ParOptScalar gneg = max2(0.0, -g);
+  ParOptScalar reg = eps / (U - L);
+  *p = (U - x) * (U - x) * ((1.0 + delta) * gpos + delta * gneg + reg);
+  *q = (x - L) * (x - L) * ((1.0 + delta) * gneg + delta * gpos + reg);
+}
+
+/*
+  Compute the coefficients of the MMA approximation of a constraint for
+  a single design variable. Here we form a convex approximation for
+  -c(x) since the constraints are formulated as c(x) >= 0.
+*/
+static inline void ParOptMMAConCoef(ParOptScalar x, ParOptScalar L,
+                                    ParOptScalar U, ParOptScalar A,
+                                    ParOptScalar *p, ParOptScalar *q) {
+  *p = (U - x) * (U - x) * max2(0.0, -A);
+  *q = (x - L) * (x - L) * max2(0.0, A);
+}
+
 /*
   Create the ParOptMMA object
 */
@@ -57,6 +91,13 @@ ParOptMMA::ParOptMMA(ParOptProblem *_prob, ParOptOptions *_options)
   const char *mma_output_file = options->getStringOption("mma_output_file");
   setOutputFile(mma_output_file);
 
+  // Set the binary history file, if any
+  history = NULL;
+  const char *mma_history_file = options->getStringOption("mma_history_file");
+  if (mma_history_file) {
+    setHistoryFile(mma_history_file);
+  }
+
   // Set the problem sizes
   int _nwcon;
   prob->getProblemSizes(&n, &m, &_nwcon);
@@ -71,6 +112,10 @@ ParOptMMA::ParOptMMA(ParOptProblem *_prob, ParOptOptions *_options)
   mma_iter = 0;
   subproblem_iter = 0;
 
+  // Check whether to store the approximation coefficients
+  low_memory = options->getBoolOption("mma_low_memory");
+  reg_eps = reg_delta = 0.0;
+
   // Initialize the data
   initialize();
 }
@@ -82,6 +127,9 @@ ParOptMMA::~ParOptMMA() {
   if (fp && fp != stdout) {
     fclose(fp);
   }
+  if (history) {
+    history->decref();
+  }
   prob->decref();
 
   xvec->decref();
@@ -101,21 +149,22 @@ ParOptMMA::~ParOptMMA() {
   Uvec->decref();
   alphavec->decref();
   betavec->decref();
-  p0vec->decref();
-  q0vec->decref();
+  if (p0vec) {
+    p0vec->decref();
+    q0vec->decref();
+  }
 
-  if (use_true_mma) {
+  if (pivecs) {
     for (int i = 0; i < m; i++) {
       pivecs[i]->decref();
       qivecs[i]->decref();
     }
     delete[] qivecs;
     delete[] pivecs;
-    delete[] b;
-  } else {
-    if (cwvec) {
-      cwvec->decref();
-    }
+  }
+  delete[] b;
+  if (cwvec) {
+    cwvec->decref();
   }
 
   delete[] z;
@@ -123,6 +172,9 @@ ParOptMMA::~ParOptMMA() {
   zlvec->decref();
   zuvec->decref();
   rvec->decref();
+  if (xdualvec) {
+    xdualvec->decref();
+  }
 }
 
 /*
@@ -169,23 +221,32 @@ void ParOptMMA::initialize() {
   alphavec->set(0.0);
   betavec->set(1.0);
 
-  // Create the coefficient vectors
-  p0vec = prob->createDesignVec();
-  p0vec->incref();
-  q0vec = prob->createDesignVec();
-  q0vec->incref();
+  // Create the coefficient vectors. With the low memory option, the
+  // coefficients are recomputed from the gradients and the asymptotes
+  // when they are needed.
+  p0vec = q0vec = NULL;
+  if (!low_memory) {
+    p0vec = prob->createDesignVec();
+    p0vec->incref();
+    q0vec = prob->createDesignVec();
+    q0vec->incref();
+  }
 
   // Set the sparse constraint vector to NULL
   cwvec = NULL;
 
   if (use_true_mma) {
-    pivecs = new ParOptVec *[m];
-    qivecs = new ParOptVec *[m];
-    for (int i = 0; i < m; i++) {
-      pivecs[i] = prob->createDesignVec();
-      pivecs[i]->incref();
-      qivecs[i] = prob->createDesignVec();
-      qivecs[i]->incref();
+    pivecs = NULL;
+    qivecs = NULL;
+    if (!low_memory) {
+      pivecs = new ParOptVec *[m];
+      qivecs = new ParOptVec *[m];
+      for (int i = 0; i < m; i++) {
+        pivecs[i] = prob->createDesignVec();
+        pivecs[i]->incref();
+        qivecs[i] = prob->createDesignVec();
+        qivecs[i]->incref();
+      }
     }
 
     b = new ParOptScalar[m];
@@ -229,6 +290,9 @@ void ParOptMMA::initialize() {
   // Create a sparse constraint vector
   rvec = prob->createDesignVec();
   rvec->incref();
+
+  // The dual solution vector is only allocated if needed
+  xdualvec = NULL;
 }
 
 void ParOptMMA::addDefaultOptions(ParOptOptions *options) {
@@ -236,6 +300,9 @@ void ParOptMMA::addDefaultOptions(ParOptOptions *options) {
   options->addStringOption("mma_output_file", "paropt.mma",
                            "Ouput file name for MMA");
 
+  options->addStringOption("mma_history_file", NULL,
+                           "Binary iteration history file name for MMA");
+
   options->addIntOption("mma_max_iterations", 200, 0, 1000000,
                         "Maximum number of iterations");
 
@@ -248,6 +315,38 @@ void ParOptMMA::addDefaultOptions(ParOptOptions *options) {
   options->addFloatOption("mma_infeas_tol", 1e-5, 0.0, 1e20,
                           "Infeasibility tolerance ");
 
+  options->addBoolOption(
+      "mma_adaptive_subproblem_tol", 0,
+      "Solve the subproblems inexactly with a tolerance set from the KKT "
+      "error of the MMA iterates");
+
+  options->addFloatOption(
+      "mma_adaptive_tol_factor", 0.1, 0.0, 1.0,
+      "Ratio of the subproblem tolerance to the MMA KKT error");
+
+  options->addFloatOption("mma_adaptive_tol_max", 0.1, 0.0, 1e20,
+                          "Maximum subproblem tolerance");
+
+  options->addIntOption(
+      "mma_adaptive_max_subproblem_iters", 50, 1, 1000000,
+      "Maximum number of subproblem iterations while the subproblem "
+      "tolerance is above the interior-point tolerance");
+
+  const char *solver_options[2] = {"interior_point", "dual"};
+  options->addEnumOption(
+      "mma_subproblem_solver", "interior_point", 2, solver_options,
+      "The method used to solve the MMA subproblem. The dual method can "
+      "only be used with the MMA constraint approximation and dense "
+      "inequality constraints");
+
+  options->addIntOption("mma_dual_max_iterations", 100, 1, 1000000,
+                        "Maximum number of iterations of the dual method");
+
+  options->addBoolOption(
+      "mma_low_memory", 0,
+      "Recompute the coefficients of the MMA approximation from the "
+      "gradients and asymptotes instead of storing them");
+
   options->addIntOption(
       "output_level", 0, 0, 1000000,
       "Output level indicating how verbose the output should be");
@@ -307,6 +406,29 @@ void ParOptMMA::setOutputFile(const char *filename) {
   }
 }
 
+/*
+  Set the binary iteration history file (only written on the root proc)
+*/
+void ParOptMMA::setHistoryFile(const char *filename) {
+  if (!history) {
+    history = new ParOptHistory(comm, "mma");
+    history->incref();
+    history->addColumn("MMA", PAROPT_HISTORY_INT);
+    history->addColumn("sub-iter", PAROPT_HISTORY_INT);
+    history->addColumn("fobj", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("l1-opt", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("linft-opt", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("l1-lambd", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("infeas", PAROPT_HISTORY_DOUBLE);
+  }
+
+  if (filename) {
+    history->open(filename);
+  } else {
+    history->close();
+  }
+}
+
 /*
   Write the parameters to the output file
 */
@@ -328,6 +450,17 @@ void ParOptMMA::optimize(ParOptInteriorPoint *optimizer) {
   const double infeas_tol = options->getFloatOption("mma_infeas_tol");
   const double l1_tol = options->getFloatOption("mma_l1_tol");
   const double linfty_tol = options->getFloatOption("mma_linfty_tol");
+  const int adaptive_tol =
+      options->getBoolOption("mma_adaptive_subproblem_tol");
+  const double adaptive_tol_factor =
+      options->getFloatOption("mma_adaptive_tol_factor");
+  const double adaptive_tol_max =
+      options->getFloatOption("mma_adaptive_tol_max");
+  const int adaptive_max_iters =
+      options->getIntOption("mma_adaptive_max_subproblem_iters");
+  const char *subproblem_solver =
+      options->getEnumOption("mma_subproblem_solver");
+  const int dual_max_iters = options->getIntOption("mma_dual_max_iterations");
 
   // Set what type of sub-problem we're going to use. Check if the flag
   // has been set to use a linearization of the constraints. If so, then
@@ -338,35 +471,111 @@ void ParOptMMA::optimize(ParOptInteriorPoint *optimizer) {
   // Set the member controlling the use of the MMA constraint approximation
   use_true_mma = !use_linearized;
 
+  // The dual method requires the separable MMA approximation for all of
+  // the constraints, so it cannot be used with the linearized or sparse
+  // constraints or with equality constraints
+  int use_dual = 0;
+  if (strcmp(subproblem_solver, "dual") == 0) {
+    if (use_true_mma && nwcon == 0 && ninequality == m) {
+      use_dual = 1;
+    } else {
+      fprintf(stderr,
+              "ParOptMMA: The dual subproblem solver cannot be used with "
+              "this problem, using the interior-point method\n");
+    }
+  }
+
   // Set the interior point optimizer data to be compatible
   ParOptOptions *options = optimizer->getOptions();
   options->setOption("use_diag_hessian", 1);
   options->setOption("use_line_search", 0);
 
+  // Store the interior-point tolerance and iteration limit. When the
+  // adaptive subproblem tolerance is used, the subproblems are solved
+  // to a tolerance that is a fraction of the KKT error, but never more
+  // tightly than abs_res_tol. The tolerance is never loosened, so that
+  // it decreases to abs_res_tol as the iterates converge. While it is
+  // looser than abs_res_tol, the number of iterations is also limited.
+  const double abs_res_tol = options->getFloatOption("abs_res_tol");
+  const int max_major_iters = options->getIntOption("max_major_iters");
+  double subproblem_tol = adaptive_tol_max;
+
+  // The upper bound on the multipliers in the dual method. This is the
+  // exact l1 penalty used by the interior-point method so that both
+  // methods find the same solution when the subproblem is infeasible.
+  const double penalty_gamma = options->getFloatOption("penalty_gamma");
+
   initializeSubProblem(xvec);
   optimizer->resetDesignAndBounds();
 
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
   for (int i = 0; i < max_iterations; i++) {
-    // Optimize the sub-problem
-    optimizer->optimize();
+    int dual_fail = 0;
+    if (use_dual) {
+      // Solve the sub-problem using the dual method. This sets the
+      // multipliers and the solution in xdualvec.
+      double tol = abs_res_tol;
+      if (adaptive_tol && subproblem_tol > abs_res_tol) {
+        tol = subproblem_tol;
+      }
+      dual_fail = solveDualSubproblem(tol, dual_max_iters, penalty_gamma);
 
-    // Get the optimized point
-    ParOptVec *x, *zw, *zl, *zu;
-    ParOptScalar *z;
-    optimizer->getOptimizedPoint(&x, &z, &zw, &zl, &zu);
+      if (!dual_fail) {
+        // Initialize the subproblem about the new point
+        initializeSubProblem(xdualvec);
+      } else {
+        // Fall back to the interior-point method for this subproblem
+        if (rank == 0) {
+          fprintf(stderr,
+                  "ParOptMMA: The dual subproblem solver failed, using the "
+                  "interior-point method\n");
+        }
+        optimizer->resetDesignAndBounds();
+      }
+    }
 
-    // Set the multipliers
-    setMultipliers(z, zw, zl, zu);
+    if (!use_dual || dual_fail) {
+      // Optimize the sub-problem
+      if (adaptive_tol && subproblem_tol > abs_res_tol) {
+        options->setOption("abs_res_tol", subproblem_tol);
+        if (adaptive_max_iters < max_major_iters) {
+          options->setOption("max_major_iters", adaptive_max_iters);
+        }
+        optimizer->optimize();
+        options->setOption("abs_res_tol", abs_res_tol);
+        options->setOption("max_major_iters", max_major_iters);
+      } else {
+        optimizer->optimize();
+      }
+
+      // Get the optimized point
+      ParOptVec *x, *zw, *zl, *zu;
+      ParOptScalar *z;
+      optimizer->getOptimizedPoint(&x, &z, &zw, &zl, &zu);
 
-    // Initialize the subproblem about the new point
-    initializeSubProblem(x);
+      // Set the multipliers
+      setMultipliers(z, zw, zl, zu);
 
-    // Reset the variable bounds
-    optimizer->resetDesignAndBounds();
+      // Initialize the subproblem about the new point
+      initializeSubProblem(x);
+
+      // Reset the variable bounds
+      optimizer->resetDesignAndBounds();
+    }
 
     // Compute the KKT error;
     double infeas, l1, linfty;
-    computeKKTError(&infeas, &l1, &linfty);
+    computeKKTError(&l1, &linfty, &infeas);
+
+    // Update the tolerance for the next subproblem
+    if (adaptive_tol) {
+      double tol = adaptive_tol_factor * (infeas > linfty ? infeas : linfty);
+      if (tol < subproblem_tol) {
+        subproblem_tol = tol;
+      }
+    }
 
     // Check for convergence of the trust region problem
     if (infeas < infeas_tol) {
@@ -378,6 +587,383 @@ void ParOptMMA::optimize(ParOptInteriorPoint *optimizer) {
   }
 }
 
+/*
+  Evaluate the dual function of the MMA subproblem.
+
+  The MMA subproblem with the constraint approximation is
+
+  min f(x) = sum_j p0[j]/(U[j] - x[j]) + q0[j]/(x[j] - L[j])
+  s.t. g_i(x) = sum_j pi[j]/(U[j] - x[j]) + qi[j]/(x[j] - L[j]) + b[i] <= 0
+       alpha <= x <= beta
+
+  For multipliers lambda >= 0, the Lagrangian is separable and its
+  minimizer over the bounds has the closed form
+
+  x[j] = (sqrt(P[j])*L[j] + sqrt(Q[j])*U[j])/(sqrt(P[j]) + sqrt(Q[j]))
+
+  clipped to [alpha[j], beta[j]], where P = p0 + sum_i lambda[i]*pi and
+  Q = q0 + sum_i lambda[i]*qi. The dual function is the value of the
+  Lagrangian at this point, its gradient is g(x) and its Hessian is
+
+  H = -sum_j (dg/dx[j])*(dg/dx[j])^{T}/(d^2 L/dx[j]^2)
+
+  where the sum is taken over the variables that are not at a bound.
+  The dual, gradient and Hessian are stored in data as
+  [dual, grad[0:m], H[0:m*m]] and are summed across all processors with
+  a single reduction. The minimizer is stored in xdualvec.
+*/
+void ParOptMMA::evalDual(const ParOptScalar *lambda, ParOptScalar *data) {
+  // Get the design variables, asymptotes and move limits
+  ParOptScalar *x0, *x, *L, *U, *alpha, *beta;
+  xvec->getArray(&x0);
+  xdualvec->getArray(&x);
+  Lvec->getArray(&L);
+  Uvec->getArray(&U);
+  alphavec->getArray(&alpha);
+  betavec->getArray(&beta);
+
+  ParOptScalar *grad = &data[1];
+  ParOptScalar *hess = &data[1 + m];
+  memset(data, 0, (1 + m + m * m) * sizeof(ParOptScalar));
+
+  // The derivatives of the constraints for each variable in the block
+  ParOptScalar *dg = new ParOptScalar[m * PAROPT_MMA_BLOCK_SIZE];
+
+  for (int j0 = 0; j0 < n; j0 += PAROPT_MMA_BLOCK_SIZE) {
+    const int nb =
+        (n - j0 < PAROPT_MMA_BLOCK_SIZE ? n - j0 : PAROPT_MMA_BLOCK_SIZE);
+    ParOptScalar P[PAROPT_MMA_BLOCK_SIZE], Q[PAROPT_MMA_BLOCK_SIZE];
+    ParOptScalar Uinv[PAROPT_MMA_BLOCK_SIZE], Linv[PAROPT_MMA_BLOCK_SIZE];
+    ParOptScalar w[PAROPT_MMA_BLOCK_SIZE];
+    getLagrangianCoefs(lambda, j0, nb, P, Q);
+
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      // Find the minimizer of the Lagrangian for this variable
+      ParOptScalar sP = sqrt(P[k]);
+      ParOptScalar sQ = sqrt(Q[k]);
+      if (ParOptRealPart(sP + sQ) > 0.0) {
+        x[j] = (sP * L[j] + sQ * U[j]) / (sP + sQ);
+      } else {
+        x[j] = x0[j];
+      }
+
+      int is_free = 1;
+      if (ParOptRealPart(x[j]) <= ParOptRealPart(alpha[j])) {
+        x[j] = alpha[j];
+        is_free = 0;
+      } else if (ParOptRealPart(x[j]) >= ParOptRealPart(beta[j])) {
+        x[j] = beta[j];
+        is_free = 0;
+      }
+
+      Uinv[k] = 1.0 / (U[j] - x[j]);
+      Linv[k] = 1.0 / (x[j] - L[j]);
+      data[0] += P[k] * Uinv[k] + Q[k] * Linv[k];
+
+      // Store the inverse of the second derivative of the Lagrangian
+      // for the variables that are not at a bound
+      w[k] = 0.0;
+      if (is_free) {
+        ParOptScalar d2 = 2.0 * (P[k] * Uinv[k] * Uinv[k] * Uinv[k] +
+                                 Q[k] * Linv[k] * Linv[k] * Linv[k]);
+        if (ParOptRealPart(d2) > 0.0) {
+          w[k] = 1.0 / d2;
+        }
+      }
+    }
+
+    for (int i = 0; i < m; i++) {
+      ParOptScalar pw[PAROPT_MMA_BLOCK_SIZE], qw[PAROPT_MMA_BLOCK_SIZE];
+      const ParOptScalar *p, *q;
+      getConCoefs(i, j0, nb, pw, qw, &p, &q);
+
+      ParOptScalar *dgi = &dg[i * PAROPT_MMA_BLOCK_SIZE];
+      for (int k = 0; k < nb; k++) {
+        grad[i] += p[k] * Uinv[k] + q[k] * Linv[k];
+        dgi[k] = p[k] * Uinv[k] * Uinv[k] - q[k] * Linv[k] * Linv[k];
+      }
+    }
+
+    for (int i = 0; i < m; i++) {
+      const ParOptScalar *dgi = &dg[i * PAROPT_MMA_BLOCK_SIZE];
+      for (int l = 0; l < m; l++) {
+        const ParOptScalar *dgl = &dg[l * PAROPT_MMA_BLOCK_SIZE];
+        ParOptScalar h = 0.0;
+        for (int k = 0; k < nb; k++) {
+          h += dgi[k] * dgl[k] * w[k];
+        }
+        hess[i * m + l] -= h;
+      }
+    }
+  }
+
+  delete[] dg;
+
+  MPI_Allreduce(MPI_IN_PLACE, data, 1 + m + m * m, PAROPT_MPI_TYPE, MPI_SUM,
+                comm);
+
+  // Add the contribution from the constant terms
+  for (int i = 0; i < m; i++) {
+    data[0] += lambda[i] * b[i];
+    grad[i] += b[i];
+  }
+}
+
+/*
+  Solve the MMA subproblem by maximizing the concave dual function.
+
+  The dual is maximized over 0 <= lambda <= max_multiplier using a
+  projected Newton method with a backtracking line search. The upper
+  bound on the multipliers makes the dual bounded when the subproblem
+  is infeasible, and corresponds to an l1 penalty on the constraint
+  violation. Each dual evaluation requires a single reduction. The
+  method starts from the current multipliers and terminates when the
+  projected gradient of the dual, which is the constraint violation,
+  is less than tol.
+
+  On exit, the multipliers are set from the dual solution, the bound
+  multipliers are computed from the gradient of the Lagrangian and the
+  primal solution is stored in xdualvec.
+
+  @param tol The tolerance on the projected gradient of the dual
+  @param max_iters The maximum number of Newton iterations
+  @param max_multiplier The upper bound on the multipliers
+  @return Zero if the method converged, non-zero otherwise
+*/
+int ParOptMMA::solveDualSubproblem(double tol, int max_iters,
+                                   double max_multiplier) {
+  if (!xdualvec) {
+    xdualvec = prob->createDesignVec();
+    xdualvec->incref();
+  }
+
+  const int size = 1 + m + m * m;
+  ParOptScalar *lambda = new ParOptScalar[m];
+  ParOptScalar *trial = new ParOptScalar[m];
+  ParOptScalar *data = new ParOptScalar[size];
+  ParOptScalar *tdata = new ParOptScalar[size];
+  ParOptScalar *step = new ParOptScalar[m];
+  ParOptScalar *K = new ParOptScalar[m * m];
+  int *free_vars = new int[m];
+  int *ipiv = new int[m];
+
+  // Start from the multipliers from the previous subproblem
+  for (int i = 0; i < m; i++) {
+    lambda[i] = max2(0.0, min2(max_multiplier, z[i]));
+  }
+  evalDual(lambda, data);
+
+  int fail = 1;
+  for (int k = 0; k < max_iters; k++) {
+    subproblem_iter++;
+    ParOptScalar *grad = &data[1];
+    ParOptScalar *hess = &data[1 + m];
+
+    // Compute the norm of the projected gradient and find the
+    // multipliers that are not fixed at a bound
+    double pg_norm = 0.0;
+    int nfree = 0;
+    for (int i = 0; i < m; i++) {
+      double g = ParOptRealPart(grad[i]);
+      double l = ParOptRealPart(lambda[i]);
+      if (!((l <= 0.0 && g < 0.0) || (l >= max_multiplier && g > 0.0))) {
+        if (fabs(g) > pg_norm) {
+          pg_norm = fabs(g);
+        }
+        free_vars[nfree] = i;
+        nfree++;
+      }
+    }
+    if (pg_norm < tol) {
+      fail = 0;
+      break;
+    }
+
+    // Compute the Newton step for the free multipliers from
+    // (-H + eps*I)*step = grad, with a small regularization since the
+    // dual Hessian is singular when the variables are at their bounds
+    double hmax = 0.0;
+    for (int a = 0; a < nfree; a++) {
+      int i = free_vars[a];
+      if (fabs(ParOptRealPart(hess[i * m + i])) > hmax) {
+        hmax = fabs(ParOptRealPart(hess[i * m + i]));
+      }
+    }
+    for (int a = 0; a < nfree; a++) {
+      for (int b = 0; b < nfree; b++) {
+        K[a + b * nfree] = -hess[free_vars[a] * m + free_vars[b]];
+      }
+      K[a + a * nfree] += 1e-8 * (1.0 + hmax);
+      step[a] = grad[free_vars[a]];
+    }
+
+    int info = 0, one = 1;
+    LAPACKdgetrf(&nfree, &nfree, K, &nfree, ipiv, &info);
+    if (info == 0) {
+      LAPACKdgetrs("N", &nfree, &one, K, &nfree, ipiv, step, &nfree, &info);
+    }
+    if (info != 0) {
+      break;
+    }
+
+    // Perform a backtracking line search along the projected path
+    int accept = 0;
+    double alpha = 1.0;
+    for (int j = 0; j < 30; j++, alpha *= 0.5) {
+      memcpy(trial, lambda, m * sizeof(ParOptScalar));
+      for (int a = 0; a < nfree; a++) {
+        int i = free_vars[a];
+        trial[i] = max2(0.0, min2(max_multiplier, lambda[i] + alpha * step[a]));
+      }
+
+      ParOptScalar slope = 0.0;
+      for (int i = 0; i < m; i++) {
+        slope += grad[i] * (trial[i] - lambda[i]);
+      }
+
+      evalDual(trial, tdata);
+      if (ParOptRealPart(tdata[0]) >= ParOptRealPart(data[0] + 1e-4 * slope)) {
+        accept = 1;
+        break;
+      }
+    }
+
+    if (!accept) {
+      // Restore the primal solution at the last point
+      evalDual(lambda, data);
+      break;
+    }
+
+    memcpy(lambda, trial, m * sizeof(ParOptScalar));
+    memcpy(data, tdata, size * sizeof(ParOptScalar));
+  }
+
+  // Set the multipliers for the constraints
+  memcpy(z, lambda, m * sizeof(ParOptScalar));
+
+  // Compute the bound multipliers from the gradient of the Lagrangian
+  ParOptScalar *x, *L, *U, *alpha, *beta, *zl, *zu;
+  xdualvec->getArray(&x);
+  Lvec->getArray(&L);
+  Uvec->getArray(&U);
+  alphavec->getArray(&alpha);
+  betavec->getArray(&beta);
+  zlvec->getArray(&zl);
+  zuvec->getArray(&zu);
+
+  for (int j0 = 0; j0 < n; j0 += PAROPT_MMA_BLOCK_SIZE) {
+    const int nb =
+        (n - j0 < PAROPT_MMA_BLOCK_SIZE ? n - j0 : PAROPT_MMA_BLOCK_SIZE);
+    ParOptScalar P[PAROPT_MMA_BLOCK_SIZE], Q[PAROPT_MMA_BLOCK_SIZE];
+    getLagrangianCoefs(lambda, j0, nb, P, Q);
+
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
+      ParOptScalar Linv = 1.0 / (x[j] - L[j]);
+      ParOptScalar r = P[k] * Uinv * Uinv - Q[k] * Linv * Linv;
+
+      zl[j] = zu[j] = 0.0;
+      if (ParOptRealPart(x[j]) <= ParOptRealPart(alpha[j])) {
+        zl[j] = max2(0.0, r);
+      } else if (ParOptRealPart(x[j]) >= ParOptRealPart(beta[j])) {
+        zu[j] = max2(0.0, -r);
+      }
+    }
+  }
+
+  delete[] lambda;
+  delete[] trial;
+  delete[] data;
+  delete[] tdata;
+  delete[] step;
+  delete[] K;
+  delete[] free_vars;
+  delete[] ipiv;
+
+  return fail;
+}
+
+/*
+  Get the coefficients of the objective approximation for the design
+  variables j0 <= j < j0 + nb. The stored coefficients are returned or,
+  if they are not stored, they are computed in the work arrays pw and
+  qw from the gradient and the asymptotes.
+*/
+void ParOptMMA::getObjCoefs(int j0, int nb, ParOptScalar *pw,
+                            ParOptScalar *qw, const ParOptScalar **p,
+                            const ParOptScalar **q) {
+  if (p0vec) {
+    ParOptScalar *p0, *q0;
+    p0vec->getArray(&p0);
+    q0vec->getArray(&q0);
+    *p = &p0[j0];
+    *q = &q0[j0];
+  } else {
+    ParOptScalar *x, *L, *U, *g;
+    xvec->getArray(&x);
+    Lvec->getArray(&L);
+    Uvec->getArray(&U);
+    gvec->getArray(&g);
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      ParOptMMAObjCoef(x[j], L[j], U[j], g[j], reg_eps, reg_delta, &pw[k],
+                       &qw[k]);
+    }
+    *p = pw;
+    *q = qw;
+  }
+}
+
+/*
+  Get the coefficients of the approximation of the i-th constraint for
+  the design variables j0 <= j < j0 + nb
+*/
+void ParOptMMA::getConCoefs(int i, int j0, int nb, ParOptScalar *pw,
+                            ParOptScalar *qw, const ParOptScalar **p,
+                            const ParOptScalar **q) {
+  if (pivecs) {
+    ParOptScalar *pi, *qi;
+    pivecs[i]->getArray(&pi);
+    qivecs[i]->getArray(&qi);
+    *p = &pi[j0];
+    *q = &qi[j0];
+  } else {
+    ParOptScalar *x, *L, *U, *A;
+    xvec->getArray(&x);
+    Lvec->getArray(&L);
+    Uvec->getArray(&U);
+    Avecs[i]->getArray(&A);
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      ParOptMMAConCoef(x[j], L[j], U[j], A[j], &pw[k], &qw[k]);
+    }
+    *p = pw;
+    *q = qw;
+  }
+}
+
+/*
+  Get the coefficients of the Lagrangian of the subproblem,
+  P = p0 + sum_i lambda[i]*pi and Q = q0 + sum_i lambda[i]*qi, for the
+  design variables j0 <= j < j0 + nb
+*/
+void ParOptMMA::getLagrangianCoefs(const ParOptScalar *lambda, int j0, int nb,
+                                   ParOptScalar *P, ParOptScalar *Q) {
+  ParOptScalar pw[PAROPT_MMA_BLOCK_SIZE], qw[PAROPT_MMA_BLOCK_SIZE];
+  const ParOptScalar *p, *q;
+  getObjCoefs(j0, nb, pw, qw, &p, &q);
+  for (int k = 0; k < nb; k++) {
+    P[k] = p[k];
+    Q[k] = q[k];
+  }
+
+  for (int i = 0; i < m; i++) {
+    getConCoefs(i, j0, nb, pw, qw, &p, &q);
+    for (int k = 0; k < nb; k++) {
+      P[k] += lambda[i] * p[k];
+      Q[k] += lambda[i] * q[k];
+    }
+  }
+}
+
 /*
   Set the new values of the multipliers
 */
@@ -488,6 +1074,26 @@ void ParOptMMA::computeKKTError(double *l1, double *linfty, double *infeas) {
 */
 void ParOptMMA::getOptimizedPoint(ParOptVec **_x) { *_x = xvec; }
 
+/*
+  Get the multipliers from the last subproblem. These are set either
+  from the interior-point solution or by the dual method.
+*/
+void ParOptMMA::getMultipliers(ParOptScalar **_z, ParOptVec **_zw,
+                               ParOptVec **_zl, ParOptVec **_zu) {
+  if (_z) {
+    *_z = z;
+  }
+  if (_zw) {
+    *_zw = zwvec;
+  }
+  if (_zl) {
+    *_zl = zlvec;
+  }
+  if (_zu) {
+    *_zu = zuvec;
+  }
+}
+
 /*
   Get the asymptotes themselves
 */
@@ -536,6 +1142,8 @@ int ParOptMMA::initializeSubProblem(ParOptVec *xv) {
   // approximations
   const double eps = options->getFloatOption("mma_eps_regularization");
   const double delta = options->getFloatOption("mma_delta_regularization");
+  reg_eps = eps;
+  reg_delta = delta;
 
   // Get the output level
   const int output_level = options->getIntOption("output_level");
@@ -556,7 +1164,18 @@ int ParOptMMA::initializeSubProblem(ParOptVec *xv) {
     return fail_obj;
   }
 
-  int fail_grad = prob->evalObjConGradient(xvec, gvec, Avecs);
+  // After the first iteration, the gradients of the linear constraints
+  // stored in Avecs are re-used. Their new values are written to the
+  // temporary vector rvec and discarded.
+  ParOptVec **Aeval = new ParOptVec *[m];
+  for (int i = 0; i < m; i++) {
+    Aeval[i] = Avecs[i];
+    if (mma_iter > 0 && prob->isDenseConLinear(i)) {
+      Aeval[i] = rvec;
+    }
+  }
+  int fail_grad = prob->evalObjConGradient(xvec, gvec, Aeval);
+  delete[] Aeval;
   if (fail_grad) {
     fprintf(stderr, "ParOptMMA: Gradient evaluation failed\n");
     return fail_grad;
@@ -593,6 +1212,23 @@ int ParOptMMA::initializeSubProblem(ParOptVec *xv) {
       // Set the first print flag to false
       first_print = 0;
     }
+
+    // Append the iteration to the binary history
+    if (history) {
+      double l1_lambda = 0.0;
+      for (int i = 0; i < m; i++) {
+        l1_lambda += fabs(ParOptRealPart(z[i]));
+      }
+
+      history->setInt("MMA", mma_iter);
+      history->setInt("sub-iter", subproblem_iter);
+      history->setDouble("fobj", ParOptRealPart(fobj));
+      history->setDouble("l1-opt", l1);
+      history->setDouble("linft-opt", linfty);
+      history->setDouble("l1-lambd", l1_lambda);
+      history->setDouble("infeas", infeas);
+      history->writeRow();
+    }
   }
 
   // Get the current values of the design variables
@@ -611,120 +1247,148 @@ int ParOptMMA::initializeSubProblem(ParOptVec *xv) {
   lbvec->getArray(&lb);
   ubvec->getArray(&ub);
 
-  // Set all of the asymptote values
-  if (mma_iter < 2) {
-    for (int j = 0; j < n; j++) {
-      // Apply move limit for the design variables
-      ParOptScalar lower = max2(lb[j], x[j] - movlim);
-      ParOptScalar upper = min2(ub[j], x[j] + movlim);
-
-      L[j] = x[j] - init_asymptote_offset * (upper - lower);
-      U[j] = x[j] + init_asymptote_offset * (upper - lower);
-    }
-  } else {
-    for (int j = 0; j < n; j++) {
-      // Apply move limit for the design variables
-      ParOptScalar lower = max2(lb[j], x[j] - movlim);
-      ParOptScalar upper = min2(ub[j], x[j] + movlim);
-
-      // Compute the product of the difference of the two previous
-      // updates to determine how to update the move limits. If the
-      // signs are different, then indc < 0.0 and we contract the
-      // asymptotes, otherwise we expand the asymptotes.
-      ParOptScalar indc = (x[j] - x1[j]) * (x1[j] - x2[j]);
-
-      // Store the previous values of the asymptotes
-      ParOptScalar Lprev = L[j];
-      ParOptScalar Uprev = U[j];
-
-      // Compute the interval length
-      ParOptScalar intrvl = max2(upper - lower, 0.01);
-      intrvl = min2(intrvl, 100.0);
-
-      if (ParOptRealPart(indc) < 0.0) {
-        // oscillation -> contract the asymptotes
-        L[j] = x[j] - asymptote_contract * (x1[j] - Lprev);
-        U[j] = x[j] + asymptote_contract * (Uprev - x1[j]);
-      } else {
-        // Relax the asymptotes
-        L[j] = x[j] - asymptote_relax * (x1[j] - Lprev);
-        U[j] = x[j] + asymptote_relax * (Uprev - x1[j]);
-      }
-
-      // Ensure that the asymptotes do not converge entirely on the
-      // design variable value
-      L[j] = min2(L[j], x[j] - min_asymptote_offset * intrvl);
-      U[j] = max2(U[j], x[j] + min_asymptote_offset * intrvl);
-
-      // Enforce a maximum offset so that the asymptotes do not
-      // move too far away from the design variables
-      L[j] = max2(L[j], x[j] - max_asymptote_offset * intrvl);
-      U[j] = min2(U[j], x[j] + max_asymptote_offset * intrvl);
-    }
-  }
-
   // Get the objective gradient array
   ParOptScalar *g;
   gvec->getArray(&g);
 
-  // Allocate a temp array to store the pointers
-  // to the constraint vector
-  ParOptScalar **A = new ParOptScalar *[m];
-  for (int i = 0; i < m; i++) {
-    Avecs[i]->getArray(&A[i]);
+  // Get the coefficients for the objective approximation, if they are
+  // stored
+  ParOptScalar *p0 = NULL, *q0 = NULL;
+  if (p0vec) {
+    p0vec->getArray(&p0);
+    q0vec->getArray(&q0);
   }
 
-  // Get the coefficients for the objective/constraint approximation
-  // information
-  ParOptScalar *p0, *q0;
-  p0vec->getArray(&p0);
-  q0vec->getArray(&q0);
-
   // Get the move limit vectors
   ParOptScalar *alpha, *beta;
   alphavec->getArray(&alpha);
   betavec->getArray(&beta);
 
-  // Compute the values of the lower/upper assymptotes
-  for (int j = 0; j < n; j++) {
-    // Apply move limit for the design variables
-    ParOptScalar lower = max2(lb[j], x[j] - movlim);
-    ParOptScalar upper = min2(ub[j], x[j] + movlim);
-
-    // Compute the move limits to avoid division by zero
-    alpha[j] = max2(max2(lower, 0.9 * L[j] + 0.1 * x[j]),
-                    x[j] - 0.5 * (upper - lower));
-    beta[j] = min2(min2(upper, 0.9 * U[j] + 0.1 * x[j]),
-                   x[j] + 0.5 * (upper - lower));
-
-    // Compute the coefficients for the objective
-    ParOptScalar gpos = max2(0.0, g[j]);
-    ParOptScalar gneg = max2(0.0, -g[j]);
-    p0[j] = (U[j] - x[j]) * (U[j] - x[j]) *
-            ((1.0 + delta) * gpos + delta * gneg + eps / (U[j] - L[j]));
-    q0[j] = (x[j] - L[j]) * (x[j] - L[j]) *
-            ((1.0 + delta) * gneg + delta * gpos + eps / (U[j] - L[j]));
+  // Allocate a temp array to store the pointers to the constraint
+  // gradients and the constraint approximation coefficients
+  ParOptScalar **A = new ParOptScalar *[m];
+  ParOptScalar **pi = NULL, **qi = NULL;
+  for (int i = 0; i < m; i++) {
+    Avecs[i]->getArray(&A[i]);
+  }
+  if (pivecs) {
+    pi = new ParOptScalar *[m];
+    qi = new ParOptScalar *[m];
+    for (int i = 0; i < m; i++) {
+      pivecs[i]->getArray(&pi[i]);
+      qivecs[i]->getArray(&qi[i]);
+    }
   }
-
   if (use_true_mma) {
     memset(b, 0, m * sizeof(ParOptScalar));
-    for (int i = 0; i < m; i++) {
-      ParOptScalar *pi, *qi;
-      pivecs[i]->getArray(&pi);
-      qivecs[i]->getArray(&qi);
-
-      // Compute the coefficients for the constraints.  Here we form a
-      // convex approximation for -c(x) since the constraints are
-      // formulated as c(x) >= 0.
-      for (int j = 0; j < n; j++) {
-        ParOptScalar gpos = max2(0.0, -A[i][j]);
-        ParOptScalar gneg = max2(0.0, A[i][j]);
-        pi[j] = (U[j] - x[j]) * (U[j] - x[j]) * gpos;
-        qi[j] = (x[j] - L[j]) * (x[j] - L[j]) * gneg;
-        b[i] += pi[j] / (U[j] - x[j]) + qi[j] / (x[j] - L[j]);
+  }
+
+  // Update the asymptotes, the move limits and the coefficients of the
+  // approximation in a single pass over the design variables. The
+  // variables are processed in blocks so that the per-variable terms
+  // are reused from cache for all of the constraints.
+  for (int j0 = 0; j0 < n; j0 += PAROPT_MMA_BLOCK_SIZE) {
+    const int nb =
+        (n - j0 < PAROPT_MMA_BLOCK_SIZE ? n - j0 : PAROPT_MMA_BLOCK_SIZE);
+    ParOptScalar Uinv[PAROPT_MMA_BLOCK_SIZE], Linv[PAROPT_MMA_BLOCK_SIZE];
+
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      // Apply move limit for the design variables
+      ParOptScalar lower = max2(lb[j], x[j] - movlim);
+      ParOptScalar upper = min2(ub[j], x[j] + movlim);
+
+      // Set the asymptote values
+      if (mma_iter < 2) {
+        L[j] = x[j] - init_asymptote_offset * (upper - lower);
+        U[j] = x[j] + init_asymptote_offset * (upper - lower);
+      } else {
+        // Compute the product of the difference of the two previous
+        // updates to determine how to update the move limits. If the
+        // signs are different, then indc < 0.0 and we contract the
+        // asymptotes, otherwise we expand the asymptotes.
+        ParOptScalar indc = (x[j] - x1[j]) * (x1[j] - x2[j]);
+
+        // Store the previous values of the asymptotes
+        ParOptScalar Lprev = L[j];
+        ParOptScalar Uprev = U[j];
+
+        // Compute the interval length
+        ParOptScalar intrvl = max2(upper - lower, 0.01);
+        intrvl = min2(intrvl, 100.0);
+
+        if (ParOptRealPart(indc) < 0.0) {
+          // oscillation -> contract the asymptotes
+          L[j] = x[j] - asymptote_contract * (x1[j] - Lprev);
+          U[j] = x[j] + asymptote_contract * (Uprev - x1[j]);
+        } else {
+          // Relax the asymptotes
+          L[j] = x[j] - asymptote_relax * (x1[j] - Lprev);
+          U[j] = x[j] + asymptote_relax * (Uprev - x1[j]);
+        }
+
+        // Ensure that the asymptotes do not converge entirely on the
+        // design variable value
+        L[j] = min2(L[j], x[j] - min_asymptote_offset * intrvl);
+        U[j] = max2(U[j], x[j] + min_asymptote_offset * intrvl);
+
+        // Enforce a maximum offset so that the asymptotes do not
+        // move too far away from the design variables
+        L[j] = max2(L[j], x[j] - max_asymptote_offset * intrvl);
+        U[j] = min2(U[j], x[j] + max_asymptote_offset * intrvl);
+      }
+
+      // Compute the move limits to avoid division by zero
+      alpha[j] = max2(max2(lower, 0.9 * L[j] + 0.1 * x[j]),
+                      x[j] - 0.5 * (upper - lower));
+      beta[j] = min2(min2(upper, 0.9 * U[j] + 0.1 * x[j]),
+                     x[j] + 0.5 * (upper - lower));
+
+      // Compute the coefficients for the objective
+      Uinv[k] = 1.0 / (U[j] - x[j]);
+      Linv[k] = 1.0 / (x[j] - L[j]);
+      if (p0) {
+        ParOptMMAObjCoef(x[j], L[j], U[j], g[j], eps, delta, &p0[j], &q0[j]);
+      }
+
+      // Check that the asymptotes, limits and variables are well-defined
+      if (!(ParOptRealPart(L[j]) < ParOptRealPart(alpha[j]))) {
+        fprintf(stderr, "ParOptMMA: Inconsistent lower asymptote\n");
+      }
+      if (!(ParOptRealPart(alpha[j]) <= ParOptRealPart(x[j]))) {
+        fprintf(stderr, "ParOptMMA: Inconsistent lower limit\n");
+      }
+      if (!(ParOptRealPart(x[j]) <= ParOptRealPart(beta[j]))) {
+        fprintf(stderr, "ParOptMMA: Inconsistent upper limit\n");
+      }
+      if (!(ParOptRealPart(beta[j]) < ParOptRealPart(U[j]))) {
+        fprintf(stderr, "ParOptMMA: Inconsistent upper assymptote\n");
+      }
+    }
+
+    // Compute the coefficients for the constraints, if they are stored,
+    // and the constant terms in the constraint approximation
+    if (use_true_mma) {
+      for (int i = 0; i < m; i++) {
+        if (pi) {
+          for (int k = 0, j = j0; k < nb; k++, j++) {
+            ParOptMMAConCoef(x[j], L[j], U[j], A[i][j], &pi[i][j], &qi[i][j]);
+          }
+        }
+
+        ParOptScalar pw[PAROPT_MMA_BLOCK_SIZE], qw[PAROPT_MMA_BLOCK_SIZE];
+        const ParOptScalar *p, *q;
+        getConCoefs(i, j0, nb, pw, qw, &p, &q);
+
+        ParOptScalar bi = 0.0;
+        for (int k = 0; k < nb; k++) {
+          bi += p[k] * Uinv[k] + q[k] * Linv[k];
+        }
+        b[i] += bi;
       }
     }
+  }
 
+  if (use_true_mma) {
     // All reduce the coefficient values
     MPI_Allreduce(MPI_IN_PLACE, b, m, PAROPT_MPI_TYPE, MPI_SUM, comm);
 
@@ -733,20 +1397,9 @@ int ParOptMMA::initializeSubProblem(ParOptVec *xv) {
     }
   }
 
-  // Check that the asymptotes, limits and variables are well-defined
-  for (int j = 0; j < n; j++) {
-    if (!(ParOptRealPart(L[j]) < ParOptRealPart(alpha[j]))) {
-      fprintf(stderr, "ParOptMMA: Inconsistent lower asymptote\n");
-    }
-    if (!(ParOptRealPart(alpha[j]) <= ParOptRealPart(x[j]))) {
-      fprintf(stderr, "ParOptMMA: Inconsistent lower limit\n");
-    }
-    if (!(ParOptRealPart(x[j]) <= ParOptRealPart(beta[j]))) {
-      fprintf(stderr, "ParOptMMA: Inconsistent upper limit\n");
-    }
-    if (!(ParOptRealPart(beta[j]) < ParOptRealPart(U[j]))) {
-      fprintf(stderr, "ParOptMMA: Inconsistent upper assymptote\n");
-    }
+  if (pi) {
+    delete[] pi;
+    delete[] qi;
   }
 
   // Increment the number of MMA iterations
@@ -791,6 +1444,15 @@ int ParOptMMA::useLowerBounds() { return 1; }
 
 int ParOptMMA::useUpperBounds() { return 1; }
 
+/*
+  Functions to indicate the linearity of the subproblem. The dense
+  constraints are linear unless the true MMA approximation is used,
+  while the sparse constraints are always linearized about xvec.
+*/
+int ParOptMMA::isDenseConLinear(int index) { return !use_true_mma; }
+
+int ParOptMMA::isSparseConLinear() { return 1; }
+
 // Get the variables and bounds from the problem
 void ParOptMMA::getVarsAndBounds(ParOptVec *x, ParOptVec *lb, ParOptVec *ub) {
   x->copyValues(xvec);
@@ -813,55 +1475,73 @@ int ParOptMMA::evalObjCon(ParOptVec *xv, ParOptScalar *fval,
   Lvec->getArray(&L);
   Uvec->getArray(&U);
 
-  // Get the coefficients for the objective
-  ParOptScalar *p0, *q0;
-  p0vec->getArray(&p0);
-  q0vec->getArray(&q0);
-
-  // Compute the objective
-  ParOptScalar fv = 0.0;
-  for (int j = 0; j < n; j++) {
-    fv += p0[j] / (U[j] - x[j]) + q0[j] / (x[j] - L[j]);
-  }
-
-  // Compute the linearized constraint
-  memset(cvals, 0, m * sizeof(ParOptScalar));
-
-  if (use_true_mma) {
+  // Get the constraint gradients for the linearized constraints
+  ParOptScalar **A = NULL;
+  if (!use_true_mma) {
+    A = new ParOptScalar *[m];
     for (int i = 0; i < m; i++) {
-      ParOptScalar *pi, *qi;
-      pivecs[i]->getArray(&pi);
-      qivecs[i]->getArray(&qi);
+      Avecs[i]->getArray(&A[i]);
+    }
+  }
 
-      // Compute the coefficients for the constraints
-      for (int j = 0; j < n; j++) {
-        cvals[i] += pi[j] / (U[j] - x[j]) + qi[j] / (x[j] - L[j]);
-      }
+  // Store the objective and constraints in a single array so that they
+  // can be summed with one reduction
+  ParOptScalar *data = new ParOptScalar[m + 1];
+  memset(data, 0, (m + 1) * sizeof(ParOptScalar));
+
+  // Compute the objective and the constraint approximation in a single
+  // pass over the design variables
+  for (int j0 = 0; j0 < n; j0 += PAROPT_MMA_BLOCK_SIZE) {
+    const int nb =
+        (n - j0 < PAROPT_MMA_BLOCK_SIZE ? n - j0 : PAROPT_MMA_BLOCK_SIZE);
+    ParOptScalar Uinv[PAROPT_MMA_BLOCK_SIZE], Linv[PAROPT_MMA_BLOCK_SIZE];
+    ParOptScalar pw[PAROPT_MMA_BLOCK_SIZE], qw[PAROPT_MMA_BLOCK_SIZE];
+    const ParOptScalar *p, *q;
+
+    getObjCoefs(j0, nb, pw, qw, &p, &q);
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      Uinv[k] = 1.0 / (U[j] - x[j]);
+      Linv[k] = 1.0 / (x[j] - L[j]);
+      data[0] += p[k] * Uinv[k] + q[k] * Linv[k];
     }
-  } else {
+
     for (int i = 0; i < m; i++) {
-      ParOptScalar *A;
-      Avecs[i]->getArray(&A);
-      for (int j = 0; j < n; j++) {
-        cvals[i] += A[j] * (x[j] - x0[j]);
+      ParOptScalar ci = 0.0;
+      if (use_true_mma) {
+        getConCoefs(i, j0, nb, pw, qw, &p, &q);
+        for (int k = 0; k < nb; k++) {
+          ci += p[k] * Uinv[k] + q[k] * Linv[k];
+        }
+      } else {
+        const ParOptScalar *a = &A[i][j0];
+        for (int k = 0, j = j0; k < nb; k++, j++) {
+          ci += a[k] * (x[j] - x0[j]);
+        }
       }
+      data[i + 1] += ci;
     }
   }
 
+  if (A) {
+    delete[] A;
+  }
+
   // All reduce the data
-  MPI_Allreduce(&fv, fval, 1, PAROPT_MPI_TYPE, MPI_SUM, comm);
-  MPI_Allreduce(MPI_IN_PLACE, cvals, m, PAROPT_MPI_TYPE, MPI_SUM, comm);
+  MPI_Allreduce(MPI_IN_PLACE, data, m + 1, PAROPT_MPI_TYPE, MPI_SUM, comm);
 
+  *fval = data[0];
   if (use_true_mma) {
     for (int i = 0; i < m; i++) {
-      cvals[i] = -(cvals[i] + b[i]);
+      cvals[i] = -(data[i + 1] + b[i]);
     }
   } else {
     for (int i = 0; i < m; i++) {
-      cvals[i] += cons[i];
+      cvals[i] = data[i + 1] + cons[i];
     }
   }
 
+  delete[] data;
+
   return 0;
 }
 
@@ -886,37 +1566,51 @@ int ParOptMMA::evalObjConGradient(ParOptVec *xv, ParOptVec *gv,
   Lvec->getArray(&L);
   Uvec->getArray(&U);
 
-  // Get the coefficients for the objective
-  ParOptScalar *p0, *q0;
-  p0vec->getArray(&p0);
-  q0vec->getArray(&q0);
-
-  // Compute the gradient of the objective
-  for (int j = 0; j < n; j++) {
-    ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
-    ParOptScalar Linv = 1.0 / (x[j] - L[j]);
-    g[j] = Uinv * Uinv * p0[j] - Linv * Linv * q0[j];
-  }
-
-  // Evaluate the gradient
+  // Get the constraint gradient arrays
+  ParOptScalar **A = NULL;
   if (use_true_mma) {
+    A = new ParOptScalar *[m];
     for (int i = 0; i < m; i++) {
-      ParOptScalar *pi, *qi;
-      pivecs[i]->getArray(&pi);
-      qivecs[i]->getArray(&qi);
+      Ac[i]->getArray(&A[i]);
+    }
+  }
 
-      ParOptScalar *A;
-      Ac[i]->getArray(&A);
+  // Evaluate the gradient of the objective and the constraints in a
+  // single pass over the design variables
+  for (int j0 = 0; j0 < n; j0 += PAROPT_MMA_BLOCK_SIZE) {
+    const int nb =
+        (n - j0 < PAROPT_MMA_BLOCK_SIZE ? n - j0 : PAROPT_MMA_BLOCK_SIZE);
+    ParOptScalar Uinv2[PAROPT_MMA_BLOCK_SIZE], Linv2[PAROPT_MMA_BLOCK_SIZE];
+    ParOptScalar pw[PAROPT_MMA_BLOCK_SIZE], qw[PAROPT_MMA_BLOCK_SIZE];
+    const ParOptScalar *p, *q;
+
+    getObjCoefs(j0, nb, pw, qw, &p, &q);
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
+      ParOptScalar Linv = 1.0 / (x[j] - L[j]);
+      Uinv2[k] = Uinv * Uinv;
+      Linv2[k] = Linv * Linv;
+      g[j] = Uinv2[k] * p[k] - Linv2[k] * q[k];
+    }
 
-      for (int j = 0; j < n; j++) {
-        ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
-        ParOptScalar Linv = 1.0 / (x[j] - L[j]);
-        A[j] = Linv * Linv * qi[j] - Uinv * Uinv * pi[j];
+    if (use_true_mma) {
+      for (int i = 0; i < m; i++) {
+        getConCoefs(i, j0, nb, pw, qw, &p, &q);
+        ParOptScalar *a = &A[i][j0];
+        for (int k = 0; k < nb; k++) {
+          a[k] = Linv2[k] * q[k] - Uinv2[k] * p[k];
+        }
       }
     }
+  }
+
+  if (use_true_mma) {
+    delete[] A;
   } else {
     for (int i = 0; i < m; i++) {
-      Ac[i]->copyValues(Avecs[i]);
+      if (Ac[i]) {
+        Ac[i]->copyValues(Avecs[i]);
+      }
     }
   }
 
@@ -941,21 +1635,24 @@ int ParOptMMA::evalHvecProduct(ParOptVec *xv, ParOptScalar *z, ParOptVec *zw,
   Lvec->getArray(&L);
   Uvec->getArray(&U);
 
-  // Get the coefficients for the objective
-  ParOptScalar *p0, *q0;
-  p0vec->getArray(&p0);
-  q0vec->getArray(&q0);
-
   // Get the components of the vector
-  ParOptScalar *p;
-  px->getArray(&p);
+  ParOptScalar *pv;
+  px->getArray(&pv);
 
   // Compute the hessian of the objective
-  for (int j = 0; j < n; j++) {
-    ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
-    ParOptScalar Linv = 1.0 / (x[j] - L[j]);
-    h[j] =
-        2.0 * (Uinv * Uinv * Uinv * p0[j] + Linv * Linv * Linv * q0[j]) * p[j];
+  for (int j0 = 0; j0 < n; j0 += PAROPT_MMA_BLOCK_SIZE) {
+    const int nb =
+        (n - j0 < PAROPT_MMA_BLOCK_SIZE ? n - j0 : PAROPT_MMA_BLOCK_SIZE);
+    ParOptScalar pw[PAROPT_MMA_BLOCK_SIZE], qw[PAROPT_MMA_BLOCK_SIZE];
+    const ParOptScalar *p, *q;
+    getObjCoefs(j0, nb, pw, qw, &p, &q);
+
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
+      ParOptScalar Linv = 1.0 / (x[j] - L[j]);
+      h[j] = 2.0 * (Uinv * Uinv * Uinv * p[k] + Linv * Linv * Linv * q[k]) *
+             pv[j];
+    }
   }
 
   return 0;
@@ -979,29 +1676,32 @@ int ParOptMMA::evalHessianDiag(ParOptVec *xv, ParOptScalar *z, ParOptVec *zw,
   Lvec->getArray(&L);
   Uvec->getArray(&U);
 
-  // Get the coefficients for the objective
-  ParOptScalar *p0, *q0;
-  p0vec->getArray(&p0);
-  q0vec->getArray(&q0);
-
-  // Compute the Hessian diagonal
-  for (int j = 0; j < n; j++) {
-    ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
-    ParOptScalar Linv = 1.0 / (x[j] - L[j]);
-    h[j] = 2.0 * (Uinv * Uinv * Uinv * p0[j] + Linv * Linv * Linv * q0[j]);
-  }
+  // Compute the Hessian diagonal of the Lagrangian in a single pass
+  // over the design variables
+  for (int j0 = 0; j0 < n; j0 += PAROPT_MMA_BLOCK_SIZE) {
+    const int nb =
+        (n - j0 < PAROPT_MMA_BLOCK_SIZE ? n - j0 : PAROPT_MMA_BLOCK_SIZE);
+    ParOptScalar Uinv3[PAROPT_MMA_BLOCK_SIZE], Linv3[PAROPT_MMA_BLOCK_SIZE];
+    ParOptScalar pw[PAROPT_MMA_BLOCK_SIZE], qw[PAROPT_MMA_BLOCK_SIZE];
+    const ParOptScalar *p, *q;
+
+    getObjCoefs(j0, nb, pw, qw, &p, &q);
+    ParOptScalar *hb = &h[j0];
+    for (int k = 0, j = j0; k < nb; k++, j++) {
+      ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
+      ParOptScalar Linv = 1.0 / (x[j] - L[j]);
+      Uinv3[k] = Uinv * Uinv * Uinv;
+      Linv3[k] = Linv * Linv * Linv;
+      hb[k] = 2.0 * (Uinv3[k] * p[k] + Linv3[k] * q[k]);
+    }
 
-  if (use_true_mma) {
-    for (int i = 0; i < m; i++) {
-      ParOptScalar *pi, *qi;
-      pivecs[i]->getArray(&pi);
-      qivecs[i]->getArray(&qi);
-
-      for (int j = 0; j < n; j++) {
-        ParOptScalar Uinv = 1.0 / (U[j] - x[j]);
-        ParOptScalar Linv = 1.0 / (x[j] - L[j]);
-        h[j] += 2.0 * z[i] *
-                (Uinv * Uinv * Uinv * pi[j] + Linv * Linv * Linv * qi[j]);
+    if (use_true_mma) {
+      for (int i = 0; i < m; i++) {
+        const ParOptScalar zi = 2.0 * z[i];
+        getConCoefs(i, j0, nb, pw, qw, &p, &q);
+        for (int k = 0; k < nb; k++) {
+          hb[k] += zi * (Uinv3[k] * p[k] + Linv3[k] * q[k]);
+        }
       }
     }
   }
@@ -53,6 +53,10 @@ class ParOptMMA : public ParOptProblem {
   // Get the optimized point
   void getOptimizedPoint(ParOptVec **x);
 
+  // Get the multipliers from the last subproblem
+  void getMultipliers(ParOptScalar **_z, ParOptVec **_zw, ParOptVec **_zl,
+                      ParOptVec **_zu);
+
   // Get the asymptotes
   void getAsymptotes(ParOptVec **_L, ParOptVec **_U);
 
@@ -84,6 +88,10 @@ class ParOptMMA : public ParOptProblem {
   int useLowerBounds();
   int useUpperBounds();
 
+  // Functions to indicate the linearity of the subproblem
+  int isDenseConLinear(int index);
+  int isSparseConLinear();
+
   // Get the variables and bounds from the problem
   void getVarsAndBounds(ParOptVec *x, ParOptVec *lb, ParOptVec *ub);
 
@@ -130,13 +138,31 @@ class ParOptMMA : public ParOptProblem {
   // Set the output file (only on the root proc)
   void setOutputFile(const char *filename);
 
+  // Set the binary iteration history file (only on the root proc)
+  void setHistoryFile(const char *filename);
+
   // Print the options summary
   void printOptionsSummary(FILE *fp);
 
+  // Solve the MMA subproblem using the dual method
+  int solveDualSubproblem(double tol, int max_iters, double max_multiplier);
+  void evalDual(const ParOptScalar *lambda, ParOptScalar *data);
+
+  // Get the approximation coefficients for a block of design variables
+  void getObjCoefs(int j0, int nb, ParOptScalar *pw, ParOptScalar *qw,
+                   const ParOptScalar **p, const ParOptScalar **q);
+  void getConCoefs(int i, int j0, int nb, ParOptScalar *pw, ParOptScalar *qw,
+                   const ParOptScalar **p, const ParOptScalar **q);
+  void getLagrangianCoefs(const ParOptScalar *lambda, int j0, int nb,
+                          ParOptScalar *P, ParOptScalar *Q);
+
   // File pointer for the summary file - depending on the settings
   FILE *fp;
   int first_print;
 
+  // The binary iteration history
+  ParOptHistory *history;
+
   // Pointer to the optimization problem
   ParOptProblem *prob;
 
@@ -172,7 +198,10 @@ class ParOptMMA : public ParOptProblem {
   // The move limits
   ParOptVec *alphavec, *betavec;
 
-  // The coefficients for the approximation
+  // The coefficients for the approximation. These are NULL when the
+  // coefficients are recomputed (low_memory is set).
+  int low_memory;
+  double reg_eps, reg_delta;     // The regularization parameters
   ParOptVec *p0vec, *q0vec;      // The objective coefs
   ParOptVec **pivecs, **qivecs;  // The constraint coefs
 
@@ -185,6 +214,9 @@ class ParOptMMA : public ParOptProblem {
   // Additional data required for computing the KKT conditions
   ParOptVec *rvec;
 
+  // The solution of the dual subproblem (allocated when needed)
+  ParOptVec *xdualvec;
+
   // The multipliers/constraints
   ParOptScalar *z;
   ParOptVec *zwvec;
@@ -214,7 +214,7 @@ void ParOptOptimizer::getOptimizedPoint(ParOptVec **x, ParOptScalar **z,
     ip->getOptimizedPoint(NULL, z, zw, zl, zu);
   } else if (mma && ip) {
     mma->getOptimizedPoint(x);
-    ip->getOptimizedPoint(NULL, z, zw, zl, zu);
+    mma->getMultipliers(z, zw, zl, zu);
   } else if (ip) {
     ip->getOptimizedPoint(x, z, zw, zl, zu);
   }
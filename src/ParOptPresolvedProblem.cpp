@@ -0,0 +1,1271 @@
+#include "ParOptPresolvedProblem.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "ParOptComplexStep.h"
+
+/*
+  The hash of a sparse constraint row used to find duplicate rows
+*/
+struct ParOptRowHash {
+  unsigned long hash;
+  int row;
+  bool operator<(const ParOptRowHash &other) const {
+    return (hash < other.hash || (hash == other.hash && row < other.row));
+  }
+};
+
+/*
+  Compute a 64-bit FNV-1a hash of a column index and value
+*/
+static unsigned long ParOptHashEntry(int col, double value) {
+  unsigned char bytes[sizeof(int) + sizeof(double)];
+  memcpy(bytes, &col, sizeof(int));
+  memcpy(&bytes[sizeof(int)], &value, sizeof(double));
+
+  unsigned long hash = 14695981039346656037UL;
+  for (size_t i = 0; i < sizeof(bytes); i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211UL;
+  }
+
+  return hash;
+}
+
+/**
+  Create the presolved problem and perform the presolve
+
+  @param _prob The problem to wrap
+  @param _fixed_tol Variables with ub - lb <= fixed_tol are fixed
+  @param _max_bound_value Bounds beyond this value are treated as infinite
+*/
+ParOptPresolvedProblem::ParOptPresolvedProblem(ParOptProblem *_prob,
+                                               double _fixed_tol,
+                                               double _max_bound_value)
+    : ParOptSparseProblem(_prob->getMPIComm()) {
+  prob = _prob;
+  prob->incref();
+
+  // The sparse constraint rows can only be reduced for sparse problems
+  sprob = dynamic_cast<ParOptSparseProblem *>(prob);
+
+  // Get the sizes of the wrapped problem
+  prob->getProblemSizes(&nvars_full, &ncon_full, &nwcon_full);
+  prob->getNumInequalities(&ninequality_full, &nwinequality_full);
+
+  // Allocate the full vectors
+  xfull = prob->createDesignVec();
+  xfull->incref();
+  gfull = prob->createDesignVec();
+  gfull->incref();
+  pfull = prob->createDesignVec();
+  pfull->incref();
+  hfull = prob->createDesignVec();
+  hfull->incref();
+
+  Afull = new ParOptVec *[ncon_full];
+  for (int i = 0; i < ncon_full; i++) {
+    Afull[i] = prob->createDesignVec();
+    Afull[i]->incref();
+  }
+  Aeval = new ParOptVec *[ncon_full];
+  Awork = prob->createDesignVec();
+  Awork->incref();
+  lin_grad_init = 0;
+  cfull = new ParOptScalar[ncon_full];
+  zfull = new ParOptScalar[ncon_full];
+
+  cwfull = prob->createConstraintVec();
+  cwfull->incref();
+  zwfull = prob->createConstraintVec();
+  zwfull->incref();
+
+  sdata = NULL;
+  if (sprob) {
+    sdata = new ParOptScalar[sprob->getSparseJacobianData(NULL, NULL, NULL)];
+  }
+
+  var_map = NULL;
+  var_index = NULL;
+  con_map = NULL;
+  wcon_map = NULL;
+  data_map = NULL;
+
+  con_nnz = -1;
+  con_rowp = NULL;
+  con_cols = NULL;
+  con_data_map = NULL;
+  con_vals = NULL;
+
+  num_jac_work = 0;
+  jac_work = NULL;
+  jac_zwork = NULL;
+
+  presolve(_fixed_tol, _max_bound_value);
+}
+
+ParOptPresolvedProblem::~ParOptPresolvedProblem() {
+  prob->decref();
+
+  xfull->decref();
+  gfull->decref();
+  pfull->decref();
+  hfull->decref();
+  for (int i = 0; i < ncon_full; i++) {
+    Afull[i]->decref();
+  }
+  delete[] Afull;
+  delete[] Aeval;
+  Awork->decref();
+  delete[] cfull;
+  delete[] zfull;
+  cwfull->decref();
+  zwfull->decref();
+  delete[] sdata;
+
+  delete[] var_map;
+  delete[] var_index;
+  delete[] con_map;
+  delete[] wcon_map;
+  delete[] data_map;
+
+  delete[] con_rowp;
+  delete[] con_cols;
+  delete[] con_data_map;
+  delete[] con_vals;
+
+  for (int k = 0; k < num_jac_work; k++) {
+    jac_work[k]->decref();
+  }
+  delete[] jac_work;
+  delete[] jac_zwork;
+}
+
+/**
+  Get the global number of fixed variables and removed constraints
+
+  @param _num_fixed The number of fixed variables
+  @param _num_dense_removed The number of removed dense constraints
+  @param _num_sparse_removed The number of removed sparse constraints
+*/
+void ParOptPresolvedProblem::getPresolveStats(int *_num_fixed,
+                                              int *_num_dense_removed,
+                                              int *_num_sparse_removed) {
+  if (_num_fixed) {
+    *_num_fixed = num_fixed;
+  }
+  if (_num_dense_removed) {
+    *_num_dense_removed = num_dense_removed;
+  }
+  if (_num_sparse_removed) {
+    *_num_sparse_removed = num_sparse_removed;
+  }
+}
+
+/**
+  Print the presolve statistics on the root processor
+
+  @param fp The file pointer
+*/
+void ParOptPresolvedProblem::printPresolveStats(FILE *fp) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (fp && rank == 0) {
+    fprintf(fp, "ParOptPresolvedProblem statistics:\n");
+    fprintf(fp, "%-24s %10d\n", "fixed variables", num_fixed);
+    fprintf(fp, "%-24s %10d\n", "removed dense cons", num_dense_removed);
+    fprintf(fp, "%-24s %10d\n", "removed sparse cons", num_sparse_removed);
+    fflush(fp);
+  }
+}
+
+/**
+  Expand a reduced design vector to the full design vector
+
+  @param xr The reduced vector
+  @param x The full vector
+  @param use_fixed_values Set the fixed variables to their values (or zero)
+*/
+void ParOptPresolvedProblem::expandDesignVec(ParOptVec *xr, ParOptVec *x,
+                                             int use_fixed_values) {
+  if (x != xfull) {
+    if (use_fixed_values) {
+      x->copyValues(xfull);
+    } else {
+      x->zeroEntries();
+    }
+  }
+
+  ParOptScalar *xra, *xa;
+  xr->getArray(&xra);
+  x->getArray(&xa);
+  for (int i = 0; i < nvars; i++) {
+    xa[var_map[i]] = xra[i];
+  }
+}
+
+/**
+  Extract the free components of a full design vector
+
+  @param x The full vector
+  @param xr The reduced vector
+*/
+void ParOptPresolvedProblem::reduceDesignVec(ParOptVec *x, ParOptVec *xr) {
+  ParOptScalar *xra, *xa;
+  xr->getArray(&xra);
+  x->getArray(&xa);
+  for (int i = 0; i < nvars; i++) {
+    xra[i] = xa[var_map[i]];
+  }
+}
+
+/*
+  Find the fixed variables and the redundant constraints, and set the
+  sizes of the reduced problem
+*/
+void ParOptPresolvedProblem::presolve(double fixed_tol,
+                                      double max_bound_value) {
+  ParOptVec *lb = prob->createDesignVec();
+  ParOptVec *ub = prob->createDesignVec();
+  lb->incref();
+  ub->incref();
+
+  // Get the starting point and bounds. The fixed values are stored in
+  // xfull and are not modified afterwards.
+  prob->getVarsAndBounds(xfull, lb, ub);
+
+  ParOptScalar *x, *l, *u;
+  xfull->getArray(&x);
+  lb->getArray(&l);
+  ub->getArray(&u);
+
+  // Find the fixed variables
+  int use_fixed = (prob->useLowerBounds() && prob->useUpperBounds());
+  var_index = new int[nvars_full];
+  int nfree = 0;
+  for (int j = 0; j < nvars_full; j++) {
+    double lj = ParOptRealPart(l[j]);
+    double uj = ParOptRealPart(u[j]);
+    if (use_fixed && uj >= lj && uj - lj <= fixed_tol &&
+        lj > -max_bound_value) {
+      x[j] = l[j];
+      var_index[j] = -1;
+    } else {
+      var_index[j] = nfree;
+      nfree++;
+    }
+  }
+
+  var_map = new int[nfree];
+  for (int j = 0; j < nvars_full; j++) {
+    if (var_index[j] >= 0) {
+      var_map[var_index[j]] = j;
+    }
+  }
+
+  int nfixed = nvars_full - nfree;
+  MPI_Allreduce(&nfixed, &num_fixed, 1, MPI_INT, MPI_SUM, comm);
+
+  // By default, keep all of the constraints
+  con_map = new int[ncon_full];
+  for (int i = 0; i < ncon_full; i++) {
+    con_map[i] = i;
+  }
+  wcon_map = new int[nwcon_full];
+  for (int i = 0; i < nwcon_full; i++) {
+    wcon_map[i] = i;
+  }
+  int ncon_kept = ncon_full;
+  int nwcon_kept = nwcon_full;
+
+  // The constraints can only be checked when some are linear or when
+  // the sparse Jacobian is available
+  int num_linear = 0;
+  for (int i = 0; i < ncon_full; i++) {
+    if (prob->isDenseConLinear(i)) {
+      num_linear++;
+    }
+  }
+  int check_sparse = (sprob && nwcon_full > 0);
+
+  if (num_linear > 0 || check_sparse) {
+    ParOptScalar fobj;
+    int fail = prob->evalObjCon(xfull, &fobj, cfull);
+    if (!fail) {
+      fail = evalWrappedGradient(xfull, NULL);
+    }
+
+    if (fail) {
+      fprintf(stderr,
+              "ParOptPresolvedProblem: Evaluation failed at the starting "
+              "point, constraints not presolved\n");
+    } else {
+      if (num_linear > 0) {
+        ncon_kept = presolveDenseCons(lb, ub, max_bound_value);
+      }
+      if (check_sparse) {
+        prob->evalSparseCon(xfull, cwfull);
+        nwcon_kept = presolveSparseCons();
+      }
+    }
+  }
+
+  int nwcon_removed = nwcon_full - nwcon_kept;
+  num_dense_removed = ncon_full - ncon_kept;
+  MPI_Allreduce(&nwcon_removed, &num_sparse_removed, 1, MPI_INT, MPI_SUM,
+                comm);
+
+  // Count the kept inequalities. The order of the constraints is
+  // unchanged so the inequalities are still first.
+  int ninequality = 0;
+  for (int i = 0; i < ncon_kept; i++) {
+    if (con_map[i] < ninequality_full) {
+      ninequality++;
+    }
+  }
+  int nwinequality = 0;
+  for (int i = 0; i < nwcon_kept; i++) {
+    if (wcon_map[i] < nwinequality_full) {
+      nwinequality++;
+    }
+  }
+
+  setProblemSizes(nfree, ncon_kept, nwcon_kept);
+  setNumInequalities(ninequality, nwinequality);
+
+  // Form the reduced sparse Jacobian pattern
+  if (sprob) {
+    const int *rowp, *cols;
+    sprob->getSparseJacobianData(&rowp, &cols, NULL);
+
+    int nnz = 0;
+    for (int i = 0; i < nwcon_kept; i++) {
+      int r = wcon_map[i];
+      for (int k = rowp[r]; k < rowp[r + 1]; k++) {
+        if (var_index[cols[k]] >= 0) {
+          nnz++;
+        }
+      }
+    }
+
+    int *rrowp = new int[nwcon_kept + 1];
+    int *rcols = new int[nnz];
+    data_map = new int[nnz];
+
+    rrowp[0] = 0;
+    for (int i = 0, n = 0; i < nwcon_kept; i++) {
+      int r = wcon_map[i];
+      for (int k = rowp[r]; k < rowp[r + 1]; k++) {
+        if (var_index[cols[k]] >= 0) {
+          rcols[n] = var_index[cols[k]];
+          data_map[n] = k;
+          n++;
+        }
+      }
+      rrowp[i + 1] = n;
+    }
+
+    setSparseJacobianData(rrowp, rcols);
+    delete[] rrowp;
+    delete[] rcols;
+  } else {
+    presolveConGradientPattern();
+  }
+
+  lb->decref();
+  ub->decref();
+}
+
+/*
+  Form the pattern of the dense constraint gradients for the kept
+  constraints and the free variables. If the wrapped problem provides
+  no pattern, or an invalid one, the gradients are dense.
+*/
+void ParOptPresolvedProblem::presolveConGradientPattern() {
+  const int *rowp, *cols;
+  int nnz = prob->getConGradientPattern(&rowp, &cols);
+  if (nnz < 0 || !rowp || (nnz > 0 && !cols) || rowp[ncon_full] != nnz) {
+    return;
+  }
+  for (int k = 0; k < nnz; k++) {
+    if (cols[k] < 0 || cols[k] >= nvars_full) {
+      return;
+    }
+  }
+
+  con_nnz = 0;
+  for (int i = 0; i < ncon; i++) {
+    int r = con_map[i];
+    for (int k = rowp[r]; k < rowp[r + 1]; k++) {
+      if (var_index[cols[k]] >= 0) {
+        con_nnz++;
+      }
+    }
+  }
+
+  con_rowp = new int[ncon + 1];
+  con_cols = new int[con_nnz > 0 ? con_nnz : 1];
+  con_data_map = new int[con_nnz > 0 ? con_nnz : 1];
+  con_vals = new ParOptScalar[nnz > 0 ? nnz : 1];
+
+  con_rowp[0] = 0;
+  for (int i = 0, n = 0; i < ncon; i++) {
+    int r = con_map[i];
+    for (int k = rowp[r]; k < rowp[r + 1]; k++) {
+      if (var_index[cols[k]] >= 0) {
+        con_cols[n] = var_index[cols[k]];
+        con_data_map[n] = k;
+        n++;
+      }
+    }
+    con_rowp[i + 1] = n;
+  }
+}
+
+/*
+  Remove the linear dense constraints that cannot become active.
+
+  The minimum of each linear constraint over the box defined by the
+  bounds of the free variables is computed with a single reduction.
+  Inequalities whose minimum is non-negative are removed. Equalities
+  that do not depend on the free variables are removed if they are
+  satisfied.
+*/
+int ParOptPresolvedProblem::presolveDenseCons(ParOptVec *lb, ParOptVec *ub,
+                                              double max_bound_value) {
+  ParOptScalar *x, *l, *u;
+  xfull->getArray(&x);
+  lb->getArray(&l);
+  ub->getArray(&u);
+
+  int use_lower = prob->useLowerBounds();
+  int use_upper = prob->useUpperBounds();
+
+  // The minimum change in the constraint, the number of non-zero
+  // gradient entries and the number of unbounded directions
+  double *range = new double[3 * ncon_full];
+  memset(range, 0, 3 * ncon_full * sizeof(double));
+
+  for (int i = 0; i < ncon_full; i++) {
+    if (!prob->isDenseConLinear(i)) {
+      continue;
+    }
+
+    ParOptScalar *A;
+    Afull[i]->getArray(&A);
+    for (int k = 0; k < nvars_full; k++) {
+      double a = ParOptRealPart(A[k]);
+      if (var_index[k] < 0 || a == 0.0) {
+        continue;
+      }
+      range[3 * i + 1] += 1.0;
+      if (a > 0.0) {
+        double lk = ParOptRealPart(l[k]);
+        if (!use_lower || lk <= -max_bound_value) {
+          range[3 * i + 2] += 1.0;
+        } else {
+          range[3 * i] += a * (lk - ParOptRealPart(x[k]));
+        }
+      } else {
+        double uk = ParOptRealPart(u[k]);
+        if (!use_upper || uk >= max_bound_value) {
+          range[3 * i + 2] += 1.0;
+        } else {
+          range[3 * i] += a * (uk - ParOptRealPart(x[k]));
+        }
+      }
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, range, 3 * ncon_full, MPI_DOUBLE, MPI_SUM, comm);
+
+  int ncon_kept = 0;
+  for (int i = 0; i < ncon_full; i++) {
+    int keep = 1;
+    if (prob->isDenseConLinear(i)) {
+      double c = ParOptRealPart(cfull[i]);
+      if (i < ninequality_full) {
+        if (range[3 * i + 2] == 0.0 && c + range[3 * i] >= 0.0) {
+          keep = 0;
+        } else if (range[3 * i + 1] == 0.0) {
+          fprintf(stderr,
+                  "ParOptPresolvedProblem: Constant dense constraint %d "
+                  "is infeasible\n",
+                  i);
+        }
+      } else if (range[3 * i + 1] == 0.0) {
+        if (c == 0.0) {
+          keep = 0;
+        } else {
+          fprintf(stderr,
+                  "ParOptPresolvedProblem: Constant dense constraint %d "
+                  "is infeasible\n",
+                  i);
+        }
+      }
+    }
+
+    if (keep) {
+      con_map[ncon_kept] = i;
+      ncon_kept++;
+    }
+  }
+
+  delete[] range;
+
+  return ncon_kept;
+}
+
+/*
+  Remove the empty and duplicate sparse constraint rows.
+
+  A row is empty when it has no entries in the free variables, so its
+  value is constant. Duplicate rows are only detected when the sparse
+  constraints are linear, since the Jacobian entries are then fixed.
+  The sparse constraints are local to each processor so no
+  communication is required.
+*/
+int ParOptPresolvedProblem::presolveSparseCons() {
+  const int *rowp, *cols;
+  const ParOptScalar *data;
+  sprob->getSparseJacobianData(&rowp, &cols, &data);
+
+  ParOptScalar *cw;
+  cwfull->getArray(&cw);
+
+  int *keep = new int[nwcon_full];
+  for (int r = 0; r < nwcon_full; r++) {
+    keep[r] = 1;
+  }
+
+  // Find the empty rows
+  ParOptRowHash *hashes = new ParOptRowHash[nwcon_full];
+  int nhash = 0;
+  for (int r = 0; r < nwcon_full; r++) {
+    unsigned long hash = 0;
+    int nfree = 0;
+    for (int k = rowp[r]; k < rowp[r + 1]; k++) {
+      if (var_index[cols[k]] >= 0) {
+        hash += ParOptHashEntry(cols[k], ParOptRealPart(data[k]));
+        nfree++;
+      }
+    }
+
+    if (nfree == 0) {
+      double c = ParOptRealPart(cw[r]);
+      if ((r < nwinequality_full && c >= 0.0) || c == 0.0) {
+        keep[r] = 0;
+      } else {
+        fprintf(stderr,
+                "ParOptPresolvedProblem: Constant sparse constraint %d "
+                "is infeasible\n",
+                r);
+      }
+    } else {
+      hashes[nhash].hash = hash;
+      hashes[nhash].row = r;
+      nhash++;
+    }
+  }
+
+  // Find the duplicate rows by comparing the rows with equal hashes
+  if (prob->isSparseConLinear()) {
+    std::sort(hashes, hashes + nhash);
+
+    int *flag = new int[nvars_full];
+    ParOptScalar *vals = new ParOptScalar[nvars_full];
+    for (int j = 0; j < nvars_full; j++) {
+      flag[j] = -1;
+    }
+
+    for (int start = 0; start < nhash;) {
+      int end = start + 1;
+      while (end < nhash && hashes[end].hash == hashes[start].hash) {
+        end++;
+      }
+
+      for (int a = start; a < end; a++) {
+        int p = hashes[a].row;
+        if (!keep[p]) {
+          continue;
+        }
+
+        // Scatter the free entries of the row p
+        int np = 0;
+        for (int k = rowp[p]; k < rowp[p + 1]; k++) {
+          if (var_index[cols[k]] >= 0) {
+            flag[cols[k]] = p;
+            vals[cols[k]] = data[k];
+            np++;
+          }
+        }
+
+        for (int b = a + 1; b < end; b++) {
+          int r = hashes[b].row;
+          if (!keep[r] || (p < nwinequality_full) != (r < nwinequality_full)) {
+            continue;
+          }
+
+          int nr = 0, equal = 1;
+          for (int k = rowp[r]; k < rowp[r + 1] && equal; k++) {
+            if (var_index[cols[k]] >= 0) {
+              equal = (flag[cols[k]] == p && vals[cols[k]] == data[k]);
+              nr++;
+            }
+          }
+          if (!equal || nr != np) {
+            continue;
+          }
+
+          // Keep the tighter of the two inequalities. The rows remain
+          // in their original order.
+          if (p < nwinequality_full) {
+            if (ParOptRealPart(cw[r]) < ParOptRealPart(cw[p])) {
+              keep[p] = 0;
+              break;
+            }
+            keep[r] = 0;
+          } else if (cw[r] == cw[p]) {
+            keep[r] = 0;
+          } else {
+            fprintf(stderr,
+                    "ParOptPresolvedProblem: Duplicate sparse constraints "
+                    "%d and %d are inconsistent\n",
+                    p, r);
+          }
+        }
+      }
+
+      start = end;
+    }
+
+    delete[] flag;
+    delete[] vals;
+  }
+
+  int nwcon_kept = 0;
+  for (int r = 0; r < nwcon_full; r++) {
+    if (keep[r]) {
+      wcon_map[nwcon_kept] = r;
+      nwcon_kept++;
+    }
+  }
+
+  delete[] keep;
+  delete[] hashes;
+
+  return nwcon_kept;
+}
+
+/*
+  Set the full multipliers from the reduced multipliers. The removed
+  constraints have zero multipliers.
+*/
+void ParOptPresolvedProblem::expandMultipliers(ParOptScalar *zr,
+                                               ParOptVec *zwr, ParOptScalar *z,
+                                               ParOptVec **zw) {
+  memset(z, 0, ncon_full * sizeof(ParOptScalar));
+  if (zr) {
+    for (int i = 0; i < ncon; i++) {
+      z[con_map[i]] = zr[i];
+    }
+  }
+
+  if (sprob && zwr) {
+    ParOptScalar *zwra, *zwa;
+    zwr->getArray(&zwra);
+    zwfull->zeroEntries();
+    zwfull->getArray(&zwa);
+    for (int i = 0; i < nwcon; i++) {
+      zwa[wcon_map[i]] = zwra[i];
+    }
+    *zw = zwfull;
+  } else {
+    *zw = zwr;
+  }
+}
+
+/**
+  Recover the full solution and multipliers from the reduced problem.
+
+  The bound multipliers of the fixed variables are set from the
+  reduced gradient of the Lagrangian at the solution, which requires an
+  evaluation of the wrapped problem. Any of the outputs may be NULL.
+
+  @param xr The reduced design vector
+  @param zr The reduced dense constraint multipliers
+  @param zwr The reduced sparse constraint multipliers
+  @param zlr The reduced lower bound multipliers
+  @param zur The reduced upper bound multipliers
+  @param x The full design vector
+  @param z The full dense constraint multipliers
+  @param zw The full sparse constraint multipliers
+  @param zl The full lower bound multipliers
+  @param zu The full upper bound multipliers
+  @return the fail flag from the evaluation of the wrapped problem
+*/
+int ParOptPresolvedProblem::postsolve(ParOptVec *xr, ParOptScalar *zr,
+                                      ParOptVec *zwr, ParOptVec *zlr,
+                                      ParOptVec *zur, ParOptVec *x,
+                                      ParOptScalar *z, ParOptVec *zw,
+                                      ParOptVec *zl, ParOptVec *zu) {
+  expandDesignVec(xr, pfull);
+  if (x) {
+    x->copyValues(pfull);
+  }
+
+  ParOptVec *zwf;
+  expandMultipliers(zr, zwr, zfull, &zwf);
+  if (z) {
+    memcpy(z, zfull, ncon_full * sizeof(ParOptScalar));
+  }
+  if (zw && zwf) {
+    zw->copyValues(zwf);
+  }
+
+  if (zl && zlr) {
+    expandDesignVec(zlr, zl, 0);
+  }
+  if (zu && zur) {
+    expandDesignVec(zur, zu, 0);
+  }
+
+  int fail = 0;
+  if (num_fixed > 0 && (zl || zu)) {
+    // Compute the gradient of the Lagrangian at the solution
+    ParOptScalar fobj;
+    fail = prob->evalObjCon(pfull, &fobj, cfull);
+    if (!fail) {
+      fail = evalWrappedGradient(pfull, NULL);
+    }
+    if (fail) {
+      fprintf(stderr,
+              "ParOptPresolvedProblem: Evaluation failed in postsolve\n");
+      return fail;
+    }
+
+    for (int i = 0; i < ncon_full; i++) {
+      gfull->axpy(-zfull[i], Afull[i]);
+    }
+    if (nwcon_full > 0 && zwf) {
+      prob->addSparseJacobianTranspose(-1.0, pfull, zwf, gfull);
+    }
+
+    // Set the bound multipliers so that g - A^{T}*z - Aw^{T}*zw - zl +
+    // zu = 0 for the fixed variables
+    ParOptScalar *r;
+    gfull->getArray(&r);
+    ParOptScalar *zla = NULL, *zua = NULL;
+    if (zl) {
+      zl->getArray(&zla);
+    }
+    if (zu) {
+      zu->getArray(&zua);
+    }
+    for (int j = 0; j < nvars_full; j++) {
+      if (var_index[j] < 0) {
+        if (zla) {
+          zla[j] = (ParOptRealPart(r[j]) > 0.0 ? r[j] : 0.0);
+        }
+        if (zua) {
+          zua[j] = (ParOptRealPart(r[j]) < 0.0 ? -r[j] : 0.0);
+        }
+      }
+    }
+  }
+
+  return fail;
+}
+
+/*
+  Create the quasi-definite matrix. For sparse problems, the matrix is
+  formed from the reduced Jacobian, otherwise the matrix from the
+  wrapped problem is used with the expanded vectors.
+*/
+ParOptQuasiDefMat *ParOptPresolvedProblem::createQuasiDefMat() {
+  if (sprob) {
+    return ParOptSparseProblem::createQuasiDefMat();
+  }
+  return new ParOptPresolvedQuasiDefMat(this, prob->createQuasiDefMat());
+}
+
+/*
+  Functions to indicate the type of sparse constraints
+*/
+int ParOptPresolvedProblem::isSparseInequality() {
+  return prob->isSparseInequality();
+}
+
+int ParOptPresolvedProblem::useLowerBounds() { return prob->useLowerBounds(); }
+
+int ParOptPresolvedProblem::useUpperBounds() { return prob->useUpperBounds(); }
+
+/*
+  Functions to indicate the linearity of the objective and constraints
+*/
+int ParOptPresolvedProblem::isObjQuadratic() { return prob->isObjQuadratic(); }
+
+int ParOptPresolvedProblem::isDenseConLinear(int index) {
+  return prob->isDenseConLinear(con_map[index]);
+}
+
+int ParOptPresolvedProblem::isSparseConLinear() {
+  return prob->isSparseConLinear();
+}
+
+/*
+  Get the free variables and their bounds
+*/
+void ParOptPresolvedProblem::getVarsAndBounds(ParOptVec *x, ParOptVec *lb,
+                                              ParOptVec *ub) {
+  prob->getVarsAndBounds(pfull, gfull, hfull);
+  reduceDesignVec(pfull, x);
+  reduceDesignVec(gfull, lb);
+  reduceDesignVec(hfull, ub);
+}
+
+/*
+  Evaluate the objective and the kept dense constraints
+*/
+int ParOptPresolvedProblem::evalObjCon(ParOptVec *x, ParOptScalar *fobj,
+                                       ParOptScalar *cons) {
+  if (sprob) {
+    return ParOptSparseProblem::evalObjCon(x, fobj, cons);
+  }
+
+  expandDesignVec(x, xfull);
+  int fail = prob->evalObjCon(xfull, fobj, cfull);
+  for (int i = 0; i < ncon; i++) {
+    cons[i] = cfull[con_map[i]];
+  }
+
+  return fail;
+}
+
+/*
+  Evaluate the objective, the kept dense constraints and the kept
+  sparse constraints
+*/
+int ParOptPresolvedProblem::evalSparseObjCon(ParOptVec *x, ParOptScalar *fobj,
+                                             ParOptScalar *cons,
+                                             ParOptVec *sparse_con) {
+  expandDesignVec(x, xfull);
+  int fail = sprob->evalSparseObjCon(xfull, fobj, cfull, cwfull);
+  for (int i = 0; i < ncon; i++) {
+    cons[i] = cfull[con_map[i]];
+  }
+
+  ParOptScalar *cw, *cwf;
+  sparse_con->getArray(&cw);
+  cwfull->getArray(&cwf);
+  for (int i = 0; i < nwcon; i++) {
+    cw[i] = cwf[wcon_map[i]];
+  }
+
+  return fail;
+}
+
+/*
+  Evaluate the gradients of the wrapped problem at the full point x.
+
+  The wrapped problem is always passed a vector for every constraint,
+  including the removed constraints. After the first successful
+  evaluation, the gradients of the linear dense constraints stored in
+  Afull are kept, and a scratch vector is passed in their place.
+*/
+int ParOptPresolvedProblem::evalWrappedGradient(ParOptVec *x,
+                                                ParOptScalar *data) {
+  for (int i = 0; i < ncon_full; i++) {
+    Aeval[i] = Afull[i];
+    if (lin_grad_init && prob->isDenseConLinear(i)) {
+      Aeval[i] = Awork;
+    }
+  }
+
+  int fail = 0;
+  if (data) {
+    fail = sprob->evalSparseObjConGradient(x, gfull, Aeval, data);
+  } else {
+    fail = prob->evalObjConGradient(x, gfull, Aeval);
+  }
+  if (!fail) {
+    lin_grad_init = 1;
+  }
+
+  return fail;
+}
+
+/*
+  Evaluate the full gradients and extract the free components. Only the
+  rows requested by the optimizer are copied back.
+*/
+int ParOptPresolvedProblem::evalFullGradient(ParOptVec *g, ParOptVec **Ac,
+                                             ParOptScalar *data) {
+  int fail = evalWrappedGradient(xfull, (data ? sdata : NULL));
+
+  reduceDesignVec(gfull, g);
+  for (int i = 0; i < ncon; i++) {
+    if (Ac[i]) {
+      reduceDesignVec(Afull[con_map[i]], Ac[i]);
+    }
+  }
+
+  if (data) {
+    int nnz = getSparseJacobianData(NULL, NULL, NULL);
+    for (int k = 0; k < nnz; k++) {
+      data[k] = sdata[data_map[k]];
+    }
+  }
+
+  return fail;
+}
+
+/*
+  Evaluate the objective and constraint gradients
+*/
+int ParOptPresolvedProblem::evalObjConGradient(ParOptVec *x, ParOptVec *g,
+                                               ParOptVec **Ac) {
+  if (sprob) {
+    return ParOptSparseProblem::evalObjConGradient(x, g, Ac);
+  }
+
+  expandDesignVec(x, xfull);
+  return evalFullGradient(g, Ac, NULL);
+}
+
+/*
+  Evaluate the objective and constraint gradients and the reduced
+  sparse Jacobian
+*/
+int ParOptPresolvedProblem::evalSparseObjConGradient(ParOptVec *x,
+                                                     ParOptVec *g,
+                                                     ParOptVec **Ac,
+                                                     ParOptScalar *data) {
+  expandDesignVec(x, xfull);
+  return evalFullGradient(g, Ac, data);
+}
+
+/*
+  Get the pattern of the dense constraint gradients for the kept
+  constraints and the free variables
+*/
+int ParOptPresolvedProblem::getConGradientPattern(const int **rowp,
+                                                  const int **cols) {
+  if (con_nnz >= 0) {
+    *rowp = con_rowp;
+    *cols = con_cols;
+  }
+  return con_nnz;
+}
+
+/*
+  Evaluate the objective gradient and the entries of the reduced
+  constraint gradients
+*/
+int ParOptPresolvedProblem::evalObjConSparseGradient(ParOptVec *x,
+                                                     ParOptVec *g,
+                                                     ParOptScalar *Avals) {
+  expandDesignVec(x, xfull);
+  int fail = prob->evalObjConSparseGradient(xfull, gfull, con_vals);
+
+  reduceDesignVec(gfull, g);
+  for (int k = 0; k < con_nnz; k++) {
+    Avals[k] = con_vals[con_data_map[k]];
+  }
+
+  return fail;
+}
+
+/*
+  Use the Jacobian-vector products of the wrapped problem, unless the
+  sparse Jacobian must be updated with the dense gradients
+*/
+int ParOptPresolvedProblem::useDenseJacobianProducts() {
+  if (sprob) {
+    return 0;
+  }
+  return prob->useDenseJacobianProducts();
+}
+
+/*
+  Evaluate the objective gradient for the matrix-free Jacobian
+*/
+int ParOptPresolvedProblem::evalObjGradient(ParOptVec *x, ParOptVec *g) {
+  expandDesignVec(x, xfull);
+  int fail = prob->evalObjGradient(xfull, gfull);
+  reduceDesignVec(gfull, g);
+
+  return fail;
+}
+
+/*
+  Allocate the full work vectors and multipliers for the products
+*/
+void ParOptPresolvedProblem::allocJacobianWork(int nvecs) {
+  if (nvecs > num_jac_work) {
+    ParOptVec **work = new ParOptVec *[nvecs];
+    for (int k = 0; k < nvecs; k++) {
+      if (k < num_jac_work) {
+        work[k] = jac_work[k];
+      } else {
+        work[k] = prob->createDesignVec();
+        work[k]->incref();
+      }
+    }
+    delete[] jac_work;
+    delete[] jac_zwork;
+    jac_work = work;
+    jac_zwork = new ParOptScalar[nvecs * ncon_full + 1];
+    num_jac_work = nvecs;
+  }
+}
+
+/*
+  Compute the products with the Jacobian of the kept constraints. The
+  fixed components of the directions are zero.
+*/
+void ParOptPresolvedProblem::addDenseJacobian(ParOptScalar alpha,
+                                              ParOptVec *x, int nvecs,
+                                              ParOptVec **px,
+                                              ParOptScalar *out) {
+  allocJacobianWork(nvecs);
+  expandDesignVec(x, xfull);
+  for (int k = 0; k < nvecs; k++) {
+    expandDesignVec(px[k], jac_work[k], 0);
+  }
+
+  memset(jac_zwork, 0, nvecs * ncon_full * sizeof(ParOptScalar));
+  prob->addDenseJacobian(alpha, xfull, nvecs, jac_work, jac_zwork);
+  for (int k = 0; k < nvecs; k++) {
+    for (int i = 0; i < ncon; i++) {
+      out[k * ncon + i] += jac_zwork[k * ncon_full + con_map[i]];
+    }
+  }
+}
+
+/*
+  Compute the transpose products with the Jacobian of the kept
+  constraints and add the free components to the output
+*/
+void ParOptPresolvedProblem::addDenseJacobianTranspose(ParOptScalar alpha,
+                                                       ParOptVec *x,
+                                                       int nvecs,
+                                                       const ParOptScalar *pz,
+                                                       ParOptVec **out) {
+  allocJacobianWork(nvecs);
+  expandDesignVec(x, xfull);
+
+  memset(jac_zwork, 0, nvecs * ncon_full * sizeof(ParOptScalar));
+  for (int k = 0; k < nvecs; k++) {
+    for (int i = 0; i < ncon; i++) {
+      jac_zwork[k * ncon_full + con_map[i]] = pz[k * ncon + i];
+    }
+    jac_work[k]->zeroEntries();
+  }
+
+  prob->addDenseJacobianTranspose(alpha, xfull, nvecs, jac_zwork, jac_work);
+  for (int k = 0; k < nvecs; k++) {
+    ParOptScalar *outa, *w;
+    out[k]->getArray(&outa);
+    jac_work[k]->getArray(&w);
+    for (int i = 0; i < nvars; i++) {
+      outa[i] += w[var_map[i]];
+    }
+  }
+}
+
+/*
+  Evaluate the product of the Hessian with a given vector
+*/
+int ParOptPresolvedProblem::evalHvecProduct(ParOptVec *x, ParOptScalar *z,
+                                            ParOptVec *zw, ParOptVec *px,
+                                            ParOptVec *hvec) {
+  expandDesignVec(x, xfull);
+  expandDesignVec(px, pfull, 0);
+
+  ParOptVec *zwf;
+  expandMultipliers(z, zw, zfull, &zwf);
+  int fail = prob->evalHvecProduct(xfull, zfull, zwf, pfull, hfull);
+  reduceDesignVec(hfull, hvec);
+
+  return fail;
+}
+
+/*
+  Evaluate the diagonal of the Hessian
+*/
+int ParOptPresolvedProblem::evalHessianDiag(ParOptVec *x, ParOptScalar *z,
+                                            ParOptVec *zw, ParOptVec *hdiag) {
+  expandDesignVec(x, xfull);
+
+  ParOptVec *zwf;
+  expandMultipliers(z, zw, zfull, &zwf);
+  int fail = prob->evalHessianDiag(xfull, zfull, zwf, hfull);
+  reduceDesignVec(hfull, hdiag);
+
+  return fail;
+}
+
+/*
+  Compute a correction to the quasi-Newton update
+*/
+void ParOptPresolvedProblem::computeQuasiNewtonUpdateCorrection(
+    ParOptVec *x, ParOptScalar *z, ParOptVec *zw, ParOptVec *s, ParOptVec *y) {
+  expandDesignVec(x, xfull);
+  expandDesignVec(s, pfull, 0);
+  expandDesignVec(y, hfull, 0);
+
+  ParOptVec *zwf;
+  expandMultipliers(z, zw, zfull, &zwf);
+  prob->computeQuasiNewtonUpdateCorrection(xfull, zfull, zwf, pfull, hfull);
+  reduceDesignVec(hfull, y);
+}
+
+/*
+  Evaluate the sparse constraints
+*/
+void ParOptPresolvedProblem::evalSparseCon(ParOptVec *x, ParOptVec *out) {
+  if (sprob) {
+    ParOptSparseProblem::evalSparseCon(x, out);
+  } else {
+    expandDesignVec(x, xfull);
+    prob->evalSparseCon(xfull, out);
+  }
+}
+
+/*
+  Compute the Jacobian-vector product out = J(x)*px
+*/
+void ParOptPresolvedProblem::addSparseJacobian(ParOptScalar alpha,
+                                               ParOptVec *x, ParOptVec *px,
+                                               ParOptVec *out) {
+  if (sprob) {
+    ParOptSparseProblem::addSparseJacobian(alpha, x, px, out);
+  } else {
+    expandDesignVec(x, xfull);
+    expandDesignVec(px, pfull, 0);
+    prob->addSparseJacobian(alpha, xfull, pfull, out);
+  }
+}
+
+/*
+  Compute the transpose Jacobian-vector product out = J(x)^{T}*pzw
+*/
+void ParOptPresolvedProblem::addSparseJacobianTranspose(ParOptScalar alpha,
+                                                        ParOptVec *x,
+                                                        ParOptVec *pzw,
+                                                        ParOptVec *out) {
+  if (sprob) {
+    ParOptSparseProblem::addSparseJacobianTranspose(alpha, x, pzw, out);
+  } else {
+    expandDesignVec(x, xfull);
+    hfull->zeroEntries();
+    prob->addSparseJacobianTranspose(alpha, xfull, pzw, hfull);
+
+    ParOptScalar *outa, *h;
+    out->getArray(&outa);
+    hfull->getArray(&h);
+    for (int i = 0; i < nvars; i++) {
+      outa[i] += h[var_map[i]];
+    }
+  }
+}
+
+/*
+  Add the inner product of the constraints to the matrix such
+  that A += J(x)*cvec*J(x)^{T} where cvec is a diagonal matrix
+*/
+void ParOptPresolvedProblem::addSparseInnerProduct(ParOptScalar alpha,
+                                                   ParOptVec *x,
+                                                   ParOptVec *cvec,
+                                                   ParOptScalar *A) {
+  if (sprob) {
+    ParOptSparseProblem::addSparseInnerProduct(alpha, x, cvec, A);
+  } else {
+    expandDesignVec(x, xfull);
+    expandDesignVec(cvec, pfull, 0);
+    prob->addSparseInnerProduct(alpha, xfull, pfull, A);
+  }
+}
+
+/*
+  Write the output from the wrapped problem at the full design point
+*/
+void ParOptPresolvedProblem::writeOutput(int iter, ParOptVec *x) {
+  expandDesignVec(x, xfull);
+  prob->writeOutput(iter, xfull);
+}
+
+/**
+  Create the quasi-definite matrix for the presolved problem
+
+  @param _pre The presolved problem
+  @param _mat The matrix created by the wrapped problem
+*/
+ParOptPresolvedQuasiDefMat::ParOptPresolvedQuasiDefMat(
+    ParOptPresolvedProblem *_pre, ParOptQuasiDefMat *_mat) {
+  pre = _pre;
+  pre->incref();
+  mat = _mat;
+  mat->incref();
+
+  ParOptProblem *prob = pre->getProblem();
+  xf = prob->createDesignVec();
+  xf->incref();
+  Dinvf = prob->createDesignVec();
+  Dinvf->incref();
+  bxf = prob->createDesignVec();
+  bxf->incref();
+  yxf = prob->createDesignVec();
+  yxf->incref();
+}
+
+ParOptPresolvedQuasiDefMat::~ParOptPresolvedQuasiDefMat() {
+  pre->decref();
+  mat->decref();
+  xf->decref();
+  Dinvf->decref();
+  bxf->decref();
+  yxf->decref();
+}
+
+/*
+  Factor the matrix with a zero inverse diagonal for the fixed
+  variables
+*/
+int ParOptPresolvedQuasiDefMat::factor(ParOptVec *x, ParOptVec *Dinv,
+                                       ParOptVec *C) {
+  pre->expandDesignVec(x, xf);
+  pre->expandDesignVec(Dinv, Dinvf, 0);
+  return mat->factor(xf, Dinvf, C);
+}
+
+/*
+  Solve the quasi-definite system with a zero right-hand-side for the
+  sparse constraints
+*/
+void ParOptPresolvedQuasiDefMat::apply(ParOptVec *bx, ParOptVec *yx,
+                                       ParOptVec *yw) {
+  pre->expandDesignVec(bx, bxf, 0);
+  mat->apply(bxf, yxf, yw);
+  pre->reduceDesignVec(yxf, yx);
+}
+
+/*
+  Solve the quasi-definite system
+*/
+void ParOptPresolvedQuasiDefMat::apply(ParOptVec *bx, ParOptVec *bw,
+                                       ParOptVec *yx, ParOptVec *yw) {
+  pre->expandDesignVec(bx, bxf, 0);
+  mat->apply(bxf, bw, yxf, yw);
+  pre->reduceDesignVec(yxf, yx);
+}
+
+/*
+  Get a description of the factorization from the wrapped matrix
+*/
+const char *ParOptPresolvedQuasiDefMat::getFactorInfo() {
+  return mat->getFactorInfo();
+}
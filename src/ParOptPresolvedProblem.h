@@ -0,0 +1,242 @@
+#ifndef PAR_OPT_PRESOLVED_PROBLEM_H
+#define PAR_OPT_PRESOLVED_PROBLEM_H
+
+#include <stdio.h>
+
+#include "ParOptProblem.h"
+
+/*
+  A problem wrapper that removes fixed variables and redundant
+  constraints from the problem passed to the optimizer.
+
+  The presolve is performed once when the wrapper is created and
+  detects:
+
+  1. Fixed variables with lb == ub (to within a tolerance). These are
+  removed from the design vector and held at their bound.
+
+  2. Dense constraints that are declared linear and cannot become
+  active. An inequality is removed when it is satisfied at every
+  point within the variable bounds, and an equality is removed when
+  its gradient with respect to the free variables is zero and it is
+  satisfied.
+
+  3. Rows of the sparse constraint Jacobian that are empty after the
+  fixed variables are removed and that are satisfied, and, when the
+  sparse constraints are declared linear, duplicate rows. For duplicate
+  inequalities only the tightest constraint is kept.
+
+  Sparse rows are only removed when the wrapped problem is a
+  ParOptSparseProblem, since the wrapper can then form the reduced
+  Jacobian directly. Otherwise, the sparse constraints are forwarded
+  unchanged and the wrapped problem's quasi-definite matrix is used
+  with a zero diagonal for the fixed variables.
+
+  The sparse format of the dense constraint gradients and the
+  matrix-free Jacobian products are forwarded with the fixed variables
+  and removed constraints dropped. Neither is forwarded when the
+  wrapped problem is a ParOptSparseProblem, since its sparse Jacobian
+  is only updated when the dense gradients are evaluated.
+
+  The constraint and variable checks are performed at the starting
+  point with the fixed variables set to their bounds. After the reduced
+  problem is solved, postsolve() recovers the full design vector and
+  multipliers, including the bound multipliers of the fixed variables.
+*/
+class ParOptPresolvedProblem : public ParOptSparseProblem {
+ public:
+  ParOptPresolvedProblem(ParOptProblem *_prob, double _fixed_tol = 0.0,
+                         double _max_bound_value = 1e20);
+  ~ParOptPresolvedProblem();
+
+  // Get the wrapped problem
+  ParOptProblem *getProblem() { return prob; }
+
+  // Get the number of fixed variables and removed constraints
+  void getPresolveStats(int *_num_fixed, int *_num_dense_removed,
+                        int *_num_sparse_removed);
+
+  // Print the presolve statistics
+  void printPresolveStats(FILE *fp);
+
+  // Expand a reduced design vector to the full design vector
+  void expandDesignVec(ParOptVec *xr, ParOptVec *x, int use_fixed_values = 1);
+
+  // Extract the free components of a full design vector
+  void reduceDesignVec(ParOptVec *x, ParOptVec *xr);
+
+  // Recover the full solution and multipliers
+  int postsolve(ParOptVec *xr, ParOptScalar *zr, ParOptVec *zwr,
+                ParOptVec *zlr, ParOptVec *zur, ParOptVec *x, ParOptScalar *z,
+                ParOptVec *zw, ParOptVec *zl, ParOptVec *zu);
+
+  // Create the quasi-definite matrix
+  ParOptQuasiDefMat *createQuasiDefMat();
+
+  // Function to indicate the type of sparse constraints
+  int isSparseInequality();
+  int useLowerBounds();
+  int useUpperBounds();
+
+  // Functions to indicate the linearity of the objective and constraints
+  int isObjQuadratic();
+  int isDenseConLinear(int index);
+  int isSparseConLinear();
+
+  // Get the variables and bounds from the problem
+  void getVarsAndBounds(ParOptVec *x, ParOptVec *lb, ParOptVec *ub);
+
+  // Evaluate the objective and constraints
+  int evalObjCon(ParOptVec *x, ParOptScalar *fobj, ParOptScalar *cons);
+  int evalSparseObjCon(ParOptVec *x, ParOptScalar *fobj, ParOptScalar *cons,
+                       ParOptVec *sparse_con);
+
+  // Evaluate the objective and constraint gradients
+  int evalObjConGradient(ParOptVec *x, ParOptVec *g, ParOptVec **Ac);
+  int evalSparseObjConGradient(ParOptVec *x, ParOptVec *g, ParOptVec **Ac,
+                               ParOptScalar *data);
+
+  // Forward the sparse constraint gradients
+  int getConGradientPattern(const int **rowp, const int **cols);
+  int evalObjConSparseGradient(ParOptVec *x, ParOptVec *g,
+                               ParOptScalar *Avals);
+
+  // Forward the matrix-free constraint Jacobian
+  int useDenseJacobianProducts();
+  int evalObjGradient(ParOptVec *x, ParOptVec *g);
+  void addDenseJacobian(ParOptScalar alpha, ParOptVec *x, int nvecs,
+                        ParOptVec **px, ParOptScalar *out);
+  void addDenseJacobianTranspose(ParOptScalar alpha, ParOptVec *x, int nvecs,
+                                 const ParOptScalar *pz, ParOptVec **out);
+
+  // Evaluate the product of the Hessian with a given vector
+  int evalHvecProduct(ParOptVec *x, ParOptScalar *z, ParOptVec *zw,
+                      ParOptVec *px, ParOptVec *hvec);
+
+  // Evaluate the diagonal Hessian
+  int evalHessianDiag(ParOptVec *x, ParOptScalar *z, ParOptVec *zw,
+                      ParOptVec *hdiag);
+
+  // Compute a correction to the quasi-Newton update
+  void computeQuasiNewtonUpdateCorrection(ParOptVec *x, ParOptScalar *z,
+                                          ParOptVec *zw, ParOptVec *s,
+                                          ParOptVec *y);
+
+  // Evaluate the constraints
+  void evalSparseCon(ParOptVec *x, ParOptVec *out);
+
+  // Compute the Jacobian-vector product out = J(x)*px
+  void addSparseJacobian(ParOptScalar alpha, ParOptVec *x, ParOptVec *px,
+                         ParOptVec *out);
+
+  // Compute the transpose Jacobian-vector product out = J(x)^{T}*pzw
+  void addSparseJacobianTranspose(ParOptScalar alpha, ParOptVec *x,
+                                  ParOptVec *pzw, ParOptVec *out);
+
+  // Add the inner product of the constraints to the matrix such
+  // that A += J(x)*cvec*J(x)^{T} where cvec is a diagonal matrix
+  void addSparseInnerProduct(ParOptScalar alpha, ParOptVec *x, ParOptVec *cvec,
+                             ParOptScalar *A);
+
+  // Write the output from the wrapped problem
+  void writeOutput(int iter, ParOptVec *x);
+
+ private:
+  // Perform the presolve
+  void presolve(double fixed_tol, double max_bound_value);
+
+  // Remove the redundant dense constraints
+  int presolveDenseCons(ParOptVec *lb, ParOptVec *ub, double max_bound_value);
+
+  // Remove the empty or duplicate sparse constraints
+  int presolveSparseCons();
+
+  // Set the full multipliers from the reduced multipliers
+  void expandMultipliers(ParOptScalar *zr, ParOptVec *zwr, ParOptScalar *z,
+                         ParOptVec **zw);
+
+  // Evaluate the gradients of the wrapped problem at a full point
+  int evalWrappedGradient(ParOptVec *x, ParOptScalar *data);
+
+  // Evaluate the full gradients and extract the reduced gradients
+  int evalFullGradient(ParOptVec *g, ParOptVec **Ac, ParOptScalar *data);
+
+  // Form the reduced pattern of the dense constraint gradients
+  void presolveConGradientPattern();
+
+  // Allocate the work vectors for the Jacobian-vector products
+  void allocJacobianWork(int nvecs);
+
+  // The wrapped problem, and the sparse problem if it is one
+  ParOptProblem *prob;
+  ParOptSparseProblem *sprob;
+
+  // The sizes of the wrapped problem
+  int nvars_full, ncon_full, nwcon_full;
+  int ninequality_full, nwinequality_full;
+
+  // The free variables and the map from the full variables
+  int *var_map;
+  int *var_index;
+
+  // The kept dense and sparse constraints
+  int *con_map;
+  int *wcon_map;
+
+  // The map from the reduced to the full sparse Jacobian entries
+  int *data_map;
+
+  // The reduced pattern of the dense constraint gradients, the map
+  // to the full entries and the full entries
+  int con_nnz;
+  int *con_rowp, *con_cols;
+  int *con_data_map;
+  ParOptScalar *con_vals;
+
+  // Work vectors for the Jacobian-vector products
+  int num_jac_work;
+  ParOptVec **jac_work;
+  ParOptScalar *jac_zwork;
+
+  // The presolve statistics
+  int num_fixed, num_dense_removed, num_sparse_removed;
+
+  // Full vectors for the evaluations
+  ParOptVec *xfull, *gfull, *pfull, *hfull;
+  ParOptVec **Afull;
+  ParOptScalar *cfull, *zfull;
+
+  // The vectors passed to the wrapped problem for the gradients. The
+  // stored gradients of the linear constraints are kept once evaluated.
+  int lin_grad_init;
+  ParOptVec **Aeval, *Awork;
+  ParOptVec *cwfull, *zwfull;
+  ParOptScalar *sdata;
+};
+
+/*
+  The quasi-definite matrix for the presolved problem.
+
+  This wraps the matrix created by the original problem. The reduced
+  vectors are expanded with a zero entry in the inverse of the diagonal
+  for each fixed variable, so that the fixed variables do not contribute
+  to the factorization and their components of the solution are zero.
+*/
+class ParOptPresolvedQuasiDefMat : public ParOptQuasiDefMat {
+ public:
+  ParOptPresolvedQuasiDefMat(ParOptPresolvedProblem *_pre,
+                             ParOptQuasiDefMat *_mat);
+  ~ParOptPresolvedQuasiDefMat();
+
+  int factor(ParOptVec *x, ParOptVec *Dinv, ParOptVec *C);
+  void apply(ParOptVec *bx, ParOptVec *yx, ParOptVec *yw);
+  void apply(ParOptVec *bx, ParOptVec *bw, ParOptVec *yx, ParOptVec *yw);
+  const char *getFactorInfo();
+
+ private:
+  ParOptPresolvedProblem *pre;
+  ParOptQuasiDefMat *mat;
+  ParOptVec *xf, *Dinvf, *bxf, *yxf;
+};
+
+#endif  // PAR_OPT_PRESOLVED_PROBLEM_H
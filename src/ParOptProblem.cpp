@@ -124,6 +124,186 @@ int ParOptProblem::useLowerBounds() { return 1; }
  */
 int ParOptProblem::useUpperBounds() { return 1; }
 
+/**
+  Evaluate the objective and constraint gradients.
+
+  This is the implementation of the pure virtual function that can be
+  called by derived classes. The dense constraint gradients are obtained
+  from the sparse format or the transpose Jacobian-vector products and
+  expanded into the vectors Ac.
+
+  @param x is the design variable vector
+  @param g is the gradient of the objective at x
+  @param Ac are the gradients of the dense constraints at x
+  @return zero on success, non-zero fail flag on error
+*/
+int ParOptProblem::evalObjConGradient(ParOptVec *x, ParOptVec *g,
+                                      ParOptVec **Ac) {
+  if (useDenseJacobianProducts()) {
+    int fail = evalObjGradient(x, g);
+    if (fail) {
+      return fail;
+    }
+
+    // Extract the gradients one at a time as A^{T}*e_i
+    ParOptScalar *e = new ParOptScalar[ncon];
+    memset(e, 0, ncon * sizeof(ParOptScalar));
+    for (int i = 0; i < ncon; i++) {
+      if (Ac[i]) {
+        e[i] = 1.0;
+        Ac[i]->zeroEntries();
+        addDenseJacobianTranspose(1.0, x, 1, e, &Ac[i]);
+        e[i] = 0.0;
+      }
+    }
+    delete[] e;
+
+    return 0;
+  }
+
+  const int *rowp, *cols;
+  int nnz = getConGradientPattern(&rowp, &cols);
+  if (nnz < 0) {
+    fprintf(stderr,
+            "ParOpt: No sparse constraint gradient pattern or Jacobian "
+            "products are provided\n");
+    return 1;
+  }
+
+  ParOptScalar *Avals = new ParOptScalar[nnz > 0 ? nnz : 1];
+  int fail = evalObjConSparseGradient(x, g, Avals);
+
+  if (!fail) {
+    for (int i = 0; i < ncon; i++) {
+      if (!Ac[i]) {
+        continue;
+      }
+      ParOptScalar *avals;
+      Ac[i]->zeroEntries();
+      Ac[i]->getArray(&avals);
+      for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+        avals[cols[jp]] = Avals[jp];
+      }
+    }
+  }
+
+  delete[] Avals;
+
+  return fail;
+}
+
+/**
+  Get the non-zero pattern of the dense constraint gradients.
+
+  By default, the dense constraint gradients are dense.
+
+  @param rowp is the pointer into each row
+  @param cols are the local design variable indices
+  @return the number of local non-zero entries or -1
+*/
+int ParOptProblem::getConGradientPattern(const int **rowp, const int **cols) {
+  if (rowp) {
+    *rowp = NULL;
+  }
+  if (cols) {
+    *cols = NULL;
+  }
+  return -1;
+}
+
+/**
+  Evaluate the objective gradient and the sparse constraint gradients.
+
+  By default, no implementation is provided.
+
+  @param x is the design variable vector
+  @param g is the gradient of the objective at x
+  @param Avals are the non-zero entries of the dense constraint gradients
+  @return zero on success, non-zero fail flag on error
+*/
+int ParOptProblem::evalObjConSparseGradient(ParOptVec *x, ParOptVec *g,
+                                            ParOptScalar *Avals) {
+  fprintf(stderr, "ParOpt: evalObjConSparseGradient is not implemented\n");
+  return 1;
+}
+
+/**
+  Indicate whether the dense constraint Jacobian is only available
+  through matrix-vector products. Default is false.
+
+  @return flag indicating whether to use Jacobian-vector products
+*/
+int ParOptProblem::useDenseJacobianProducts() { return 0; }
+
+/**
+  Evaluate the objective gradient for a matrix-free Jacobian.
+
+  By default, no implementation is provided.
+
+  @param x is the design variable vector
+  @param g is the gradient of the objective at x
+  @return zero on success, non-zero fail flag on error
+*/
+int ParOptProblem::evalObjGradient(ParOptVec *x, ParOptVec *g) {
+  fprintf(stderr, "ParOpt: evalObjGradient is not implemented\n");
+  return 1;
+}
+
+/**
+  Compute a set of dense constraint Jacobian-vector products.
+
+  By default, no implementation is provided.
+
+  @param alpha is a scalar factor
+  @param x is the design variable vector
+  @param nvecs is the number of vectors
+  @param px are the input direction vectors
+  @param out is the array of products of length nvecs*ncon
+*/
+void ParOptProblem::addDenseJacobian(ParOptScalar alpha, ParOptVec *x,
+                                     int nvecs, ParOptVec **px,
+                                     ParOptScalar *out) {}
+
+/**
+  Compute a set of dense constraint transpose Jacobian-vector products.
+
+  By default, no implementation is provided.
+
+  @param alpha is a scalar factor
+  @param x is the design variable vector
+  @param nvecs is the number of vectors
+  @param pz is the array of input multipliers of length nvecs*ncon
+  @param out are the output vectors
+*/
+void ParOptProblem::addDenseJacobianTranspose(ParOptScalar alpha,
+                                              ParOptVec *x, int nvecs,
+                                              const ParOptScalar *pz,
+                                              ParOptVec **out) {}
+
+/**
+  Indicate whether the objective is a quadratic function with a
+  constant Hessian. Default is false.
+
+  @return flag indicating whether the objective is quadratic
+*/
+int ParOptProblem::isObjQuadratic() { return 0; }
+
+/**
+  Indicate whether the given dense constraint is linear. Default is
+  false.
+
+  @param index the index of the dense constraint
+  @return flag indicating whether the constraint is linear
+*/
+int ParOptProblem::isDenseConLinear(int index) { return 0; }
+
+/**
+  Indicate whether the sparse constraints are linear. Default is false.
+
+  @return flag indicating whether the sparse constraints are linear
+*/
+int ParOptProblem::isSparseConLinear() { return 0; }
+
 /**
   Evaluate the product of the Hessian with a given vector.
 
@@ -676,7 +856,9 @@ void ParOptSparseProblem::setSparseJacobianData(const int *_rowp,
 }
 
 ParOptSparseProblem::~ParOptSparseProblem() {
-  cw->decref();
+  if (cw) {
+    cw->decref();
+  }
   delete[] rowp;
   delete[] cols;
   delete[] data;
@@ -30,7 +30,12 @@ class ParOptSparseProblem;
   evalObjConGradient(): This function evaluates the objective and
   constraint gradients at the current point. Again, the fail flag is
   given as above. Note that the constraint gradients are returned as a
-  series of dense vectors.
+  series of dense vectors. Alternatively, constraints that depend on
+  only a few design variables can provide their gradients in a sparse
+  format through getConGradientPattern() and evalObjConSparseGradient().
+  For large numbers of dense constraints, the problem can instead
+  provide products with the constraint Jacobian, see
+  useDenseJacobianProducts().
 
   The class takes as input the communicator for the optimizer, the
   number of local design variables on the given process, and the
@@ -133,6 +138,42 @@ class ParOptProblem : public ParOptBase {
    */
   virtual int useUpperBounds();
 
+  /**
+    Indicate whether the objective is a quadratic function with a
+    constant Hessian. Default is false.
+
+    @return flag indicating whether the objective is quadratic
+  */
+  virtual int isObjQuadratic();
+
+  /**
+    Indicate whether the given dense constraint is linear. Default is
+    false.
+
+    The interior-point method only uses the gradient of a linear dense
+    constraint from the first gradient evaluation of each call to
+    optimize(). In later calls to evalObjConGradient(), the entry
+    Ac[index] is a scratch vector whose values are discarded, so its
+    computation may be skipped. With the sparse gradient format, the
+    entries of the linear constraints in Avals retain their values from
+    the first call and may be left unchanged.
+
+    @param index the index of the dense constraint
+    @return flag indicating whether the constraint is linear
+  */
+  virtual int isDenseConLinear(int index);
+
+  /**
+    Indicate whether the sparse constraints are linear. Default is
+    false.
+
+    When the sparse constraints are linear, the sparse quasi-definite
+    matrix computes the transpose of the constant Jacobian only once.
+
+    @return flag indicating whether the sparse constraints are linear
+  */
+  virtual int isSparseConLinear();
+
   /**
     Get the initial variable values and bounds for the problem
 
@@ -164,6 +205,12 @@ class ParOptProblem : public ParOptBase {
     and dense constraint functions. This call is made only after a call
     to evaluate the objective and dense constraint functions.
 
+    Problems that provide the sparse format or the Jacobian-vector
+    products can implement this by calling
+    ParOptProblem::evalObjConGradient(), which expands the gradients
+    returned by evalObjConSparseGradient(), or computes them with
+    transpose Jacobian-vector products.
+
     @param x is the design variable vector
     @param g is the gradient of the objective at x
     @param Ac are the gradients of the dense constraints at x
@@ -172,6 +219,96 @@ class ParOptProblem : public ParOptBase {
   virtual int evalObjConGradient(ParOptVec *x, ParOptVec *g,
                                  ParOptVec **Ac) = 0;
 
+  /**
+    Get the non-zero pattern of the dense constraint gradients.
+
+    Dense constraints that depend on only a small fraction of the
+    design variables can provide their gradients in a sparse format.
+    The pattern is given for the local design variables in compressed
+    sparse row format, with one row for each of the ncon dense
+    constraints: the local indices of the non-zero entries of the i-th
+    gradient are cols[rowp[i]:rowp[i+1]]. The pattern must not change.
+    The default implementation returns -1 to indicate that the
+    gradients are dense.
+
+    @param rowp is the pointer into each row
+    @param cols are the local design variable indices
+    @return the number of local non-zero entries or -1
+  */
+  virtual int getConGradientPattern(const int **rowp, const int **cols);
+
+  /**
+    Evaluate the objective gradient and the sparse constraint gradients.
+
+    This is only called if getConGradientPattern() returns a non-zero
+    pattern. The entries of the constraint gradients are returned in
+    the order given by the pattern.
+
+    @param x is the design variable vector
+    @param g is the gradient of the objective at x
+    @param Avals are the non-zero entries of the dense constraint gradients
+    @return zero on success, non-zero fail flag on error
+  */
+  virtual int evalObjConSparseGradient(ParOptVec *x, ParOptVec *g,
+                                       ParOptScalar *Avals);
+
+  /**
+    Indicate whether the dense constraint Jacobian is only available
+    through matrix-vector products. Default is false.
+
+    When this returns true, the interior-point method never requests the
+    dense constraint gradients. Instead, it calls evalObjGradient() and
+    then computes products with the dense constraint Jacobian A(x)
+    through addDenseJacobian() and addDenseJacobianTranspose().
+
+    @return flag indicating whether to use Jacobian-vector products
+  */
+  virtual int useDenseJacobianProducts();
+
+  /**
+    Evaluate the objective gradient for a matrix-free Jacobian.
+
+    This call is made only after a call to evaluate the objective and
+    dense constraint functions. The subsequent Jacobian-vector products
+    use the dense constraint Jacobian at x.
+
+    @param x is the design variable vector
+    @param g is the gradient of the objective at x
+    @return zero on success, non-zero fail flag on error
+  */
+  virtual int evalObjGradient(ParOptVec *x, ParOptVec *g);
+
+  /**
+    Compute a set of dense constraint Jacobian-vector products.
+
+    This code computes out[k*ncon:(k+1)*ncon] += alpha*A(x)*px[k] for
+    k = 0,...,nvecs-1. The result must be the same on all processors.
+
+    @param alpha is a scalar factor
+    @param x is the design variable vector
+    @param nvecs is the number of vectors
+    @param px are the input direction vectors
+    @param out is the array of products of length nvecs*ncon
+  */
+  virtual void addDenseJacobian(ParOptScalar alpha, ParOptVec *x, int nvecs,
+                                ParOptVec **px, ParOptScalar *out);
+
+  /**
+    Compute a set of dense constraint transpose Jacobian-vector products.
+
+    This code computes out[k] += alpha*A(x)^{T}*pz[k*ncon:(k+1)*ncon]
+    for k = 0,...,nvecs-1.
+
+    @param alpha is a scalar factor
+    @param x is the design variable vector
+    @param nvecs is the number of vectors
+    @param pz is the array of input multipliers of length nvecs*ncon
+    @param out are the output vectors
+  */
+  virtual void addDenseJacobianTranspose(ParOptScalar alpha, ParOptVec *x,
+                                         int nvecs, const ParOptScalar *pz,
+                                         ParOptVec **out);
+
   /**
     Evaluate the product of the Hessian with a given vector.
 
@@ -295,6 +432,28 @@ class ParOptProblem : public ParOptBase {
   int nwinequality;  // Number of sparse inequality constraints < nwcon
 };
 
+/*
+  Factory class used to create new instances of a problem.
+
+  Some optimization methods evaluate several design points at the same
+  time by splitting the processors into groups. Each group requires its
+  own problem instance defined on the group's communicator. The problem
+  instances must have the same total number of design variables and the
+  same number of dense constraints as the original problem, but the
+  distribution of the design variables across processors may differ.
+  The variables are assigned to the groups' processors in rank order.
+*/
+class ParOptProblemFactory : public ParOptBase {
+ public:
+  /**
+    Create a new problem instance on the given communicator
+
+    @param comm The communicator for the new problem instance
+    @return A new problem instance
+  */
+  virtual ParOptProblem *createProblem(MPI_Comm comm) = 0;
+};
+
 /*
   Problem with general sparse constraints
 */
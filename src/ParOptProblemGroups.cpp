@@ -0,0 +1,284 @@
+#include "ParOptProblemGroups.h"
+
+#include <string.h>
+
+/**
+  Split the processors into groups and create the problem instances
+
+  @param _comm The communicator of the original problem
+  @param factory The factory used to create the problem instances
+  @param _num_groups The number of processor groups
+  @param _nvars The local number of design variables
+  @param _ncon The number of dense constraints
+*/
+ParOptProblemGroups::ParOptProblemGroups(MPI_Comm _comm,
+                                         ParOptProblemFactory *factory,
+                                         int _num_groups, int _nvars,
+                                         int _ncon) {
+  comm = _comm;
+  nvars = _nvars;
+  ncon = _ncon;
+
+  num_groups = 0;
+  group = 0;
+  groups = NULL;
+  root = NULL;
+  group_comm = MPI_COMM_NULL;
+  prob = NULL;
+  x = NULL;
+  g = NULL;
+  Ac = NULL;
+  send_count = send_ptr = NULL;
+  recv_count = recv_ptr = NULL;
+  counts = NULL;
+  xsend = NULL;
+  buff = NULL;
+
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  if (_num_groups > size) {
+    _num_groups = size;
+  }
+  if (!factory || _num_groups <= 1) {
+    return;
+  }
+
+  // Split the processors into contiguous groups
+  group = (_num_groups * rank) / size;
+  MPI_Comm_split(comm, group, rank, &group_comm);
+
+  // Create the problem instance on this group
+  prob = factory->createProblem(group_comm);
+  int group_nvars = 0, group_ncon = 0, group_nwcon = 0;
+  if (prob) {
+    prob->incref();
+    prob->getProblemSizes(&group_nvars, &group_ncon, &group_nwcon);
+  }
+
+  // Find the offset of this processor's variables within the group
+  int group_offset = 0;
+  MPI_Exscan(&group_nvars, &group_offset, 1, MPI_INT, MPI_SUM, group_comm);
+  int group_rank;
+  MPI_Comm_rank(group_comm, &group_rank);
+  if (group_rank == 0) {
+    group_offset = 0;
+  }
+
+  // Gather the group, the original variable range and the group
+  // variable range from all processors
+  int local[4] = {group, nvars, group_offset, group_nvars};
+  int *info = new int[4 * size];
+  MPI_Allgather(local, 4, MPI_INT, info, 4, MPI_INT, comm);
+
+  // Check that the problem instance is compatible
+  int nvars_total = 0;
+  int group_total = 0;
+  for (int k = 0; k < size; k++) {
+    nvars_total += info[4 * k + 1];
+    if (info[4 * k] == group) {
+      group_total += info[4 * k + 3];
+    }
+  }
+  int compatible = (prob && group_total == nvars_total && group_ncon == ncon &&
+                    group_nwcon == 0);
+  MPI_Allreduce(MPI_IN_PLACE, &compatible, 1, MPI_INT, MPI_MIN, comm);
+  if (!compatible) {
+    delete[] info;
+    if (prob) {
+      prob->decref();
+    }
+    prob = NULL;
+    MPI_Comm_free(&group_comm);
+    return;
+  }
+
+  num_groups = _num_groups;
+  groups = new int[size];
+  root = new int[num_groups];
+  send_count = new int[size];
+  send_ptr = new int[size];
+  recv_count = new int[size];
+  recv_ptr = new int[size];
+  counts = new int[2 * size];
+
+  // Find the overlap between the variables on this processor and the
+  // group variables on every other processor, and vice versa
+  int offset = 0;
+  for (int k = 0; k < rank; k++) {
+    offset += info[4 * k + 1];
+  }
+  for (int k = 0, start = 0; k < size; k++) {
+    groups[k] = info[4 * k];
+
+    int lower = info[4 * k + 2];
+    int upper = lower + info[4 * k + 3];
+    if (lower < offset) {
+      lower = offset;
+    }
+    if (upper > offset + nvars) {
+      upper = offset + nvars;
+    }
+    send_count[k] = (upper > lower ? upper - lower : 0);
+    send_ptr[k] = groups[k] * nvars + lower - offset;
+
+    lower = start;
+    upper = start + info[4 * k + 1];
+    if (lower < group_offset) {
+      lower = group_offset;
+    }
+    if (upper > group_offset + group_nvars) {
+      upper = group_offset + group_nvars;
+    }
+    recv_count[k] = (upper > lower ? upper - lower : 0);
+    recv_ptr[k] = lower - group_offset;
+
+    start += info[4 * k + 1];
+  }
+  delete[] info;
+
+  // Find the root processor for each group
+  for (int k = size - 1; k >= 0; k--) {
+    root[groups[k]] = k;
+  }
+
+  x = prob->createDesignVec();
+  x->incref();
+
+  xsend = new ParOptScalar[num_groups * nvars];
+  buff = new ParOptScalar[size * (ncon + 2)];
+}
+
+/*
+  Free the problem instances and the data for the groups
+*/
+ParOptProblemGroups::~ParOptProblemGroups() {
+  if (prob) {
+    prob->decref();
+  }
+  if (x) {
+    x->decref();
+  }
+  if (g) {
+    g->decref();
+    for (int i = 0; i < ncon; i++) {
+      Ac[i]->decref();
+    }
+    delete[] Ac;
+  }
+  if (group_comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&group_comm);
+  }
+  delete[] groups;
+  delete[] root;
+  delete[] send_count;
+  delete[] send_ptr;
+  delete[] recv_count;
+  delete[] recv_ptr;
+  delete[] counts;
+  delete[] xsend;
+  delete[] buff;
+}
+
+/*
+  Send the local trial points to the groups, evaluate them and share
+  the results between all processors
+*/
+void ParOptProblemGroups::evalObjCon(int npts, int *fail, ParOptScalar *fobj,
+                                     ParOptScalar *cons) {
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  // Only send to and receive from the groups with a trial point
+  int *scount = &counts[0];
+  int *rcount = &counts[size];
+  for (int k = 0; k < size; k++) {
+    scount[k] = (groups[k] < npts ? send_count[k] : 0);
+    rcount[k] = (group < npts ? recv_count[k] : 0);
+  }
+
+  ParOptScalar *xvals;
+  x->getArray(&xvals);
+  MPI_Alltoallv(xsend, scount, send_ptr, PAROPT_MPI_TYPE, xvals, rcount,
+                recv_ptr, PAROPT_MPI_TYPE, comm);
+
+  // Evaluate the trial point assigned to this group. The result is
+  // stored as (fail, fobj, cons).
+  ParOptScalar *local = new ParOptScalar[ncon + 2];
+  memset(local, 0, (ncon + 2) * sizeof(ParOptScalar));
+  if (group < npts) {
+    int fail_g = prob->evalObjCon(x, &local[1], &local[2]);
+    local[0] = 1.0 * fail_g;
+  }
+
+  // Share the results between all processors
+  MPI_Allgather(local, ncon + 2, PAROPT_MPI_TYPE, buff, ncon + 2,
+                PAROPT_MPI_TYPE, comm);
+  delete[] local;
+
+  // Extract the values from the group roots
+  for (int k = 0; k < npts; k++) {
+    const ParOptScalar *result = &buff[(ncon + 2) * root[k]];
+    fail[k] = (ParOptRealPart(result[0]) != 0.0);
+    fobj[k] = result[1];
+    memcpy(&cons[k * ncon], &result[2], ncon * sizeof(ParOptScalar));
+  }
+}
+
+/*
+  Evaluate the gradients on the k-th group and send them back to the
+  distribution of the original problem
+*/
+int ParOptProblemGroups::evalObjConGradient(int k, ParOptVec *gvec,
+                                            ParOptVec **Acvec) {
+  if (!g) {
+    g = prob->createDesignVec();
+    g->incref();
+    Ac = new ParOptVec *[ncon];
+    for (int i = 0; i < ncon; i++) {
+      Ac[i] = prob->createDesignVec();
+      Ac[i]->incref();
+    }
+  }
+
+  int fail = 0;
+  if (group == k) {
+    fail = prob->evalObjConGradient(x, g, Ac);
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+
+  if (!fail) {
+    sendToOriginal(k, g, gvec);
+    for (int i = 0; i < ncon; i++) {
+      sendToOriginal(k, Ac[i], Acvec[i]);
+    }
+  }
+
+  return fail;
+}
+
+/*
+  Send the values of a vector on group k to the original distribution.
+  This reverses the communication pattern used for the trial points.
+*/
+void ParOptProblemGroups::sendToOriginal(int k, ParOptVec *gvec,
+                                         ParOptVec *vec) {
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  int *scount = &counts[0];
+  int *rcount = &counts[size];
+  int *rptr = new int[size];
+  for (int j = 0; j < size; j++) {
+    scount[j] = (group == k ? recv_count[j] : 0);
+    rcount[j] = (groups[j] == k ? send_count[j] : 0);
+    rptr[j] = (groups[j] == k ? send_ptr[j] - k * nvars : 0);
+  }
+
+  ParOptScalar *gvals, *vals;
+  gvec->getArray(&gvals);
+  vec->getArray(&vals);
+  MPI_Alltoallv(gvals, scount, recv_ptr, PAROPT_MPI_TYPE, vals, rcount, rptr,
+                PAROPT_MPI_TYPE, comm);
+  delete[] rptr;
+}
@@ -0,0 +1,110 @@
+#ifndef PAR_OPT_PROBLEM_GROUPS_H
+#define PAR_OPT_PROBLEM_GROUPS_H
+
+#include "ParOptProblem.h"
+
+/*
+  Evaluate several design points concurrently on groups of processors.
+
+  The processors are split into contiguous groups and the factory is
+  used to create a problem instance on each group. The trial points are
+  formed by the caller in the distribution of the original problem,
+  with one local array for each group (see getTrialPoint()). Each
+  processor then sends only the parts of its local arrays that are
+  owned by the processors of the corresponding group, so the full
+  design vector is never formed on any processor.
+
+  The objective and constraint values computed by each group are shared
+  between all processors. The gradients of a single group can also be
+  computed and sent back to the distribution of the original problem.
+
+  This class is used by the parallel line search and the concurrent
+  evaluation of trust-region radii. The problem instances must have the
+  same total number of design variables and the same number of dense
+  constraints as the original problem, and no sparse constraints. If
+  this is not the case, or if the factory does not create a problem,
+  getNumGroups() returns zero.
+*/
+class ParOptProblemGroups : public ParOptBase {
+ public:
+  ParOptProblemGroups(MPI_Comm _comm, ParOptProblemFactory *factory,
+                      int _num_groups, int _nvars, int _ncon);
+  ~ParOptProblemGroups();
+
+  /**
+    Get the number of processor groups
+
+    @return The number of groups or zero if the groups are not used
+  */
+  int getNumGroups() { return num_groups; }
+
+  /**
+    Get the local array for the trial point evaluated by a group
+
+    The array has the local size of the original problem. It must be
+    set on all processors before calling evalObjCon().
+
+    @param k The group index
+    @return The local values of the trial point
+  */
+  ParOptScalar *getTrialPoint(int k) { return &xsend[k * nvars]; }
+
+  /**
+    Evaluate the trial points on the first npts groups concurrently
+
+    @param npts The number of trial points
+    @param fail The failure flag for each trial point
+    @param fobj The objective value at each trial point
+    @param cons The constraint values at each trial point
+  */
+  void evalObjCon(int npts, int *fail, ParOptScalar *fobj,
+                  ParOptScalar *cons);
+
+  /**
+    Evaluate the gradients at the trial point of the k-th group
+
+    This must be called after evalObjCon() with k < npts and before the
+    group evaluates another point. The gradients are returned in the
+    distribution of the original problem.
+
+    @param k The group index
+    @param g The objective gradient
+    @param Ac The dense constraint gradients
+    @return The failure flag from the group
+  */
+  int evalObjConGradient(int k, ParOptVec *g, ParOptVec **Ac);
+
+ private:
+  // Send a vector from group k to the original distribution
+  void sendToOriginal(int k, ParOptVec *gvec, ParOptVec *vec);
+
+  // The communicator and the problem sizes
+  MPI_Comm comm;
+  int nvars, ncon;
+
+  // The groups and the communicator for this group
+  int num_groups;
+  int group;
+  int *groups;
+  int *root;
+  MPI_Comm group_comm;
+
+  // The problem instance and trial point for this group
+  ParOptProblem *prob;
+  ParOptVec *x;
+
+  // The gradient vectors for this group
+  ParOptVec *g;
+  ParOptVec **Ac;
+
+  // Counts and offsets used to send the trial points to the groups
+  int *send_count, *send_ptr;
+  int *recv_count, *recv_ptr;
+  int *counts;
+
+  // The local trial points and the buffer for the results
+  ParOptScalar *xsend;
+  ParOptScalar *buff;
+};
+
+#endif  // PAR_OPT_PROBLEM_GROUPS_H
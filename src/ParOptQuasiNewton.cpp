@@ -486,6 +486,87 @@ int ParOptLBFGS::getCompactMat(ParOptScalar *_b0, const ParOptScalar **_d,
   return 2 * msub;
 }
 
+/**
+  Get the update pairs that define the approximation
+
+  The pairs are ordered from the oldest to the most recent. The
+  returned arrays point to the internal vectors.
+
+  @param _b0 the diagonal factor
+  @param _S the step vectors
+  @param _Y the gradient difference vectors
+  @return the number of update pairs
+*/
+int ParOptLBFGS::getUpdatePairs(ParOptScalar *_b0, ParOptVec ***_S,
+                                ParOptVec ***_Y) {
+  if (_b0) {
+    *_b0 = b0;
+  }
+  if (_S) {
+    *_S = S;
+  }
+  if (_Y) {
+    *_Y = Y;
+  }
+
+  return msub;
+}
+
+/**
+  Set the approximation from a list of update pairs.
+
+  This is used to restore the approximation from a checkpoint file.
+  The pairs are ordered from the oldest to the most recent and are
+  not checked against the curvature condition. Only the most recent
+  pairs are retained if the list exceeds the subspace size.
+
+  @param _b0 the diagonal factor
+  @param m the number of update pairs
+  @param _S the step vectors
+  @param _Y the gradient difference vectors
+  @return zero on success
+*/
+int ParOptLBFGS::setUpdatePairs(ParOptScalar _b0, int m, ParOptVec **_S,
+                                ParOptVec **_Y) {
+  reset();
+
+  // Keep the most recent pairs
+  int offset = 0;
+  if (m > msub_max) {
+    offset = m - msub_max;
+    m = msub_max;
+  }
+
+  b0 = _b0;
+  msub = m;
+  for (int i = 0; i < msub; i++) {
+    S[i]->copyValues(_S[offset + i]);
+    Y[i]->copyValues(_Y[offset + i]);
+  }
+
+  // Compute the S^{T}S, L and D matrices
+  for (int i = 0; i < msub; i++) {
+    for (int j = 0; j <= i; j++) {
+      B[i + j * msub_max] = S[i]->dot(S[j]);
+      B[j + i * msub_max] = B[i + j * msub_max];
+    }
+    for (int j = 0; j < i; j++) {
+      L[i + j * msub_max] = S[i]->dot(Y[j]);
+    }
+    D[i] = S[i]->dot(Y[i]);
+  }
+
+  // Set the ordering of the Z-vectors
+  for (int i = 0; i < msub; i++) {
+    Z[i] = S[i];
+    Z[i + msub] = Y[i];
+  }
+
+  computeMatUpdate();
+
+  return 0;
+}
+
 /**
   The following class implements the limited-memory SR1 update.
 
@@ -705,6 +786,16 @@ int ParOptLSR1::update(ParOptVec *x, const ParOptScalar *z, ParOptVec *zw,
     L[msub - 1 + i * msub_max] = S[msub - 1]->dot(Y[i]);
   }
 
+  computeMatUpdate();
+
+  return update_type;
+}
+
+/*
+  Compute the Z-vectors and the factored M-matrix from the stored S/Y
+  vectors and the B, L and D matrices
+*/
+void ParOptLSR1::computeMatUpdate() {
   // Set the values into the M-matrix
   memset(M, 0, msub * msub * sizeof(ParOptScalar));
 
@@ -742,8 +833,6 @@ int ParOptLSR1::update(ParOptVec *x, const ParOptScalar *z, ParOptVec *zw,
     int n = msub, info = 0;
     LAPACKdgetrf(&n, &n, M_factor, &n, mfpiv, &info);
   }
-
-  return update_type;
 }
 
 /**
@@ -835,3 +924,78 @@ int ParOptLSR1::getCompactMat(ParOptScalar *_b0, const ParOptScalar **_d,
 
   return msub;
 }
+
+/**
+  Get the update pairs that define the approximation
+
+  The pairs are ordered from the oldest to the most recent. The
+  returned arrays point to the internal vectors.
+
+  @param _b0 the diagonal factor
+  @param _S the step vectors
+  @param _Y the gradient difference vectors
+  @return the number of update pairs
+*/
+int ParOptLSR1::getUpdatePairs(ParOptScalar *_b0, ParOptVec ***_S,
+                               ParOptVec ***_Y) {
+  if (_b0) {
+    *_b0 = b0;
+  }
+  if (_S) {
+    *_S = S;
+  }
+  if (_Y) {
+    *_Y = Y;
+  }
+
+  return msub;
+}
+
+/**
+  Set the approximation from a list of update pairs.
+
+  This is used to restore the approximation from a checkpoint file.
+  The pairs are ordered from the oldest to the most recent and are
+  not checked against the curvature condition. Only the most recent
+  pairs are retained if the list exceeds the subspace size.
+
+  @param _b0 the diagonal factor
+  @param m the number of update pairs
+  @param _S the step vectors
+  @param _Y the gradient difference vectors
+  @return zero on success
+*/
+int ParOptLSR1::setUpdatePairs(ParOptScalar _b0, int m, ParOptVec **_S,
+                               ParOptVec **_Y) {
+  reset();
+
+  // Keep the most recent pairs
+  int offset = 0;
+  if (m > msub_max) {
+    offset = m - msub_max;
+    m = msub_max;
+  }
+
+  b0 = _b0;
+  msub = m;
+  for (int i = 0; i < msub; i++) {
+    S[i]->copyValues(_S[offset + i]);
+    Y[i]->copyValues(_Y[offset + i]);
+  }
+
+  // Compute the S^{T}S, L and D matrices
+  for (int i = 0; i < msub; i++) {
+    for (int j = 0; j <= i; j++) {
+      B[i + j * msub_max] = S[i]->dot(S[j]);
+      B[j + i * msub_max] = B[i + j * msub_max];
+    }
+    for (int j = 0; j < i; j++) {
+      L[i + j * msub_max] = S[i]->dot(Y[j]);
+    }
+    D[i] = S[i]->dot(Y[i]);
+  }
+
+  computeMatUpdate();
+
+  return 0;
+}
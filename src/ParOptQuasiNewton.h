@@ -64,6 +64,20 @@ class ParOptCompactQuasiNewton : public ParOptBase {
 
   // Get the maximum size of the compact representation
   virtual int getMaxLimitedMemorySize() = 0;
+
+  // Get the update pairs that define the approximation. This is used to
+  // store the approximation in a checkpoint file and does not need to
+  // be implemented in general.
+  virtual int getUpdatePairs(ParOptScalar *_b0, ParOptVec ***_S,
+                             ParOptVec ***_Y) {
+    return 0;
+  }
+
+  // Set the approximation from a list of update pairs
+  virtual int setUpdatePairs(ParOptScalar _b0, int m, ParOptVec **_S,
+                             ParOptVec **_Y) {
+    return 1;
+  }
 };
 
 /**
@@ -113,6 +127,10 @@ class ParOptLBFGS : public ParOptCompactQuasiNewton {
   // Get the maximum size of the limited-memory BFGS
   int getMaxLimitedMemorySize();
 
+  // Get/set the update pairs
+  int getUpdatePairs(ParOptScalar *_b0, ParOptVec ***_S, ParOptVec ***_Y);
+  int setUpdatePairs(ParOptScalar _b0, int m, ParOptVec **_S, ParOptVec **_Y);
+
  protected:
   // Update the coefficients
   void computeMatUpdate();
@@ -189,7 +207,14 @@ class ParOptLSR1 : public ParOptCompactQuasiNewton {
   // Get the maximum size of the limited-memory BFGS
   int getMaxLimitedMemorySize();
 
+  // Get/set the update pairs
+  int getUpdatePairs(ParOptScalar *_b0, ParOptVec ***_S, ParOptVec ***_Y);
+  int setUpdatePairs(ParOptScalar _b0, int m, ParOptVec **_S, ParOptVec **_Y);
+
  protected:
+  // Update the coefficients
+  void computeMatUpdate();
+
   // The type of initial diagonal approximation to use
   ParOptQuasiNewtonDiagonalType diagonal_type;
 
@@ -0,0 +1,837 @@
+#include "ParOptScaledProblem.h"
+
+#include <string.h>
+
+#include "ParOptComplexStep.h"
+
+/*
+  Compute y = d^{power}*x component-wise for power = -1, 1 or 2.
+  The vectors x and y may be the same.
+*/
+static void ParOptScaleEntries(ParOptVec *d, ParOptVec *x, ParOptVec *y,
+                               int power) {
+  ParOptScalar *darr, *xarr, *yarr;
+  int size = d->getArray(&darr);
+  x->getArray(&xarr);
+  y->getArray(&yarr);
+
+  if (power == -1) {
+    for (int i = 0; i < size; i++) {
+      yarr[i] = xarr[i] / darr[i];
+    }
+  } else if (power == 2) {
+    for (int i = 0; i < size; i++) {
+      yarr[i] = darr[i] * darr[i] * xarr[i];
+    }
+  } else {
+    for (int i = 0; i < size; i++) {
+      yarr[i] = darr[i] * xarr[i];
+    }
+  }
+}
+
+/**
+  Create the scaled problem and compute the scale factors at the
+  starting point of the wrapped problem
+
+  @param _prob The problem to wrap
+  @param _options The scaling options
+*/
+ParOptScaledProblem::ParOptScaledProblem(ParOptProblem *_prob,
+                                         ParOptOptions *_options)
+    : ParOptProblem(_prob->getMPIComm()) {
+  prob = _prob;
+  prob->incref();
+
+  options = _options;
+  if (!options) {
+    options = new ParOptOptions(comm);
+    addDefaultOptions(options);
+  }
+  options->incref();
+
+  // Use the optimizer's bound value if the options are shared
+  max_bound_value = 1e20;
+  if (options->isOption("max_bound_value")) {
+    max_bound_value = options->getFloatOption("max_bound_value");
+  }
+
+  // Set the problem sizes
+  int _nvars, _ncon, _nwcon;
+  prob->getProblemSizes(&_nvars, &_ncon, &_nwcon);
+  setProblemSizes(_nvars, _ncon, _nwcon);
+
+  // Set the number of inequalities
+  int _ninequality, _nwinequality;
+  prob->getNumInequalities(&_ninequality, &_nwinequality);
+  setNumInequalities(_ninequality, _nwinequality);
+
+  // Allocate the scale factors
+  fscale = 1.0;
+  cscale = new double[ncon];
+  for (int i = 0; i < ncon; i++) {
+    cscale[i] = 1.0;
+  }
+  dscale = prob->createDesignVec();
+  dscale->incref();
+  dscale->set(1.0);
+
+  has_start = 0;
+  xstart = prob->createDesignVec();
+  xstart->incref();
+
+  // Allocate the vectors for the wrapped problem
+  xw = prob->createDesignVec();
+  xw->incref();
+  pw = prob->createDesignVec();
+  pw->incref();
+  ww = prob->createDesignVec();
+  ww->incref();
+  zwrap = new ParOptScalar[ncon];
+  zwwrap = prob->createConstraintVec();
+  zwwrap->incref();
+
+  num_jac_work = 0;
+  jac_work = NULL;
+  jac_zwork = NULL;
+
+  updateScaling();
+}
+
+ParOptScaledProblem::~ParOptScaledProblem() {
+  prob->decref();
+  options->decref();
+  delete[] cscale;
+  dscale->decref();
+  xstart->decref();
+  xw->decref();
+  pw->decref();
+  ww->decref();
+  delete[] zwrap;
+  zwwrap->decref();
+  for (int k = 0; k < num_jac_work; k++) {
+    jac_work[k]->decref();
+  }
+  delete[] jac_work;
+  delete[] jac_zwork;
+}
+
+/**
+  Add the default options for the scaling
+
+  @param options The options object
+*/
+void ParOptScaledProblem::addDefaultOptions(ParOptOptions *options) {
+  options->addFloatOption(
+      "scaling_max_gradient", 100.0, 1e-20, 1e20,
+      "Objective and constraints are scaled so that the infinity norm of "
+      "their gradients at the starting point is at most this value");
+
+  options->addFloatOption(
+      "scaling_min_gradient", 0.0, 0.0, 1e20,
+      "Objective and constraints are scaled up so that the infinity norm "
+      "of their gradients is at least this value. Zero disables this");
+
+  options->addFloatOption("scaling_min_value", 1e-8, 1e-20, 1.0,
+                          "Minimum value of any scale factor");
+
+  options->addFloatOption(
+      "scaling_variable_range", 100.0, 1.0, 1e20,
+      "Design variable scale factors are limited to [1/range, range]. "
+      "A value of 1.0 leaves the design variables unscaled");
+}
+
+/**
+  Get the options object associated with the scaling
+*/
+ParOptOptions *ParOptScaledProblem::getOptions() { return options; }
+
+/*
+  Compute the scale factor that brings the gradient norm into the
+  range [scaling_min_gradient, scaling_max_gradient]
+*/
+double ParOptScaledProblem::computeScale(double gnorm) {
+  double max_grad = options->getFloatOption("scaling_max_gradient");
+  double min_grad = options->getFloatOption("scaling_min_gradient");
+  double min_value = options->getFloatOption("scaling_min_value");
+
+  double scale = 1.0;
+  if (gnorm > max_grad) {
+    scale = max_grad / gnorm;
+  } else if (gnorm > 0.0 && gnorm < min_grad) {
+    scale = min_grad / gnorm;
+  }
+
+  if (scale < min_value) {
+    scale = min_value;
+  } else if (scale > 1.0 / min_value) {
+    scale = 1.0 / min_value;
+  }
+
+  return scale;
+}
+
+/**
+  Re-compute the scale factors from the gradients at a point
+
+  The point is used as the starting point returned by
+  getVarsAndBounds(). When no point is provided, the starting point
+  of the wrapped problem is used. If the evaluation fails, the scale
+  factors are reset to one.
+
+  @param x The point in the original design variables (or NULL)
+  @return The fail flag from the evaluation
+*/
+int ParOptScaledProblem::updateScaling(ParOptVec *x) {
+  if (x) {
+    xstart->copyValues(x);
+    has_start = 1;
+  } else {
+    ParOptVec *lb = prob->createDesignVec();
+    ParOptVec *ub = prob->createDesignVec();
+    lb->incref();
+    ub->incref();
+    prob->getVarsAndBounds(xstart, lb, ub);
+    lb->decref();
+    ub->decref();
+    has_start = 0;
+  }
+
+  // Evaluate the gradients at the point
+  ParOptVec *g = prob->createDesignVec();
+  g->incref();
+  ParOptVec **Ac = new ParOptVec *[ncon];
+  for (int i = 0; i < ncon; i++) {
+    Ac[i] = prob->createDesignVec();
+    Ac[i]->incref();
+  }
+
+  ParOptScalar fobj;
+  int fail = prob->evalObjCon(xstart, &fobj, zwrap);
+  if (!fail) {
+    fail = prob->evalObjConGradient(xstart, g, Ac);
+  }
+
+  fscale = 1.0;
+  for (int i = 0; i < ncon; i++) {
+    cscale[i] = 1.0;
+  }
+  dscale->set(1.0);
+
+  if (fail) {
+    fprintf(stderr,
+            "ParOptScaledProblem: Evaluation failed, scaling not applied\n");
+  } else {
+    fscale = computeScale(g->maxabs());
+    for (int i = 0; i < ncon; i++) {
+      cscale[i] = computeScale(Ac[i]->maxabs());
+    }
+
+    // Balance the largest entry in each column of the scaled gradients
+    double range = options->getFloatOption("scaling_variable_range");
+    if (range > 1.0) {
+      ParOptScalar *d, *garr;
+      int size = dscale->getArray(&d);
+      g->getArray(&garr);
+      for (int j = 0; j < size; j++) {
+        double col = fscale * fabs(ParOptRealPart(garr[j]));
+        for (int i = 0; i < ncon; i++) {
+          ParOptScalar *aarr;
+          Ac[i]->getArray(&aarr);
+          double val = cscale[i] * fabs(ParOptRealPart(aarr[j]));
+          if (val > col) {
+            col = val;
+          }
+        }
+
+        if (col > 0.0) {
+          double dj = 1.0 / col;
+          if (dj > range) {
+            dj = range;
+          } else if (dj < 1.0 / range) {
+            dj = 1.0 / range;
+          }
+          d[j] = dj;
+        }
+      }
+    }
+  }
+
+  g->decref();
+  for (int i = 0; i < ncon; i++) {
+    Ac[i]->decref();
+  }
+  delete[] Ac;
+
+  return fail;
+}
+
+/**
+  Get the scale factors
+
+  @param _fscale The objective scale factor
+  @param _cscale The dense constraint scale factors
+  @param _dscale The design variable scale factors
+*/
+void ParOptScaledProblem::getScaling(double *_fscale, const double **_cscale,
+                                     ParOptVec **_dscale) {
+  if (_fscale) {
+    *_fscale = fscale;
+  }
+  if (_cscale) {
+    *_cscale = cscale;
+  }
+  if (_dscale) {
+    *_dscale = dscale;
+  }
+}
+
+/**
+  Print a summary of the scale factors
+
+  @param fp The output file
+*/
+void ParOptScaledProblem::printScaling(FILE *fp) {
+  double cmin = 1.0, cmax = 1.0;
+  for (int i = 0; i < ncon; i++) {
+    if (i == 0 || cscale[i] < cmin) {
+      cmin = cscale[i];
+    }
+    if (i == 0 || cscale[i] > cmax) {
+      cmax = cscale[i];
+    }
+  }
+
+  ParOptScalar *d;
+  int size = dscale->getArray(&d);
+  double drange[2] = {-1e300, -1e300};
+  for (int j = 0; j < size; j++) {
+    double dj = ParOptRealPart(d[j]);
+    if (-dj > drange[0]) {
+      drange[0] = -dj;
+    }
+    if (dj > drange[1]) {
+      drange[1] = dj;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, drange, 2, MPI_DOUBLE, MPI_MAX, comm);
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  if (fp && rank == 0) {
+    fprintf(fp, "ParOptScaledProblem scale factors:\n");
+    fprintf(fp, "%-24s %10.3e\n", "objective", fscale);
+    fprintf(fp, "%-24s %10.3e\n", "min dense con", cmin);
+    fprintf(fp, "%-24s %10.3e\n", "max dense con", cmax);
+    fprintf(fp, "%-24s %10.3e\n", "min design var", -drange[0]);
+    fprintf(fp, "%-24s %10.3e\n", "max design var", drange[1]);
+    fflush(fp);
+  }
+}
+
+/**
+  Convert the original design variables to the scaled variables
+
+  @param x The original design vector
+  @param xs The scaled design vector
+*/
+void ParOptScaledProblem::scaleDesignVec(ParOptVec *x, ParOptVec *xs) {
+  ParOptScaleEntries(dscale, x, xs, -1);
+}
+
+/**
+  Convert the scaled design variables to the original variables
+
+  @param xs The scaled design vector
+  @param x The original design vector
+*/
+void ParOptScaledProblem::unscaleDesignVec(ParOptVec *xs, ParOptVec *x) {
+  ParOptScaleEntries(dscale, xs, x, 1);
+}
+
+/**
+  Recover the solution and the multipliers of the original problem
+  from the solution of the scaled problem
+
+  Any of the output arguments may be NULL.
+
+  @param xs The scaled design vector
+  @param zs The multipliers of the scaled dense constraints
+  @param zws The multipliers of the sparse constraints
+  @param zls The scaled lower bound multipliers
+  @param zus The scaled upper bound multipliers
+  @param x The original design vector
+  @param z The dense constraint multipliers
+  @param zw The sparse constraint multipliers
+  @param zl The lower bound multipliers
+  @param zu The upper bound multipliers
+*/
+void ParOptScaledProblem::unscaleSolution(ParOptVec *xs, ParOptScalar *zs,
+                                          ParOptVec *zws, ParOptVec *zls,
+                                          ParOptVec *zus, ParOptVec *x,
+                                          ParOptScalar *z, ParOptVec *zw,
+                                          ParOptVec *zl, ParOptVec *zu) {
+  if (x && xs) {
+    unscaleDesignVec(xs, x);
+  }
+  if (z && zs) {
+    for (int i = 0; i < ncon; i++) {
+      z[i] = zs[i] * cscale[i] / fscale;
+    }
+  }
+  if (zw && zws) {
+    zw->copyValues(zws);
+    zw->scale(1.0 / fscale);
+  }
+
+  // The bound multipliers satisfy zl = zl~/(sf*D)
+  if (zl && zls) {
+    ParOptScaleEntries(dscale, zls, zl, -1);
+    zl->scale(1.0 / fscale);
+  }
+  if (zu && zus) {
+    ParOptScaleEntries(dscale, zus, zu, -1);
+    zu->scale(1.0 / fscale);
+  }
+}
+
+/*
+  Set the multipliers for the wrapped problem. The Lagrangian of the
+  scaled problem is sf times the Lagrangian of the original problem
+  with z = sc*z~/sf and zw = zw~/sf.
+*/
+void ParOptScaledProblem::unscaleMultipliers(ParOptScalar *zs, ParOptVec *zws,
+                                             ParOptScalar *z, ParOptVec **zw) {
+  for (int i = 0; i < ncon; i++) {
+    z[i] = 0.0;
+    if (zs) {
+      z[i] = zs[i] * cscale[i] / fscale;
+    }
+  }
+
+  *zw = NULL;
+  if (zws) {
+    zwwrap->copyValues(zws);
+    zwwrap->scale(1.0 / fscale);
+    *zw = zwwrap;
+  }
+}
+
+/*
+  Create the design vector
+*/
+ParOptVec *ParOptScaledProblem::createDesignVec() {
+  return prob->createDesignVec();
+}
+
+/*
+  Create the sparse constraint vector
+*/
+ParOptVec *ParOptScaledProblem::createConstraintVec() {
+  return prob->createConstraintVec();
+}
+
+/*
+  Create the quasi-definite matrix from the wrapped problem's matrix
+*/
+ParOptQuasiDefMat *ParOptScaledProblem::createQuasiDefMat() {
+  return new ParOptScaledQuasiDefMat(this, prob->createQuasiDefMat());
+}
+
+/*
+  Get the communicator for the problem
+*/
+MPI_Comm ParOptScaledProblem::getMPIComm() { return prob->getMPIComm(); }
+
+/*
+  Functions to indicate the type of sparse constraints
+*/
+int ParOptScaledProblem::isSparseInequality() {
+  return prob->isSparseInequality();
+}
+
+int ParOptScaledProblem::useLowerBounds() { return prob->useLowerBounds(); }
+
+int ParOptScaledProblem::useUpperBounds() { return prob->useUpperBounds(); }
+
+/*
+  Functions to indicate the linearity of the objective and constraints.
+  These are not changed by the scaling.
+*/
+int ParOptScaledProblem::isObjQuadratic() { return prob->isObjQuadratic(); }
+
+int ParOptScaledProblem::isDenseConLinear(int index) {
+  return prob->isDenseConLinear(index);
+}
+
+int ParOptScaledProblem::isSparseConLinear() {
+  return prob->isSparseConLinear();
+}
+
+/*
+  Get the scaled variables and bounds. Bounds beyond max_bound_value
+  are not scaled so that they remain infinite.
+*/
+void ParOptScaledProblem::getVarsAndBounds(ParOptVec *x, ParOptVec *lb,
+                                           ParOptVec *ub) {
+  prob->getVarsAndBounds(x, lb, ub);
+  if (has_start) {
+    x->copyValues(xstart);
+  }
+
+  ParOptScalar *d, *xarr, *lbarr, *ubarr;
+  int size = dscale->getArray(&d);
+  x->getArray(&xarr);
+  lb->getArray(&lbarr);
+  ub->getArray(&ubarr);
+  for (int j = 0; j < size; j++) {
+    xarr[j] /= d[j];
+    if (ParOptRealPart(lbarr[j]) > -max_bound_value) {
+      lbarr[j] /= d[j];
+    }
+    if (ParOptRealPart(ubarr[j]) < max_bound_value) {
+      ubarr[j] /= d[j];
+    }
+  }
+}
+
+/*
+  Evaluate the scaled objective and constraints
+*/
+int ParOptScaledProblem::evalObjCon(ParOptVec *x, ParOptScalar *fobj,
+                                    ParOptScalar *cons) {
+  unscaleDesignVec(x, xw);
+  int fail = prob->evalObjCon(xw, fobj, cons);
+  *fobj *= fscale;
+  for (int i = 0; i < ncon; i++) {
+    cons[i] *= cscale[i];
+  }
+
+  return fail;
+}
+
+/*
+  Evaluate the scaled objective and constraint gradients. Entries of
+  Ac that are NULL are not evaluated.
+*/
+int ParOptScaledProblem::evalObjConGradient(ParOptVec *x, ParOptVec *g,
+                                            ParOptVec **Ac) {
+  unscaleDesignVec(x, xw);
+  int fail = prob->evalObjConGradient(xw, g, Ac);
+
+  ParOptScaleEntries(dscale, g, g, 1);
+  g->scale(fscale);
+  for (int i = 0; i < ncon; i++) {
+    if (Ac[i]) {
+      ParOptScaleEntries(dscale, Ac[i], Ac[i], 1);
+      Ac[i]->scale(cscale[i]);
+    }
+  }
+
+  return fail;
+}
+
+/*
+  Get the non-zero pattern of the dense constraint gradients. This is
+  not changed by the scaling.
+*/
+int ParOptScaledProblem::getConGradientPattern(const int **rowp,
+                                               const int **cols) {
+  return prob->getConGradientPattern(rowp, cols);
+}
+
+/*
+  Evaluate the scaled objective gradient and the scaled sparse
+  constraint gradients
+*/
+int ParOptScaledProblem::evalObjConSparseGradient(ParOptVec *x, ParOptVec *g,
+                                                  ParOptScalar *Avals) {
+  unscaleDesignVec(x, xw);
+  int fail = prob->evalObjConSparseGradient(xw, g, Avals);
+
+  ParOptScaleEntries(dscale, g, g, 1);
+  g->scale(fscale);
+
+  const int *rowp, *cols;
+  prob->getConGradientPattern(&rowp, &cols);
+  ParOptScalar *d;
+  dscale->getArray(&d);
+  for (int i = 0; i < ncon; i++) {
+    for (int jp = rowp[i]; jp < rowp[i + 1]; jp++) {
+      Avals[jp] *= cscale[i] * d[cols[jp]];
+    }
+  }
+
+  return fail;
+}
+
+/*
+  Indicate whether the dense constraint Jacobian is matrix-free
+*/
+int ParOptScaledProblem::useDenseJacobianProducts() {
+  return prob->useDenseJacobianProducts();
+}
+
+/*
+  Evaluate the scaled objective gradient for a matrix-free Jacobian
+*/
+int ParOptScaledProblem::evalObjGradient(ParOptVec *x, ParOptVec *g) {
+  unscaleDesignVec(x, xw);
+  int fail = prob->evalObjGradient(xw, g);
+
+  ParOptScaleEntries(dscale, g, g, 1);
+  g->scale(fscale);
+
+  return fail;
+}
+
+/*
+  Allocate the work vectors and array for nvecs Jacobian-vector products
+*/
+void ParOptScaledProblem::allocJacobianWork(int nvecs) {
+  if (nvecs > num_jac_work) {
+    ParOptVec **work = new ParOptVec *[nvecs];
+    for (int k = 0; k < nvecs; k++) {
+      if (k < num_jac_work) {
+        work[k] = jac_work[k];
+      } else {
+        work[k] = prob->createDesignVec();
+        work[k]->incref();
+      }
+    }
+    delete[] jac_work;
+    delete[] jac_zwork;
+    jac_work = work;
+    jac_zwork = new ParOptScalar[nvecs * ncon + 1];
+    num_jac_work = nvecs;
+  }
+}
+
+/*
+  Compute the scaled Jacobian-vector products,
+  out[k*ncon:(k+1)*ncon] += alpha*diag(sc)*A(x)*D*px[k]
+*/
+void ParOptScaledProblem::addDenseJacobian(ParOptScalar alpha, ParOptVec *x,
+                                           int nvecs, ParOptVec **px,
+                                           ParOptScalar *out) {
+  allocJacobianWork(nvecs);
+  unscaleDesignVec(x, xw);
+  for (int k = 0; k < nvecs; k++) {
+    ParOptScaleEntries(dscale, px[k], jac_work[k], 1);
+  }
+
+  memset(jac_zwork, 0, nvecs * ncon * sizeof(ParOptScalar));
+  prob->addDenseJacobian(alpha, xw, nvecs, jac_work, jac_zwork);
+  for (int k = 0; k < nvecs; k++) {
+    for (int i = 0; i < ncon; i++) {
+      out[k * ncon + i] += cscale[i] * jac_zwork[k * ncon + i];
+    }
+  }
+}
+
+/*
+  Compute the scaled transpose Jacobian-vector products,
+  out[k] += alpha*D*A(x)^{T}*diag(sc)*pz[k*ncon:(k+1)*ncon]
+*/
+void ParOptScaledProblem::addDenseJacobianTranspose(ParOptScalar alpha,
+                                                    ParOptVec *x, int nvecs,
+                                                    const ParOptScalar *pz,
+                                                    ParOptVec **out) {
+  allocJacobianWork(nvecs);
+  unscaleDesignVec(x, xw);
+  for (int k = 0; k < nvecs; k++) {
+    for (int i = 0; i < ncon; i++) {
+      jac_zwork[k * ncon + i] = cscale[i] * pz[k * ncon + i];
+    }
+    jac_work[k]->zeroEntries();
+  }
+
+  prob->addDenseJacobianTranspose(alpha, xw, nvecs, jac_zwork, jac_work);
+  for (int k = 0; k < nvecs; k++) {
+    ParOptScaleEntries(dscale, jac_work[k], jac_work[k], 1);
+    out[k]->axpy(1.0, jac_work[k]);
+  }
+}
+
+/*
+  Evaluate the product of the scaled Hessian with a vector,
+  sf*D*H*D*px
+*/
+int ParOptScaledProblem::evalHvecProduct(ParOptVec *x, ParOptScalar *z,
+                                         ParOptVec *zw, ParOptVec *px,
+                                         ParOptVec *hvec) {
+  unscaleDesignVec(x, xw);
+  unscaleDesignVec(px, pw);
+
+  ParOptVec *zwu;
+  unscaleMultipliers(z, zw, zwrap, &zwu);
+  int fail = prob->evalHvecProduct(xw, zwrap, zwu, pw, hvec);
+
+  ParOptScaleEntries(dscale, hvec, hvec, 1);
+  hvec->scale(fscale);
+
+  return fail;
+}
+
+/*
+  Evaluate the diagonal of the scaled Hessian, sf*D^2*diag(H)
+*/
+int ParOptScaledProblem::evalHessianDiag(ParOptVec *x, ParOptScalar *z,
+                                         ParOptVec *zw, ParOptVec *hdiag) {
+  unscaleDesignVec(x, xw);
+
+  ParOptVec *zwu;
+  unscaleMultipliers(z, zw, zwrap, &zwu);
+  int fail = prob->evalHessianDiag(xw, zwrap, zwu, hdiag);
+
+  ParOptScaleEntries(dscale, hdiag, hdiag, 2);
+  hdiag->scale(fscale);
+
+  return fail;
+}
+
+/*
+  Compute a correction to the quasi-Newton update. The step is
+  s = D*s~ and the difference in the Lagrangian gradient is
+  y = y~/(sf*D) in the original variables.
+*/
+void ParOptScaledProblem::computeQuasiNewtonUpdateCorrection(
+    ParOptVec *x, ParOptScalar *z, ParOptVec *zw, ParOptVec *s, ParOptVec *y) {
+  unscaleDesignVec(x, xw);
+  unscaleDesignVec(s, pw);
+  ParOptScaleEntries(dscale, y, ww, -1);
+  ww->scale(1.0 / fscale);
+
+  ParOptVec *zwu;
+  unscaleMultipliers(z, zw, zwrap, &zwu);
+  prob->computeQuasiNewtonUpdateCorrection(xw, zwrap, zwu, pw, ww);
+
+  ParOptScaleEntries(dscale, ww, y, 1);
+  y->scale(fscale);
+}
+
+/*
+  Evaluate the sparse constraints
+*/
+void ParOptScaledProblem::evalSparseCon(ParOptVec *x, ParOptVec *out) {
+  unscaleDesignVec(x, xw);
+  prob->evalSparseCon(xw, out);
+}
+
+/*
+  Compute the Jacobian-vector product out = J(x)*D*px
+*/
+void ParOptScaledProblem::addSparseJacobian(ParOptScalar alpha, ParOptVec *x,
+                                            ParOptVec *px, ParOptVec *out) {
+  unscaleDesignVec(x, xw);
+  unscaleDesignVec(px, pw);
+  prob->addSparseJacobian(alpha, xw, pw, out);
+}
+
+/*
+  Compute the transpose Jacobian-vector product out = D*J(x)^{T}*pzw
+*/
+void ParOptScaledProblem::addSparseJacobianTranspose(ParOptScalar alpha,
+                                                     ParOptVec *x,
+                                                     ParOptVec *pzw,
+                                                     ParOptVec *out) {
+  unscaleDesignVec(x, xw);
+  pw->zeroEntries();
+  prob->addSparseJacobianTranspose(alpha, xw, pzw, pw);
+  ParOptScaleEntries(dscale, pw, pw, 1);
+  out->axpy(1.0, pw);
+}
+
+/*
+  Add the inner product of the constraints to the matrix such that
+  A += J(x)*D*cvec*D*J(x)^{T}
+*/
+void ParOptScaledProblem::addSparseInnerProduct(ParOptScalar alpha,
+                                                ParOptVec *x, ParOptVec *cvec,
+                                                ParOptScalar *A) {
+  unscaleDesignVec(x, xw);
+  ParOptScaleEntries(dscale, cvec, pw, 2);
+  prob->addSparseInnerProduct(alpha, xw, pw, A);
+}
+
+/*
+  Write the output from the wrapped problem at the original design point
+*/
+void ParOptScaledProblem::writeOutput(int iter, ParOptVec *x) {
+  unscaleDesignVec(x, xw);
+  prob->writeOutput(iter, xw);
+}
+
+/**
+  Create the quasi-definite matrix for the scaled problem
+
+  @param _scaled The scaled problem
+  @param _mat The matrix created by the wrapped problem
+*/
+ParOptScaledQuasiDefMat::ParOptScaledQuasiDefMat(
+    ParOptScaledProblem *_scaled, ParOptQuasiDefMat *_mat) {
+  scaled = _scaled;
+  scaled->incref();
+  mat = _mat;
+  mat->incref();
+
+  ParOptProblem *prob = scaled->getProblem();
+  xu = prob->createDesignVec();
+  xu->incref();
+  Dinvu = prob->createDesignVec();
+  Dinvu->incref();
+  bxu = prob->createDesignVec();
+  bxu->incref();
+}
+
+ParOptScaledQuasiDefMat::~ParOptScaledQuasiDefMat() {
+  scaled->decref();
+  mat->decref();
+  xu->decref();
+  Dinvu->decref();
+  bxu->decref();
+}
+
+/*
+  Factor the matrix with the inverse diagonal D*Dinv*D
+*/
+int ParOptScaledQuasiDefMat::factor(ParOptVec *x, ParOptVec *Dinv,
+                                    ParOptVec *C) {
+  ParOptVec *dscale;
+  scaled->getScaling(NULL, NULL, &dscale);
+  ParOptScaleEntries(dscale, x, xu, 1);
+  ParOptScaleEntries(dscale, Dinv, Dinvu, 2);
+  return mat->factor(xu, Dinvu, C);
+}
+
+/*
+  Solve the quasi-definite system with a zero right-hand-side for the
+  sparse constraints
+*/
+void ParOptScaledQuasiDefMat::apply(ParOptVec *bx, ParOptVec *yx,
+                                    ParOptVec *yw) {
+  ParOptVec *dscale;
+  scaled->getScaling(NULL, NULL, &dscale);
+  ParOptScaleEntries(dscale, bx, bxu, -1);
+  mat->apply(bxu, yx, yw);
+  ParOptScaleEntries(dscale, yx, yx, -1);
+}
+
+/*
+  Solve the quasi-definite system
+*/
+void ParOptScaledQuasiDefMat::apply(ParOptVec *bx, ParOptVec *bw,
+                                    ParOptVec *yx, ParOptVec *yw) {
+  ParOptVec *dscale;
+  scaled->getScaling(NULL, NULL, &dscale);
+  ParOptScaleEntries(dscale, bx, bxu, -1);
+  mat->apply(bxu, bw, yx, yw);
+  ParOptScaleEntries(dscale, yx, yx, -1);
+}
+
+/*
+  Get a description of the factorization from the wrapped matrix
+*/
+const char *ParOptScaledQuasiDefMat::getFactorInfo() {
+  return mat->getFactorInfo();
+}
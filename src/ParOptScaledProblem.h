@@ -0,0 +1,215 @@
+#ifndef PAR_OPT_SCALED_PROBLEM_H
+#define PAR_OPT_SCALED_PROBLEM_H
+
+#include <stdio.h>
+
+#include "ParOptOptions.h"
+#include "ParOptProblem.h"
+
+/*
+  A problem wrapper that scales the objective, the dense constraints
+  and the design variables.
+
+  Poorly scaled problems increase the number of interior-point
+  iterations and often require a tight function_precision. This
+  wrapper computes scale factors from the gradients at the starting
+  point and passes the scaled problem to the optimizer:
+
+  f~(x~) = sf*f(D*x~)
+  c~_i(x~) = sc_i*c_i(D*x~)
+
+  where x = D*x~ and D is a diagonal matrix of variable scale factors.
+  The objective and constraint factors are computed so that the
+  infinity norms of the gradients are at most scaling_max_gradient (and
+  at least scaling_min_gradient, if it is set). The variable scale
+  factors are the inverse of the largest entry in each column of the
+  scaled gradients, limited to the range set by scaling_variable_range.
+  Setting the range to 1.0 leaves the design variables unscaled.
+
+  The sparse format of the dense constraint gradients and the
+  matrix-free dense constraint Jacobian are forwarded to the wrapped
+  problem with the scaling applied, A~ = diag(sc)*A*D.
+
+  The sparse constraints are not scaled, but their Jacobian is
+  transformed by the variable scaling, J~ = J*D. The quasi-definite
+  matrix of the wrapped problem is used with the transformed diagonal
+  so that the sparse Jacobian does not need to be modified.
+
+  The scale factors can be re-computed at a new point by calling
+  updateScaling(). This changes the problem seen by the optimizer, so
+  it should only be done between calls to the optimizer, followed by a
+  call to resetDesignAndBounds(). After the optimization, the solution
+  and the multipliers of the original problem are recovered with
+  unscaleSolution().
+*/
+class ParOptScaledProblem : public ParOptProblem {
+ public:
+  ParOptScaledProblem(ParOptProblem *_prob, ParOptOptions *_options = NULL);
+  ~ParOptScaledProblem();
+
+  // Get the default option values
+  static void addDefaultOptions(ParOptOptions *options);
+  ParOptOptions *getOptions();
+
+  // Get the wrapped problem
+  ParOptProblem *getProblem() { return prob; }
+
+  // Re-compute the scale factors at the given point
+  int updateScaling(ParOptVec *x = NULL);
+
+  // Get the scale factors
+  void getScaling(double *_fscale, const double **_cscale,
+                  ParOptVec **_dscale);
+
+  // Print a summary of the scale factors
+  void printScaling(FILE *fp);
+
+  // Convert between the original and the scaled design variables
+  void scaleDesignVec(ParOptVec *x, ParOptVec *xs);
+  void unscaleDesignVec(ParOptVec *xs, ParOptVec *x);
+
+  // Recover the solution and multipliers of the original problem
+  void unscaleSolution(ParOptVec *xs, ParOptScalar *zs, ParOptVec *zws,
+                       ParOptVec *zls, ParOptVec *zus, ParOptVec *x,
+                       ParOptScalar *z, ParOptVec *zw, ParOptVec *zl,
+                       ParOptVec *zu);
+
+  // Create the design vectors
+  ParOptVec *createDesignVec();
+  ParOptVec *createConstraintVec();
+  ParOptQuasiDefMat *createQuasiDefMat();
+
+  // Get the communicator for the problem
+  MPI_Comm getMPIComm();
+
+  // Function to indicate the type of sparse constraints
+  int isSparseInequality();
+  int useLowerBounds();
+  int useUpperBounds();
+
+  // Functions to indicate the linearity of the objective and constraints
+  int isObjQuadratic();
+  int isDenseConLinear(int index);
+  int isSparseConLinear();
+
+  // Get the variables and bounds from the problem
+  void getVarsAndBounds(ParOptVec *x, ParOptVec *lb, ParOptVec *ub);
+
+  // Evaluate the objective and constraints
+  int evalObjCon(ParOptVec *x, ParOptScalar *fobj, ParOptScalar *cons);
+
+  // Evaluate the objective and constraint gradients
+  int evalObjConGradient(ParOptVec *x, ParOptVec *g, ParOptVec **Ac);
+
+  // Sparse format of the dense constraint gradients
+  int getConGradientPattern(const int **rowp, const int **cols);
+  int evalObjConSparseGradient(ParOptVec *x, ParOptVec *g,
+                               ParOptScalar *Avals);
+
+  // Matrix-free dense constraint Jacobian
+  int useDenseJacobianProducts();
+  int evalObjGradient(ParOptVec *x, ParOptVec *g);
+  void addDenseJacobian(ParOptScalar alpha, ParOptVec *x, int nvecs,
+                        ParOptVec **px, ParOptScalar *out);
+  void addDenseJacobianTranspose(ParOptScalar alpha, ParOptVec *x, int nvecs,
+                                 const ParOptScalar *pz, ParOptVec **out);
+
+  // Evaluate the product of the Hessian with a given vector
+  int evalHvecProduct(ParOptVec *x, ParOptScalar *z, ParOptVec *zw,
+                      ParOptVec *px, ParOptVec *hvec);
+
+  // Evaluate the diagonal Hessian
+  int evalHessianDiag(ParOptVec *x, ParOptScalar *z, ParOptVec *zw,
+                      ParOptVec *hdiag);
+
+  // Compute a correction to the quasi-Newton update
+  void computeQuasiNewtonUpdateCorrection(ParOptVec *x, ParOptScalar *z,
+                                          ParOptVec *zw, ParOptVec *s,
+                                          ParOptVec *y);
+
+  // Evaluate the constraints
+  void evalSparseCon(ParOptVec *x, ParOptVec *out);
+
+  // Compute the Jacobian-vector product out = J(x)*px
+  void addSparseJacobian(ParOptScalar alpha, ParOptVec *x, ParOptVec *px,
+                         ParOptVec *out);
+
+  // Compute the transpose Jacobian-vector product out = J(x)^{T}*pzw
+  void addSparseJacobianTranspose(ParOptScalar alpha, ParOptVec *x,
+                                  ParOptVec *pzw, ParOptVec *out);
+
+  // Add the inner product of the constraints to the matrix such
+  // that A += J(x)*cvec*J(x)^{T} where cvec is a diagonal matrix
+  void addSparseInnerProduct(ParOptScalar alpha, ParOptVec *x, ParOptVec *cvec,
+                             ParOptScalar *A);
+
+  // Write the output from the wrapped problem
+  void writeOutput(int iter, ParOptVec *x);
+
+ private:
+  // Compute the scale factor that brings a gradient norm into range
+  double computeScale(double gnorm);
+
+  // Set the multipliers passed to the wrapped problem
+  void unscaleMultipliers(ParOptScalar *zs, ParOptVec *zws, ParOptScalar *z,
+                          ParOptVec **zw);
+
+  // Allocate the work data for the dense Jacobian-vector products
+  void allocJacobianWork(int nvecs);
+
+  // The wrapped problem
+  ParOptProblem *prob;
+
+  // The options
+  ParOptOptions *options;
+
+  // The bound value beyond which the bounds are not scaled
+  double max_bound_value;
+
+  // The objective, constraint and design variable scale factors
+  double fscale;
+  double *cscale;
+  ParOptVec *dscale;
+
+  // The starting point set by updateScaling (if any)
+  int has_start;
+  ParOptVec *xstart;
+
+  // Vectors and multipliers for the wrapped problem
+  ParOptVec *xw, *pw, *ww;
+  ParOptScalar *zwrap;
+  ParOptVec *zwwrap;
+
+  // Work data for the dense Jacobian-vector products (allocated when
+  // needed)
+  int num_jac_work;
+  ParOptVec **jac_work;
+  ParOptScalar *jac_zwork;
+};
+
+/*
+  The quasi-definite matrix for the scaled problem.
+
+  This wraps the matrix created by the original problem. With x = D*x~
+  and J~ = J*D, the scaled system is equivalent to a system in the
+  original variables with the inverse diagonal D*Dinv~*D, a scaled
+  right-hand-side D^{-1}*bx~ and the solution yx~ = D^{-1}*yx.
+*/
+class ParOptScaledQuasiDefMat : public ParOptQuasiDefMat {
+ public:
+  ParOptScaledQuasiDefMat(ParOptScaledProblem *_scaled,
+                          ParOptQuasiDefMat *_mat);
+  ~ParOptScaledQuasiDefMat();
+
+  int factor(ParOptVec *x, ParOptVec *Dinv, ParOptVec *C);
+  void apply(ParOptVec *bx, ParOptVec *yx, ParOptVec *yw);
+  void apply(ParOptVec *bx, ParOptVec *bw, ParOptVec *yx, ParOptVec *yw);
+  const char *getFactorInfo();
+
+ private:
+  ParOptScaledProblem *scaled;
+  ParOptQuasiDefMat *mat;
+  ParOptVec *xu, *Dinvu, *bxu;
+};
+
+#endif  // PAR_OPT_SCALED_PROBLEM_H
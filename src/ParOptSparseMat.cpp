@@ -317,11 +317,14 @@ int ParOptQuasiDefSparseMat::factor(ParOptVec *x, ParOptVec *Dinv0,
   const ParOptScalar *data;
   prob->getSparseJacobianData(&rowp, &cols, &data);
 
-  // Compute the transpose of the constraint Jacobian
+  // Compute the transpose of the constraint Jacobian. When the sparse
+  // constraints are linear, the transpose is only computed once.
   if (!Atvals) {
     Atvals = new ParOptScalar[rowp[nwcon]];
+    ParOptSparseTranspose(nwcon, nvars, rowp, cols, data, colp, rows, Atvals);
+  } else if (!prob->isSparseConLinear()) {
+    ParOptSparseTranspose(nwcon, nvars, rowp, cols, data, colp, rows, Atvals);
   }
-  ParOptSparseTranspose(nwcon, nvars, rowp, cols, data, colp, rows, Atvals);
 
   if (!chol) {
     // Compute the non-zero pattern of the full matrix
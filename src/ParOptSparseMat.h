@@ -61,6 +61,49 @@ class ParOptQuasiDefMat : public ParOptBase {
   virtual const char *getFactorInfo() { return NULL; }
 };
 
+/*
+  Abstract base class for a user-supplied preconditioner for the
+  inexact Newton (GMRES) solution of the KKT system.
+
+  The preconditioner represents an approximation B of the Hessian of
+  the Lagrangian. When it is selected with gmres_precon_type = user, it
+  replaces the quasi-definite matrix from the problem during the
+  inexact Newton steps, so that factor() and apply() must solve
+
+  [ B + D   Aw^{T} ][  yx ] = [ bx ]
+  [ Aw       - C   ][ -yw ] = [ bw ]
+
+  where D = Dinv^{-1} contains only the barrier terms from the bounds
+  and the qn_sigma regularization. The product with B is used within
+  GMRES to correct the preconditioned operator with the exact
+  Hessian-vector products.
+*/
+class ParOptHessianPrecon : public ParOptQuasiDefMat {
+ public:
+  /**
+    Update the Hessian approximation at the current point.
+
+    This is called before the first inexact Newton step and then every
+    gmres_precon_refresh inexact Newton steps. The matrix is factored
+    at every step since the barrier terms in D change.
+
+    @param x is the design variable vector
+    @param z is the array of multipliers for the dense constraints
+    @param zw is the vector of multipliers for the sparse constraints
+    @return zero on success, non-zero flag on error
+  */
+  virtual int update(ParOptVec *x, ParOptScalar *z, ParOptVec *zw) = 0;
+
+  /**
+    Compute the product out = out + alpha*B*px
+
+    @param alpha is the scalar multiple
+    @param px is the input vector
+    @param out is the output vector
+  */
+  virtual void multAdd(ParOptScalar alpha, ParOptVec *px, ParOptVec *out) = 0;
+};
+
 /*
   Interface for the quasi-definite matrix
 
@@ -24,6 +24,9 @@ inline ParOptScalar max2(ParOptScalar a, ParOptScalar b) {
   }
 }
 
+// The number of work vectors for the truncated CG subproblem solver
+static const int PAROPT_TR_CG_NUM_WORK = 9;
+
 ParOptQuadraticSubproblem::ParOptQuadraticSubproblem(
     ParOptProblem *_prob, ParOptCompactQuasiNewton *_qn)
     : ParOptTrustRegionSubproblem(_prob->getMPIComm()) {
@@ -149,6 +152,25 @@ void ParOptQuadraticSubproblem::initModelAndBounds(double tr_size) {
   prob->evalObjConGradient(xk, gk, Ak);
 }
 
+/*
+  Initialize the model at the given point
+*/
+int ParOptQuadraticSubproblem::initModelAndBoundsAtPoint(double tr_size,
+                                                         ParOptVec *x) {
+  // Get the lower/upper bounds and replace the starting point
+  prob->getVarsAndBounds(xk, lb, ub);
+  xk->copyValues(x);
+
+  // Set the lower/upper bounds for the trust region
+  setTrustRegionBounds(tr_size);
+
+  // Evaluate objective constraints and gradients
+  prob->evalObjCon(xk, &fk, ck);
+  prob->evalObjConGradient(xk, gk, Ak);
+
+  return 0;
+}
+
 /*
   Set the trust region bounds
 */
@@ -324,9 +346,12 @@ int ParOptQuadraticSubproblem::evalObjCon(ParOptVec *step, ParOptScalar *fobj,
 */
 int ParOptQuadraticSubproblem::evalObjConGradient(ParOptVec *step, ParOptVec *g,
                                                   ParOptVec **Ac) {
-  // Copy the values of constraint gradient
+  // Copy the values of constraint gradient, skipping the gradients
+  // that the optimizer has already stored
   for (int i = 0; i < m; i++) {
-    Ac[i]->copyValues(Ak[i]);
+    if (Ac[i]) {
+      Ac[i]->copyValues(Ak[i]);
+    }
   }
 
   // Evaluate the gradient of the quadratic objective
@@ -686,6 +711,34 @@ ParOptTrustRegion::ParOptTrustRegion(ParOptTrustRegionSubproblem *_subproblem,
 
   // Set the trust region radius
   tr_size = options->getFloatOption("tr_init_size");
+  restart_x = NULL;
+
+  // The warm start point and multipliers are allocated when they are
+  // first used
+  has_warm_start = 0;
+  warm_start_x = NULL;
+  warm_start_z = NULL;
+  warm_start_zw = NULL;
+  warm_start_zl = NULL;
+  warm_start_zu = NULL;
+  subproblem_tol = 0.0;
+
+  // The truncated CG work vectors are allocated when they are first used
+  cg_work = NULL;
+
+  // The processor groups are created when they are first used
+  rg_factory = NULL;
+  rg_num_groups = 0;
+  rg_groups = NULL;
+  rg_radius = NULL;
+  rg_steps = NULL;
+  rg_z = NULL;
+  rg_zw = NULL;
+  rg_zl = NULL;
+  rg_zu = NULL;
+  rg_fobj = NULL;
+  rg_con = NULL;
+  rg_fail = NULL;
 
   // Set the iteration count to zero
   iter_count = 0;
@@ -713,6 +766,13 @@ ParOptTrustRegion::ParOptTrustRegion(ParOptTrustRegionSubproblem *_subproblem,
   if (filename) {
     setOutputFile(filename);
   }
+
+  // Set the binary history file, if any
+  history = NULL;
+  const char *history_file = options->getStringOption("tr_history_file");
+  if (history_file) {
+    setHistoryFile(history_file);
+  }
 }
 
 /**
@@ -725,6 +785,26 @@ ParOptTrustRegion::~ParOptTrustRegion() {
 
   delete[] penalty_gamma;
   t->decref();
+  if (restart_x) {
+    restart_x->decref();
+  }
+  if (warm_start_x) {
+    warm_start_x->decref();
+    warm_start_zw->decref();
+    warm_start_zl->decref();
+    warm_start_zu->decref();
+  }
+  delete[] warm_start_z;
+  if (cg_work) {
+    for (int k = 0; k < PAROPT_TR_CG_NUM_WORK; k++) {
+      cg_work[k]->decref();
+    }
+    delete[] cg_work;
+  }
+  freeRadiusGroups();
+  if (rg_factory) {
+    rg_factory->decref();
+  }
 
   if (tr_use_soc) {
     best_step->decref();
@@ -734,12 +814,18 @@ ParOptTrustRegion::~ParOptTrustRegion() {
   if (outfp && outfp != stdout) {
     fclose(outfp);
   }
+  if (history) {
+    history->decref();
+  }
 }
 
 void ParOptTrustRegion::addDefaultOptions(ParOptOptions *options) {
   options->addStringOption("tr_output_file", "paropt.tr",
                            "Trust region output file");
 
+  options->addStringOption("tr_history_file", NULL,
+                           "Trust region binary iteration history file");
+
   options->addIntOption(
       "output_level", 0, 0, 1000000,
       "Output level indicating how verbose the output should be");
@@ -788,6 +874,45 @@ void ParOptTrustRegion::addDefaultOptions(ParOptOptions *options) {
   options->addBoolOption("filter_has_feas_restore_phase", 1,
                          "Use feasibility restoration for filter method");
 
+  options->addBoolOption(
+      "tr_warm_start", 0,
+      "Warm start each interior-point subproblem solve from the solution "
+      "of the previous subproblem");
+
+  options->addBoolOption(
+      "tr_adaptive_subproblem_tol", 0,
+      "Solve the subproblems inexactly with a tolerance set from the KKT "
+      "error of the trust-region iterates");
+
+  options->addFloatOption(
+      "tr_adaptive_tol_factor", 0.1, 0.0, 1.0,
+      "Ratio of the subproblem tolerance to the trust-region KKT error");
+
+  options->addFloatOption("tr_adaptive_tol_max", 0.1, 0.0, 1e20,
+                          "Maximum subproblem tolerance");
+
+  options->addIntOption(
+      "tr_adaptive_max_subproblem_iters", 50, 1, 1000000,
+      "Maximum number of subproblem iterations while the subproblem "
+      "tolerance is above the interior-point tolerance");
+
+  const char *subproblem_solver_options[3] = {"automatic", "interior_point",
+                                              "truncated_cg"};
+  options->addEnumOption(
+      "tr_subproblem_solver", "automatic", 3, subproblem_solver_options,
+      "The subproblem solver. The automatic setting uses truncated CG when "
+      "the problem has no dense or sparse constraints");
+
+  options->addIntOption(
+      "tr_cg_max_iterations", 100, 1, 1000000,
+      "Maximum number of Hessian-vector products in the truncated CG "
+      "subproblem solver");
+
+  options->addFloatOption(
+      "tr_cg_rtol", 1e-6, 0.0, 1.0,
+      "Relative tolerance on the projected gradient of the model for the "
+      "truncated CG subproblem solver");
+
   options->addBoolOption(
       "tr_use_soc", 0,
       "Use second order correction when trial step is rejeccted");
@@ -799,6 +924,12 @@ void ParOptTrustRegion::addDefaultOptions(ParOptOptions *options) {
   options->addIntOption("tr_max_soc_iterations", 20, 0, 1000000,
                         "Maximum number of trust region iterations");
 
+  options->addIntOption(
+      "tr_num_radius_groups", 1, 1, 1000,
+      "Number of processor groups used to evaluate trial points for "
+      "decreasing trust region radii concurrently after a rejected step "
+      "(requires a problem factory)");
+
   options->addIntOption("tr_max_iterations", 200, 0, 1000000,
                         "Maximum number of trust region iterations");
 
@@ -867,6 +998,48 @@ void ParOptTrustRegion::setOutputFile(const char *filename) {
   }
 }
 
+/**
+  Set the binary iteration history file (only written on the root proc)
+
+  The history contains one row per iteration with the values from the
+  text output file. The model reductions are only set by the l1 penalty
+  method. Passing NULL closes the file.
+
+  @param filename the history file name
+*/
+void ParOptTrustRegion::setHistoryFile(const char *filename) {
+  if (!history) {
+    history = new ParOptHistory(subproblem->getMPIComm(), "tr");
+    history->incref();
+    history->addColumn("iter", PAROPT_HISTORY_INT);
+    history->addColumn("fobj", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("infes", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("l1", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("linfty", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("|x - xk|", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("tr", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("rho", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("mod red.", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("avg z", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("max z", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("avg pen.", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("max pen.", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("time(s)", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("sub-iter", PAROPT_HISTORY_INT);
+    history->addColumn("accepted", PAROPT_HISTORY_INT);
+    history->addColumn("ared(f)", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("pred(f)", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("ared(c)", PAROPT_HISTORY_DOUBLE);
+    history->addColumn("pred(c)", PAROPT_HISTORY_DOUBLE);
+  }
+
+  if (filename) {
+    history->open(filename);
+  } else {
+    history->close();
+  }
+}
+
 /*
   Add to the info string
 */
@@ -881,6 +1054,754 @@ void ParOptTrustRegion::addToInfo(size_t info_size, char *info,
   va_end(args);
 }
 
+/*
+  Set the starting point for the next trust-region subproblem.
+
+  When tr_warm_start is set, the solution of the previous subproblem is
+  shifted by the change in the linearization point, so that it is a
+  step from the new point, and the interior-point method is warm
+  started from it with the saved multipliers. The multipliers are
+  saved with the point since the second-order correction and
+  restoration solves overwrite those in the interior-point method.
+  Otherwise, the subproblem is solved from the default starting point.
+*/
+void ParOptTrustRegion::initSubproblemStart(ParOptInteriorPoint *optimizer) {
+  if (has_warm_start && options->getBoolOption("tr_warm_start")) {
+    ParOptVec *xk;
+    subproblem->getLinearModel(&xk);
+    warm_start_x->axpy(-1.0, xk);
+    optimizer->warmStartDesignAndBounds(warm_start_x, warm_start_z,
+                                        warm_start_zw, warm_start_zl,
+                                        warm_start_zu);
+    has_warm_start = 0;
+  } else {
+    optimizer->resetDesignAndBounds();
+  }
+}
+
+/*
+  Save the solution of the subproblem as a point in the design space,
+  along with the multipliers, so that it can be used to warm start the
+  next subproblem. Multipliers that are not provided keep the values
+  from the last call.
+*/
+void ParOptTrustRegion::saveSubproblemSolution(ParOptVec *step,
+                                               ParOptScalar *z, ParOptVec *zw,
+                                               ParOptVec *zl, ParOptVec *zu) {
+  if (options->getBoolOption("tr_warm_start")) {
+    if (!warm_start_x) {
+      warm_start_x = subproblem->createDesignVec();
+      warm_start_x->incref();
+      warm_start_z = new ParOptScalar[m];
+      memset(warm_start_z, 0, m * sizeof(ParOptScalar));
+      warm_start_zw = subproblem->createConstraintVec();
+      warm_start_zw->incref();
+      warm_start_zl = subproblem->createDesignVec();
+      warm_start_zl->incref();
+      warm_start_zu = subproblem->createDesignVec();
+      warm_start_zu->incref();
+    }
+    ParOptVec *xk;
+    subproblem->getLinearModel(&xk);
+    warm_start_x->copyValues(xk);
+    warm_start_x->axpy(1.0, step);
+    if (z) {
+      memcpy(warm_start_z, z, m * sizeof(ParOptScalar));
+    }
+    if (zw) {
+      warm_start_zw->copyValues(zw);
+    }
+    if (zl) {
+      warm_start_zl->copyValues(zl);
+    }
+    if (zu) {
+      warm_start_zu->copyValues(zu);
+    }
+    has_warm_start = 1;
+  }
+}
+
+/*
+  Solve the interior-point subproblem.
+
+  When tr_adaptive_subproblem_tol is set, the subproblem is solved to
+  the adaptive tolerance, but never more tightly than abs_res_tol. While
+  the adaptive tolerance is looser than abs_res_tol, the number of
+  subproblem iterations is also limited. The interior-point options are
+  restored after the solve.
+
+  @param optimizer The interior-point optimizer
+  @param abs_res_tol The interior-point residual tolerance
+  @param max_major_iters The interior-point iteration limit
+*/
+void ParOptTrustRegion::optimizeSubproblem(ParOptInteriorPoint *optimizer,
+                                           double abs_res_tol,
+                                           int max_major_iters) {
+  if (options->getBoolOption("tr_adaptive_subproblem_tol") &&
+      subproblem_tol > abs_res_tol) {
+    const int tr_adaptive_max_subproblem_iters =
+        options->getIntOption("tr_adaptive_max_subproblem_iters");
+
+    ParOptOptions *ip_options = optimizer->getOptions();
+    ip_options->setOption("abs_res_tol", subproblem_tol);
+    if (tr_adaptive_max_subproblem_iters < max_major_iters) {
+      ip_options->setOption("max_major_iters",
+                            tr_adaptive_max_subproblem_iters);
+    }
+
+    optimizer->optimize();
+
+    ip_options->setOption("abs_res_tol", abs_res_tol);
+    ip_options->setOption("max_major_iters", max_major_iters);
+  } else {
+    optimizer->optimize();
+  }
+}
+
+/*
+  Update the adaptive subproblem tolerance after a trust-region step.
+
+  The tolerance is set to a fraction of the KKT error at the current
+  iterate, bounded by tr_adaptive_tol_max. As safeguards, the tolerance
+  is never loosened, so that it decreases to the interior-point
+  tolerance as the iterates converge, and it is reduced by a factor of
+  ten when a step is rejected, since an inexact subproblem solution may
+  be the reason for the poor agreement between the model and function.
+
+  @param kkt_error The KKT error at the current iterate
+  @param step_is_accepted Flag indicating whether the step was accepted
+*/
+void ParOptTrustRegion::updateSubproblemTolerance(double kkt_error,
+                                                  int step_is_accepted) {
+  if (options->getBoolOption("tr_adaptive_subproblem_tol")) {
+    const double tr_adaptive_tol_factor =
+        options->getFloatOption("tr_adaptive_tol_factor");
+    const double tr_adaptive_tol_max =
+        options->getFloatOption("tr_adaptive_tol_max");
+
+    double tol = tr_adaptive_tol_factor * kkt_error;
+    if (tol > tr_adaptive_tol_max) {
+      tol = tr_adaptive_tol_max;
+    }
+    if (!step_is_accepted && tol > 0.1 * subproblem_tol) {
+      tol = 0.1 * subproblem_tol;
+    }
+    if (tol < subproblem_tol) {
+      subproblem_tol = tol;
+    }
+  }
+}
+
+/*
+  Decide whether to solve the subproblems with the truncated CG method.
+
+  The truncated CG method only applies to problems without dense or
+  sparse constraints. With the automatic setting, it is selected
+  whenever this is the case.
+*/
+int ParOptTrustRegion::useTruncatedCG() {
+  const char *solver = options->getEnumOption("tr_subproblem_solver");
+  if (strcmp(solver, "interior_point") == 0) {
+    return 0;
+  }
+  if (m == 0 && nwcon == 0) {
+    return 1;
+  }
+  int rank;
+  MPI_Comm_rank(subproblem->getMPIComm(), &rank);
+  if (strcmp(solver, "truncated_cg") == 0 && rank == 0) {
+    fprintf(stderr,
+            "ParOptTrustRegion: The truncated CG subproblem solver requires "
+            "a problem without constraints, using the interior-point "
+            "method\n");
+  }
+  return 0;
+}
+
+/*
+  Solve the bound-constrained trust-region subproblem
+
+  min  g^{T}*p + 1/2*p^{T}*B*p
+  s.t. lk <= p <= uk
+
+  with a projected truncated CG method, where B is the quasi-Newton
+  approximation and the bounds lk/uk are the intersection of the
+  trust region and the variable bounds.
+
+  Each outer iteration fixes the variables that are at a bound with a
+  gradient that points out of the feasible region, and runs CG on the
+  remaining free variables. When a CG step leaves the feasible region,
+  or a direction of non-positive curvature is found, the better of the
+  step to the first bound along the direction and the projection of
+  the full step onto the bounds is taken and the free set is updated.
+  The iterations stop when the projected gradient of the model is less
+  than tr_cg_rtol times its initial value, or when the number of
+  Hessian-vector products reaches tr_cg_max_iterations.
+
+  @param _step The step (owned by the trust-region object)
+  @return The number of Hessian-vector products
+*/
+int ParOptTrustRegion::solveSubproblemCG(ParOptVec **_step) {
+  const int tr_cg_max_iterations =
+      options->getIntOption("tr_cg_max_iterations");
+  const double tr_cg_rtol = options->getFloatOption("tr_cg_rtol");
+  const int tr_adaptive_subproblem_tol =
+      options->getBoolOption("tr_adaptive_subproblem_tol");
+  MPI_Comm comm = subproblem->getMPIComm();
+
+  // Allocate the work vectors the first time they are needed
+  if (!cg_work) {
+    cg_work = new ParOptVec *[PAROPT_TR_CG_NUM_WORK];
+    for (int k = 0; k < PAROPT_TR_CG_NUM_WORK; k++) {
+      cg_work[k] = subproblem->createDesignVec();
+      cg_work[k]->incref();
+    }
+  }
+
+  ParOptVec *pvec = cg_work[0];  // The step
+  ParOptVec *lvec = cg_work[1];  // The lower bounds on the step
+  ParOptVec *uvec = cg_work[2];  // The upper bounds on the step
+  ParOptVec *fvec = cg_work[3];  // Free variable indicator
+  ParOptVec *rvec = cg_work[4];  // The model gradient g + B*p
+  ParOptVec *svec = cg_work[5];  // The CG residual on the free variables
+  ParOptVec *dvec = cg_work[6];  // The CG search direction
+  ParOptVec *wvec = cg_work[7];  // The product B*d
+  ParOptVec *qvec = cg_work[8];  // The projected trial step
+
+  // Get the bounds for the step and the model
+  subproblem->getVarsAndBounds(pvec, lvec, uvec);
+  pvec->zeroEntries();
+  ParOptVec *gk;
+  subproblem->getLinearModel(NULL, NULL, &gk);
+  ParOptCompactQuasiNewton *qn = subproblem->getQuasiNewton();
+  rvec->copyValues(gk);
+
+  ParOptScalar *p, *l, *u, *f, *r, *s, *d, *q;
+  pvec->getArray(&p);
+  lvec->getArray(&l);
+  uvec->getArray(&u);
+  fvec->getArray(&f);
+  rvec->getArray(&r);
+  svec->getArray(&s);
+  dvec->getArray(&d);
+  qvec->getArray(&q);
+
+  int iters = 0;
+  double tol = -1.0;
+  while (iters < tr_cg_max_iterations) {
+    // Find the free variables and set the residual to the negative
+    // projected gradient
+    for (int j = 0; j < n; j++) {
+      double pj = ParOptRealPart(p[j]);
+      double rj = ParOptRealPart(r[j]);
+      if ((pj <= ParOptRealPart(l[j]) && rj > 0.0) ||
+          (pj >= ParOptRealPart(u[j]) && rj < 0.0)) {
+        f[j] = 0.0;
+      } else {
+        f[j] = 1.0;
+      }
+      s[j] = -f[j] * r[j];
+    }
+
+    ParOptScalar rz = svec->dot(svec);
+    double snorm = sqrt(ParOptRealPart(rz));
+    if (tol < 0.0) {
+      tol = tr_cg_rtol * snorm;
+      if (tr_adaptive_subproblem_tol && subproblem_tol > tol) {
+        tol = subproblem_tol;
+      }
+    }
+    if (snorm <= tol) {
+      break;
+    }
+
+    // Run CG on the free variables until a bound is reached
+    dvec->copyValues(svec);
+    while (iters < tr_cg_max_iterations) {
+      if (qn) {
+        qn->mult(dvec, wvec);
+      } else {
+        wvec->zeroEntries();
+      }
+      iters++;
+
+      // Find the step to the first bound along the direction and the
+      // step at which all the free variables reach a bound
+      double step_lims[2] = {1e20, 0.0};
+      for (int j = 0; j < n; j++) {
+        double dj = ParOptRealPart(d[j]);
+        double tj = -1.0;
+        if (dj > 0.0) {
+          tj = ParOptRealPart(u[j] - p[j]) / dj;
+        } else if (dj < 0.0) {
+          tj = ParOptRealPart(l[j] - p[j]) / dj;
+        }
+        if (tj >= 0.0) {
+          if (tj < step_lims[0]) {
+            step_lims[0] = tj;
+          }
+          if (-tj < step_lims[1]) {
+            step_lims[1] = -tj;
+          }
+        }
+      }
+      MPI_Allreduce(MPI_IN_PLACE, step_lims, 2, MPI_DOUBLE, MPI_MIN, comm);
+      double alpha_max = step_lims[0];
+
+      ParOptScalar dBd = dvec->dot(wvec);
+      double alpha = -1.0;
+      if (ParOptRealPart(dBd) > 0.0) {
+        alpha = ParOptRealPart(rz / dBd);
+      }
+
+      if (alpha >= 0.0 && alpha < alpha_max) {
+        // Take the CG step
+        pvec->axpy(alpha, dvec);
+        rvec->axpy(alpha, wvec);
+        for (int j = 0; j < n; j++) {
+          s[j] = -f[j] * r[j];
+        }
+
+        ParOptScalar rz_new = svec->dot(svec);
+        if (sqrt(ParOptRealPart(rz_new)) <= tol) {
+          break;
+        }
+        ParOptScalar beta = rz_new / rz;
+        dvec->scale(beta);
+        dvec->axpy(1.0, svec);
+        rz = rz_new;
+        continue;
+      }
+
+      // The step reaches a bound or the curvature is not positive. Find
+      // the model reduction at the first bound along the direction.
+      ParOptScalar rd = rvec->dot(dvec);
+      ParOptScalar red_bound =
+          alpha_max * rd + 0.5 * alpha_max * alpha_max * dBd;
+
+      // Project the full step onto the bounds. With non-positive
+      // curvature, step until all the free variables reach a bound.
+      double alpha_proj = (alpha >= 0.0 ? alpha : -step_lims[1]);
+      for (int j = 0; j < n; j++) {
+        ParOptScalar pj = p[j] + alpha_proj * d[j];
+        if (ParOptRealPart(pj) < ParOptRealPart(l[j])) {
+          pj = l[j];
+        } else if (ParOptRealPart(pj) > ParOptRealPart(u[j])) {
+          pj = u[j];
+        }
+        q[j] = pj - p[j];
+      }
+
+      // Find the model reduction along the projected step, using the
+      // residual vector to store the product with the Hessian
+      if (qn) {
+        qn->mult(qvec, svec);
+      } else {
+        svec->zeroEntries();
+      }
+      iters++;
+      ParOptScalar red_proj = rvec->dot(qvec) + 0.5 * qvec->dot(svec);
+
+      if (ParOptRealPart(red_proj) < ParOptRealPart(red_bound)) {
+        pvec->axpy(1.0, qvec);
+        rvec->axpy(1.0, svec);
+      } else {
+        // Step to the first bound, placing the blocking variables
+        // exactly on their bounds
+        for (int j = 0; j < n; j++) {
+          double dj = ParOptRealPart(d[j]);
+          if (dj > 0.0 && ParOptRealPart(u[j] - p[j]) <= alpha_max * dj) {
+            p[j] = u[j];
+          } else if (dj < 0.0 &&
+                     ParOptRealPart(l[j] - p[j]) >= alpha_max * dj) {
+            p[j] = l[j];
+          } else {
+            p[j] += alpha_max * d[j];
+          }
+        }
+        rvec->axpy(alpha_max, wvec);
+      }
+      break;
+    }
+  }
+
+  *_step = pvec;
+  return iters;
+}
+
+/*
+  Solve the subproblem at the current trust-region radius with either
+  the truncated CG method or the interior-point method
+*/
+void ParOptTrustRegion::solveSubproblem(ParOptInteriorPoint *optimizer,
+                                        int use_cg, double abs_res_tol,
+                                        int max_major_iters, ParOptVec **step,
+                                        ParOptScalar **z, ParOptVec **zw) {
+  if (use_cg) {
+    // The number of subproblem iterations is the number of
+    // Hessian-vector products
+    subproblem_iters = solveSubproblemCG(step);
+    *z = NULL;
+    *zw = NULL;
+  } else {
+    // Initialize the barrier parameter and the starting point
+    initSubproblemStart(optimizer);
+
+    // Optimize the subproblem to the current tolerance
+    optimizeSubproblem(optimizer, abs_res_tol, max_major_iters);
+
+    // Get the design variables
+    ParOptVec *zl, *zu;
+    optimizer->getOptimizedPoint(step, z, zw, &zl, &zu);
+    saveSubproblemSolution(*step, *z, *zw, zl, zu);
+
+    // Get the number of subproblem iterations
+    optimizer->getIterationCounters(&subproblem_iters);
+  }
+}
+
+/**
+  Set the problem factory used for the concurrent evaluation of
+  trust-region radii.
+
+  When the option tr_num_radius_groups is greater than one, the
+  processors are split into groups and the factory is used to create
+  a problem instance on each group. After a step is rejected, the
+  subproblem is solved for a sequence of decreasing radii and the trial
+  points are evaluated concurrently, one on each group. The largest
+  radius with an acceptable trial point is then used for the step. The
+  radii are solved in rounds, so that no further radii are solved once
+  a trial point is accepted.
+
+  Note that the concurrent evaluation is not used for problems with
+  sparse constraints.
+
+  @param factory The problem factory
+*/
+void ParOptTrustRegion::setRadiusProblemFactory(ParOptProblemFactory *factory) {
+  if (factory) {
+    factory->incref();
+  }
+  if (rg_factory) {
+    rg_factory->decref();
+  }
+  rg_factory = factory;
+
+  // Free the old groups, these will be re-created when required
+  freeRadiusGroups();
+}
+
+/*
+  Split the processors into groups and create the problem instances
+  for the concurrent evaluation of the radii
+*/
+void ParOptTrustRegion::initRadiusGroups() {
+  freeRadiusGroups();
+
+  const int tr_num_radius_groups =
+      options->getIntOption("tr_num_radius_groups");
+  if (!rg_factory || tr_num_radius_groups <= 1 || nwcon > 0) {
+    return;
+  }
+
+  MPI_Comm comm = subproblem->getMPIComm();
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  if (size <= 1) {
+    return;
+  }
+
+  rg_groups =
+      new ParOptProblemGroups(comm, rg_factory, tr_num_radius_groups, n, m);
+  rg_groups->incref();
+
+  rg_num_groups = rg_groups->getNumGroups();
+  if (rg_num_groups == 0) {
+    if (rank == 0) {
+      fprintf(stderr,
+              "ParOptTrustRegion: Incompatible radius problem instance, "
+              "using the sequential radius update\n");
+    }
+    freeRadiusGroups();
+    rg_factory->decref();
+    rg_factory = NULL;
+    return;
+  }
+
+  // Allocate space for the steps, the multipliers and the trial point
+  // data
+  rg_steps = new ParOptVec *[rg_num_groups];
+  rg_zw = new ParOptVec *[rg_num_groups];
+  rg_zl = new ParOptVec *[rg_num_groups];
+  rg_zu = new ParOptVec *[rg_num_groups];
+  for (int k = 0; k < rg_num_groups; k++) {
+    rg_steps[k] = subproblem->createDesignVec();
+    rg_steps[k]->incref();
+    rg_zw[k] = subproblem->createConstraintVec();
+    rg_zw[k]->incref();
+    rg_zl[k] = subproblem->createDesignVec();
+    rg_zl[k]->incref();
+    rg_zu[k] = subproblem->createDesignVec();
+    rg_zu[k]->incref();
+  }
+  rg_radius = new double[rg_num_groups];
+  rg_z = new ParOptScalar[rg_num_groups * m];
+  rg_fobj = new ParOptScalar[rg_num_groups];
+  rg_con = new ParOptScalar[rg_num_groups * m];
+  rg_fail = new int[rg_num_groups];
+}
+
+/*
+  Free the data allocated for the concurrent evaluation of the radii
+*/
+void ParOptTrustRegion::freeRadiusGroups() {
+  if (rg_groups) {
+    rg_groups->decref();
+  }
+  if (rg_steps) {
+    for (int k = 0; k < rg_num_groups; k++) {
+      rg_steps[k]->decref();
+      rg_zw[k]->decref();
+      rg_zl[k]->decref();
+      rg_zu[k]->decref();
+    }
+    delete[] rg_steps;
+    delete[] rg_zw;
+    delete[] rg_zl;
+    delete[] rg_zu;
+  }
+  delete[] rg_radius;
+  delete[] rg_z;
+  delete[] rg_fobj;
+  delete[] rg_con;
+  delete[] rg_fail;
+
+  rg_num_groups = 0;
+  rg_groups = NULL;
+  rg_radius = NULL;
+  rg_steps = NULL;
+  rg_z = NULL;
+  rg_zw = NULL;
+  rg_zl = NULL;
+  rg_zu = NULL;
+  rg_fobj = NULL;
+  rg_con = NULL;
+  rg_fail = NULL;
+}
+
+/*
+  Evaluate the objective and constraints at the trial points
+  xk + rg_steps[k] for k = start,...,start+nradii-1 concurrently.
+
+  Each processor forms its local part of the trial points, and only
+  sends these values to the processors of the group that evaluates the
+  point. The results are shared between all processors.
+*/
+void ParOptTrustRegion::evalRadiusGroups(int start, int nradii) {
+  ParOptVec *xk;
+  subproblem->getLinearModel(&xk);
+  ParOptScalar *xvals;
+  xk->getArray(&xvals);
+
+  for (int k = 0; k < nradii; k++) {
+    ParOptScalar *tvals = rg_groups->getTrialPoint(k);
+    ParOptScalar *pvals;
+    rg_steps[start + k]->getArray(&pvals);
+    for (int i = 0; i < n; i++) {
+      tvals[i] = xvals[i] + pvals[i];
+    }
+  }
+
+  rg_groups->evalObjCon(nradii, &rg_fail[start], &rg_fobj[start],
+                        &rg_con[start * m]);
+}
+
+/*
+  Solve the subproblem for a sequence of decreasing trust-region radii
+  and select the largest radius with an acceptable trial point.
+
+  The candidate radii start from the current radius and decrease by the
+  same factor that is applied when a step is rejected. The subproblems
+  share the model, so they are solved on all processors one after the
+  other. The candidates are solved and evaluated in rounds: the first
+  round contains a single radius and each following round doubles the
+  number of radii, with one trial point evaluated on each group. No
+  further radii are solved once a trial point is accepted, so the
+  expected case, where the first reduced radius is acceptable, only
+  requires a single subproblem solution.
+
+  The trial points are tested with the merit function or, when
+  filter_test is set, with the filter. If no trial point is acceptable,
+  the smallest radius is selected. The trust-region radius is set to the
+  selected radius.
+
+  Note that the selected trial point is evaluated again when the step is
+  taken, since the gradient evaluation that follows requires a
+  preceding evaluation at the same point with the full problem.
+
+  @param optimizer The interior-point optimizer
+  @param use_cg Flag indicating whether to use the truncated CG method
+  @param filter_test Flag indicating whether to use the filter test
+  @param abs_res_tol The interior-point residual tolerance
+  @param max_major_iters The interior-point iteration limit
+  @param _step The step for the selected radius
+  @param _z The multipliers for the selected radius
+*/
+void ParOptTrustRegion::solveRadiusGroups(ParOptInteriorPoint *optimizer,
+                                          int use_cg, int filter_test,
+                                          double abs_res_tol,
+                                          int max_major_iters,
+                                          ParOptVec **_step,
+                                          ParOptScalar **_z) {
+  const double tr_eta = options->getFloatOption("tr_eta");
+  const double tr_min_size = options->getFloatOption("tr_min_size");
+  const double function_precision =
+      options->getFloatOption("function_precision");
+
+  // The factor applied to the radius when a step is rejected
+  const double factor = (filter_test ? 0.5 : 0.25);
+
+  // Compute the objective and infeasibility at the current point
+  ParOptScalar fk;
+  ParOptScalar *ck = new ParOptScalar[m];
+  ParOptScalar *cm = new ParOptScalar[m];
+  subproblem->evalObjCon(NULL, &fk, ck);
+
+  int nradii = 0;
+  int iters = 0;
+  int round_size = 1;
+  int last_radius = 0;
+  double radius = tr_size;
+
+  // The index of the selected radius
+  int k = -1;
+  while (k < 0) {
+    // Solve the subproblem for each of the radii in this round
+    int start = nradii;
+    while (nradii < start + round_size && nradii < rg_num_groups) {
+      rg_radius[nradii] = radius;
+      subproblem->setTrustRegionBounds(radius);
+
+      ParOptVec *step, *zw;
+      ParOptScalar *z;
+      solveSubproblem(optimizer, use_cg, abs_res_tol, max_major_iters, &step,
+                      &z, &zw);
+      iters += subproblem_iters;
+
+      // Keep the multipliers of each radius so that the subproblem
+      // for the next iteration is warm started from the selected one
+      rg_steps[nradii]->copyValues(step);
+      if (z) {
+        memcpy(&rg_z[nradii * m], z, m * sizeof(ParOptScalar));
+      } else {
+        memset(&rg_z[nradii * m], 0, m * sizeof(ParOptScalar));
+      }
+      if (!use_cg) {
+        ParOptVec *zl, *zu;
+        optimizer->getOptimizedPoint(NULL, NULL, NULL, &zl, &zu);
+        if (zw) {
+          rg_zw[nradii]->copyValues(zw);
+        }
+        if (zl) {
+          rg_zl[nradii]->copyValues(zl);
+        }
+        if (zu) {
+          rg_zu[nradii]->copyValues(zu);
+        }
+      }
+      nradii++;
+
+      if (radius <= tr_min_size || nradii == rg_num_groups) {
+        last_radius = 1;
+        break;
+      }
+      radius = (factor * radius > tr_min_size ? factor * radius : tr_min_size);
+    }
+
+    // Evaluate the trial points of this round concurrently
+    evalRadiusGroups(start, nradii - start);
+
+    // Find the largest radius with an acceptable trial point. The
+    // last radius is selected without a test.
+    for (int j = start; j < nradii; j++) {
+      if (last_radius && j == nradii - 1) {
+        k = j;
+        break;
+      }
+      if (rg_fail[j]) {
+        continue;
+      }
+
+      ParOptScalar fm;
+      subproblem->evalObjCon(rg_steps[j], &fm, cm);
+      ParOptScalar ft = rg_fobj[j];
+      const ParOptScalar *ct = &rg_con[j * m];
+
+      // Compute the infeasibility at the current point, for the model
+      // and at the trial point. The merit function uses the penalty
+      // parameters.
+      ParOptScalar hk = 0.0, hm = 0.0, ht = 0.0;
+      for (int i = 0; i < m; i++) {
+        double gamma = (filter_test ? 1.0 : penalty_gamma[i]);
+        if (i < nineq) {
+          hk += gamma * max2(0.0, -ck[i]);
+          hm += gamma * max2(0.0, -cm[i]);
+          ht += gamma * max2(0.0, -ct[i]);
+        } else {
+          hk += gamma * fabs(ck[i]);
+          hm += gamma * fabs(cm[i]);
+          ht += gamma * fabs(ct[i]);
+        }
+      }
+
+      int accept = 0;
+      if (filter_test) {
+        ParOptScalar model_red = fk - fm;
+        ParOptScalar actual_red = fk - ft;
+        accept =
+            (acceptableByFilter(ft, ht) && acceptableByPair(ft, ht, fk, hk) &&
+             !(ParOptRealPart(actual_red) <
+                   ParOptRealPart(tr_eta * model_red) &&
+               ParOptRealPart(model_red) > 0.0));
+      } else {
+        ParOptScalar actual_reduc = fk - ft + (hk - ht);
+        ParOptScalar model_reduc = fk - fm + (hk - hm);
+        ParOptScalar rho = 1.0;
+        if (fabs(ParOptRealPart(model_reduc)) > function_precision ||
+            fabs(ParOptRealPart(actual_reduc)) > function_precision) {
+          rho = actual_reduc / model_reduc;
+        }
+        accept = (ParOptRealPart(rho) >= tr_eta);
+      }
+
+      if (accept) {
+        k = j;
+        break;
+      }
+    }
+
+    round_size *= 2;
+  }
+
+  delete[] ck;
+  delete[] cm;
+
+  // Set the trust region to the selected radius
+  tr_size = rg_radius[k];
+  subproblem->setTrustRegionBounds(tr_size);
+  if (use_cg) {
+    saveSubproblemSolution(rg_steps[k], &rg_z[k * m], NULL, NULL, NULL);
+  } else {
+    saveSubproblemSolution(rg_steps[k], &rg_z[k * m], rg_zw[k], rg_zl[k],
+                           rg_zu[k]);
+  }
+  subproblem_iters = iters;
+
+  *_step = rg_steps[k];
+  *_z = &rg_z[k * m];
+}
+
 /**
   Get the optimized point from the subproblem class
 
@@ -1081,16 +2002,150 @@ int ParOptTrustRegion::getPenaltyGamma(const double **_penalty_gamma) {
   return m;
 }
 
+/**
+   Write the state of the trust-region method to a checkpoint file.
+
+   The file contains the design point, the trust-region radius, the
+   penalty parameters, the filter and the update pairs of the
+   quasi-Newton approximation used by the subproblem. The file can be
+   read on a different number of processors.
+
+   @param filename is the name of the file
+   @param compress is a flag to compress the data (requires zlib)
+   @return zero on success, non-zero on failure
+*/
+int ParOptTrustRegion::writeCheckpointFile(const char *filename,
+                                           int compress) {
+  MPI_Comm comm = subproblem->getMPIComm();
+  ParOptCheckpoint *ck = new ParOptCheckpoint(comm);
+  ck->incref();
+
+  // The design point of the current model
+  ParOptVec *xk;
+  subproblem->getLinearModel(&xk);
+  ck->addVec("x", xk);
+
+  // The trust-region radius and penalty parameters
+  ParOptScalar radius = tr_size;
+  ck->addScalars("tr_size", 1, &radius);
+  ParOptScalar *gamma = new ParOptScalar[m];
+  for (int i = 0; i < m; i++) {
+    gamma[i] = penalty_gamma[i];
+  }
+  ck->addScalars("penalty_gamma", m, gamma);
+  delete[] gamma;
+
+  // The filter, stored as (f, h) pairs
+  int nfilter = filter.size();
+  ParOptScalar *fh = new ParOptScalar[2 * nfilter];
+  int k = 0;
+  for (auto entry = filter.begin(); entry != filter.end(); entry++, k++) {
+    fh[2 * k] = entry->f;
+    fh[2 * k + 1] = entry->h;
+  }
+  ck->addScalars("filter", 2 * nfilter, fh);
+  delete[] fh;
+
+  // The quasi-Newton update pairs
+  ck->addQuasiNewton("qn", subproblem->getQuasiNewton());
+
+  int fail = ck->write(filename, compress);
+  ck->decref();
+
+  return fail;
+}
+
+/**
+   Read the state of the trust-region method from a checkpoint file.
+
+   The trust-region radius, penalty parameters, filter and quasi-Newton
+   update pairs are set immediately. The design point is used to
+   initialize the subproblem when the optimization starts. Subproblems
+   that cannot be initialized at a given point start from the problem
+   starting point instead.
+
+   @param filename is the name of the file
+   @return zero on success, non-zero on failure
+*/
+int ParOptTrustRegion::readCheckpointFile(const char *filename) {
+  MPI_Comm comm = subproblem->getMPIComm();
+  ParOptCheckpoint *ck = new ParOptCheckpoint(comm);
+  ck->incref();
+
+  int fail = ck->read(filename);
+  if (fail) {
+    ck->decref();
+    return fail;
+  }
+
+  int nfilter = ck->getRecordLength("filter") / 2;
+  ParOptScalar radius = 0.0;
+  ParOptScalar *gamma = new ParOptScalar[m];
+  ParOptScalar *fh = new ParOptScalar[2 * nfilter + 1];
+  ParOptVec *x = subproblem->createDesignVec();
+  x->incref();
+
+  fail = (nfilter < 0 || ck->getVec("x", x) ||
+          ck->getScalars("tr_size", 1, &radius) ||
+          ck->getScalars("penalty_gamma", m, gamma) ||
+          ck->getScalars("filter", 2 * nfilter, fh) ||
+          ck->getQuasiNewton("qn", subproblem, subproblem->getQuasiNewton()));
+
+  if (!fail) {
+    tr_size = ParOptRealPart(radius);
+    for (int i = 0; i < m; i++) {
+      penalty_gamma[i] = ParOptRealPart(gamma[i]);
+    }
+    filter.clear();
+    for (int k = 0; k < nfilter; k++) {
+      filter.push_back(FilterElement(fh[2 * k], fh[2 * k + 1]));
+    }
+    if (restart_x) {
+      restart_x->decref();
+    }
+    restart_x = x;
+  } else {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0) {
+      fprintf(stderr, "ParOpt: Failed to read the checkpoint file %s\n",
+              filename);
+    }
+    x->decref();
+  }
+
+  delete[] gamma;
+  delete[] fh;
+  ck->decref();
+
+  return fail;
+}
+
 /**
   Initialize the problem
 */
 void ParOptTrustRegion::initialize() {
   // tr_size = options->getFloatOption("tr_init_size");
-  subproblem->initModelAndBounds(tr_size);
+  // Use the design point read from a checkpoint file, if any
+  int init_fail = 1;
+  if (restart_x) {
+    init_fail = subproblem->initModelAndBoundsAtPoint(tr_size, restart_x);
+    restart_x->decref();
+    restart_x = NULL;
+  }
+  if (init_fail) {
+    subproblem->initModelAndBounds(tr_size);
+  }
 
   // Set the iteration count to zero
   iter_count = 0;
 
+  // The first subproblem is not warm started
+  has_warm_start = 0;
+
+  // Start the inexact subproblem solves at the loosest tolerance
+  subproblem_tol = options->getFloatOption("tr_adaptive_tol_max");
+
   int mpi_rank;
   MPI_Comm_rank(subproblem->getMPIComm(), &mpi_rank);
   if (mpi_rank == 0) {
@@ -1228,9 +2283,9 @@ void ParOptTrustRegion::minimizeInfeas(
 /**
   Update the subproblem using SL1QP method
 */
-void ParOptTrustRegion::sl1qpUpdate(ParOptVec *step, ParOptScalar *z,
-                                    ParOptVec *zw, double *infeas, double *l1,
-                                    double *linfty) {
+int ParOptTrustRegion::sl1qpUpdate(ParOptVec *step, ParOptScalar *z,
+                                   ParOptVec *zw, double *infeas, double *l1,
+                                   double *linfty) {
   // Start timer
   double t_total = MPI_Wtime();
 
@@ -1321,6 +2376,13 @@ void ParOptTrustRegion::sl1qpUpdate(ParOptVec *step, ParOptScalar *z,
             ParOptRealPart(infeas_k - infeas_model));
   }
 
+  if (history) {
+    history->setDouble("ared(f)", ParOptRealPart(fk - ft));
+    history->setDouble("pred(f)", ParOptRealPart(obj_reduc));
+    history->setDouble("ared(c)", ParOptRealPart(infeas_k - infeas_t));
+    history->setDouble("pred(c)", ParOptRealPart(infeas_k - infeas_model));
+  }
+
   // Compute the ratio of the actual reduction
   ParOptScalar rho = 1.0;
   if (fabs(ParOptRealPart(model_reduc)) <= function_precision &&
@@ -1374,6 +2436,10 @@ void ParOptTrustRegion::sl1qpUpdate(ParOptVec *step, ParOptScalar *z,
   // Compute the KKT error at the current point
   computeKKTError(z, zw, l1, linfty);
 
+  // Update the tolerance for the next subproblem
+  updateSubproblemTolerance(*infeas > *linfty ? *infeas : *linfty,
+                            step_is_accepted);
+
   // Compute the max z/average z and max gamma/average gamma
   double zmax = 0.0, zav = 0.0, gmax = 0.0, gav = 0.0;
   for (int i = 0; i < m; i++) {
@@ -1439,8 +2505,31 @@ void ParOptTrustRegion::sl1qpUpdate(ParOptVec *step, ParOptScalar *z,
     fflush(fp);
   }
 
+  // Append the iteration to the binary history
+  if (history) {
+    history->setInt("iter", iter_count);
+    history->setDouble("fobj", ParOptRealPart(fk));
+    history->setDouble("infes", *infeas);
+    history->setDouble("l1", *l1);
+    history->setDouble("linfty", *linfty);
+    history->setDouble("|x - xk|", smax);
+    history->setDouble("tr", tr_size);
+    history->setDouble("rho", ParOptRealPart(rho));
+    history->setDouble("mod red.", ParOptRealPart(model_reduc));
+    history->setDouble("avg z", zav);
+    history->setDouble("max z", zmax);
+    history->setDouble("avg pen.", gav);
+    history->setDouble("max pen.", gmax);
+    history->setDouble("time(s)", t_total);
+    history->setInt("sub-iter", subproblem_iters);
+    history->setInt("accepted", step_is_accepted);
+    history->writeRow();
+  }
+
   // Update the iteration counter
   iter_count++;
+
+  return step_is_accepted;
 }
 
 /**
@@ -1452,9 +2541,13 @@ void ParOptTrustRegion::sl1qpUpdate(ParOptVec *step, ParOptScalar *z,
   @param optimizer An instance of the ParOptInteriorPoint optimizer class
 */
 void ParOptTrustRegion::sl1qpOptimize(ParOptInteriorPoint *optimizer) {
+  // Check whether to use the truncated CG subproblem solver. In this
+  // case there are no constraints and no penalty parameters to update.
+  const int use_cg = useTruncatedCG();
+
   // Extract options
   const int tr_adaptive_gamma_update =
-      options->getBoolOption("tr_adaptive_gamma_update");
+      options->getBoolOption("tr_adaptive_gamma_update") && !use_cg;
   const int tr_max_iterations = options->getIntOption("tr_max_iterations");
   const double tr_penalty_gamma_max =
       options->getFloatOption("tr_penalty_gamma_max");
@@ -1499,6 +2592,11 @@ void ParOptTrustRegion::sl1qpOptimize(ParOptInteriorPoint *optimizer) {
   // don't generate output files from subiterations.
   ip_options->setOption("write_output_frequency", 0);
 
+  // Store the interior-point tolerance and iteration limit. These are
+  // modified for the inexact subproblem solves.
+  const double ip_abs_res_tol = ip_options->getFloatOption("abs_res_tol");
+  const int ip_max_major_iters = ip_options->getIntOption("max_major_iters");
+
   // Extract and store the barrier strategy and starting point strategy.
   // During the linear optimization subproblem, these will be reset to
   // more appropriate values. During the QP part of the optimization, these
@@ -1540,6 +2638,12 @@ void ParOptTrustRegion::sl1qpOptimize(ParOptInteriorPoint *optimizer) {
   // Initialize the trust region problem for the first iteration
   initialize();
 
+  // Create the processor groups for the concurrent evaluation of radii
+  if (rg_factory && !rg_groups) {
+    initRadiusGroups();
+  }
+  int step_is_accepted = 1;
+
   // Iterate over the trust region subproblem until convergence
   for (int i = 0; i < tr_max_iterations; i++) {
     if (tr_adaptive_gamma_update) {
@@ -1559,19 +2663,17 @@ void ParOptTrustRegion::sl1qpOptimize(ParOptInteriorPoint *optimizer) {
       subproblem->writeOutput(i, xk);
     }
 
-    // Initialize the barrier parameter
-    optimizer->resetDesignAndBounds();
-
-    // Optimize the subproblem
-    optimizer->optimize();
-
-    // Get the design variables
-    ParOptVec *step, *zw;
+    // Solve the subproblem. After a rejected step, the subproblem is
+    // solved for several radii that are evaluated concurrently.
+    ParOptVec *step, *zw = NULL;
     ParOptScalar *z;
-    optimizer->getOptimizedPoint(&step, &z, &zw, NULL, NULL);
-
-    // Get the number of subproblem iterations
-    optimizer->getIterationCounters(&subproblem_iters);
+    if (rg_num_groups > 1 && !step_is_accepted) {
+      solveRadiusGroups(optimizer, use_cg, 0, ip_abs_res_tol,
+                        ip_max_major_iters, &step, &z);
+    } else {
+      solveSubproblem(optimizer, use_cg, ip_abs_res_tol, ip_max_major_iters,
+                      &step, &z, &zw);
+    }
 
     if (tr_adaptive_gamma_update) {
       // Find the infeasibility at the origin x = xk
@@ -1595,7 +2697,7 @@ void ParOptTrustRegion::sl1qpOptimize(ParOptInteriorPoint *optimizer) {
     // Update the trust region based on the performance at the new
     // point.
     double infeas, l1, linfty;
-    sl1qpUpdate(step, z, zw, &infeas, &l1, &linfty);
+    step_is_accepted = sl1qpUpdate(step, z, zw, &infeas, &l1, &linfty);
 
     // Check for convergence of the trust region problem
     if (infeas < tr_infeas_tol) {
@@ -1710,6 +2812,9 @@ void ParOptTrustRegion::filterOptimize(ParOptInteriorPoint *optimizer) {
   const int tr_write_output_frequency =
       options->getIntOption("tr_write_output_frequency");
 
+  // Use the truncated CG method for problems without constraints
+  const int use_cg = useTruncatedCG();
+
   // Set up the optimizer so that it uses the quasi-Newton approximation
   ParOptCompactQuasiNewton *qn = subproblem->getQuasiNewton();
   optimizer->setQuasiNewton(qn);
@@ -1724,6 +2829,11 @@ void ParOptTrustRegion::filterOptimize(ParOptInteriorPoint *optimizer) {
   // don't generate output files from subiterations.
   ip_options->setOption("write_output_frequency", 0);
 
+  // Store the interior-point tolerance and iteration limit. These are
+  // modified for the inexact subproblem solves.
+  const double ip_abs_res_tol = ip_options->getFloatOption("abs_res_tol");
+  const int ip_max_major_iters = ip_options->getIntOption("max_major_iters");
+
   // Set the initial values for the penalty parameter
   optimizer->setPenaltyGamma(penalty_gamma);
 
@@ -1765,6 +2875,12 @@ void ParOptTrustRegion::filterOptimize(ParOptInteriorPoint *optimizer) {
   // Keep tracking the feasibility (compatibility) restoration phase
   int this_step_is_resto = 0;
   int last_step_is_resto = 0;
+  int last_step_is_rejected = 0;
+
+  // Create the processor groups for the concurrent evaluation of radii
+  if (rg_factory && !rg_groups) {
+    initRadiusGroups();
+  }
 
   // Iterate over the trust region subproblem until convergence
   for (int iteration = 0; iteration < tr_max_iterations; iteration++) {
@@ -1789,14 +2905,19 @@ void ParOptTrustRegion::filterOptimize(ParOptInteriorPoint *optimizer) {
     // to use the quasi-Newton Hessian approximation
     ip_options->setOption("sequential_linear_method", 0);
 
-    // Optimize the subproblem
-    optimizer->resetDesignAndBounds();
-    optimizer->optimize();
-
-    // Get the step in the design variable and the multiplier values
-    ParOptVec *step, *zw;
+    // Optimize the subproblem to the current tolerance and get the step
+    // in the design variable and the multiplier values. After a rejected
+    // step, the subproblem is solved for several radii that are
+    // evaluated concurrently.
+    ParOptVec *step, *zw = NULL;
     ParOptScalar *z;
-    optimizer->getOptimizedPoint(&step, &z, &zw, NULL, NULL);
+    if (rg_num_groups > 1 && last_step_is_rejected && !last_step_is_resto) {
+      solveRadiusGroups(optimizer, use_cg, 1, ip_abs_res_tol,
+                        ip_max_major_iters, &step, &z);
+    } else {
+      solveSubproblem(optimizer, use_cg, ip_abs_res_tol, ip_max_major_iters,
+                      &step, &z, &zw);
+    }
 
     /*
       Check if the QP subproblem we just solved is incompatible, where
@@ -1817,10 +2938,12 @@ void ParOptTrustRegion::filterOptimize(ParOptInteriorPoint *optimizer) {
         c[i] + A[i]*step
     */
 
-    // We may enter feasibility restoration only it is specified
-    if (options->getBoolOption("filter_has_feas_restore_phase")) {
+    // We may enter feasibility restoration only it is specified. The
+    // truncated CG method is only used without constraints, so the
+    // subproblem is always compatible.
+    if (options->getBoolOption("filter_has_feas_restore_phase") && !use_cg) {
       // Compute feasibility
-      double infeas;
+      double infeas = 0.0;
       ParOptScalar dummy;
       ParOptScalar *cm = new ParOptScalar[m];
       subproblem->evalObjCon(step, &dummy, cm);
@@ -2155,6 +3278,27 @@ void ParOptTrustRegion::filterOptimize(ParOptInteriorPoint *optimizer) {
       fflush(fp);
     }
 
+    // Append the iteration to the binary history
+    if (history) {
+      history->setInt("iter", iter_count);
+      history->setDouble("fobj", ParOptRealPart(fobj_trial));
+      history->setDouble("infes", ParOptRealPart(infeas_trial));
+      history->setDouble("l1", l1);
+      history->setDouble("linfty", linfty);
+      history->setDouble("|x - xk|", smax);
+      history->setDouble("tr", tr_size);
+      history->setDouble("rho", ParOptRealPart(rho));
+      history->setDouble("mod red.", ParOptRealPart(model_red));
+      history->setDouble("avg z", zav);
+      history->setDouble("max z", zmax);
+      history->setDouble("avg pen.", gav);
+      history->setDouble("max pen.", gmax);
+      history->setDouble("time(s)", t_total);
+      history->setInt("sub-iter", qp_iters);
+      history->setInt("accepted", step_is_accepted);
+      history->writeRow();
+    }
+
     // Output additional information
     if (mpi_rank == 0 && output_level > 0) {
       FILE *fp = stdout;
@@ -2191,11 +3335,19 @@ void ParOptTrustRegion::filterOptimize(ParOptInteriorPoint *optimizer) {
     // Reset the trust region radius bounds
     subproblem->setTrustRegionBounds(tr_size);
 
+    // Update the tolerance for the next subproblem
+    double kkt_error = ParOptRealPart(infeas_trial);
+    if (linfty > kkt_error) {
+      kkt_error = linfty;
+    }
+    updateSubproblemTolerance(kkt_error, step_is_accepted);
+
     // Update the iteration counter
     iter_count++;
 
     // Update restoration phase flags for next iteration
     last_step_is_resto = this_step_is_resto;
+    last_step_is_rejected = !step_is_accepted;
 
     // Check for convergence of the trust region problem
     if (ParOptRealPart(infeas_trial) < ParOptRealPart(tr_infeas_tol)) {
@@ -30,6 +30,19 @@ class ParOptTrustRegionSubproblem : public ParOptProblem {
   */
   virtual void initModelAndBounds(double tr_size) = 0;
 
+  /**
+    Initialize the sub-problem at the given point, rather than the
+    problem starting point. This is used to restart the trust-region
+    method from a checkpoint file.
+
+    @param tr_size The trust-region radius at the point
+    @param x The design point
+    @return Zero on success, non-zero if this is not supported
+  */
+  virtual int initModelAndBoundsAtPoint(double tr_size, ParOptVec *x) {
+    return 1;
+  }
+
   /**
     Set the trust region radius about the current point
 
@@ -159,6 +172,7 @@ class ParOptQuadraticSubproblem : public ParOptTrustRegionSubproblem {
   // Implementation for the trust-region specific functions
   ParOptCompactQuasiNewton *getQuasiNewton();
   void initModelAndBounds(double tr_size);
+  int initModelAndBoundsAtPoint(double tr_size, ParOptVec *x);
   void setTrustRegionBounds(double tr_size);
   int evalTrialStepAndUpdate(int update_flag, ParOptVec *step, ParOptScalar *z,
                              ParOptVec *zw, ParOptScalar *fobj,
@@ -180,6 +194,11 @@ class ParOptQuadraticSubproblem : public ParOptTrustRegionSubproblem {
   int useLowerBounds();
   int useUpperBounds();
 
+  // The model is quadratic with linearized constraints
+  int isObjQuadratic() { return 1; }
+  int isDenseConLinear(int index) { return 1; }
+  int isSparseConLinear() { return 1; }
+
   // Get the variables and bounds from the problem
   void getVarsAndBounds(ParOptVec *x, ParOptVec *lb, ParOptVec *ub);
 
@@ -399,6 +418,13 @@ class ParOptTrustRegion : public ParOptBase {
   // Get the optimized point
   void getOptimizedPoint(ParOptVec **_x);
 
+  // Write and read the trust-region state to a checkpoint file
+  int writeCheckpointFile(const char *filename, int compress = 0);
+  int readCheckpointFile(const char *filename);
+
+  // Set the problem factory for the concurrent evaluation of radii
+  void setRadiusProblemFactory(ParOptProblemFactory *factory);
+
  private:
   // The trust region optimization subproblem
   ParOptTrustRegionSubproblem *subproblem;
@@ -407,7 +433,7 @@ class ParOptTrustRegion : public ParOptBase {
   ParOptOptions *options;
 
   // Solve the subproblem using SL1QP method
-  void sl1qpUpdate(ParOptVec *step, ParOptScalar *z, ParOptVec *zw,
+  int sl1qpUpdate(ParOptVec *step, ParOptScalar *z, ParOptVec *zw,
                    double *infeas, double *l1, double *linfty);
 
   // Optimization-specific code for the filter and sl1qp strategies
@@ -449,6 +475,9 @@ class ParOptTrustRegion : public ParOptBase {
   // Set the output file
   void setOutputFile(const char *filename);
 
+  // Set the binary iteration history file
+  void setHistoryFile(const char *filename);
+
   // Compute the KKT error in the solution
   void computeKKTError(const ParOptScalar *z, ParOptVec *zw, double *l1,
                        double *linfty);
@@ -459,8 +488,39 @@ class ParOptTrustRegion : public ParOptBase {
   // Add info statement
   void addToInfo(size_t info_size, char *info, const char *format, ...);
 
+  // Set the starting point for the interior-point subproblem solver
+  void initSubproblemStart(ParOptInteriorPoint *optimizer);
+  void saveSubproblemSolution(ParOptVec *step, ParOptScalar *z, ParOptVec *zw,
+                              ParOptVec *zl, ParOptVec *zu);
+
+  // Solve the subproblem inexactly using the adaptive tolerance
+  void optimizeSubproblem(ParOptInteriorPoint *optimizer, double abs_res_tol,
+                          int max_major_iters);
+  void updateSubproblemTolerance(double kkt_error, int step_is_accepted);
+
+  // Solve the subproblem with a projected truncated CG method when
+  // there are no dense or sparse constraints
+  int useTruncatedCG();
+  int solveSubproblemCG(ParOptVec **_step);
+
+  // Solve the subproblem at the current radius
+  void solveSubproblem(ParOptInteriorPoint *optimizer, int use_cg,
+                       double abs_res_tol, int max_major_iters,
+                       ParOptVec **step, ParOptScalar **z, ParOptVec **zw);
+
+  // Solve the subproblem at several radii and evaluate the trial points
+  // concurrently on groups of processors
+  void initRadiusGroups();
+  void freeRadiusGroups();
+  void evalRadiusGroups(int start, int nradii);
+  void solveRadiusGroups(ParOptInteriorPoint *optimizer, int use_cg,
+                         int filter_test, double abs_res_tol,
+                         int max_major_iters, ParOptVec **step,
+                         ParOptScalar **z);
+
   // File pointer for the summary file - depending on the settings
   FILE *outfp;
+  ParOptHistory *history;         // The binary iteration history
   int iter_count;                 // Iteration counter
   int subproblem_iters;           // Subproblem iteration counter
   int adaptive_subproblem_iters;  // Subproblem iteration counter
@@ -473,6 +533,33 @@ class ParOptTrustRegion : public ParOptBase {
 
   double tr_size;         // The trust region size
   double *penalty_gamma;  // Penalty parameters
+  ParOptVec *restart_x;   // The design point read from a checkpoint file
+
+  // The previous subproblem solution and multipliers used for the
+  // warm start
+  int has_warm_start;
+  ParOptVec *warm_start_x;
+  ParOptScalar *warm_start_z;
+  ParOptVec *warm_start_zw, *warm_start_zl, *warm_start_zu;
+
+  // The adaptive tolerance for the interior-point subproblem solves
+  double subproblem_tol;
+
+  // Work vectors for the truncated CG subproblem solver
+  ParOptVec **cg_work;
+
+  // Data for the concurrent evaluation of the trust-region radii
+  ParOptProblemFactory *rg_factory;
+  int rg_num_groups;               // The number of processor groups
+  ParOptProblemGroups *rg_groups;  // The processor groups
+  double *rg_radius;               // The candidate radii
+  ParOptVec **rg_steps;            // The steps for the candidate radii
+  ParOptScalar *rg_z;              // The multipliers for the candidates
+  ParOptVec **rg_zw;               // The sparse constraint multipliers
+  ParOptVec **rg_zl, **rg_zu;      // The bound multipliers
+  ParOptScalar *rg_fobj;           // The objective at the trial points
+  ParOptScalar *rg_con;            // The constraints at the trial points
+  int *rg_fail;                    // Failure flags at the trial points
 
   // Temporary vectors
   ParOptVec *t;
@@ -0,0 +1,123 @@
+from paropt import ParOpt
+import numpy as np
+
+
+def get_local_size(comm, ntotal):
+    """
+    Get the number of variables on this processor when ntotal variables
+    are distributed across the processors of the communicator
+    """
+    offset = (ntotal * comm.rank) // comm.size
+    return (ntotal * (comm.rank + 1)) // comm.size - offset
+
+
+class Rosenbrock(ParOpt.Problem):
+    """
+    A Rosenbrock-type problem with linear constraints that is shared by
+    the regression tests. The objective is
+
+    f(x) = sum_i (1 - x_i)^2 + 100*(x_i^2 - y_i)^2
+
+    where y_i only depends on the global index of the variable, so the
+    local sizes can differ between processors and between runs. The
+    constraints are c_k(x) = cmean[k] - mean(x) >= 0. The number of
+    objective and gradient evaluations are counted.
+
+    The variables where fixed is True have lower and upper bounds equal
+    to xfixed. If reduced is True, these variables are removed by hand
+    instead, so that the problem is the one seen by the optimizer after
+    a presolve. Other keyword arguments are passed to ParOpt.Problem.
+    """
+
+    def __init__(
+        self,
+        comm,
+        nvars,
+        x0=-1.0,
+        lb=-2.0,
+        ub=2.0,
+        cmean=(0.5,),
+        fixed=None,
+        xfixed=0.9,
+        reduced=False,
+        **kwargs
+    ):
+        self.comm = comm
+        self.x0 = x0
+        self.lb = lb
+        self.ub = ub
+        self.cmean = cmean
+        self.ncon = len(cmean)
+        self.ntotal = comm.allreduce(nvars)
+        offset = int(np.sum(comm.allgather(nvars)[: comm.rank]))
+        index = np.arange(offset, offset + nvars)
+        self.y = 0.3 + 0.5 * (index % 7) / 7.0
+        self.nobj = 0
+        self.ngrad = 0
+
+        self.fixed = fixed
+        self.xfixed = xfixed
+        self.reduced = reduced
+        self.free = np.arange(nvars)
+        if fixed is not None and reduced:
+            self.free = np.nonzero(np.logical_not(fixed))[0]
+
+        super().__init__(comm, nvars=len(self.free), ncon=self.ncon, **kwargs)
+
+    def expand(self, x):
+        """Get the full local design vector from the variables x"""
+        xfull = self.xfixed * np.ones(len(self.y))
+        xfull[self.free] = x[:]
+        return xfull
+
+    def getVarsAndBounds(self, x, lb, ub):
+        x[:] = self.x0
+        lb[:] = self.lb
+        ub[:] = self.ub
+        if self.fixed is not None and not self.reduced:
+            index = np.nonzero(self.fixed)[0].tolist()
+            lb[index] = self.xfixed
+            ub[index] = self.xfixed
+
+    def evalObjCon(self, x):
+        self.nobj += 1
+        x = self.expand(x)
+        fobj = np.sum((1.0 - x) ** 2 + 100.0 * (x**2 - self.y) ** 2)
+        fobj = self.comm.allreduce(fobj)
+        xsum = self.comm.allreduce(np.sum(x))
+        con = np.array([c - xsum / self.ntotal for c in self.cmean])
+        return 0, fobj, con
+
+    def evalGradient(self, x):
+        """
+        Get the gradient of the objective and of each of the constraints
+        at the full local design vector x
+        """
+        g = -2.0 * (1.0 - x) + 400.0 * (x**2 - self.y) * x
+        a = -np.ones(len(x)) / self.ntotal
+        return g, a
+
+    def evalObjConGradient(self, x, g, A):
+        self.ngrad += 1
+        gfull, a = self.evalGradient(self.expand(x))
+        g[:] = gfull[self.free]
+        for Ai in A:
+            Ai[:] = a[self.free]
+        return 0
+
+
+class RosenbrockFactory(ParOpt.ProblemFactory):
+    """
+    Create instances of the Rosenbrock problem with ntotal variables for
+    the processor groups. The created problems are kept so that their
+    evaluations can be counted.
+    """
+
+    def __init__(self, ntotal):
+        self.ntotal = ntotal
+        self.group_problems = []
+
+    def createProblem(self, comm):
+        prob = Rosenbrock(comm, get_local_size(comm, self.ntotal))
+        self.group_problems.append(prob)
+        return prob
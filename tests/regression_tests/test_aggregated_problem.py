@@ -0,0 +1,140 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from mpi4py import MPI
+
+
+class StressProblem(ParOpt.AggregatedProblem):
+    """
+    Maximize the sum of the variables subject to a local constraint on
+    each variable, c_j = 1 - (x_j/u_j)**2 >= 0, and a user-defined dense
+    constraint that is not active at the solution. The exact solution
+    is x = u.
+    """
+
+    def __init__(self, comm, nvars, options):
+        self.comm = comm
+        self.nvars = nvars
+        self.ntotal = comm.allreduce(nvars)
+        offset = comm.rank * nvars
+        self.u = 1.0 + (np.arange(offset, offset + nvars) % 5) / 4.0
+        super().__init__(comm, nvars=nvars, ncon=1, nlocal=nvars, options=options)
+
+    def getVarsAndBounds(self, x, lb, ub):
+        x[:] = 0.5
+        lb[:] = 0.0
+        ub[:] = 10.0
+
+    def getLocalCons(self, x):
+        return 1.0 - (np.array(x[:]) / self.u) ** 2
+
+    def evalObjConLocal(self, x):
+        fobj = self.comm.allreduce(-np.sum(x[:]))
+        con = np.array([3.0 * self.ntotal + fobj])
+        lcon = self.getLocalCons(x)
+        return 0, fobj, con, lcon
+
+    def evalObjConLocalGradient(self, x, g, A, groups, weights, Ag):
+        g[:] = -1.0
+        A[0][:] = -1.0
+        for j in range(self.nvars):
+            Ag[groups[j]][j] += weights[j] * (-2.0 * x[j] / self.u[j] ** 2)
+        return 0
+
+    def getExactObjective(self):
+        return self.comm.allreduce(-np.sum(self.u))
+
+
+class AggregatedProblemTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, prob):
+        options = {
+            "qn_subspace_size": 10,
+            "abs_res_tol": 1e-10,
+            "max_major_iters": 500,
+            "output_file": os.devnull,
+        }
+        opt = ParOpt.InteriorPoint(prob, options)
+        opt.optimize()
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+
+        # Return the objective error and the minimum local constraint
+        fobj = self.comm.allreduce(-np.sum(x[:]))
+        lcon = self.comm.allreduce(np.min(prob.getLocalCons(x)), op=MPI.MIN)
+        return fobj - prob.getExactObjective(), lcon, np.array(z)
+
+    def test_ks(self):
+        prob = StressProblem(self.comm, 10, {"aggregation_ks_weight": 50.0})
+        self.assertEqual(prob.getNumAggregationGroups(), 1)
+
+        # The KS function is a lower bound on the local constraints, so
+        # the solution is feasible and the objective is conservative
+        err, lcon, z = self.optimize(prob)
+        self.assertGreater(err, 0.0)
+        self.assertGreater(lcon, -1e-8)
+
+        # The user-defined constraint follows the aggregated constraint
+        # and is not active
+        self.assertEqual(len(z), 2)
+        self.assertGreater(z[0], 1e-3)
+        self.assertLess(abs(z[1]), 1e-6)
+
+    def test_pnorm(self):
+        options = {"aggregation_type": "pnorm", "aggregation_pnorm": 8.0}
+        prob = StressProblem(self.comm, 10, options)
+
+        # The p-norm is an upper bound on the failure values
+        err, lcon, z = self.optimize(prob)
+        self.assertGreater(err, 0.0)
+        self.assertGreater(lcon, -1e-8)
+
+    def test_continuation(self):
+        options = {
+            "aggregation_ks_weight": 20.0,
+            "aggregation_max_ks_weight": 160.0,
+            "aggregation_continuation_factor": 4.0,
+        }
+        prob = StressProblem(self.comm, 10, options)
+        err0, lcon0, z0 = self.optimize(prob)
+
+        # Increase the aggregation parameter up to its maximum value
+        self.assertTrue(prob.updateAggregation())
+        self.assertEqual(prob.getAggregationParameter(), 80.0)
+        err1, lcon1, z1 = self.optimize(prob)
+
+        self.assertTrue(prob.updateAggregation())
+        self.assertEqual(prob.getAggregationParameter(), 160.0)
+        self.assertFalse(prob.updateAggregation())
+        err2, lcon2, z2 = self.optimize(prob)
+
+        # The solution approaches the exact solution and remains feasible
+        self.assertLess(err1, err0)
+        self.assertLess(err2, err1)
+        self.assertGreater(lcon2, -1e-8)
+
+    def test_groups(self):
+        options = {"aggregation_ks_weight": 50.0}
+        prob = StressProblem(self.comm, 10, options)
+        err0, lcon0, z0 = self.optimize(prob)
+
+        for grouping in ["index", "value"]:
+            options = {
+                "aggregation_ks_weight": 50.0,
+                "aggregation_num_groups": 4,
+                "aggregation_grouping": grouping,
+            }
+            prob = StressProblem(self.comm, 10, options)
+            self.assertEqual(prob.getNumAggregationGroups(), 4)
+
+            # Smaller groups are less conservative
+            err, lcon, z = self.optimize(prob)
+            self.assertEqual(len(z), 5)
+            self.assertLess(err, err0)
+            self.assertGreater(lcon, -1e-8)
+
+        # There are never more groups than local constraints
+        options = {"aggregation_num_groups": 1000}
+        prob = StressProblem(self.comm, 10, options)
+        self.assertEqual(prob.getNumAggregationGroups(), 20)
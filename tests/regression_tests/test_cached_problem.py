@@ -0,0 +1,102 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock
+
+
+class CachedProblemTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, options, use_cache):
+        prob = Rosenbrock(self.comm, 10)
+        cached = None
+        if use_cache:
+            cached = ParOpt.CachedProblem(prob, max_entries=4)
+            opt = ParOpt.Optimizer(cached, options)
+        else:
+            opt = ParOpt.Optimizer(prob, options)
+        opt.optimize()
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        return prob, cached, np.array(x[:]), np.array(z)
+
+    def check_cache(self, options):
+        prob, cached, x0, z0 = self.optimize(options, False)
+        cprob, cached, x1, z1 = self.optimize(options, True)
+
+        # The cache must not change the path taken by the optimizer
+        np.testing.assert_array_equal(x0, x1)
+        np.testing.assert_array_equal(z0, z1)
+
+        # Every miss is forwarded to the wrapped problem exactly once
+        stats = cached.getCacheStats()
+        self.assertEqual(stats["obj_misses"], cprob.nobj)
+        self.assertEqual(stats["obj_hits"] + stats["obj_misses"], prob.nobj)
+        self.assertEqual(stats["grad_hits"] + stats["grad_misses"], prob.ngrad)
+        self.assertLessEqual(cprob.ngrad, stats["grad_misses"])
+
+        return stats
+
+    def test_interior_point(self):
+        options = {
+            "algorithm": "ip",
+            "qn_subspace_size": 5,
+            "abs_res_tol": 1e-8,
+            "max_major_iters": 200,
+            "output_file": os.devnull,
+        }
+        self.check_cache(options)
+
+    def test_trust_region(self):
+        options = {
+            "algorithm": "tr",
+            "qn_subspace_size": 5,
+            "tr_init_size": 0.5,
+            "tr_max_iterations": 100,
+            "output_file": os.devnull,
+            "tr_output_file": os.devnull,
+        }
+        self.check_cache(options)
+
+    def repeat_optimization(self, max_entries, clear_cache=False):
+        options = {
+            "algorithm": "tr",
+            "qn_subspace_size": 5,
+            "tr_init_size": 0.5,
+            "tr_max_iterations": 10,
+            "output_file": os.devnull,
+            "tr_output_file": os.devnull,
+        }
+        prob = Rosenbrock(self.comm, 10)
+        cached = ParOpt.CachedProblem(prob, max_entries=max_entries)
+        opt = ParOpt.Optimizer(cached, options)
+        opt.optimize()
+        nobj = prob.nobj
+        ngrad = prob.ngrad
+
+        # Repeat the same optimization with the same cache
+        if clear_cache:
+            cached.clearCache()
+        opt = ParOpt.Optimizer(cached, options)
+        opt.optimize()
+
+        return prob.nobj - nobj, prob.ngrad - ngrad
+
+    def test_repeat_all_cached(self):
+        # All the points from the first run fit in the cache, so the
+        # second run does not evaluate the wrapped problem
+        nobj, ngrad = self.repeat_optimization(100)
+        self.assertEqual(nobj, 0)
+        self.assertEqual(ngrad, 0)
+
+        # After clearing the cache, the points are evaluated again
+        nobj, ngrad = self.repeat_optimization(100, clear_cache=True)
+        self.assertGreater(nobj, 0)
+        self.assertGreater(ngrad, 0)
+
+    def test_repeat_lru_eviction(self):
+        # With a single entry, the older points are evicted before they
+        # are requested again
+        nobj, ngrad = self.repeat_optimization(1)
+        self.assertGreater(nobj, 0)
+        self.assertGreater(ngrad, 0)
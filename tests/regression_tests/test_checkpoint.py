@@ -0,0 +1,111 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock
+
+
+class CheckpointTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def setUp(self):
+        self.fname = "paropt_checkpoint_test.bin"
+
+    def tearDown(self):
+        self.comm.Barrier()
+        if self.comm.rank == 0 and os.path.exists(self.fname):
+            os.remove(self.fname)
+
+    def gather(self, x):
+        return np.concatenate(self.comm.allgather(np.array(x[:])))
+
+    def run_interior_point(self, nvars, max_iters, read=False, write=False):
+        prob = Rosenbrock(self.comm, nvars)
+        options = {
+            "qn_subspace_size": 10,
+            "max_major_iters": max_iters,
+            "output_file": os.devnull,
+            "compress_checkpoint": self.compress,
+        }
+        opt = ParOpt.InteriorPoint(prob, options)
+        if read:
+            self.assertEqual(opt.readSolutionFile(self.fname), 0)
+        opt.optimize()
+        if write:
+            self.assertEqual(opt.writeSolutionFile(self.fname), 0)
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        return self.gather(x), z, self.gather(zl), self.gather(zu), prob.nobj
+
+    def run_trust_region(self, nvars, max_iters, read=False, write=False):
+        prob = Rosenbrock(self.comm, nvars)
+        qn = ParOpt.LBFGS(prob, subspace=10)
+        subproblem = ParOpt.QuadraticSubproblem(prob, qn)
+        options = {
+            "tr_init_size": 0.5,
+            "tr_max_iterations": max_iters,
+            "tr_output_file": os.devnull,
+        }
+        opt = ParOpt.InteriorPoint(subproblem, {"output_file": os.devnull})
+        tr = ParOpt.TrustRegion(subproblem, options)
+        if read:
+            self.assertEqual(tr.readCheckpointFile(self.fname), 0)
+        tr.optimize(opt)
+        if write:
+            self.assertEqual(tr.writeCheckpointFile(self.fname, self.compress), 0)
+        return self.gather(tr.getOptimizedPoint()), prob.nobj
+
+    def check_interior_point(self):
+        # The uninterrupted reference run
+        x0, z0, zl0, zu0, nobj0 = self.run_interior_point(10, 100)
+
+        # Stop after 10 iterations and write the checkpoint
+        self.run_interior_point(10, 10, write=True)
+
+        # Restart with the same and with a different distribution of the
+        # design variables. The restarted runs continue from the saved
+        # state, so they reach the same point with fewer evaluations
+        # than the reference run.
+        for nvars in [10, [7, 13][self.comm.rank]]:
+            x, z, zl, zu, nobj = self.run_interior_point(nvars, 100, read=True)
+            np.testing.assert_allclose(x, x0, rtol=1e-8, atol=1e-10)
+            np.testing.assert_allclose(z, z0, rtol=1e-6, atol=1e-10)
+            np.testing.assert_allclose(zl, zl0, rtol=1e-6, atol=1e-10)
+            np.testing.assert_allclose(zu, zu0, rtol=1e-6, atol=1e-10)
+            self.assertLess(nobj, nobj0 - 5)
+
+    def check_trust_region(self):
+        x0, nobj0 = self.run_trust_region(10, 100)
+        self.run_trust_region(10, 8, write=True)
+
+        # The radius, filter, penalty parameters and quasi-Newton pairs
+        # are restored, so the restarted run reproduces the remaining
+        # iterations of the reference run
+        for nvars in [10, [7, 13][self.comm.rank]]:
+            x, nobj = self.run_trust_region(nvars, 100, read=True)
+            np.testing.assert_allclose(x, x0, rtol=1e-12, atol=1e-14)
+            self.assertLess(nobj, nobj0 - 5)
+
+    def test_interior_point(self):
+        self.compress = False
+        self.check_interior_point()
+
+    def test_interior_point_compressed(self):
+        # Without zlib the file is written uncompressed
+        self.compress = True
+        self.check_interior_point()
+
+    def test_trust_region(self):
+        self.compress = False
+        self.check_trust_region()
+
+    def test_trust_region_compressed(self):
+        self.compress = True
+        self.check_trust_region()
+
+    def test_invalid_file(self):
+        # Reading a checkpoint for a problem of a different size fails
+        self.compress = False
+        self.run_interior_point(10, 2, write=True)
+        prob = Rosenbrock(self.comm, 12)
+        opt = ParOpt.InteriorPoint(prob, {"output_file": os.devnull})
+        self.assertNotEqual(opt.readSolutionFile(self.fname), 0)
@@ -0,0 +1,123 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+
+
+class CoupledProblem(ParOpt.Problem):
+    """
+    A convex problem with a coupling term between all design variables,
+    so that the Hessian is not diagonal,
+
+    f(x) = sum_i (0.25*(x_i - y_i)^4 + 0.5*d_i*x_i^2) + 0.5*c*S^2/N
+
+    where S is the sum of the design variables and N is the total number
+    of design variables. The constraint S/N >= 0.1 is active.
+    """
+
+    def __init__(self, comm, nvars):
+        self.comm = comm
+        self.ntotal = comm.allreduce(nvars)
+        offset = comm.rank * nvars
+        index = np.arange(offset, offset + nvars)
+        self.y = 1.0 + 0.2 * (index % 5)
+        self.d = 10.0 ** (index % 3)
+        self.c = 50.0
+        self.nhvec = 0
+        self.ndiag = 0
+        super().__init__(comm, nvars=nvars, ncon=1)
+
+    def getVarsAndBounds(self, x, lb, ub):
+        x[:] = 0.5
+        lb[:] = -2.0
+        ub[:] = 2.0
+
+    def evalObjCon(self, x):
+        x = np.array(x[:])
+        s = self.comm.allreduce(np.sum(x))
+        fobj = np.sum(0.25 * (x - self.y) ** 4 + 0.5 * self.d * x**2)
+        fobj = self.comm.allreduce(fobj) + 0.5 * self.c * s**2 / self.ntotal
+        con = np.array([s / self.ntotal - 0.1])
+        return 0, fobj, con
+
+    def evalObjConGradient(self, x, g, A):
+        x = np.array(x[:])
+        s = self.comm.allreduce(np.sum(x))
+        g[:] = (x - self.y) ** 3 + self.d * x + self.c * s / self.ntotal
+        A[0][:] = 1.0 / self.ntotal
+        return 0
+
+    def evalHvecProduct(self, x, z, zw, px, hvec):
+        self.nhvec += 1
+        x = np.array(x[:])
+        p = np.array(px[:])
+        s = self.comm.allreduce(np.sum(p))
+        h = 3.0 * (x - self.y) ** 2 + self.d
+        hvec[:] = h * p + self.c * s / self.ntotal
+        return 0
+
+    def evalHessianDiag(self, x, z, zw, hdiag):
+        self.ndiag += 1
+        x = np.array(x[:])
+        hdiag[:] = 3.0 * (x - self.y) ** 2 + self.d + self.c / self.ntotal
+        return 0
+
+
+class GMRESPreconTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, options):
+        prob = CoupledProblem(self.comm, 20)
+        opts = {
+            "qn_subspace_size": 10,
+            "abs_res_tol": 1e-10,
+            "max_major_iters": 200,
+            "use_hvec_product": True,
+            "gmres_subspace_size": 10,
+            "nk_switch_tol": 1e3,
+            "output_file": os.devnull,
+        }
+        opts.update(options)
+        opt = ParOpt.InteriorPoint(prob, opts)
+        opt.optimize()
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        return np.array(x[:]), z, prob
+
+    def test_quasi_newton(self):
+        x, z, prob = self.optimize({"gmres_precon_type": "quasi_newton"})
+        self.assertGreater(prob.nhvec, 0)
+        self.assertEqual(prob.ndiag, 0)
+
+        # Without a user-supplied preconditioner, the quasi-Newton
+        # preconditioner is used
+        xu, zu, probu = self.optimize({"gmres_precon_type": "user"})
+        np.testing.assert_array_equal(xu, x)
+        np.testing.assert_array_equal(zu, z)
+        self.assertEqual(probu.nhvec, prob.nhvec)
+        self.assertEqual(probu.ndiag, 0)
+
+    def test_diag_hessian(self):
+        xref, zref, prob = self.optimize({"use_hvec_product": False})
+        self.assertEqual(prob.nhvec, 0)
+
+        options = {"gmres_precon_type": "diag_hessian"}
+        for use_qn in [True, False]:
+            options["use_qn_gmres_precon"] = use_qn
+            x, z, prob = self.optimize(options)
+            self.assertGreater(prob.nhvec, 0)
+            self.assertGreater(prob.ndiag, 0)
+            np.testing.assert_allclose(x, xref, rtol=1e-6, atol=1e-8)
+            np.testing.assert_allclose(z, zref, rtol=1e-6)
+
+    def test_precon_refresh(self):
+        # Refreshing the Hessian diagonal less often reduces the number
+        # of evaluations but gives the same solution
+        options = {"gmres_precon_type": "diag_hessian"}
+        x0, z0, prob0 = self.optimize(options)
+
+        options["gmres_precon_refresh"] = 3
+        x, z, prob = self.optimize(options)
+        self.assertGreater(prob.ndiag, 0)
+        self.assertLess(prob.ndiag, prob0.ndiag)
+        np.testing.assert_allclose(x, x0, rtol=1e-6, atol=1e-8)
+        np.testing.assert_allclose(z, z0, rtol=1e-6)
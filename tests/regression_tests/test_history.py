@@ -0,0 +1,114 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock
+
+
+class HistoryTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def setUp(self):
+        self.output = "paropt_history_test.out"
+        self.history = "paropt_history_test.bin"
+
+    def tearDown(self):
+        self.comm.Barrier()
+        if self.comm.rank == 0:
+            for fname in [self.output, self.history]:
+                if os.path.exists(fname):
+                    os.remove(fname)
+
+    def optimize(self, options):
+        prob = Rosenbrock(self.comm, 10, x0=0.5, lb=0.0)
+        opts = {
+            "qn_subspace_size": 10,
+            "output_file": os.devnull,
+            "tr_output_file": os.devnull,
+            "mma_output_file": os.devnull,
+        }
+        opts.update(options)
+        opt = ParOpt.Optimizer(prob, opts)
+        opt.optimize()
+        self.comm.Barrier()
+
+    def compare(self, solver, unpack, int_cols, float_cols):
+        """
+        Compare the binary history with the columns of the text output
+        """
+        self.assertTrue(ParOpt.is_history_file(self.history))
+        self.assertFalse(ParOpt.is_history_file(self.output))
+
+        name, data = ParOpt.read_history(self.history)
+        self.assertEqual(name, solver)
+
+        text_args, text_objs = unpack(self.output)
+        args, objs = ParOpt.unpack_history(self.history)
+        self.assertEqual(args, list(data.dtype.names))
+        self.assertGreater(len(data), 1)
+        self.assertEqual(len(data), len(text_objs[0]))
+
+        for col in text_args:
+            self.assertIn(col, args)
+        for col in int_cols:
+            index = text_args.index(col)
+            np.testing.assert_array_equal(data[col], text_objs[index])
+            np.testing.assert_array_equal(objs[args.index(col)], data[col])
+        for col in float_cols:
+            index = text_args.index(col)
+            np.testing.assert_allclose(data[col], text_objs[index], rtol=1e-5)
+
+    def test_interior_point(self):
+        options = {
+            "algorithm": "ip",
+            "output_file": self.output,
+            "history_file": self.history,
+        }
+        self.optimize(options)
+        self.compare("ip", ParOpt.unpack_output, ["iter", "nobj", "ngrd"], ["fobj"])
+
+        # The quantities that are not set in the first iteration are NaN
+        name, data = ParOpt.read_history(self.history)
+        self.assertTrue(np.isnan(data["alpha"][0]))
+        self.assertFalse(np.any(np.isnan(data["alpha"][1:])))
+
+    def test_trust_region(self):
+        options = {
+            "algorithm": "tr",
+            "tr_init_size": 0.5,
+            "tr_max_iterations": 20,
+            "tr_output_file": self.output,
+            "tr_history_file": self.history,
+        }
+        self.optimize(options)
+        self.compare("tr", ParOpt.unpack_tr_output, ["iter"], ["fobj"])
+
+    def test_mma(self):
+        options = {
+            "algorithm": "mma",
+            "mma_max_iterations": 20,
+            "mma_output_file": self.output,
+            "mma_history_file": self.history,
+        }
+        self.optimize(options)
+        self.compare("mma", ParOpt.unpack_mma_output, ["MMA", "sub-iter"], ["fobj"])
+
+    def test_partial_row(self):
+        options = {"algorithm": "ip", "history_file": self.history}
+        self.optimize(options)
+        name, data = ParOpt.read_history(self.history)
+        nrows = len(data)
+        fobj = np.array(data["fobj"])
+        del data
+
+        # A file that is being written only returns the complete rows
+        if self.comm.rank == 0:
+            with open(self.history, "r+b") as fp:
+                fp.seek(0, 2)
+                fp.truncate(fp.tell() - 3)
+        self.comm.Barrier()
+
+        name, data = ParOpt.read_history(self.history)
+        self.assertEqual(len(data), nrows - 1)
+        np.testing.assert_array_equal(data["fobj"], fobj[:-1])
+        del data
@@ -0,0 +1,62 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock, RosenbrockFactory, get_local_size
+
+
+class LineSearchGroupsTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, num_groups, factory_ntotal=20):
+        ntotal = 20
+        options = {
+            "qn_subspace_size": 10,
+            "abs_res_tol": 1e-8,
+            "max_major_iters": 500,
+            "use_line_search": True,
+            "num_line_search_groups": num_groups,
+            "output_file": os.devnull,
+        }
+
+        prob = Rosenbrock(self.comm, get_local_size(self.comm, ntotal))
+        factory = RosenbrockFactory(factory_ntotal)
+        opt = ParOpt.InteriorPoint(prob, options)
+        opt.setLineSearchProblemFactory(factory)
+        opt.optimize()
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+
+        ngroup = 0
+        for p in factory.group_problems:
+            ngroup += p.nobj
+
+        return np.array(x[:]), np.array(z), prob.nobj, ngroup
+
+    def test_line_search_groups(self):
+        x0, z0, nobj0, ngroup0 = self.optimize(1)
+        x1, z1, nobj1, ngroup1 = self.optimize(2)
+
+        # The groups are not used with a single group
+        self.assertEqual(ngroup0, 0)
+
+        # The groups evaluate the trial points and return the same
+        # solution as the sequential line search
+        self.assertGreater(ngroup1, 0)
+        np.testing.assert_allclose(x0, x1, rtol=1e-6, atol=1e-8)
+        np.testing.assert_allclose(z0, z1, rtol=1e-6, atol=1e-8)
+
+        # The trial points accepted on the groups are not evaluated
+        # again on the original problem
+        self.assertLess(nobj1, nobj0)
+
+    def test_incompatible_factory(self):
+        x0, z0, nobj0, ngroup0 = self.optimize(1)
+
+        # The problem instances from the factory have a different
+        # number of variables, so the groups cannot be used and the
+        # sequential line search is used instead
+        x1, z1, nobj1, ngroup1 = self.optimize(2, factory_ntotal=21)
+        self.assertEqual(ngroup1, 0)
+        self.assertEqual(nobj0, nobj1)
+        np.testing.assert_array_equal(x0, x1)
+        np.testing.assert_array_equal(z0, z1)
@@ -0,0 +1,118 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+
+
+class Quadratic(ParOpt.Problem):
+    """
+    A problem with a quadratic objective and two linear constraints. The
+    second constraint is active at the optimum, while the first is not.
+
+    When the problem is declared linear, the constraint gradients are
+    only correct on the first gradient evaluation. Afterwards NaN is
+    written to every Ac[i], since these vectors are scratch space whose
+    values must be discarded by the optimizer.
+    """
+
+    def __init__(self, comm, nvars, linear=False):
+        self.comm = comm
+        self.linear = linear
+        self.ntotal = comm.allreduce(nvars)
+        self.num_grad = 0
+        offset = comm.rank * nvars
+        index = np.arange(offset, offset + nvars)
+        self.w = 1.0 + (index % 5)
+        self.y = 1.0 + 0.1 * (index % 4)
+        self.a = 1.0 + 0.5 * (index % 3)
+        super().__init__(
+            comm,
+            nvars=nvars,
+            ncon=2,
+            obj_quadratic=linear,
+            dense_con_linear=[linear, linear],
+        )
+
+    def getVarsAndBounds(self, x, lb, ub):
+        x[:] = 1.0
+        lb[:] = 0.1
+        ub[:] = 2.0
+
+    def evalObjCon(self, x):
+        x = np.array(x[:])
+        fobj = self.comm.allreduce(np.sum(self.w * (x - self.y) ** 2))
+        xsum = self.comm.allreduce(np.sum(x))
+        axsum = self.comm.allreduce(np.sum(self.a * x))
+        con = np.array([1.5 - xsum / self.ntotal, 1.0 - axsum / self.ntotal])
+        return 0, fobj, con
+
+    def evalObjConGradient(self, x, g, A):
+        x = np.array(x[:])
+        g[:] = 2.0 * self.w * (x - self.y)
+        if self.linear and self.num_grad > 0:
+            A[0][:] = np.nan
+            A[1][:] = np.nan
+        else:
+            A[0][:] = -1.0 / self.ntotal
+            A[1][:] = -self.a / self.ntotal
+        self.num_grad += 1
+        return 0
+
+
+class LinearityTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, algorithm, linear, presolve=False):
+        prob = Quadratic(self.comm, 10, linear=linear)
+        opt_prob = prob
+        if presolve:
+            opt_prob = ParOpt.PresolvedProblem(prob)
+
+        if algorithm == "mma":
+            options = {
+                "algorithm": "mma",
+                "mma_max_iterations": 200,
+                "output_file": os.devnull,
+                "mma_output_file": os.devnull,
+            }
+            opt = ParOpt.Optimizer(opt_prob, options)
+            opt.optimize()
+            x, z, zw, zl, zu = opt.getOptimizedPoint()
+        else:
+            options = {
+                "qn_subspace_size": 10,
+                "abs_res_tol": 1e-10,
+                "max_major_iters": 500,
+                "output_file": os.devnull,
+            }
+            opt = ParOpt.InteriorPoint(opt_prob, options)
+            opt.optimize()
+            x, z, zw, zl, zu = opt.getOptimizedPoint()
+            if presolve:
+                x, z, zw, zl, zu = opt_prob.postsolve(x, z, zw, zl, zu)
+
+        fail, fobj, con = prob.evalObjCon(x)
+        return np.array(x[:]), np.array(z), fobj, con, prob.num_grad
+
+    def check_linear(self, algorithm, presolve=False):
+        x0, z0, fobj0, con0, ngrad0 = self.optimize(algorithm, False, presolve)
+        x, z, fobj, con, ngrad = self.optimize(algorithm, True, presolve)
+
+        # The stored constraint gradients are used after the first
+        # evaluation, so the NaN values written later are never seen
+        self.assertGreater(ngrad, 1)
+        self.assertTrue(np.all(np.isfinite(x)))
+        np.testing.assert_allclose(x, x0, rtol=1e-6, atol=1e-8)
+        np.testing.assert_allclose(z, z0, rtol=1e-5, atol=1e-6)
+        self.assertAlmostEqual(fobj, fobj0, delta=1e-6 * abs(fobj0))
+        self.assertGreater(con[0], 0.0)
+        self.assertAlmostEqual(con[1], 0.0, delta=1e-6)
+
+    def test_interior_point(self):
+        self.check_linear("ip")
+
+    def test_mma(self):
+        self.check_linear("mma")
+
+    def test_presolve(self):
+        self.check_linear("ip", presolve=True)
@@ -0,0 +1,251 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock
+
+
+class Compliance(ParOpt.Problem):
+    """
+    A convex problem with reciprocal terms in the objective, similar to
+    the compliance of a truss, and two linear constraints. The second
+    constraint is active at the optimum, while the first is not.
+    """
+
+    def __init__(self, comm, nvars):
+        self.comm = comm
+        self.ntotal = comm.allreduce(nvars)
+        offset = comm.rank * nvars
+        index = np.arange(offset, offset + nvars)
+        self.w = 1.0 + (index % 5)
+        self.a = 1.0 + 0.5 * (index % 3)
+        super().__init__(comm, nvars=nvars, ncon=2)
+
+    def getVarsAndBounds(self, x, lb, ub):
+        x[:] = 1.0
+        lb[:] = 0.1
+        ub[:] = 2.0
+
+    def evalObjCon(self, x):
+        x = np.array(x[:])
+        fobj = self.comm.allreduce(np.sum(self.w / x))
+        xsum = self.comm.allreduce(np.sum(x))
+        axsum = self.comm.allreduce(np.sum(self.a * x))
+        con = np.array([0.5 - xsum / self.ntotal, 0.6 - axsum / self.ntotal])
+        return 0, fobj, con
+
+    def evalObjConGradient(self, x, g, A):
+        x = np.array(x[:])
+        g[:] = -self.w / x**2
+        A[0][:] = -1.0 / self.ntotal
+        A[1][:] = -self.a / self.ntotal
+        return 0
+
+
+class MixedRosenbrock(Rosenbrock):
+    """
+    The shared Rosenbrock problem with a second constraint whose gradient
+    changes sign, so that both terms of the MMA constraint approximation
+    are used
+    """
+
+    def __init__(self, comm, nvars):
+        super().__init__(comm, nvars, cmean=(0.5, 0.1))
+        self.w = self.y - 0.55
+
+    def gradients(self, x):
+        g, a = self.evalGradient(x)
+        return g, [a, -self.w / self.ntotal]
+
+    def evalObjCon(self, x):
+        fail, fobj, con = super().evalObjCon(x)
+        con[1] = 0.1 - self.comm.allreduce(np.sum(self.w * x[:])) / self.ntotal
+        return fail, fobj, con
+
+    def evalObjConGradient(self, x, g, A):
+        self.ngrad += 1
+        g[:], A1 = self.gradients(np.array(x[:]))
+        A[0][:], A[1][:] = A1
+        return 0
+
+
+class MMASubproblemTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def setUp(self):
+        self.history = "paropt_mma_subproblem_test.bin"
+
+    def tearDown(self):
+        self.comm.Barrier()
+        if self.comm.rank == 0 and os.path.exists(self.history):
+            os.remove(self.history)
+
+    def optimize(self, options):
+        prob = Compliance(self.comm, 10)
+        opts = {
+            "algorithm": "mma",
+            "mma_max_iterations": 200,
+            "output_file": os.devnull,
+            "mma_output_file": os.devnull,
+            "mma_history_file": self.history,
+        }
+        opts.update(options)
+        opt = ParOpt.Optimizer(prob, opts)
+        opt.optimize()
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        fail, fobj, con = prob.evalObjCon(x)
+        return np.array(x[:]), z, fobj, con
+
+    def read_history(self):
+        self.comm.Barrier()
+        name, data = ParOpt.read_history(self.history)
+        return np.array(data)
+
+    def test_dual_solver(self):
+        x0, z0, fobj0, con0 = self.optimize({})
+        self.assertGreater(z0[1], 1.0)
+
+        # The dual method solves the same subproblems, so it reaches the
+        # same optimum to the convergence tolerance
+        for low_memory in [False, True]:
+            options = {
+                "mma_subproblem_solver": "dual",
+                "mma_low_memory": low_memory,
+            }
+            x, z, fobj, con = self.optimize(options)
+            np.testing.assert_allclose(x, x0, rtol=1e-5)
+            np.testing.assert_allclose(z, z0, rtol=1e-4, atol=1e-4)
+            self.assertAlmostEqual(fobj, fobj0, delta=1e-6 * fobj0)
+            self.assertGreaterEqual(con[0], 0.0)
+            self.assertAlmostEqual(con[1], 0.0, delta=1e-6)
+
+    def test_dual_fallback(self):
+        # With too few dual iterations the dual method does not converge
+        # and the subproblem is solved with the interior-point method
+        x0, z0, fobj0, con0 = self.optimize({})
+        options = {
+            "mma_subproblem_solver": "dual",
+            "mma_dual_max_iterations": 1,
+        }
+        x, z, fobj, con = self.optimize(options)
+        np.testing.assert_allclose(x, x0, rtol=1e-5)
+        np.testing.assert_allclose(z, z0, rtol=1e-4, atol=1e-4)
+        self.assertAlmostEqual(fobj, fobj0, delta=1e-6 * fobj0)
+
+    def check_low_memory(self, options):
+        # Recomputing the coefficients of the approximation instead of
+        # storing them gives the same iterates
+        x0, z0, fobj0, con0 = self.optimize(options)
+        hist0 = self.read_history()
+        options["mma_low_memory"] = True
+        x, z, fobj, con = self.optimize(options)
+        hist = self.read_history()
+
+        self.assertGreater(len(hist0), 1)
+        self.assertEqual(len(hist), len(hist0))
+        for name in hist0.dtype.names:
+            np.testing.assert_allclose(hist[name], hist0[name], rtol=1e-12)
+        np.testing.assert_allclose(x, x0, rtol=1e-12)
+        np.testing.assert_allclose(z, z0, rtol=1e-12, atol=1e-14)
+
+    def test_low_memory_interior_point(self):
+        self.check_low_memory({"mma_subproblem_solver": "interior_point"})
+
+    def test_low_memory_dual(self):
+        self.check_low_memory({"mma_subproblem_solver": "dual"})
+
+    def test_low_memory_constraint_linearization(self):
+        self.check_low_memory({"mma_use_constraint_linearization": True})
+
+    def check_approximation(self, prob, mma, eps, delta, linearized):
+        """
+        Evaluate the MMA approximation about the last iterate directly
+        from its definition and compare it with the subproblem
+        """
+        x0 = np.array(mma.getOptimizedPoint()[:])
+        L, U = mma.getAsymptotes()
+        L = np.array(L[:])
+        U = np.array(U[:])
+        fail, f0, c0 = prob.evalObjCon(mma.getOptimizedPoint())
+        g0, A0 = prob.gradients(x0)
+
+        # Pick a trial point between the asymptotes
+        s = np.sin(np.arange(len(x0)) + self.comm.rank)
+        xt = np.where(s > 0.0, x0 + 0.5 * s * (U - x0), x0 + 0.5 * s * (x0 - L))
+        Uinv = 1.0 / (U - xt)
+        Linv = 1.0 / (xt - L)
+        z = np.array([0.3, 0.7])
+
+        # The objective approximation
+        gpos = np.maximum(0.0, g0)
+        gneg = np.maximum(0.0, -g0)
+        reg = eps / (U - L)
+        p0 = (U - x0) ** 2 * ((1.0 + delta) * gpos + delta * gneg + reg)
+        q0 = (x0 - L) ** 2 * ((1.0 + delta) * gneg + delta * gpos + reg)
+        fobj = self.comm.allreduce(np.sum(p0 * Uinv + q0 * Linv))
+        g = p0 * Uinv**2 - q0 * Linv**2
+        hdiag = 2.0 * (p0 * Uinv**3 + q0 * Linv**3)
+
+        # The constraint approximation, one constraint at a time
+        con = np.zeros(len(c0))
+        A = []
+        for i, Ai in enumerate(A0):
+            if linearized:
+                con[i] = c0[i] + self.comm.allreduce(np.dot(Ai, xt - x0))
+                A.append(Ai)
+            else:
+                pi = (U - x0) ** 2 * np.maximum(0.0, -Ai)
+                qi = (x0 - L) ** 2 * np.maximum(0.0, Ai)
+                b = -(
+                    c0[i] + self.comm.allreduce(np.sum(pi / (U - x0) + qi / (x0 - L)))
+                )
+                con[i] = -(self.comm.allreduce(np.sum(pi * Uinv + qi * Linv)) + b)
+                A.append(qi * Linv**2 - pi * Uinv**2)
+                hdiag += 2.0 * z[i] * (pi * Uinv**3 + qi * Linv**3)
+
+        x = mma.createDesignVec()
+        x[:] = xt
+        fail, fobj1, con1 = mma.evalObjCon(x)
+        self.assertEqual(fail, 0)
+        self.assertAlmostEqual(fobj1, fobj, delta=1e-12 * abs(fobj))
+        np.testing.assert_allclose(con1, con, rtol=1e-12, atol=1e-14)
+
+        g1 = mma.createDesignVec()
+        A1 = [mma.createDesignVec() for i in range(len(c0))]
+        self.assertEqual(mma.evalObjConGradient(x, g1, A1), 0)
+        np.testing.assert_allclose(g1[:], g, rtol=1e-12, atol=1e-14)
+        for i in range(len(c0)):
+            np.testing.assert_allclose(A1[i][:], A[i], rtol=1e-12, atol=1e-14)
+
+        h1 = mma.createDesignVec()
+        self.assertEqual(mma.evalHessianDiag(x, z, h1), 0)
+        np.testing.assert_allclose(h1[:], hdiag, rtol=1e-12, atol=1e-14)
+
+    def check_fused_kernels(self, options):
+        # Use more variables than two blocks of the kernels on each
+        # processor, with a partial last block
+        eps = 1e-3
+        delta = 1e-5
+        prob = MixedRosenbrock(self.comm, 600)
+        opts = {
+            "mma_max_iterations": 3,
+            "mma_eps_regularization": eps,
+            "mma_delta_regularization": delta,
+            "mma_output_file": os.devnull,
+        }
+        opts.update(options)
+        mma = ParOpt.MMA(prob, opts)
+        opt = ParOpt.InteriorPoint(mma, {"output_file": os.devnull})
+        mma.optimize(opt)
+
+        linearized = options.get("mma_use_constraint_linearization", False)
+        self.check_approximation(prob, mma, eps, delta, linearized)
+
+    def test_fused_kernels(self):
+        self.check_fused_kernels({})
+
+    def test_fused_kernels_low_memory(self):
+        self.check_fused_kernels({"mma_low_memory": True})
+
+    def test_fused_kernels_constraint_linearization(self):
+        self.check_fused_kernels({"mma_use_constraint_linearization": True})
@@ -0,0 +1,263 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock
+
+
+def fixed_rosenbrock(comm, nvars, reduced=False, redundant=False):
+    """
+    Create the Rosenbrock problem where every third variable is fixed by
+    setting equal lower and upper bounds. If redundant is True, a second
+    linear constraint that can never be active is added, which is
+    removed by the presolve.
+    """
+    offset = comm.rank * nvars
+    fixed = (np.arange(offset, offset + nvars) % 3) == 0
+    cmean = (0.5, 3.0) if redundant else (0.5,)
+    return Rosenbrock(
+        comm,
+        nvars,
+        cmean=cmean,
+        fixed=fixed,
+        reduced=reduced,
+        dense_con_linear=[True] * len(cmean),
+    )
+
+
+class SparseQuadratic(ParOpt.Problem):
+    """
+    A quadratic problem with a linear dense constraint and sparse linear
+    constraints that bound the sum of each pair of variables.
+
+    The last variable is fixed. The sparse constraints also include a
+    row that only depends on the fixed variable and a looser duplicate
+    of the first pair, which are both removed by the presolve. If
+    reduced is True, the fixed variable and the removed rows are
+    removed by hand.
+    """
+
+    def __init__(self, comm, npairs, reduced=False):
+        self.comm = comm
+        self.reduced = reduced
+        self.npairs = npairs
+        nvars = 2 * npairs + 1
+        self.ntotal = comm.allreduce(nvars)
+        offset = comm.rank * nvars
+        index = np.arange(offset, offset + nvars)
+        self.w = 1.0 + (index % 5)
+        self.y = 1.0 + 0.1 * (index % 4)
+        self.s = 1.8 + 0.2 * (np.arange(npairs) % 2)
+        self.xfixed = 0.5
+
+        # The rows of the sparse constraints and their bounds. Each row
+        # is the bound minus the sum of its variables.
+        self.rows = [[2 * k, 2 * k + 1] for k in range(npairs)]
+        self.bounds = list(self.s)
+        self.kept = list(range(npairs))
+        if reduced:
+            self.free = np.arange(nvars - 1)
+        else:
+            self.free = np.arange(nvars)
+            self.rows.insert(1, [nvars - 1])
+            self.bounds.insert(1, 1.0)
+            self.rows.insert(3, [0, 1])
+            self.bounds.insert(3, self.s[0] + 0.5)
+            self.kept = [0, 2, 4] + list(range(5, npairs + 2))
+
+        rowp = [0]
+        cols = []
+        for row in self.rows:
+            cols.extend(row)
+            rowp.append(len(cols))
+
+        super().__init__(
+            comm,
+            nvars=len(self.free),
+            ncon=1,
+            nwcon=len(self.rows),
+            rowp=rowp,
+            cols=cols,
+            obj_quadratic=True,
+            dense_con_linear=[True],
+            sparse_con_linear=True,
+        )
+
+    def expand(self, x):
+        xfull = self.xfixed * np.ones(len(self.y))
+        xfull[self.free] = x[:]
+        return xfull
+
+    def getVarsAndBounds(self, x, lb, ub):
+        x[:] = 0.5
+        lb[:] = 0.0
+        ub[:] = 2.0
+        if not self.reduced:
+            x[len(self.y) - 1] = self.xfixed
+            lb[len(self.y) - 1] = self.xfixed
+            ub[len(self.y) - 1] = self.xfixed
+
+    def evalSparseObjCon(self, x, sparse_cons):
+        x = self.expand(x)
+        fobj = self.comm.allreduce(np.sum(self.w * (x - self.y) ** 2))
+        xsum = self.comm.allreduce(np.sum(x))
+        for i, row in enumerate(self.rows):
+            sparse_cons[i] = self.bounds[i] - np.sum(x[row])
+        return 0, fobj, np.array([1.5 - xsum / self.ntotal])
+
+    def evalSparseObjConGradient(self, x, g, A, data):
+        x = self.expand(x)
+        g[:] = (2.0 * self.w * (x - self.y))[self.free]
+        A[0][:] = -1.0 / self.ntotal
+        data[:] = -1.0
+        return 0
+
+    def evalGradient(self, x):
+        g = 2.0 * self.w * (x - self.y)
+        a = -np.ones(len(x)) / self.ntotal
+        return g, a
+
+
+class PresolvedProblemTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, prob):
+        options = {
+            "qn_subspace_size": 10,
+            "abs_res_tol": 1e-10,
+            "max_major_iters": 500,
+            "output_file": os.devnull,
+        }
+        opt = ParOpt.InteriorPoint(prob, options)
+        opt.optimize()
+        return opt.getOptimizedPoint()
+
+    def check_postsolve(self, prob, presolved, ref, ncon, kept):
+        """
+        Solve the presolved problem and the problem reduced by hand and
+        check the solution and multipliers recovered by the postsolve.
+        The kept dense constraints of prob are given by kept.
+        """
+        nvars = len(prob.y)
+
+        # Solve the presolved problem and recover the full solution
+        xr, zr, zwr, zlr, zur = self.optimize(presolved)
+        self.assertEqual(len(zr), len(kept))
+        x, z, zw, zl, zu = presolved.postsolve(xr, zr, zwr, zlr, zur)
+        x = np.array(x[:])
+        zl = np.array(zl[:])
+        zu = np.array(zu[:])
+        self.assertEqual(len(x), nvars)
+        self.assertEqual(len(z), ncon)
+
+        # The optimizer sees the same reduced problem in both cases
+        xref, zref, zwref, zlref, zuref = self.optimize(ref)
+
+        free = ref.free
+        fixed = np.setdiff1d(np.arange(nvars), free)
+        removed = np.setdiff1d(np.arange(ncon), kept)
+        np.testing.assert_allclose(x[free], xref[:], rtol=1e-10, atol=1e-12)
+        np.testing.assert_allclose(x[fixed], prob.xfixed)
+        np.testing.assert_allclose(z[kept], zref, rtol=1e-10, atol=1e-12)
+        np.testing.assert_array_equal(z[removed], 0.0)
+        np.testing.assert_allclose(zl[free], zlref[:], rtol=1e-10, atol=1e-12)
+        np.testing.assert_allclose(zu[free], zuref[:], rtol=1e-10, atol=1e-12)
+
+        # The bound multipliers of the fixed variables satisfy the
+        # stationarity condition g - A^{T}*z - zl + zu = 0. All of the
+        # dense constraints have the same gradient.
+        g, a = prob.evalGradient(x)
+        r = g - np.sum(z) * a - zl + zu
+        np.testing.assert_allclose(r[fixed], 0.0, atol=1e-12)
+        return x, z, zw, zl, zu, zwref, r
+
+    def test_presolve_postsolve(self):
+        nvars = 10
+        prob = fixed_rosenbrock(self.comm, nvars)
+        presolved = ParOpt.PresolvedProblem(prob)
+
+        # Every third variable is fixed and no constraints are removed
+        stats = presolved.getPresolveStats()
+        nfixed = self.comm.allreduce(int(np.sum(prob.fixed)))
+        self.assertEqual(stats["num_fixed"], nfixed)
+        self.assertEqual(stats["num_dense_removed"], 0)
+
+        # Solve the problem with the fixed variables removed by hand
+        ref = fixed_rosenbrock(self.comm, nvars, reduced=True)
+        x, z, zw, zl, zu, zwref, r = self.check_postsolve(prob, presolved, ref, 1, [0])
+        self.assertIsNone(zw)
+        fixed = np.nonzero(prob.fixed)[0]
+        self.assertTrue(np.all(zl >= 0.0))
+        self.assertTrue(np.all(zu >= 0.0))
+        self.assertTrue(np.all(zl[fixed] * zu[fixed] == 0.0))
+        self.assertGreater(np.max(zl[fixed] + zu[fixed]), 0.0)
+
+        # The full solution satisfies the stationarity condition for
+        # the free variables to the tolerance of the optimizer
+        np.testing.assert_allclose(r, 0.0, atol=1e-8)
+
+    def test_remove_dense_constraint(self):
+        nvars = 10
+        prob = fixed_rosenbrock(self.comm, nvars, redundant=True)
+        presolved = ParOpt.PresolvedProblem(prob)
+
+        # The second linear constraint is positive over the bounds
+        stats = presolved.getPresolveStats()
+        nfixed = self.comm.allreduce(int(np.sum(prob.fixed)))
+        self.assertEqual(stats["num_fixed"], nfixed)
+        self.assertEqual(stats["num_dense_removed"], 1)
+        self.assertEqual(stats["num_sparse_removed"], 0)
+
+        # The reduced problem is the same as the problem with the fixed
+        # variables and the redundant constraint removed by hand
+        ref = fixed_rosenbrock(self.comm, nvars, reduced=True)
+        self.assertEqual(len(presolved.createDesignVec()), len(ref.free))
+        x, z, zw, zl, zu, zwref, r = self.check_postsolve(prob, presolved, ref, 2, [0])
+        self.assertIsNone(zw)
+        np.testing.assert_allclose(r, 0.0, atol=1e-8)
+
+    def test_remove_sparse_constraints(self):
+        npairs = 5
+        prob = SparseQuadratic(self.comm, npairs)
+        presolved = ParOpt.PresolvedProblem(prob)
+
+        # The row of the fixed variable and the looser duplicate row
+        # are removed on each processor
+        stats = presolved.getPresolveStats()
+        self.assertEqual(stats["num_fixed"], self.comm.size)
+        self.assertEqual(stats["num_dense_removed"], 0)
+        self.assertEqual(stats["num_sparse_removed"], 2 * self.comm.size)
+
+        ref = SparseQuadratic(self.comm, npairs, reduced=True)
+        self.assertEqual(len(presolved.createDesignVec()), 2 * npairs)
+        self.assertEqual(len(presolved.createConstraintVec()), npairs)
+        x, z, zw, zl, zu, zwref, r = self.check_postsolve(prob, presolved, ref, 1, [0])
+
+        # The multipliers of the removed rows are zero and the kept rows
+        # have the multipliers of the problem reduced by hand
+        zw = np.array(zw[:])
+        removed = np.setdiff1d(np.arange(len(prob.rows)), prob.kept)
+        np.testing.assert_allclose(zw[prob.kept], zwref[:], rtol=1e-10, atol=1e-12)
+        np.testing.assert_array_equal(zw[removed], 0.0)
+        self.assertGreater(np.max(zw), 0.0)
+
+        # Check the stationarity of the full solution including the
+        # sparse constraints, which all have -1 entries
+        for i, row in enumerate(prob.rows):
+            r[row] += zw[i]
+        np.testing.assert_allclose(r, 0.0, atol=1e-8)
+
+    def test_no_fixed_variables(self):
+        # Without fixed variables the presolved problem is identical
+        prob = Rosenbrock(self.comm, 10)
+        presolved = ParOpt.PresolvedProblem(prob)
+        stats = presolved.getPresolveStats()
+        self.assertEqual(stats["num_fixed"], 0)
+
+        xr, zr, zwr, zlr, zur = self.optimize(presolved)
+        x, z, zw, zl, zu = presolved.postsolve(xr, zr, zwr, zlr, zur)
+        xref, zref, zwref, zlref, zuref = self.optimize(prob)
+        np.testing.assert_array_equal(x[:], xref[:])
+        np.testing.assert_array_equal(z, zref)
+        np.testing.assert_array_equal(zl[:], zlref[:])
+        np.testing.assert_array_equal(zu[:], zuref[:])
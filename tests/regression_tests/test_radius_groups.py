@@ -0,0 +1,80 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock, RosenbrockFactory, get_local_size
+
+
+class RadiusGroupsTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, num_groups, strategy, factory_ntotal=20):
+        ntotal = 20
+        options = {
+            "tr_init_size": 2.0,
+            "tr_max_iterations": 100,
+            "tr_num_radius_groups": num_groups,
+            "tr_accept_step_strategy": strategy,
+            "tr_output_file": os.devnull,
+        }
+
+        # The radius groups are not used after a restoration step, so the
+        # feasibility restoration is turned off for the filter method
+        if strategy == "filter_method":
+            options["filter_has_feas_restore_phase"] = False
+
+        prob = Rosenbrock(self.comm, get_local_size(self.comm, ntotal))
+        qn = ParOpt.LBFGS(prob, subspace=10)
+        subproblem = ParOpt.QuadraticSubproblem(prob, qn)
+        opt = ParOpt.InteriorPoint(subproblem, {"output_file": os.devnull})
+        tr = ParOpt.TrustRegion(subproblem, options)
+        factory = RosenbrockFactory(factory_ntotal)
+        tr.setRadiusProblemFactory(factory)
+        tr.optimize(opt)
+        x = tr.getOptimizedPoint()
+
+        ngroup = 0
+        for p in factory.group_problems:
+            ngroup += p.nobj
+        ngroup = self.comm.allreduce(ngroup)
+
+        return np.array(x[:]), prob.nobj, ngroup
+
+    def check_radius_groups(self, strategy):
+        x0, nobj0, ngroup0 = self.optimize(1, strategy)
+        x1, nobj1, ngroup1 = self.optimize(2, strategy)
+
+        # The groups are not used with a single group
+        self.assertEqual(ngroup0, 0)
+
+        # The largest acceptable radius is the radius that is accepted by
+        # the sequential update, so the iterates are the same
+        np.testing.assert_allclose(x0, x1, rtol=1e-12, atol=1e-14)
+
+        # Steps are rejected, so the trial points are evaluated on the
+        # groups
+        self.assertGreater(ngroup1, 0)
+        return nobj0, nobj1
+
+    def test_penalty_method(self):
+        # The selected trial point is evaluated again on the original
+        # problem before the gradient evaluation, which takes the place
+        # of the evaluation in the sequential update
+        nobj0, nobj1 = self.check_radius_groups("penalty_method")
+        self.assertEqual(nobj0, nobj1)
+
+    def test_filter_method(self):
+        # More than one radius is rejected in a row, and the rejected
+        # trial points are only evaluated on the groups
+        nobj0, nobj1 = self.check_radius_groups("filter_method")
+        self.assertLess(nobj1, nobj0)
+
+    def test_incompatible_factory(self):
+        x0, nobj0, ngroup0 = self.optimize(1, "penalty_method")
+
+        # The problem instances from the factory have a different
+        # number of variables, so the sequential radius update is used
+        x1, nobj1, ngroup1 = self.optimize(2, "penalty_method", factory_ntotal=21)
+        self.assertEqual(ngroup1, 0)
+        self.assertEqual(nobj0, nobj1)
+        np.testing.assert_array_equal(x0, x1)
@@ -0,0 +1,144 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from mpi4py import MPI
+
+
+class PoorlyScaled(ParOpt.Problem):
+    """
+    A convex quadratic problem with a large objective, a small
+    constraint and design variables that vary over several orders of
+    magnitude
+    """
+
+    def __init__(self, comm, nvars):
+        self.comm = comm
+        self.ntotal = comm.allreduce(nvars)
+        offset = comm.rank * nvars
+        index = np.arange(offset, offset + nvars)
+        self.s = 10.0 ** (index % 4)
+        self.y = 0.3 + 0.5 * (index % 7) / 7.0
+        super().__init__(comm, nvars=nvars, ncon=1)
+
+    def getVarsAndBounds(self, x, lb, ub):
+        x[:] = 0.1 * self.s
+        lb[:] = 0.0
+        ub[:] = 2.0 * self.s
+
+    def evalObjCon(self, x):
+        u = x[:] / self.s
+        fobj = 1e6 * self.comm.allreduce(np.sum((u - self.y) ** 2))
+        usum = self.comm.allreduce(np.sum(u))
+        con = np.array([1e-3 * (0.4 - usum / self.ntotal)])
+        return 0, fobj, con
+
+    def evalObjConGradient(self, x, g, A):
+        u = x[:] / self.s
+        g[:] = 2e6 * (u - self.y) / self.s
+        A[0][:] = -1e-3 / (self.ntotal * self.s)
+        return 0
+
+
+class ScaledProblemTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, prob):
+        options = {
+            "qn_subspace_size": 10,
+            "abs_res_tol": 1e-10,
+            "max_major_iters": 500,
+            "output_file": os.devnull,
+        }
+        opt = ParOpt.InteriorPoint(prob, options)
+        opt.optimize()
+        return opt.getOptimizedPoint()
+
+    def get_solution(self, prob):
+        # The constraint is active and none of the bounds are active, so
+        # the solution shifts the scaled variables by a constant
+        ybar = self.comm.allreduce(np.sum(prob.y)) / prob.ntotal
+        x = prob.s * (prob.y - (ybar - 0.4))
+        z = 2e9 * prob.ntotal * (ybar - 0.4)
+        return x, z
+
+    def test_scaling(self):
+        prob = PoorlyScaled(self.comm, 8)
+        options = {"scaling_max_gradient": 10.0, "scaling_min_gradient": 1.0}
+        scaled = ParOpt.ScaledProblem(prob, options)
+        fscale, cscale, dscale = scaled.getScaling()
+
+        # The scaled gradients at the starting point are within range
+        x = prob.createDesignVec()
+        lb = prob.createDesignVec()
+        ub = prob.createDesignVec()
+        prob.getVarsAndBounds(x, lb, ub)
+        g = prob.createDesignVec()
+        A = [prob.createDesignVec()]
+        prob.evalObjConGradient(x, g, A)
+
+        gmax = self.comm.allreduce(np.max(np.abs(g[:])), op=MPI.MAX)
+        amax = self.comm.allreduce(np.max(np.abs(A[0][:])), op=MPI.MAX)
+        self.assertAlmostEqual(fscale * gmax, 10.0)
+        self.assertAlmostEqual(cscale[0] * amax, 1.0)
+
+        # The variable scale factors are limited by the default range
+        d = np.array(dscale[:])
+        self.assertTrue(np.all(d >= 1e-2 * (1.0 - 1e-12)))
+        self.assertTrue(np.all(d <= 1e2 * (1.0 + 1e-12)))
+        self.assertGreater(self.comm.allreduce(np.max(d), op=MPI.MAX), 1.0)
+
+        # A range of 1.0 leaves the design variables unscaled
+        scaled = ParOpt.ScaledProblem(prob, {"scaling_variable_range": 1.0})
+        fscale, cscale, dscale = scaled.getScaling()
+        np.testing.assert_array_equal(dscale[:], 1.0)
+
+    def test_unscale_solution(self):
+        prob = PoorlyScaled(self.comm, 8)
+        scaled = ParOpt.ScaledProblem(prob, {"scaling_min_gradient": 1.0})
+
+        # Solve the scaled problem and recover the original solution
+        xs, zs, zws, zls, zus = self.optimize(scaled)
+        x, z, zw, zl, zu = scaled.unscaleSolution(xs, zs, zws, zls, zus)
+        self.assertIsNone(zw)
+
+        xopt, zopt = self.get_solution(prob)
+        np.testing.assert_allclose(x[:], xopt, rtol=1e-6)
+        np.testing.assert_allclose(z[0], zopt, rtol=1e-6)
+        np.testing.assert_allclose(zl[:], 0.0, atol=1e-6 * zopt)
+        np.testing.assert_allclose(zu[:], 0.0, atol=1e-6 * zopt)
+
+        # Check the stationarity of the Lagrangian of the original
+        # problem at the recovered solution
+        g = prob.createDesignVec()
+        A = [prob.createDesignVec()]
+        prob.evalObjConGradient(x, g, A)
+        r = g[:] - z[0] * A[0][:] - zl[:] + zu[:]
+        np.testing.assert_allclose(r, 0.0, atol=1e-6 * np.max(np.abs(g[:])))
+
+    def test_update_scaling(self):
+        prob = PoorlyScaled(self.comm, 8)
+        scaled = ParOpt.ScaledProblem(prob, {"scaling_min_gradient": 1.0})
+        fscale0, cscale0, dscale0 = scaled.getScaling()
+
+        # The objective gradient is smaller at the solution, so the
+        # objective scale factor increases
+        xopt, zopt = self.get_solution(prob)
+        x = prob.createDesignVec()
+        x[:] = xopt
+        self.assertEqual(scaled.updateScaling(x), 0)
+        fscale1, cscale1, dscale1 = scaled.getScaling()
+        self.assertGreater(fscale1, fscale0)
+
+        # The updated point is used as the new starting point
+        xs, zs, zws, zls, zus = self.optimize(scaled)
+        x, z, zw, zl, zu = scaled.unscaleSolution(xs, zs, zws, zls, zus)
+        np.testing.assert_allclose(x[:], xopt, rtol=1e-6)
+        np.testing.assert_allclose(z[0], zopt, rtol=1e-6)
+
+        # Re-computing at the starting point restores the scale factors
+        self.assertEqual(scaled.updateScaling(), 0)
+        fscale2, cscale2, dscale2 = scaled.getScaling()
+        self.assertEqual(fscale0, fscale2)
+        np.testing.assert_array_equal(cscale0, cscale2)
+        np.testing.assert_array_equal(dscale0[:], dscale2[:])
@@ -0,0 +1,54 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock
+
+
+class TruncatedCGTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def optimize(self, solver, ncon=0):
+        # The upper bounds are active at the optimum. The linear
+        # constraint is only added if ncon = 1.
+        cmean = (1.0,) * ncon
+        prob = Rosenbrock(self.comm, 10, x0=0.5, ub=0.6, cmean=cmean)
+        options = {
+            "algorithm": "tr",
+            "tr_subproblem_solver": solver,
+            "tr_init_size": 0.5,
+            "tr_max_iterations": 200,
+            "qn_subspace_size": 10,
+            "output_file": os.devnull,
+            "tr_output_file": os.devnull,
+        }
+        opt = ParOpt.Optimizer(prob, options)
+        opt.optimize()
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        fail, fobj, con = prob.evalObjCon(x)
+        return np.array(x[:]), fobj
+
+    def test_bound_constrained(self):
+        x0, fobj0 = self.optimize("interior_point")
+
+        # The truncated CG method is selected automatically when there
+        # are no constraints
+        x, fobj = self.optimize("truncated_cg")
+        xa, fobja = self.optimize("automatic")
+        np.testing.assert_array_equal(xa, x)
+        self.assertEqual(fobja, fobj)
+
+        # The steps are projected onto the bounds, so the bounds are
+        # satisfied exactly and the optimum is the same
+        self.assertTrue(np.all(x <= 0.6))
+        self.assertTrue(np.any(x == 0.6))
+        np.testing.assert_allclose(x, x0, rtol=1e-6, atol=1e-7)
+        self.assertAlmostEqual(fobj, fobj0, delta=1e-6 * fobj0)
+
+    def test_constrained(self):
+        # With constraints, the interior-point method is always used
+        x0, fobj0 = self.optimize("interior_point", ncon=1)
+        for solver in ["truncated_cg", "automatic"]:
+            x, fobj = self.optimize(solver, ncon=1)
+            np.testing.assert_array_equal(x, x0)
+            self.assertEqual(fobj, fobj0)
@@ -0,0 +1,122 @@
+from paropt import ParOpt
+import os
+import unittest
+import numpy as np
+from rosenbrock import Rosenbrock
+
+
+class WarmStartTest(unittest.TestCase):
+    N_PROCS = 2  # num of procs used
+
+    def setUp(self):
+        self.history = "paropt_warm_start_test.bin"
+        self.options = {
+            "qn_subspace_size": 10,
+            "abs_res_tol": 1e-8,
+            "init_barrier_param": 0.1,
+            "output_file": os.devnull,
+        }
+
+    def tearDown(self):
+        self.comm.Barrier()
+        if self.comm.rank == 0:
+            if os.path.exists(self.history):
+                os.remove(self.history)
+
+    def cold_start(self):
+        prob = Rosenbrock(self.comm, 10, cmean=(0.2,))
+        opt = ParOpt.InteriorPoint(prob, self.options)
+        opt.optimize()
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        return prob, opt, x, z, zl, zu
+
+    def warm_start(self, x, z, zl, zu, options={}):
+        prob = Rosenbrock(self.comm, 10, cmean=(0.2,))
+        opts = dict(self.options)
+        opts.update(options)
+        opt = ParOpt.InteriorPoint(prob, opts)
+        opt.warmStartDesignAndBounds(x, z, None, zl, zu)
+        opt.optimize()
+        return prob, opt
+
+    def check_slacks(self, prob, opt):
+        """
+        Check that the slack variables satisfy c(x) - s + t = 0
+        """
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        s, t, sw, tw = opt.getOptimizedSlacks()
+        fail, fobj, con = prob.evalObjCon(x)
+        np.testing.assert_allclose(s - t, con, rtol=1e-12, atol=1e-14)
+        self.assertTrue(np.all(s > 0.0))
+        self.assertTrue(np.all(t > 0.0))
+
+    def test_warm_start_point(self):
+        prob0, opt0, x0, z0, zl0, zu0 = self.cold_start()
+
+        # Without any iterations, the starting point is returned
+        prob, opt = self.warm_start(x0, z0, zl0, zu0, {"max_major_iters": 0})
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        np.testing.assert_allclose(x[:], x0[:], rtol=1e-14)
+        np.testing.assert_allclose(z, z0, rtol=1e-14)
+        self.check_slacks(prob, opt)
+
+        # The barrier parameter matches the small complementarity at the
+        # optimum instead of the value used for a cold start
+        barrier = opt.getBarrierParameter()
+        self.assertGreaterEqual(barrier, 0.1 * self.options["abs_res_tol"])
+        self.assertLess(barrier, 1e-3 * self.options["init_barrier_param"])
+
+        # The warm start converges to the same point with fewer evaluations
+        prob, opt = self.warm_start(x0, z0, zl0, zu0)
+        x, z, zw, zl, zu = opt.getOptimizedPoint()
+        np.testing.assert_allclose(x[:], x0[:], rtol=1e-6)
+        np.testing.assert_allclose(z, z0, rtol=1e-5)
+        self.assertLess(prob.nobj, prob0.nobj)
+
+    def test_barrier_cap(self):
+        prob0, opt0, x0, z0, zl0, zu0 = self.cold_start()
+
+        # Large multipliers at a point away from the optimum give a
+        # complementarity larger than the initial barrier parameter
+        zl0[:] = 1e3
+        zu0[:] = 1e3
+        x0[:] = -1.0
+        prob, opt = self.warm_start(
+            x0, 1e3 * np.ones(1), zl0, zu0, {"max_major_iters": 0}
+        )
+        self.check_slacks(prob, opt)
+
+        # The barrier parameter is not larger than for a cold start
+        init_barrier = self.options["init_barrier_param"]
+        self.assertGreater(opt.getComplementarity(), init_barrier)
+        self.assertEqual(opt.getBarrierParameter(), init_barrier)
+
+    def optimize_tr(self, warm_start):
+        prob = Rosenbrock(self.comm, 10, cmean=(0.2,))
+        options = {
+            "tr_init_size": 0.5,
+            "tr_max_iterations": 200,
+            "tr_warm_start": warm_start,
+            "tr_output_file": os.devnull,
+            "tr_history_file": self.history,
+        }
+        qn = ParOpt.LBFGS(prob, subspace=10)
+        subproblem = ParOpt.QuadraticSubproblem(prob, qn)
+        opt = ParOpt.InteriorPoint(subproblem, {"output_file": os.devnull})
+        tr = ParOpt.TrustRegion(subproblem, options)
+        tr.optimize(opt)
+        x = tr.getOptimizedPoint()
+
+        self.comm.Barrier()
+        name, data = ParOpt.read_history(self.history)
+        return np.array(x[:]), prob.nobj, np.sum(data["sub-iter"])
+
+    def test_trust_region(self):
+        x0, nobj0, niter0 = self.optimize_tr(False)
+        x, nobj, niter = self.optimize_tr(True)
+
+        # The warm-started subproblems reach the same trust-region
+        # iterates with fewer interior-point iterations
+        np.testing.assert_allclose(x, x0, rtol=1e-5)
+        self.assertEqual(nobj, nobj0)
+        self.assertLess(niter, niter0)